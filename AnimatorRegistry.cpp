@@ -1,12 +1,14 @@
 ﻿// AnimatorRegistry.cpp
 #include "AnimatorRegistry.h"
 #include "ModelSkinned.h"
+#include "anim_blend_space.h"
 #include "shader3d.h"
 
 #include <vector>
 #include <string>
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
 
 using namespace DirectX;
 
@@ -17,13 +19,64 @@ static std::vector<AnimClipDesc> gClips;     // 动作注册表
 static int        gCurrent = -1;             // 当前播放索引（-1 = 无）
 static XMMATRIX   gBaseWorld = XMMatrixIdentity();
 
-// 记录加载的 mesh+skel 组合（以后可做只换 anim 的优化）
+// 记录加载的 mesh+skel 组合：同一组合只加载一次，切换动作只换 anim
 struct MeshSkelKey {
     std::wstring mesh;
     std::wstring skel;
     bool operator==(const MeshSkelKey& o) const { return mesh == o.mesh && skel == o.skel; }
 };
-static MeshSkelKey gLoadedKey{ L"", L"" };
+static MeshSkelKey gLoadedKey{ L"", L"" };   // 当前绑定到 ModelSkinned 的组合
+static int         gSwapAfterFade = -1;       // 保留旧模型淡入中：淡入结束后换到该动作的模型（-1 = 无）
+
+// 常驻缓存：mesh+skel → ModelSkinned 模型句柄
+struct ResidentModel {
+    MeshSkelKey key;
+    int         model = -1;
+};
+static std::vector<ResidentModel> gResidentModels;
+
+// 与 gClips 平行：每个注册动作的模型/剪辑句柄（-1 = 尚未加载）
+static std::vector<int> gClipModel;
+static std::vector<int> gClipAnim;
+
+// 混合空间：样本解析成动作索引；当前播放中的混合空间与参数
+struct BlendSpaceEntry {
+    AnimBlendSpaceDesc desc;
+    AnimBlendSpace     space;
+    std::vector<int>   sampleClip;  // 与 desc.samples 平行：gClips 索引
+};
+static std::vector<BlendSpaceEntry> gBlendSpaces;
+static int              gCurrentBlend = -1;          // -1 = 当前不是混合空间
+static float            gBlendParam[2] = { 0.0f, 0.0f };
+static AnimBlendWeights gBlendWeights;
+
+// 延后的播放：资源还在流式加载时先记下参数，当前动作继续播放，就绪后在 Update 里切换
+struct PendingPlay {
+    int            idx = -1;            // 动作索引
+    int            blend = -1;          // 或混合空间索引
+    float          blendSec = 0.0f;
+    AnimBlendCurve curve = AnimBlendCurve::Linear;
+    bool           overrideLoop = false, loopValue = true;
+    bool           overrideRate = false;
+    float          rateValue = 1.0f;
+};
+static PendingPlay gPendingPlay;
+static bool        gPlayStarted = false;   // 有新动作开始播放（ConsumePlayStarted 读取后清零）
+
+// 动画层：层号 = 下标（与 ModelSkinned 默认实例的层一一对应）
+struct LayerEntry {
+    AnimLayerDesc desc;
+    int   clip = -1;            // 层上播放中的动作索引（-1 = 空闲 / 已停止）
+    int   pendingClip = -1;     // 资源加载中的动作：就绪后在 Update 里开始
+    float pendingFade = 0.0f;
+    bool  started = false;      // ConsumeLayerStarted 读取后清零
+};
+static std::vector<LayerEntry> gLayers;
+
+// 上一次 Update 越过的动画事件（名字指向常驻剪辑，剪辑释放前有效）
+static const uint32_t kMaxFrameEvents = 16;
+static AnimEventHit   gFrameEvents[kMaxFrameEvents];
+static uint32_t       gFrameEventCount = 0;
 
 // RootMotion 累计（由 Update 写入 → 被上层消费）
 static XMFLOAT3 gRM_AccumPos = { 0,0,0 };
@@ -40,15 +93,145 @@ static void ApplyWorldWithRootMotion()
     ModelSkinned_SetWorldMatrix(T * gBaseWorld);
 }
 
+static MeshSkelKey MakeKey(const AnimClipDesc& c)
+{
+    return MeshSkelKey{ c.meshPath, c.skelPath };
+}
+
+// 组合 → 常驻模型句柄（还没加载 = -1）
+static int ResidentModelOf(const MeshSkelKey& key)
+{
+    for (const auto& r : gResidentModels)
+        if (r.key == key) return r.model;
+    return -1;
+}
+
+// 释放全部常驻资源（注册表本身不动）
+static void ReleaseResident()
+{
+    for (int h : gClipAnim) ModelSkinned_ReleaseClip(h);
+    for (auto& r : gResidentModels) ModelSkinned_ReleaseModel(r.model);
+    gResidentModels.clear();
+    gClipModel.assign(gClips.size(), -1);
+    gClipAnim.assign(gClips.size(), -1);
+    gLoadedKey = MeshSkelKey{};
+    gSwapAfterFade = -1;
+}
+
+// 确保第 idx 个动作的 mesh+skel / anim 已常驻（只在第一次做 IO）
+static bool EnsureResident(int idx)
+{
+    const AnimClipDesc& clip = gClips[idx];
+
+    if (gClipModel[idx] < 0) {
+        const MeshSkelKey key = MakeKey(clip);
+        for (const auto& r : gResidentModels) {
+            if (r.key == key) { gClipModel[idx] = r.model; break; }
+        }
+        if (gClipModel[idx] < 0) {
+            // 贴图随模型常驻：同一 mesh+skel 以首个注册动作的 mat/override 为准
+            ModelSkinnedDesc d{};
+            d.meshPath = clip.meshPath;
+            d.skelPath = clip.skelPath;
+            d.matPath = clip.matPath;
+            d.baseColorTexOverride = clip.baseColorOverride;
+
+            const int h = ModelSkinned_CreateModel(d);
+            if (h < 0) {
+#if defined(DEBUG) || defined(_DEBUG)
+                char buf[300];
+                sprintf_s(buf, "[Anim] Load mesh/skel FAILED for clip %ls (%ls)\n",
+                    clip.name.c_str(), clip.meshPath.c_str());
+                OutputDebugStringA(buf);
+#endif
+                return false;
+            }
+            gResidentModels.push_back(ResidentModel{ key, h });
+            gClipModel[idx] = h;
+        }
+    }
+
+    if (gClipAnim[idx] < 0 && !clip.animPath.empty()) {
+        gClipAnim[idx] = ModelSkinned_CreateClip(clip.animPath);
+        if (gClipAnim[idx] < 0) {
+#if defined(DEBUG) || defined(_DEBUG)
+            char buf[300];
+            sprintf_s(buf, "[Anim] Load anim FAILED for clip %ls (%ls)\n",
+                clip.name.c_str(), clip.animPath.c_str());
+            OutputDebugStringA(buf);
+#endif
+            return false;
+        }
+    }
+    return true;
+}
+
+// EnsureResident 的异步版：缺的资源发流式请求，不阻塞
+// bump = true：已在加载中的也提到 priority（Play 等着用）；false 只补发缺的（预加载）
+static void RequestResident(int idx, AssetStreamPriority priority, bool bump)
+{
+    const AnimClipDesc& clip = gClips[idx];
+
+    if (gClipModel[idx] < 0) {
+        const MeshSkelKey key = MakeKey(clip);
+        for (const auto& r : gResidentModels) {
+            if (r.key == key) { gClipModel[idx] = r.model; break; }
+        }
+    }
+    if (gClipModel[idx] < 0) {
+        ModelSkinnedDesc d{};
+        d.meshPath = clip.meshPath;
+        d.skelPath = clip.skelPath;
+        d.matPath = clip.matPath;
+        d.baseColorTexOverride = clip.baseColorOverride;
+
+        const int h = ModelSkinned_CreateModelAsync(d, priority);
+        if (h >= 0) {
+            gResidentModels.push_back(ResidentModel{ MakeKey(clip), h });
+            gClipModel[idx] = h;
+        }
+    }
+    else if (bump) {
+        ModelSkinned_SetModelLoadPriority(gClipModel[idx], priority);
+    }
+
+    if (clip.animPath.empty()) return;
+    if (gClipAnim[idx] < 0) gClipAnim[idx] = ModelSkinned_CreateClipAsync(clip.animPath, priority);
+    else if (bump) ModelSkinned_SetClipLoadPriority(gClipAnim[idx], priority);
+}
+
+// 第 idx 个动作的常驻资源：两边都 Ready 才算 Ready；任一失败 / 取消 / 没发出请求算 Failed
+static AssetStreamState ResidentState(int idx)
+{
+    const AssetStreamState ms = ModelSkinned_GetModelState(gClipModel[idx]);
+    const AssetStreamState cs = gClips[idx].animPath.empty()
+        ? AssetStreamState::Ready : ModelSkinned_GetClipState(gClipAnim[idx]);
+    if (ms == AssetStreamState::Ready && cs == AssetStreamState::Ready) return AssetStreamState::Ready;
+
+    auto busy = [](AssetStreamState s) {
+        return s == AssetStreamState::Ready || s == AssetStreamState::Queued || s == AssetStreamState::Loading;
+    };
+    return (busy(ms) && busy(cs)) ? AssetStreamState::Loading : AssetStreamState::Failed;
+}
+
 // ---------------------------------
 // 对外实现
 // ---------------------------------
 bool AnimatorRegistry_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx)
 {
     gClips.clear();
+    gClipModel.clear();
+    gClipAnim.clear();
+    gResidentModels.clear();
     gCurrent = -1;
     gBaseWorld = XMMatrixIdentity();
     gLoadedKey = MeshSkelKey{};
+    gSwapAfterFade = -1;
+    gBlendSpaces.clear();
+    gCurrentBlend = -1;
+    gPendingPlay = PendingPlay{};
+    gPlayStarted = false;
+    gLayers.clear();
 
     gRM_AccumPos = { 0,0,0 };
     gRM_AccumYaw = 0.0f;
@@ -60,15 +243,33 @@ bool AnimatorRegistry_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx)
 
 void AnimatorRegistry_Finalize()
 {
+    ReleaseResident();
     gClips.clear();
+    gClipModel.clear();
+    gClipAnim.clear();
     gCurrent = -1;
-    // 如需 ModelSkinned 侧释放，按你的工程调用相应 finalize
+    gBlendSpaces.clear();
+    gCurrentBlend = -1;
+    gPendingPlay = PendingPlay{};
+    gPlayStarted = false;
+    gLayers.clear();
+    gFrameEventCount = 0;
+    ModelSkinned_Finalize();
 }
 
 void AnimatorRegistry_Clear()
 {
+    ReleaseResident();
     gClips.clear();
+    gClipModel.clear();
+    gClipAnim.clear();
     gCurrent = -1;
+    gBlendSpaces.clear();
+    gCurrentBlend = -1;
+    gPendingPlay = PendingPlay{};
+    gPlayStarted = false;
+    gLayers.clear();
+    gFrameEventCount = 0;
 }
 
 static int FindIndex(const std::wstring& name)
@@ -83,12 +284,84 @@ bool AnimatorRegistry_Register(const AnimClipDesc& clip)
     if (clip.name.empty()) return false;
     if (FindIndex(clip.name) >= 0) return false; // 去重
     gClips.push_back(clip);
+    gClipModel.push_back(-1);
+    gClipAnim.push_back(-1);
     return true;
 }
 
+static int FindBlendSpace(const std::wstring& name)
+{
+    for (int i = 0; i < (int)gBlendSpaces.size(); ++i)
+        if (gBlendSpaces[i].desc.name == name) return i;
+    return -1;
+}
+
+bool AnimatorRegistry_RegisterBlendSpace(const AnimBlendSpaceDesc& bs)
+{
+    if (bs.name.empty() || bs.samples.empty()) return false;
+    if (FindIndex(bs.name) >= 0 || FindBlendSpace(bs.name) >= 0) return false;
+
+    BlendSpaceEntry e{};
+    e.desc = bs;
+    e.space.dims = (bs.dims == 2) ? 2u : 1u;
+    for (const auto& smp : bs.samples) {
+        const int idx = FindIndex(smp.clip);
+        if (idx < 0) {
+#if defined(DEBUG) || defined(_DEBUG)
+            char buf[300];
+            sprintf_s(buf, "[Anim] Blend space %ls: unknown clip %ls\n", bs.name.c_str(), smp.clip.c_str());
+            OutputDebugStringA(buf);
+#endif
+            return false;
+        }
+        e.sampleClip.push_back(idx);
+        e.space.posX.push_back(smp.x);
+        e.space.posY.push_back(smp.y);
+    }
+    if (!AnimBlendSpace_Build(e.space)) {
+#if defined(DEBUG) || defined(_DEBUG)
+        char buf[300];
+        sprintf_s(buf, "[Anim] Blend space %ls: build FAILED (degenerate sample layout)\n", bs.name.c_str());
+        OutputDebugStringA(buf);
+#endif
+        return false;
+    }
+    gBlendSpaces.push_back(std::move(e));
+    return true;
+}
+
+static int FindLayer(const std::wstring& name)
+{
+    for (int i = 0; i < (int)gLayers.size(); ++i)
+        if (gLayers[i].desc.name == name) return i;
+    return -1;
+}
+
+bool AnimatorRegistry_RegisterLayer(const AnimLayerDesc& layer)
+{
+    if (layer.name.empty() || FindLayer(layer.name) >= 0) return false;
+    if ((int)gLayers.size() >= MODEL_SKINNED_MAX_LAYERS) {
+#if defined(DEBUG) || defined(_DEBUG)
+        char buf[300];
+        sprintf_s(buf, "[Anim] Layer %ls: too many layers (max %d)\n", layer.name.c_str(), MODEL_SKINNED_MAX_LAYERS);
+        OutputDebugStringA(buf);
+#endif
+        return false;
+    }
+    LayerEntry e{};
+    e.desc = layer;
+    gLayers.push_back(std::move(e));
+    return true;
+}
+
+bool AnimatorRegistry_HasLayer(const std::wstring& name)
+{
+    return FindLayer(name) >= 0;
+}
+
 bool AnimatorRegistry_Has(const std::wstring& name)
 {
-    return FindIndex(name) >= 0;
+    return FindIndex(name) >= 0 || FindBlendSpace(name) >= 0;
 }
 
 const AnimClipDesc* AnimatorRegistry_Get(const std::wstring& name)
@@ -99,32 +372,83 @@ const AnimClipDesc* AnimatorRegistry_Get(const std::wstring& name)
 
 bool AnimatorRegistry_LoadAll()
 {
-    // 当前实现：真正的加载在 Play 里做；这里返回 true
+    // 预加载全部注册动作：之后 Play 只切换句柄，不再读文件
+    bool ok = true;
+    for (int i = 0; i < (int)gClips.size(); ++i) {
+        if (!EnsureResident(i)) ok = false;
+    }
+    return ok;
+}
+
+void AnimatorRegistry_LoadAllAsync(AssetStreamPriority priority)
+{
+    for (int i = 0; i < (int)gClips.size(); ++i) RequestResident(i, priority, false);
+}
+
+bool AnimatorRegistry_IsReady(const std::wstring& name)
+{
+    const int idx = FindIndex(name);
+    if (idx >= 0) return ResidentState(idx) == AssetStreamState::Ready;
+    const int bs = FindBlendSpace(name);
+    if (bs < 0) return false;
+    for (int i : gBlendSpaces[bs].sampleClip)
+        if (ResidentState(i) != AssetStreamState::Ready) return false;
     return true;
 }
 
-bool AnimatorRegistry_Play(const std::wstring& name,
+// 按当前参数重算权重并交给 ModelSkinned（只动权重，相位连续）
+static void ApplyBlendWeights()
+{
+    if (gCurrentBlend < 0) return;
+    const BlendSpaceEntry& e = gBlendSpaces[gCurrentBlend];
+    gBlendWeights = AnimBlendSpace_Evaluate(e.space, gBlendParam[0], gBlendParam[1]);
+
+    int   clips[3];
+    float rates[3];
+    for (uint32_t k = 0; k < gBlendWeights.count; ++k) {
+        const uint16_t s = gBlendWeights.sample[k];
+        clips[k] = gClipAnim[e.sampleClip[s]];
+        rates[k] = e.desc.samples[s].rate;
+    }
+    ModelSkinned_SetBlendClips(clips, gBlendWeights.weight, rates, (int)gBlendWeights.count);
+}
+
+// Play / CrossFade 共用：blendSec <= 0 为硬切
+static bool PlayIndex(int idx, float blendSec, AnimBlendCurve curve,
     bool* outChanged,
     bool overrideLoop, bool loopValue,
     bool overrideRate, float rateValue)
 {
     if (outChanged) *outChanged = false;
-
-    int idx = FindIndex(name);
     if (idx < 0) return false;
+    gCurrentBlend = -1;
 
     const AnimClipDesc& clip = gClips[idx];
-
-    // 底层加载描述
-    ModelSkinnedDesc d{};
-    d.meshPath = clip.meshPath;
-    d.skelPath = clip.skelPath;
-    d.animPath = clip.animPath;
-    d.matPath = clip.matPath;
-    d.baseColorTexOverride = clip.baseColorOverride;
-
-    // 目前为稳妥：统一全量加载
-    if (!ModelSkinned_Load(d)) return false;
+    const std::wstring& name = clip.name;
+
+    // 常驻资源（LoadAll 已预加载时这里不做 IO）
+    if (!EnsureResident(idx)) return false;
+
+    // mesh+skel 组合变化时才换模型；anim 每次都重新绑定（时间归零）
+    // 过渡中且两个模型可互换（路径不同、内容相同的 mesh+skel；同一套资源应在注册时共用路径）→ 保留当前模型，只换剪辑，才能淡入；
+    // 淡入结束后在 Update 里换到新动作自己的模型（SwapAfterFade），画哪个模型不取决于过渡历史
+    const MeshSkelKey key = MakeKey(clip);
+    gSwapAfterFade = -1;
+    if (!(key == gLoadedKey)) {
+        const int bound = ResidentModelOf(gLoadedKey);
+        const bool keepModel = blendSec > 0.0f && bound >= 0
+            && ModelSkinned_AreModelsInterchangeable(bound, gClipModel[idx]);
+        if (keepModel) {
+            gSwapAfterFade = idx;
+        }
+        else {
+            if (!ModelSkinned_BindModel(gClipModel[idx])) return false;
+            gLoadedKey = key;
+            blendSec = 0.0f;
+        }
+    }
+    // 旧剪辑留作淡出源，两边都常驻 → 过渡不需要重新加载
+    if (!ModelSkinned_CrossFade(gClipAnim[idx], blendSec, curve)) return false;
 
     // ★ 新增：若本动画注册时指定了 motion-root，就在此覆盖
     if (!clip.motionRootNameUTF8.empty()) {
@@ -209,17 +533,279 @@ bool AnimatorRegistry_Play(const std::wstring& name,
     return true;
 }
 
+// 播放混合空间：先以主样本（当前参数下权重最大）走 PlayIndex，再挂上其余样本
+static bool PlayBlendSpace(int bsIdx, float blendSec, AnimBlendCurve curve, bool* outChanged)
+{
+    if (outChanged) *outChanged = false;
+    if (bsIdx < 0) return false;
+    const BlendSpaceEntry& e = gBlendSpaces[bsIdx];
+
+    // 样本全部常驻，且与主样本骨架兼容（每帧换主样本也不需要 IO / 换模型）
+    for (int idx : e.sampleClip) if (!EnsureResident(idx)) return false;
+
+    const int prevBlend = gCurrentBlend;
+    const AnimBlendWeights w = AnimBlendSpace_Evaluate(e.space, gBlendParam[0], gBlendParam[1]);
+    const int mainIdx = e.sampleClip[w.sample[0]];
+    if (!PlayIndex(mainIdx, blendSec, curve, nullptr, false, true, false, 1.0f)) return false;
+
+    for (int idx : e.sampleClip) {
+        if (!ModelSkinned_AreModelsInterchangeable(gClipModel[mainIdx], gClipModel[idx])) {
+#if defined(DEBUG) || defined(_DEBUG)
+            char buf[300];
+            sprintf_s(buf, "[Anim] Blend space %ls: clip %ls has an incompatible skeleton\n",
+                e.desc.name.c_str(), gClips[idx].name.c_str());
+            OutputDebugStringA(buf);
+#endif
+            return true; // 主样本照常播放，只是不混合
+        }
+    }
+
+    gCurrentBlend = bsIdx;
+    ApplyBlendWeights();
+    if (outChanged) *outChanged = (prevBlend != bsIdx);
+    return true;
+}
+
+// 资源齐了就播放；还在加载就记成延后播放（高优先级请求，当前动作继续播放）
+// 最新一次 Play / CrossFade 覆盖之前没生效的延后播放；资源加载失败返回 false
+static bool PlayOrDefer(const PendingPlay& p, bool* outChanged)
+{
+    if (outChanged) *outChanged = false;
+    if (p.idx < 0 && p.blend < 0) return false;
+
+    const std::vector<int> one{ p.idx };
+    const std::vector<int>& idxs = (p.idx >= 0) ? one : gBlendSpaces[p.blend].sampleClip;
+    bool loading = false;
+    for (int i : idxs) {
+        RequestResident(i, AssetStreamPriority::High, true);
+        const AssetStreamState s = ResidentState(i);
+        if (s == AssetStreamState::Failed) { gPendingPlay = PendingPlay{}; return false; }
+        if (s != AssetStreamState::Ready) loading = true;
+    }
+    if (loading) {
+        gPendingPlay = p;
+        gPlayStarted = false;
+        return true;
+    }
+
+    gPendingPlay = PendingPlay{};
+    const bool ok = (p.idx >= 0)
+        ? PlayIndex(p.idx, p.blendSec, p.curve, outChanged, p.overrideLoop, p.loopValue, p.overrideRate, p.rateValue)
+        : PlayBlendSpace(p.blend, p.blendSec, p.curve, outChanged);
+    if (ok) gPlayStarted = true;
+    return ok;
+}
+
+bool AnimatorRegistry_Play(const std::wstring& name,
+    bool* outChanged,
+    bool overrideLoop, bool loopValue,
+    bool overrideRate, float rateValue)
+{
+    PendingPlay p;
+    p.idx = FindIndex(name);
+    if (p.idx < 0) p.blend = FindBlendSpace(name);
+    p.overrideLoop = overrideLoop;
+    p.loopValue = loopValue;
+    p.overrideRate = overrideRate;
+    p.rateValue = rateValue;
+    return PlayOrDefer(p, outChanged);
+}
+
+bool AnimatorRegistry_CrossFade(const std::wstring& name, float blendSeconds, const char* blendCurve,
+    bool* outChanged)
+{
+    PendingPlay p;
+    p.idx = FindIndex(name);
+    if (p.idx < 0) p.blend = FindBlendSpace(name);
+    p.blendSec = blendSeconds;
+    p.curve = AnimPose_ParseBlendCurve(blendCurve);
+    return PlayOrDefer(p, outChanged);
+}
+
+// 层上开始播放（资源已常驻）：遮罩每次按当前模型重设，层权重淡入
+static bool StartLayer(int li, int idx, float fadeSec)
+{
+    LayerEntry& e = gLayers[li];
+    const AnimClipDesc& clip = gClips[idx];
+    const int inst = ModelSkinned_GetDefaultInstance();
+
+    std::vector<const char*> roots;
+    for (const std::string& r : e.desc.maskRoots) roots.push_back(r.c_str());
+    const float* weights = (e.desc.maskWeights.size() == roots.size()) ? e.desc.maskWeights.data() : nullptr;
+    ModelSkinned_SetLayerMask(inst, li, e.desc.mode, roots.data(), weights, (int)roots.size());
+
+    if (!ModelSkinned_PlayLayer(inst, li, gClipAnim[idx], e.desc.weight, fadeSec, clip.loop, clip.playbackRate)) {
+#if defined(DEBUG) || defined(_DEBUG)
+        char buf[300];
+        sprintf_s(buf, "[Anim] Layer %ls: play %ls FAILED (incompatible skeleton?)\n",
+            e.desc.name.c_str(), clip.name.c_str());
+        OutputDebugStringA(buf);
+#endif
+        e.clip = -1;
+        return false;
+    }
+    e.clip = idx;
+    e.started = true;
+    return true;
+}
+
+bool AnimatorRegistry_PlayLayer(const std::wstring& layer, const std::wstring& clip, float fadeSeconds)
+{
+    const int li = FindLayer(layer);
+    const int idx = FindIndex(clip);
+    if (li < 0 || idx < 0) return false;
+    LayerEntry& e = gLayers[li];
+    e.pendingClip = -1;
+    e.started = false;
+
+    RequestResident(idx, AssetStreamPriority::High, true);
+    const AssetStreamState s = ResidentState(idx);
+    if (s == AssetStreamState::Failed) return false;
+    if (s != AssetStreamState::Ready) {
+        e.pendingClip = idx;
+        e.pendingFade = fadeSeconds;
+        return true;
+    }
+    return StartLayer(li, idx, fadeSeconds);
+}
+
+void AnimatorRegistry_StopLayer(const std::wstring& layer, float fadeSeconds)
+{
+    const int li = FindLayer(layer);
+    if (li < 0) return;
+    gLayers[li].pendingClip = -1;
+    gLayers[li].clip = -1;
+    gLayers[li].started = false;
+    ModelSkinned_StopLayer(ModelSkinned_GetDefaultInstance(), li, fadeSeconds);
+}
+
+bool AnimatorRegistry_IsLayerActive(const std::wstring& layer)
+{
+    const int li = FindLayer(layer);
+    if (li < 0) return false;
+    return gLayers[li].pendingClip >= 0 || ModelSkinned_IsLayerActive(ModelSkinned_GetDefaultInstance(), li);
+}
+
+bool AnimatorRegistry_ConsumeLayerStarted(const std::wstring& layer, float* outClipSec)
+{
+    const int li = FindLayer(layer);
+    if (li < 0 || !gLayers[li].started) return false;
+    LayerEntry& e = gLayers[li];
+    e.started = false;
+
+    float t = 0.0f, dur = 0.0f;
+    if (!ModelSkinned_GetLayerTime(ModelSkinned_GetDefaultInstance(), li, &t, &dur)) return false;
+    const float rate = gClips[e.clip].playbackRate;
+    if (outClipSec) *outClipSec = dur / (rate > 0.0f ? rate : 1.0f);
+    return true;
+}
+
+bool AnimatorRegistry_ConsumePlayStarted()
+{
+    const bool started = gPlayStarted;
+    gPlayStarted = false;
+    return started;
+}
+
+void AnimatorRegistry_SetBlendParams(float x, float y)
+{
+    gBlendParam[0] = x;
+    gBlendParam[1] = y;
+    ApplyBlendWeights();
+}
+
+bool AnimatorRegistry_GetBlendSpaceSpeed(float* outSpeed)
+{
+    if (!outSpeed || gCurrentBlend < 0) return false;
+    const BlendSpaceEntry& e = gBlendSpaces[gCurrentBlend];
+    float v = 0.0f;
+    for (uint32_t k = 0; k < gBlendWeights.count; ++k) {
+        const float sp = e.desc.samples[gBlendWeights.sample[k]].speed;
+        if (sp <= 0.0f) return false;
+        v += gBlendWeights.weight[k] * sp;
+    }
+    *outSpeed = v;
+    return true;
+}
+
 void AnimatorRegistry_SetWorld(const XMMATRIX& world)
 {
     gBaseWorld = world;
     ApplyWorldWithRootMotion(); // 让位移叠加到新 world 上
 }
 
+// 延后的层播放：资源就绪就开始，加载失败则放弃
+static void UpdatePendingLayers()
+{
+    for (int li = 0; li < (int)gLayers.size(); ++li) {
+        LayerEntry& e = gLayers[li];
+        if (e.pendingClip < 0) continue;
+        const AssetStreamState s = ResidentState(e.pendingClip);
+        if (s == AssetStreamState::Loading) continue;
+        const int idx = e.pendingClip;
+        e.pendingClip = -1;
+        if (s == AssetStreamState::Ready) StartLayer(li, idx, e.pendingFade);
+#if defined(DEBUG) || defined(_DEBUG)
+        else {
+            char buf[300];
+            sprintf_s(buf, "[Anim] Deferred layer play FAILED for %ls on %ls\n",
+                gClips[idx].name.c_str(), e.desc.name.c_str());
+            OutputDebugStringA(buf);
+        }
+#endif
+    }
+}
+
+// 保留旧模型的淡入结束 → 换到当前动作自己的模型（剪辑 / 时间不变）
+static void SwapAfterFade()
+{
+    if (gSwapAfterFade < 0 || ModelSkinned_IsCrossFading(ModelSkinned_GetDefaultInstance())) return;
+    const int idx = gSwapAfterFade;
+    gSwapAfterFade = -1;
+    if (ModelSkinned_SwapModel(ModelSkinned_GetDefaultInstance(), gClipModel[idx])) {
+        gLoadedKey = MakeKey(gClips[idx]);
+    }
+#if defined(DEBUG) || defined(_DEBUG)
+    else {
+        char buf[300];
+        sprintf_s(buf, "[Anim] Model swap after fade FAILED for %ls (keeping the previous model)\n", gClips[idx].name.c_str());
+        OutputDebugStringA(buf);
+    }
+#endif
+}
+
+// 本帧事件：当前动作的在前，各层的按层号接在后面
+static void CollectFrameEvents()
+{
+    gFrameEventCount = ModelSkinned_GetUpdateEvents(gFrameEvents, kMaxFrameEvents);
+    const int inst = ModelSkinned_GetDefaultInstance();
+    for (int li = 0; li < (int)gLayers.size() && gFrameEventCount < kMaxFrameEvents; ++li) {
+        gFrameEventCount += ModelSkinned_GetLayerUpdateEvents(inst, li,
+            gFrameEvents + gFrameEventCount, kMaxFrameEvents - gFrameEventCount);
+    }
+}
+
 void AnimatorRegistry_Update(double dtSec)
 {
+    // 延后的播放：资源就绪就在这里切换；加载失败则放弃，保持当前动作
+    if (gPendingPlay.idx >= 0 || gPendingPlay.blend >= 0) {
+        const PendingPlay p = gPendingPlay;
+        if (!PlayOrDefer(p, nullptr)) {
+#if defined(DEBUG) || defined(_DEBUG)
+            char buf[300];
+            sprintf_s(buf, "[Anim] Deferred play FAILED for %ls\n",
+                (p.idx >= 0 ? gClips[p.idx].name : gBlendSpaces[p.blend].desc.name).c_str());
+            OutputDebugStringA(buf);
+#endif
+        }
+    }
+    SwapAfterFade();
+
     if (gCurrent < 0 || gCurrent >= (int)gClips.size()) {
         // 没有有效动画也要推进底层时间（如静态姿势）
+        UpdatePendingLayers();
         ModelSkinned_Update(dtSec);
+        CollectFrameEvents();
         return;
     }
 
@@ -273,7 +859,22 @@ void AnimatorRegistry_Update(double dtSec)
     }
 
     // 先采样再推进：保持 [t, t+dt] 采样与推进时序一致
+    UpdatePendingLayers();
     ModelSkinned_Update(dtSec);
+    CollectFrameEvents();
+}
+
+uint32_t AnimatorRegistry_GetFrameEvents(AnimEventHit* out, uint32_t maxOut)
+{
+    if (!out) return 0;
+    const uint32_t n = std::min(gFrameEventCount, maxOut);
+    for (uint32_t i = 0; i < n; ++i) out[i] = gFrameEvents[i];
+    return n;
+}
+
+uint32_t AnimatorRegistry_QueryEvents(float t0, float t1, AnimEventHit* out, uint32_t maxOut)
+{
+    return ModelSkinned_QueryEvents(t0, t1, out, maxOut);
 }
 
 void AnimatorRegistry_Draw()
@@ -351,6 +952,7 @@ bool AnimatorRegistry_DebugGetCurrentClipLengthSec(float* outSec)
 {
     if (!outSec) return false;
     if (gCurrent < 0 || gCurrent >= (int)gClips.size()) return false;
+    if (gPendingPlay.idx >= 0 || gPendingPlay.blend >= 0) return false;   // 新动作还没开始
 
     const auto& cur = gClips[gCurrent];
     const uint32_t fc = ModelSkinned_GetFrameCount();
@@ -4,6 +4,10 @@
 #include <d3d11.h>
 #include <DirectXMath.h>
 
+#include "anim_clip.h"   // AnimEventHit
+#include "anim_pose.h"   // AnimLayerBlend
+#include "asset_stream.h" // AssetStreamPriority
+
 // RootMotion 策略
 enum class RootMotionType : uint8_t {
     None = 0,           // 不使用动画位移
@@ -32,6 +36,30 @@ struct AnimClipDesc {
     std::string motionRootNameUTF8; 
 };
 
+// 混合空间样本：引用一个已注册动作，放在参数轴 (x[,y]) 上
+struct AnimBlendSampleDesc {
+    std::wstring clip;                 // 动作名（须已 Register，骨架兼容）
+    float x = 0.0f, y = 0.0f;          // 参数位置（1D 只用 x）
+    float rate = 1.0f;                 // 该样本自身的播放速率（同一剪辑可用不同速率放在不同位置）
+    float speed = 0.0f;                // 该样本对应的移动速度（米/秒，0 = 不提供）
+};
+
+// 混合空间：Play / CrossFade 可直接用 name 播放
+struct AnimBlendSpaceDesc {
+    std::wstring name;
+    uint32_t     dims = 1;             // 1 或 2
+    std::vector<AnimBlendSampleDesc> samples;
+};
+
+// 动画层：基础动作（Play / CrossFade / 混合空间）之上的覆盖 / 叠加层，如移动中只换上半身的攻击
+struct AnimLayerDesc {
+    std::wstring             name;
+    AnimLayerBlend           mode = AnimLayerBlend::Override;
+    std::vector<std::string> maskRoots;     // 子树根骨骼名（UTF-8，如 "mixamorig:Spine" 及以下）；空 = 全身
+    std::vector<float>       maskWeights;   // 与 maskRoots 平行（空 = 全 1）
+    float                    weight = 1.0f; // 层上动作淡入后的层权重
+};
+
 // 初始化/结束
 bool AnimatorRegistry_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx);
 void AnimatorRegistry_Finalize();
@@ -39,21 +67,60 @@ void AnimatorRegistry_Finalize();
 // 注册/查询
 void AnimatorRegistry_Clear();
 bool AnimatorRegistry_Register(const AnimClipDesc& clip);
-bool AnimatorRegistry_Has(const std::wstring& name);
+bool AnimatorRegistry_Has(const std::wstring& name);          // 动作或混合空间
 const AnimClipDesc* AnimatorRegistry_Get(const std::wstring& name);
-bool AnimatorRegistry_LoadAll(); // 目前不做 IO，仅校验
+bool AnimatorRegistry_LoadAll(); // 预加载全部注册动作（mesh+skel 按组合去重）；全部成功返回 true
+// 异步预加载（asset_stream）：立即返回；Play / CrossFade 用到还没加载完的动作时会提到 High 并延后切换
+void AnimatorRegistry_LoadAllAsync(AssetStreamPriority priority = AssetStreamPriority::Low);
+bool AnimatorRegistry_IsReady(const std::wstring& name);      // 动作（或混合空间的全部样本）已常驻
+// 注册混合空间（样本动作需先 Register）；名字不能与动作或其他混合空间重复
+bool AnimatorRegistry_RegisterBlendSpace(const AnimBlendSpaceDesc& bs);
+
+// 注册动画层：层号 = 注册顺序（先注册的先合成），最多 MODEL_SKINNED_MAX_LAYERS 个；名字不能重复
+bool AnimatorRegistry_RegisterLayer(const AnimLayerDesc& layer);
+bool AnimatorRegistry_HasLayer(const std::wstring& name);
 
 // 播放控制（可传入临时覆盖参数）
+// 资源还在流式加载时：发高优先级请求、返回 true，当前动作继续播放，就绪后在 Update 里切换
 bool AnimatorRegistry_Play(const std::wstring& name,
     bool* outChanged = nullptr,
     bool overrideLoop = false, bool loopValue = true,
     bool overrideRate = false, float rateValue = 1.0f);
 
+// 交叉淡入：旧动作继续播放，在 blendSeconds 秒内按曲线过渡到 name
+// blendCurve："linear" / "ease_in" / "ease_out" / "ease_in_out"（PlayerSMOutput.blendCurve 直接传入）
+// mesh+skel 组合不同时退化为硬切
+bool AnimatorRegistry_CrossFade(const std::wstring& name, float blendSeconds, const char* blendCurve,
+    bool* outChanged = nullptr);
+// 自上次调用以来是否有 Play / CrossFade 真正生效（含延后的那种）；读取后清零
+bool AnimatorRegistry_ConsumePlayStarted();
+
+// 在层上播放动作（骨架须与当前基础动作兼容，按骨骼名重定向）：基础动作照常播放，层权重在 fadeSeconds 内淡入
+// 只采样遮罩内的骨骼，层级合成仍然只做一次；资源还在流式加载时延后到 Update 开始
+bool AnimatorRegistry_PlayLayer(const std::wstring& layer, const std::wstring& clip, float fadeSeconds);
+// 层权重在 fadeSeconds 内淡出，之后层空闲
+void AnimatorRegistry_StopLayer(const std::wstring& layer, float fadeSeconds);
+bool AnimatorRegistry_IsLayerActive(const std::wstring& layer);   // 播放中 / 淡出中 / 等资源
+// 层上的动作真正开始后读一次：返回 true 并给出剪辑时长（秒，考虑 playbackRate）；读取后清零
+bool AnimatorRegistry_ConsumeLayerStarted(const std::wstring& layer, float* outClipSec);
+
+// 混合空间参数（当前播放的是混合空间时立即重算权重；否则只记下，下次进入时使用）
+void AnimatorRegistry_SetBlendParams(float x, float y = 0.0f);
+// 当前混合空间按权重插值的移动速度；不在混合空间 / 样本没给 speed 时返回 false
+bool AnimatorRegistry_GetBlendSpaceSpeed(float* outSpeed);
+
 // 世界矩阵/更新/绘制
 void AnimatorRegistry_SetWorld(const DirectX::XMMATRIX& world);
 void AnimatorRegistry_Update(double dtSec);
 void AnimatorRegistry_Draw();
 
+// 动画事件（.anim 事件轨道，cook_tool.py anim-events 写入）
+// 上一次 AnimatorRegistry_Update 中当前动作越过的事件（按发生顺序；淡出中的旧动作不算），
+// 之后是各层上的动作越过的事件（按层号），返回个数
+uint32_t AnimatorRegistry_GetFrameEvents(AnimEventHit* out, uint32_t maxOut);
+// 当前动作在 [t0, t1)（剪辑时间，秒）越过的事件；循环动作 t1 可越过终点（回绕）
+uint32_t AnimatorRegistry_QueryEvents(float t0, float t1, AnimEventHit* out, uint32_t maxOut);
+
 // 状态查询
 std::wstring  AnimatorRegistry_CurrentName();
 RootMotionType AnimatorRegistry_CurrentRootMotionType();
@@ -76,5 +143,5 @@ bool AnimatorRegistry_ConsumeRootMotionDelta(RootMotionDelta* out);
 bool AnimatorRegistry_DebugGetCurrentClipName(const wchar_t** outName);
 // 返回 motion-root 的局部 yaw：首帧 yaw0、当前帧 yawNow（弧度）
 bool AnimatorRegistry_DebugGetRootYaw(float* yaw0, float* yawNow);
-// 返回“当前剪辑总时长（秒）”（考虑 playbackRate）
+// 返回“当前剪辑总时长（秒）”（考虑 playbackRate）；有延后播放未生效时返回 false
 bool AnimatorRegistry_DebugGetCurrentClipLengthSec(float* outSec);
@@ -6,10 +6,20 @@
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <Windows.h>
 
 #include "asset_format.h"     // 你 AssetCooker 的公共头（含 JointRec / SkeletonHeader 等）
+#include "anim_pose.h"        // 骨架 SoA / 线性姿态计算
+#include "anim_clip.h"        // .anim v1/v2 读取与采样
+#include "asset_view.h"       // .mesh/.skel/.anim 只读映射
+#include "asset_stream.h"     // 异步加载（CreateModelAsync / CreateClipAsync）
+#include "anim_skinning.h"    // CPU 蒙皮（包围盒 / 射线 / 校验）
+#include "mesh_quant.h"       // .mesh v2 压缩顶点解码
+#include "mesh_lod.h"         // 网格 LOD 表 / 按屏幕大小选档
+#include "job_pool.h"         // EvaluatePoses 并行
+#include "camera.h"           // 动画 LOD：Camera_GetPosition
 #include "shader3d.h"         // 用来设置 b0~b4（已存在）
 #include "texture.h"          // Texture_Load / Texture_SetTexture
 #include "sampler.h"          // Sampler_SetFillterAnisotropic 等
@@ -24,67 +34,247 @@ namespace fs = std::filesystem;
 static ID3D11Device* gDev = nullptr;
 static ID3D11DeviceContext* gCtx = nullptr;
 
-static ID3D11Buffer* gVB = nullptr;
-static ID3D11Buffer* gIB = nullptr;
-static UINT                  gIndexCount = 0;
-static DXGI_FORMAT           gIndexFormat = DXGI_FORMAT_R16_UINT;
-
 static ID3D11VertexShader* gVS = nullptr;
 static ID3D11InputLayout* gIL = nullptr;
+static ID3D11VertexShader* gVSDQ = nullptr;   // 双四元数蒙皮（输入布局与 gVS 相同，共用 gIL）
+
+// .mesh v2 压缩顶点（28 字节）：位置在 VS 里用 b6 反量化；没有 .cso 时加载时解成 v1 上传
+static ID3D11VertexShader* gVSQ = nullptr;
+static ID3D11VertexShader* gVSDQQ = nullptr;
+static ID3D11InputLayout*  gILQ = nullptr;
 
-// b5：骨矩阵数组
-static ID3D11Buffer* gCBBones = nullptr;
+// b5：骨矩阵数组（常量缓冲按实例持有，见 SkinnedInstance::boneCB；DQ 模式每骨骼 2 个 float4，共用同一块）
 static const UINT            MAX_BONES = 128;
 
 // 可选：光照常量（与现有 Shader3d 配合）
 static ID3D11Buffer* gCBAmbient = nullptr;     // VS b3
 static ID3D11Buffer* gCBDirectional = nullptr; // VS b4
 
-// Velocity-Driven 开关：为“动画位移”使用时清除根的局部 XZ 平移
-static bool                  gZeroRootTransXZ = false;
-
-// 世界矩阵（由上层设置）
-static XMMATRIX              gWorld = XMMatrixIdentity();
-
-// 贴图
-static int                   gTexId = -1;
+// 一次 DrawIndexed：索引/顶点范围 + 本次要上传的骨骼（boneCount == 0：未拆分，直接用全局下标）
+struct SkinnedDrawRange {
+    UINT indexOffset = 0, indexCount = 0;
+    UINT vertexOffset = 0, vertexCount = 0;
+    UINT boneOffset = 0, boneCount = 0;      // paletteBones[boneOffset .. +boneCount)
+    UINT lodFirst = 0;                        // HAS_LODS：lodRanges[lodFirst .. +lodCount)
+    UINT material = 0;                        // Submesh::materialIndex（draws 按它排序）
+    AABB bounds{};                            // 子网格（bind pose）包围盒：网格 LOD 选档用
+};
 
-// 骨架
-struct Joint {
-    int        parent = -1;
-    XMFLOAT4X4 invBind;     // 行主存储
-    XMFLOAT3   bindT{ 0,0,0 };
-    XMFLOAT4   bindR{ 0,0,0,1 };
-    XMFLOAT3   bindS{ 1,1,1 };
-    std::string name;       // ★ 新增：骨骼名（UTF-8）
+// 常驻资源：mesh+skel（GPU 缓冲、已做 bind-pose 修正的骨架、贴图）——只加载一次
+struct SkinnedModelRes {
+    ID3D11Buffer* vb = nullptr;
+    ID3D11Buffer* ib = nullptr;
+    UINT          indexCount = 0;
+    DXGI_FORMAT   indexFormat = DXGI_FORMAT_R16_UINT;
+    std::vector<SkinnedDrawRange> draws;      // 至少一个
+    std::vector<uint16_t>         paletteBones; // HAS_BONE_PALETTES：子网格局部下标 → 全局骨骼
+    UINT                          lodCount = 1; // 网格 LOD 档数（1 = 只有 LOD0）
+    std::vector<MeshLodRange>     lodRanges;    // [draw * lodCount + lod]
+    UINT          vertexStride = sizeof(SkinnedVertexV1);
+    bool          quantized = false;    // VB 是 v2 压缩顶点（gVSQ / gILQ + b6）
+    AABB          bounds{};             // v2 的反量化区间（MeshHeader::bounds）
+    ID3D11Buffer* cbDequant = nullptr;  // VS b6：posMin / posExtent（quantized 时）
+    int           texId = -1;           // 默认贴图：覆盖贴图 / 第一张有贴图的材质
+    std::vector<int> matTex;            // [materialIndex] → 贴图（没有贴图的材质 = texId）
+    AssetViewRef  meshFile;             // 映射的 .mesh（cpuVerts 指向这里）
+    const void*   cpuVerts = nullptr;   // CPU 蒙皮用的顶点（映射里的 VB 原地引用，不拷贝）
+    bool          cpuVertsV2 = false;   // cpuVerts 是 v2 压缩顶点：CPU 蒙皮时逐段解到临时区，不常驻 v1 副本
+    uint32_t      cpuVertCount = 0;
+    AnimSkeleton  skel;                 // parent / evalOrder / invBind / bindLocal（SoA）
+    std::vector<std::string> jointNames; // 骨骼名（UTF-8），只在解析 MotionRoot / LOD 骨骼表时用
+    std::vector<uint8_t>     lodJointKeep; // LOD 省略末端骨骼时：1 = 保留（加载时按名字解析）
 };
-static std::vector<Joint>    gJoints;
 
-// 动画帧缓存
-static float                 gSampleRate = 30.0f;
-static float                 gDurationSec = 0.0f;
-static uint32_t              gFrameCount = 0;
-static bool                  gLoop = true;
-static float                 gPlayback = 1.0f;
-static float                 gTime = 0.0f;   // 当前时间（秒）
+// 句柄 = 下标；释放后置空，不复用下标（数量很少）
+static std::vector<std::unique_ptr<SkinnedModelRes>> gModels;
+static std::vector<std::unique_ptr<AnimClip>>        gClips;   // .anim（v1 逐帧 / v2 压缩）
+
+// .mesh 里 GPU 上传要用的部分（指向映射，上传完即可释放）
+struct MeshUpload {
+    AssetViewRef file;
+    const void*  vbData = nullptr;
+    size_t       vbBytes = 0;
+    const void*  ibData = nullptr;
+    size_t       ibBytes = 0;
+};
 
-static std::vector<AnimTRS>  gAnimFrames;    // 连续存储：frame 0..N-1，每帧 jointCount 个 AnimTRS
+// 异步加载中的资源：解码线程填 CPU 部分，主线程（AssetStream_Update）建 GPU 缓冲后放进 gModels / gClips
+struct PendingModel {
+    ModelSkinnedDesc                 desc;
+    std::unique_ptr<SkinnedModelRes> res = std::make_unique<SkinnedModelRes>();
+    MeshUpload                       upload;
+    std::wstring                     texPath;
+    std::vector<std::wstring>        matTexPaths;
+    AssetStreamHandle                stream = 0;
+};
+struct PendingClip {
+    std::unique_ptr<AnimClip> clip = std::make_unique<AnimClip>();
+    AssetStreamHandle         stream = 0;
+};
+// 与 gModels / gClips 平行：pending 非空 = 加载中；state = 最终结果（Ready / Failed / Cancelled）
+struct ModelLoadSlot { std::shared_ptr<PendingModel> pending; AssetStreamState state = AssetStreamState::Ready; };
+struct ClipLoadSlot  { std::shared_ptr<PendingClip>  pending; AssetStreamState state = AssetStreamState::Ready; };
+static std::vector<ModelLoadSlot> gModelLoad;
+static std::vector<ClipLoadSlot>  gClipLoad;
+
+// 重定向映射缓存：每个（模型骨架, 剪辑）一份，所有实例共用（只在绑定时查找 / 建立）
+// 剪辑和骨架同序时不建表（map 为空）；释放模型 / 剪辑时删掉相关的条目
+struct RetargetEntry {
+    const SkinnedModelRes* model = nullptr;
+    const AnimClip*        clip = nullptr;
+    bool                   ok = false;   // false = 对不上（骨骼数不同且没有名字表 / 名字一个都不匹配）
+    AnimRetargetMap        map;
+};
+static std::vector<std::unique_ptr<RetargetEntry>> gRetargets;
+
+// 动画层：基础姿态之上的覆盖 / 叠加层（遮罩按骨骼名建，换模型时重建）
+struct SkinnedLayer {
+    AnimLayerBlend           mode = AnimLayerBlend::Override;
+    std::vector<std::string> maskRoots;            // 子树根骨骼名（空 = 全身）
+    std::vector<float>       maskRootWeights;      // 与 maskRoots 平行
+    const SkinnedModelRes*   maskModel = nullptr;  // jointWeight 按哪个模型建的
+    std::vector<float>       jointWeight;          // 逐骨骼遮罩权重
+    std::vector<uint8_t>     jointKeep;            // jointWeight > 0：采样时只解这些骨骼
+
+    const AnimClip*        clip = nullptr;         // nullptr = 空闲
+    const AnimRetargetMap* map = nullptr;
+    std::vector<AnimTRS>   refPose;                // Additive 的参考姿态：剪辑第 0 帧
+    float time = 0.0f;
+    float playback = 1.0f;
+    bool  loop = false;
+    float weight = 0.0f;         // 当前层权重
+    float targetWeight = 0.0f;   // 淡入 / 淡出的目标（0 且到达 → 层空闲）
+    float fadeSpeed = 0.0f;      // 每秒权重变化量（0 = 立即）
+
+    // 上一次 Update 推进的区间（事件查询用）
+    const AnimClip* evClip = nullptr;
+    float           evT0 = 0.0f, evT1 = 0.0f;
+    bool            evLoop = false;
+};
 
-// 每帧递归计算出的全局矩阵（行主）
-static std::vector<XMFLOAT4X4> gPalette;
-static std::vector<XMMATRIX>   g_temp_globals;
+// 实例：只保存轻量的播放状态，mesh/skel/clip 全部指向共享资源
+struct SkinnedInstance {
+    bool                  used = false;
+    SkinnedModelRes*      model = nullptr;   // 共享（Bind 只是换指针，不做 IO）
+    const AnimClip*       clip = nullptr;    // 共享
+    const AnimRetargetMap* clipMap = nullptr; // clip 的重定向表（gRetargets；nullptr = 同序）
+
+    // 播放状态
+    bool  loop = true;
+    float playback = 1.0f;
+    float time = 0.0f;       // 当前时间（秒）
+
+    // 世界矩阵（由上层设置）
+    XMMATRIX world = XMMatrixIdentity();
+
+    // Velocity-Driven 开关：为“动画位移”使用时清除根的局部 XZ 平移
+    bool  zeroRootTransXZ = false;
+
+    // —— 入场对齐 + ΔYaw 抽取 ——
+    bool  rootYawAlignEnabled = false;
+    float rootYawAlignTarget = 0.0f; // 目标 yaw（弧度），一般=Idle首帧
+    float rootYawStart = 0.0f;       // 本剪辑首帧 yaw（弧度）
+
+    // —— 节点世界层的 yaw 修正（NodeFix），乘在 world 之前 ——
+    float nodeYawFixRad = 0.0f;
+
+    // —— MotionRoot（可配置）——
+    std::string motionRootNameUTF8 = "mixamorig:Hips"; // 缺省：Hips
+    int         motionRootIndex = -1;
+
+    // —— 相位同步的多剪辑混合（混合空间）——
+    // blendCount > 0 时：所有剪辑共用归一化相位 phase ∈ [0,1)，剪辑 i 在 phase * duration_i 采样；
+    // clip / time 跟随权重最大的剪辑（RootMotion / yaw 等单剪辑逻辑照旧使用它）
+    static const int kMaxBlendClips = 3;
+    const AnimClip* blendClip[kMaxBlendClips] = {};
+    const AnimRetargetMap* blendMap[kMaxBlendClips] = {};
+    float           blendWeight[kMaxBlendClips] = {};
+    float           blendRate[kMaxBlendClips] = {};   // 各剪辑自身的速率（决定一个周期的时长）
+    int             blendCount = 0;
+    float           phase = 0.0f;
+
+    // —— 交叉淡入淡出：上一个剪辑继续播放，权重按曲线移到当前剪辑 ——
+    const AnimClip* fadeClip = nullptr;   // 淡出中的剪辑（nullptr = 没有过渡）
+    const AnimRetargetMap* fadeMap = nullptr;
+    float           fadeTime = 0.0f;
+    float           fadePlayback = 1.0f;
+    bool            fadeLoop = true;
+    float           fadeElapsed = 0.0f;
+    float           fadeDuration = 0.0f;
+    AnimBlendCurve  fadeCurve = AnimBlendCurve::Linear;
+    float           fadeNodeYawFixRad = 0.0f;   // 淡出剪辑当时的 NodeYawFix
+
+    // —— 动画层：按层号依次合成到基础姿态上 ——
+    SkinnedLayer    layers[MODEL_SKINNED_MAX_LAYERS];
+
+    // 调色板（已转置，直接上传 b5）
+    std::vector<XMFLOAT4X4> palette;
+    SkinningMode            skinning = SkinningMode::Linear;
+
+    // 上一次 Update 推进的区间（事件查询用；evT1 不回绕，可以超过 duration）
+    const AnimClip* evClip = nullptr;
+    float           evT0 = 0.0f, evT1 = 0.0f;
+    bool            evLoop = true;
+    std::vector<XMFLOAT4>   dqPalette;   // DualQuat 模式：由 palette 转换（实部/对偶部交错）
+    bool poseDirty = true;   // 时间/相位/淡入淡出/层权重/剪辑/根设置变了 → 调色板需要重算（EvaluatePoses 或 Draw 时）
+                             // 时间没走的帧（dt / 播放速度为 0、非循环停在终点、层停在目标权重）保持 false
+    bool poseLagging = false; // palette 是 LOD 降频的插值结果（落后于当前时间）；时间停下后补一次精确求值
+    uint32_t poseVersion = 1; // palette 每变一次 +1（完整求值 / LOD 插值）
+
+    // b5 常量缓冲（实例自己的）：[0] = 整个调色板（未拆分的 draw），[1 + d] = draws[d] 用到的那段
+    // 内容对应 gpuVersion / gpuDQ；版本没变的 Draw（同帧多个 pass、冻结 / 静止的实例）不再上传
+    std::vector<ID3D11Buffer*> boneCB;
+    uint32_t gpuVersion = 0;  // 0 = 还没上传过
+    bool     gpuDQ = false;
+
+    // —— 动画 LOD（EvaluatePoses 按相机距离选档）——
+    int             lod = -1;             // 当前档（-1 = 未启用 LOD，每帧完整求值）
+    int             lodOverride = -1;     // >= 0：强制使用该档
+    int             meshLodOverride = -1; // 网格 LOD：>= 0 强制使用该档（-1 = 按屏幕大小）
+    bool            lodReduceJoints = false; // 求值时省略末端骨骼
+    bool            lodKeyValid = false;  // lodPrev/lodNext 可用于插值
+    const AnimClip* lodKeyClip = nullptr; // 上次完整求值时的剪辑（换了 → 立刻重算，不插值）
+    uint32_t        lodFrame = 0;         // 距上次完整求值的帧数
+    std::vector<XMFLOAT4X4> lodPrev, lodNext; // 降频：最近两次完整求值的调色板
+};
 
-// —— 入场对齐 + ΔYaw 抽取 —— 
-static bool  gRootYawAlignEnabled = false;
-static float gRootYawAlignTarget = 0.0f; // 目标 yaw（弧度），一般=Idle首帧
-static float gRootYawStart = 0.0f; // 本剪辑首帧 yaw（弧度）
+// 句柄 = 下标；释放后 used=false，之后 CreateInstance 复用
+static std::vector<SkinnedInstance> gInstances;
+
+// 旧接口（无句柄的 ModelSkinned_*）操作的默认实例
+static int gDefaultInstance = -1;
+
+// 旧接口 ModelSkinned_Load 自己创建的资源（再次 Load 时释放）
+static int gLegacyModel = -1;
+static int gLegacyClip = -1;
+
+// 姿态计算用的临时区：每个线程 slot 一份（slot 0 = 主线程，Draw 内的补算也用它）
+struct PoseScratch {
+    std::vector<XMMATRIX> globals;
+    std::vector<AnimTRS>  pose;      // 当前时间的插值姿态（可就地修改根）
+    std::vector<AnimTRS>  fadePose;  // 淡出剪辑的姿态
+    std::vector<AnimTRS>  blendPose; // 混合空间中第 2、3 个剪辑
+    std::vector<AnimTRS>  layerPose; // 动画层剪辑的姿态（只有遮罩内的骨骼有效）
+    std::vector<uint8_t>  layerKeep; // 层遮罩 ∧ LOD 遮罩
+    std::vector<float>    sample;    // AnimClip_SamplePose 用
+};
+static std::vector<PoseScratch> g_scratch(1);
+static std::vector<int>         g_evalList;   // EvaluatePoses：本帧需要重算的实例
+
+// 动画 LOD 档位（按 maxDistance 升序）；空 = 关闭
+static std::vector<ModelSkinnedLodLevel> g_lodLevels = {
+    {  15.0f, 1, false, false },   // 近：每帧、全骨骼
+    {  30.0f, 2, true,  false },   // 中：隔帧，省略手指/脸
+    {  60.0f, 4, true,  false },   // 远：每 4 帧
+    { 1e30f,  1, true,  true  },   // 很远：冻结
+};
 
-// —— 节点世界层的 yaw 修正（NodeFix），乘在 world 之前 —— 
-static float gNodeYawFixRad = 0.0f;
+// 网格 LOD 阈值（屏幕大小，降序）：< [i] 时至少用 LOD i+1；空 = 总是 LOD0
+static std::vector<float> g_meshLodThresholds(std::begin(MESH_LOD_DEFAULT_THRESHOLDS), std::end(MESH_LOD_DEFAULT_THRESHOLDS));
 
-// —— MotionRoot（可配置）——
-static std::string gMotionRootNameUTF8 = "mixamorig:Hips"; // 缺省：Hips
-static int         gMotionRootIndex = -1;
+// 主线程专用（调试 / yaw 计算）
+static std::vector<XMMATRIX> g_temp_globals;
+static std::vector<AnimTRS>  g_decode_pose;   // 整帧读取
 
 // 安全释放
 #ifndef SAFE_RELEASE
@@ -107,11 +297,6 @@ static void EnsureD3D() {
     }
 }
 
-// 前置
-static XMMATRIX MakeLocalMatrix(const AnimTRS& t);
-static void ComputeGlobalBindPoseRecursively(size_t boneIndex, const XMMATRIX& parentGlobalTransform);
-static void ComputeAnimationPoseRecursively(size_t boneIndex, const XMMATRIX& parentGlobalTransform, const AnimTRS* currentFramePose);
-
 // ---------------------------------------------------------
 // 读文件小工具
 // ---------------------------------------------------------
@@ -125,100 +310,41 @@ static bool ReadAll(const std::wstring& path, std::vector<uint8_t>& out) {
     return true;
 }
 
-static XMMATRIX MakeLocalMatrix(const AnimTRS& t) {
-    XMVECTOR T = XMVectorSet(t.T[0], t.T[1], t.T[2], 0.0f);
-    XMVECTOR R = XMVectorSet(t.R[0], t.R[1], t.R[2], t.R[3]);
-    XMVECTOR S = XMVectorSet(t.S[0], t.S[1], t.S[2], 1.0f);
-    return XMMatrixScalingFromVector(S) * XMMatrixRotationQuaternion(R) * XMMatrixTranslationFromVector(T);
-}
-
 // ---------------------------------------------------------
-// 从 .mat 尝试读取第一条材质的 baseColorTex 并加载（可选）
+// 从 .mat 读取每条材质的 baseColorTex 路径（下标 = materialIndex；没有贴图的为空）
 // ---------------------------------------------------------
-static bool TryLoadBaseColorFromMat(const std::wstring& matPathW) {
-    if (matPathW.empty()) return false;
-    std::ifstream f(matPathW, std::ios::binary);
-    if (!f) return false;
+static std::vector<std::wstring> ReadBaseColorPathsFromMat(const AssetView* file, const std::wstring& matPathW) {
+    std::vector<std::wstring> out;
+    if (!file || file->size < sizeof(FileHeader) + sizeof(MaterialHeader)) return out;
+    const uint8_t* p = file->data;
 
     FileHeader fh{};                     // from asset_format.h
-    if (!f.read((char*)&fh, sizeof(fh))) return false;
-    if (std::memcmp(fh.magic, "MATL", 4) != 0) return false;
+    std::memcpy(&fh, p, sizeof(fh)); p += sizeof(fh);
+    if (std::memcmp(fh.magic, "MATL", 4) != 0) return out;
 
     MaterialHeader mh{};
-    if (!f.read((char*)&mh, sizeof(mh))) return false;
-    if (mh.materialCount == 0) return false;
-
-    MaterialRec rec{};
-    if (!f.read((char*)&rec, sizeof(rec))) return false;
-
-    if (rec.baseColorTex[0]) {
-        fs::path folder = fs::path(matPathW).parent_path();
+    std::memcpy(&mh, p, sizeof(mh)); p += sizeof(mh);
+    const size_t count = std::min<size_t>(mh.materialCount, (file->size - (p - file->data)) / sizeof(MaterialRec));
+
+    const fs::path folder = fs::path(matPathW).parent_path();
+    out.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        MaterialRec rec{};
+        std::memcpy(&rec, p + i * sizeof(MaterialRec), sizeof(rec));
+        if (!rec.baseColorTex[0]) continue;
         std::string rel(rec.baseColorTex, rec.baseColorTex + strnlen(rec.baseColorTex, sizeof(rec.baseColorTex)));
-        fs::path texPath = folder / fs::path(rel);
-        gTexId = Texture_Load(texPath.wstring().c_str());
-        return (gTexId >= 0);
+        out[i] = (folder / fs::path(rel)).wstring();
     }
-    return false;
+    return out;
 }
 
 // ---------------------------------------------------------
-// 加载 .mesh（v1 带皮肤）：创建 VB/IB & InputLayout
+// 蒙皮 VS + 输入布局（所有模型共用，只创建一次）
 // ---------------------------------------------------------
-static bool LoadMeshV1(const std::wstring& meshPathW) {
+static bool EnsureSkinnedShader() {
+    if (gVS && gIL) return true;
     EnsureD3D();
-    std::vector<uint8_t> bin;
-    if (!ReadAll(meshPathW, bin)) return false;
-
-    const uint8_t* p = bin.data();
-    const uint8_t* e = bin.data() + bin.size();
-    auto need = [&](size_t n) { return (size_t)(e - p) >= n; };
-
-    if (!need(sizeof(FileHeader))) return false;
-    auto fh = (const FileHeader*)p; p += sizeof(FileHeader);
-    if (std::memcmp(fh->magic, "MESH", 4) != 0) return false;
-
-    if (!need(sizeof(MeshHeader))) return false;
-    auto mh = (const MeshHeader*)p; p += sizeof(MeshHeader);
-
-    if ((mh->flags & HAS_SKIN) == 0) return false;
-
-    const UINT stride = mh->vertexStride; // 56（你的格式）
-    const UINT vcount = mh->vertexCount;
-    const UINT icount = mh->indexCount;
-    const bool idx32 = (mh->vertexCount > 65535);
-
-    size_t vbBytes = size_t(vcount) * stride;
-    if (!need(vbBytes)) return false;
-    const void* vbData = p; p += vbBytes;
-
-    size_t ibBytes = size_t(icount) * (idx32 ? 4 : 2);
-    if (!need(ibBytes)) return false;
-    const void* ibData = p; p += ibBytes;
-
-    size_t sbBytes = sizeof(Submesh) * mh->submeshCount;
-    if (need(sbBytes)) p += sbBytes; // 暂不拆材质组
-
-    // VB
-    SAFE_RELEASE(gVB);
-    D3D11_BUFFER_DESC bd{};
-    bd.Usage = D3D11_USAGE_DEFAULT;
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.ByteWidth = UINT(vbBytes);
-    D3D11_SUBRESOURCE_DATA sd{};
-    sd.pSysMem = vbData;
-    if (FAILED(gDev->CreateBuffer(&bd, &sd, &gVB))) return false;
-
-    // IB
-    SAFE_RELEASE(gIB);
-    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    bd.ByteWidth = UINT(ibBytes);
-    sd.pSysMem = ibData;
-    if (FAILED(gDev->CreateBuffer(&bd, &sd, &gIB))) return false;
 
-    gIndexCount = icount;
-    gIndexFormat = idx32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
-
-    // VS + IL
     std::vector<uint8_t> vsbin;
     if (!ReadAll(L"shader_vertex_skinned_3d.cso", vsbin)) return false;
 
@@ -237,152 +363,256 @@ static bool LoadMeshV1(const std::wstring& meshPathW) {
     if (FAILED(gDev->CreateInputLayout(descs, ARRAYSIZE(descs),
         vsbin.data(), vsbin.size(), &gIL))) return false;
 
+    // DQ 版本可选：找不到 .cso 时 DualQuat 实例退回线性蒙皮
+    std::vector<uint8_t> dqbin;
+    SAFE_RELEASE(gVSDQ);
+    if (ReadAll(L"shader_vertex_skinned_dq_3d.cso", dqbin)) {
+        if (FAILED(gDev->CreateVertexShader(dqbin.data(), dqbin.size(), nullptr, &gVSDQ))) gVSDQ = nullptr;
+    }
+    if (!gVSDQ) OutputDebugStringA("[ModelSkinned] shader_vertex_skinned_dq_3d.cso not available, DualQuat falls back to Linear\n");
+
+    // 压缩顶点版本可选：找不到 .cso 时 v2 网格在加载时解成 v1 上传
+    std::vector<uint8_t> qbin;
+    SAFE_RELEASE(gVSQ);
+    SAFE_RELEASE(gVSDQQ);
+    SAFE_RELEASE(gILQ);
+    if (ReadAll(L"shader_vertex_skinned_q_3d.cso", qbin) &&
+        SUCCEEDED(gDev->CreateVertexShader(qbin.data(), qbin.size(), nullptr, &gVSQ))) {
+        D3D11_INPUT_ELEMENT_DESC qdescs[] = {
+            { "POSITION",     0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "NORMAL",       0, DXGI_FORMAT_R16G16_SNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TANGENT",      0, DXGI_FORMAT_R16G16_SNORM,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD",     0, DXGI_FORMAT_R16G16_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "BLENDINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT,      0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "BLENDWEIGHT",  0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        };
+        if (FAILED(gDev->CreateInputLayout(qdescs, ARRAYSIZE(qdescs), qbin.data(), qbin.size(), &gILQ))) SAFE_RELEASE(gVSQ);
+    }
+    if (gVSQ && ReadAll(L"shader_vertex_skinned_dq_q_3d.cso", dqbin)) {
+        if (FAILED(gDev->CreateVertexShader(dqbin.data(), dqbin.size(), nullptr, &gVSDQQ))) gVSDQQ = nullptr;
+    }
+    if (!gVSQ) OutputDebugStringA("[ModelSkinned] shader_vertex_skinned_q_3d.cso not available, v2 meshes are expanded to v1 on load\n");
+
     return true;
 }
 
 // ---------------------------------------------------------
-// 加载 .skel（★ 修好骨骼名读取）
+// 解析 .mesh（v1 / v2 带皮肤）：子网格 / 调色板表；VB/IB 数据留在映射里等上传（纯 CPU）
 // ---------------------------------------------------------
-static bool LoadSkel(const std::wstring& skelPathW) {
-    std::vector<uint8_t> bin;
-    if (!ReadAll(skelPathW, bin)) return false;
+static bool ParseMesh(const AssetViewRef& file, SkinnedModelRes& m, MeshUpload& up) {
+    // 映射整个文件：VB/IB 直接从映射页上传，CPU 蒙皮也原地读顶点
+    if (!file) return false;
 
-    const uint8_t* p = bin.data();
-    const uint8_t* e = bin.data() + bin.size();
+    const uint8_t* p = file->data;
+    const uint8_t* e = file->data + file->size;
     auto need = [&](size_t n) { return (size_t)(e - p) >= n; };
 
     if (!need(sizeof(FileHeader))) return false;
     auto fh = (const FileHeader*)p; p += sizeof(FileHeader);
-    if (std::memcmp(fh->magic, "SKEL", 4) != 0) return false;
-
-    if (!need(sizeof(SkeletonHeader))) return false;
-    auto sh = (const SkeletonHeader*)p; p += sizeof(SkeletonHeader);
+    if (std::memcmp(fh->magic, "MESH", 4) != 0) return false;
 
-    gJoints.clear();
-    gJoints.resize(sh->jointCount);
-    if (!need(sizeof(JointRec) * sh->jointCount)) return false;
+    if (!need(sizeof(MeshHeader))) return false;
+    auto mh = (const MeshHeader*)p; p += sizeof(MeshHeader);
 
-    for (uint32_t i = 0; i < sh->jointCount; ++i) {
-        auto jr = (const JointRec*)p; p += sizeof(JointRec);
+    if ((mh->flags & HAS_SKIN) == 0) return false;
 
-        Joint j{};
-        j.parent = jr->parent;
+    // v1：56 字节 float 顶点；v2：28 字节压缩顶点
+    const bool quantized = (fh->version == MESH_VERSION_V2);
+    const UINT stride = mh->vertexStride;
+    if (stride != (quantized ? sizeof(SkinnedVertexV2) : sizeof(SkinnedVertexV1))) {
+        char buf[128];
+        sprintf_s(buf, "[ModelSkinned] unsupported .mesh vertex (version=%08x, stride=%u)\n", fh->version, stride);
+        OutputDebugStringA(buf);
+        return false;
+    }
+    const UINT vcount = mh->vertexCount;
+    const UINT icount = mh->indexCount;
+    const bool idx32 = (mh->vertexCount > 65535);
 
-        // invBind（asset 写的是按列主存 float[16]；在这里直接 memcpy 到 XMFLOAT4X4(行主存)
-        // 你当前工程里下游按“行主”用，所以一直保持 memcpy 的方式（与之前一致）。
-        std::memcpy(&j.invBind, jr->invBind, sizeof(float) * 16);
+    size_t vbBytes = size_t(vcount) * stride;
+    if (!need(vbBytes)) return false;
+    const void* vbData = p; p += vbBytes;
 
-        j.bindT = XMFLOAT3(jr->bindLocalT[0], jr->bindLocalT[1], jr->bindLocalT[2]);
-        j.bindR = XMFLOAT4(jr->bindLocalR[0], jr->bindLocalR[1], jr->bindLocalR[2], jr->bindLocalR[3]);
-        j.bindS = XMFLOAT3(jr->bindLocalS[0], jr->bindLocalS[1], jr->bindLocalS[2]);
+    size_t ibBytes = size_t(icount) * (idx32 ? 4 : 2);
+    if (!need(ibBytes)) return false;
+    const void* ibData = p; p += ibBytes;
 
-        // ★ 关键：读骨骼名（假定 JointRec 里有 char name[64]；这是 AssetCooker 常见做法）
-        // 如果你们的 JointRec 用的是 nameOffset/哈希，请把这里改成相应读取方式。
-        {
-            // 兼容保护：把 name 视作以 0 结尾的 C 字符串
-            const size_t kMax = sizeof(jr->name);
-            size_t len = strnlen(jr->name, kMax);
-            j.name.assign(jr->name, jr->name + len);
+    // 子网格：每个子网格一次 DrawIndexed（材质 / LOD / 骨骼调色板各自不同）
+    // 未拆分的网格共用整个 VB；没有 Submesh 表的旧文件整体画一次
+    m.draws.clear();
+    m.paletteBones.clear();
+    size_t sbBytes = sizeof(Submesh) * mh->submeshCount;
+    if ((mh->flags & HAS_BONE_PALETTES) == 0) {
+        if (mh->submeshCount > 0 && need(sbBytes)) {
+            for (uint32_t i = 0; i < mh->submeshCount; ++i) {
+                Submesh sm;
+                std::memcpy(&sm, p + i * sizeof(Submesh), sizeof(sm));
+                if (size_t(sm.indexOffset) + sm.indexCount > icount) {
+                    OutputDebugStringA("[ModelSkinned] bad submesh table in .mesh\n");
+                    return false;
+                }
+                SkinnedDrawRange r;
+                r.indexOffset = sm.indexOffset; r.indexCount = sm.indexCount;
+                r.vertexCount = vcount;
+                r.material = sm.materialIndex;
+                r.bounds = sm.bounds;
+                m.draws.push_back(r);
+            }
+            p += sbBytes;
+        }
+        else {
+            SkinnedDrawRange r;
+            r.indexCount = icount;
+            r.vertexCount = vcount;
+            r.bounds = mh->bounds;
+            m.draws.push_back(r);
         }
-
-        gJoints[i] = std::move(j);
+    }
+    else {
+        if (!need(sbBytes)) return false;
+        const uint8_t* sb = p; p += sbBytes;
+
+        MeshBonePaletteHeader ph{};
+        if (!need(sizeof(ph))) return false;
+        std::memcpy(&ph, p, sizeof(ph)); p += sizeof(ph);
+
+        const size_t palBytes = sizeof(MeshBonePalette) * mh->submeshCount;
+        if (!need(palBytes + size_t(ph.boneIndexCount) * sizeof(uint16_t))) return false;
+        const uint8_t* pb = p; p += palBytes;
+        m.paletteBones.resize(ph.boneIndexCount);
+        std::memcpy(m.paletteBones.data(), p, m.paletteBones.size() * sizeof(uint16_t));
+
+        for (uint32_t i = 0; i < mh->submeshCount; ++i) {
+            Submesh sm; MeshBonePalette bp;
+            std::memcpy(&sm, sb + i * sizeof(Submesh), sizeof(sm));
+            std::memcpy(&bp, pb + i * sizeof(MeshBonePalette), sizeof(bp));
+            if (bp.boneCount == 0 || bp.boneCount > MAX_BONES ||
+                size_t(bp.boneOffset) + bp.boneCount > m.paletteBones.size() ||
+                size_t(sm.indexOffset) + sm.indexCount > icount ||
+                size_t(bp.vertexOffset) + bp.vertexCount > vcount) {
+                OutputDebugStringA("[ModelSkinned] bad bone palette table in .mesh\n");
+                return false;
+            }
+            SkinnedDrawRange r;
+            r.indexOffset = sm.indexOffset;  r.indexCount = sm.indexCount;
+            r.vertexOffset = bp.vertexOffset; r.vertexCount = bp.vertexCount;
+            r.boneOffset = bp.boneOffset;    r.boneCount = bp.boneCount;
+            r.material = sm.materialIndex;
+            m.draws.push_back(r);
+        }
+        if (m.draws.empty()) return false;
     }
 
-    gPalette.resize(std::max<size_t>(1, gJoints.size()));
-
-    // 解析一次 MotionRoot（默认策略可解析出 Hips）
-    ModelSkinned_ResolveMotionRoot();
-    return true;
-}
-
-// ---------------------------------------------------------
-// 加载 .anim（可选）
-// ---------------------------------------------------------
-static bool LoadAnim(const std::wstring& animPathW) {
-    gAnimFrames.clear();
-    gFrameCount = 0; gDurationSec = 0.0f;
-
-    if (animPathW.empty()) return true; // 没动画也不报错
-
-    std::vector<uint8_t> bin;
-    if (!ReadAll(animPathW, bin)) return false;
-
-    const uint8_t* p = bin.data();
-    const uint8_t* e = bin.data() + bin.size();
-    auto need = [&](size_t n) { return (size_t)(e - p) >= n; };
-
-    if (!need(sizeof(FileHeader))) return false;
-    auto fh = (const FileHeader*)p; p += sizeof(FileHeader);
-    if (std::memcmp(fh->magic, "ANIM", 4) != 0) return false;
-
-    if (!need(sizeof(AnimHeader))) return false;
-    auto ah = (const AnimHeader*)p; p += sizeof(AnimHeader);
-
-    if (ah->jointCount != gJoints.size()) {
-        // 数量不匹配：先严格处理（如需容错可在此处做重映射）
+    // 网格 LOD：每个子网格各自选档（lodRanges 按子网格下标，排序前先记下）
+    MeshLodInfo lod;
+    if (!MeshLod_Parse(file->data, file->size, lod)) {
+        OutputDebugStringA("[ModelSkinned] bad LOD table in .mesh\n");
         return false;
     }
+    m.lodCount = lod.lodCount;
+    m.lodRanges = std::move(lod.ranges);
+    if (m.lodCount > 1 && m.draws.size() != mh->submeshCount) {
+        OutputDebugStringA("[ModelSkinned] LOD table does not match the submesh table in .mesh\n");
+        return false;
+    }
+    for (size_t i = 0; i < m.draws.size() && i < lod.submeshBounds.size(); ++i) {
+        m.draws[i].bounds = lod.submeshBounds[i];
+        m.draws[i].lodFirst = UINT(i) * m.lodCount;
+    }
 
-    gSampleRate = ah->sampleRate;
-    gFrameCount = ah->frameCount;
-    gDurationSec = ah->durationSec;
-
-    size_t framesBytes = size_t(gFrameCount) * size_t(ah->jointCount) * sizeof(AnimTRS);
-    if (!need(framesBytes)) return false;
-
-    gAnimFrames.resize(gFrameCount * ah->jointCount);
-    std::memcpy(gAnimFrames.data(), p, framesBytes);
-    return true;
-}
+    // 按材质排序：同一材质的子网格连着画，贴图只在材质变化时切换
+    // 没有 LOD、未拆分、索引区间首尾相接的同材质子网格合并成一次 DrawIndexed
+    std::stable_sort(m.draws.begin(), m.draws.end(),
+        [](const SkinnedDrawRange& a, const SkinnedDrawRange& b) { return a.material < b.material; });
+    if (m.lodCount == 1) {
+        size_t out = 0;
+        for (size_t i = 0; i < m.draws.size(); ++i) {
+            SkinnedDrawRange& last = m.draws[out];
+            const SkinnedDrawRange& r = m.draws[i];
+            if (i > 0 && r.boneCount == 0 && last.boneCount == 0 && r.material == last.material &&
+                r.indexOffset == last.indexOffset + last.indexCount) {
+                last.indexCount += r.indexCount;
+                for (int k = 0; k < 3; ++k) {
+                    last.bounds.minv[k] = std::min(last.bounds.minv[k], r.bounds.minv[k]);
+                    last.bounds.maxv[k] = std::max(last.bounds.maxv[k], r.bounds.maxv[k]);
+                }
+                continue;
+            }
+            if (i > 0) ++out;
+            m.draws[out] = r;
+        }
+        m.draws.resize(m.draws.empty() ? 0 : out + 1);
+    }
+    if (m.draws.empty()) return false;
+#if defined(DEBUG) || defined(_DEBUG)
+    if (m.lodCount > 1) {
+        char buf[128];
+        sprintf_s(buf, "[ModelSkinned] .mesh has %u LODs, max error %.2f mm\n", m.lodCount,
+            m.lodRanges.empty() ? 0.0f : 1000.0f * std::max_element(m.lodRanges.begin(), m.lodRanges.end(),
+                [](const MeshLodRange& a, const MeshLodRange& b) { return a.error < b.error; })->error);
+        OutputDebugStringA(buf);
+    }
+#endif
 
-// ---------------------------------------------------------
-// 递归计算
-// ---------------------------------------------------------
-static void ComputeGlobalBindPoseRecursively(size_t boneIndex, const XMMATRIX& parentGlobalTransform)
-{
-    const auto& joint = gJoints[boneIndex];
-    XMVECTOR T = XMLoadFloat3(&joint.bindT);
-    XMVECTOR R = XMLoadFloat4(&joint.bindR);
-    XMVECTOR S = XMLoadFloat3(&joint.bindS);
-    XMMATRIX localBindPose = XMMatrixScalingFromVector(S) * XMMatrixRotationQuaternion(R) * XMMatrixTranslationFromVector(T);
+    m.indexCount = icount;
+    m.indexFormat = idx32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
 
-    XMMATRIX globalTransform = localBindPose * parentGlobalTransform;
-    g_temp_globals[boneIndex] = globalTransform;
+    m.vertexStride = stride;
+    m.quantized = quantized;
+    m.bounds = mh->bounds;
+    m.meshFile = file;
+    m.cpuVerts = vbData;
+    m.cpuVertsV2 = quantized;
+    m.cpuVertCount = vcount;
 
-    for (size_t i = 0; i < gJoints.size(); ++i) {
-        if (gJoints[i].parent == (int)boneIndex) {
-            ComputeGlobalBindPoseRecursively(i, globalTransform);
-        }
-    }
+    up.file = file;
+    up.vbData = vbData; up.vbBytes = vbBytes;
+    up.ibData = ibData; up.ibBytes = ibBytes;
+    return true;
 }
 
-static void ComputeAnimationPoseRecursively(size_t boneIndex, const XMMATRIX& parentGlobalTransform, const AnimTRS* currentFramePose)
-{
-    const AnimTRS& jointPose = currentFramePose[boneIndex];
-    XMMATRIX localTransform = MakeLocalMatrix(jointPose);
+// 建 VB/IB（主线程）：直接从映射上传
+static bool CreateMeshBuffers(SkinnedModelRes& m, const MeshUpload& up) {
+    EnsureD3D();
 
-    XMMATRIX globalTransform = localTransform * parentGlobalTransform;
-    g_temp_globals[boneIndex] = globalTransform;
+    // VB
+    SAFE_RELEASE(m.vb);
+    D3D11_BUFFER_DESC bd{};
+    bd.Usage = D3D11_USAGE_DEFAULT;
+    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bd.ByteWidth = UINT(up.vbBytes);
+    D3D11_SUBRESOURCE_DATA sd{};
+    sd.pSysMem = up.vbData;
+    if (FAILED(gDev->CreateBuffer(&bd, &sd, &m.vb))) return false;
 
-    for (size_t i = 0; i < gJoints.size(); ++i) {
-        if (gJoints[i].parent == (int)boneIndex) {
-            ComputeAnimationPoseRecursively(i, globalTransform, currentFramePose);
-        }
-    }
+    // IB
+    SAFE_RELEASE(m.ib);
+    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+    bd.ByteWidth = UINT(up.ibBytes);
+    sd.pSysMem = up.ibData;
+    if (FAILED(gDev->CreateBuffer(&bd, &sd, &m.ib))) return false;
+    return true;
 }
 
 // ---------------------------------------------------------
 // 常量缓冲
 // ---------------------------------------------------------
-static bool CreateCBBones() {
-    EnsureD3D();
-    SAFE_RELEASE(gCBBones);
+// b5：按矩阵版大小建（DQ 只用前一半）；DYNAMIC 缓冲在下一次 Map 之前内容保持不变
+static ID3D11Buffer* CreateBoneCB() {
     D3D11_BUFFER_DESC bd{};
     bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
     bd.Usage = D3D11_USAGE_DYNAMIC;
     bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     bd.ByteWidth = ((UINT)MAX_BONES * sizeof(XMFLOAT4X4) + 255) & ~255u;
-    return SUCCEEDED(gDev->CreateBuffer(&bd, nullptr, &gCBBones));
+    ID3D11Buffer* cb = nullptr;
+    return SUCCEEDED(gDev->CreateBuffer(&bd, nullptr, &cb)) ? cb : nullptr;
+}
+
+// 实例的 b5 缓冲：换模型（draw 划分变了）/ 销毁时释放，下次 Draw 重建并上传
+static void ReleaseBoneCB(SkinnedInstance& I) {
+    for (ID3D11Buffer*& cb : I.boneCB) SAFE_RELEASE(cb);
+    I.boneCB.clear();
+    I.gpuVersion = 0;
 }
 
 // ---------------------------------------------------------
@@ -391,8 +621,8 @@ static bool CreateCBBones() {
 bool ModelSkinned_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx) {
     gDev = dev; gCtx = ctx;
 
-    // b5: bones
-    if (!CreateCBBones()) return false;
+    // b5: bones（实例第一次 Draw 时创建）
+    EnsureD3D();
 
     // b3: ambient
     {
@@ -422,409 +652,1586 @@ bool ModelSkinned_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx) {
     return true;
 }
 
-bool ModelSkinned_Load(const ModelSkinnedDesc& d) {
-    if (!LoadMeshV1(d.meshPath)) return false;
-    if (!LoadSkel(d.skelPath))   return false;
+// ---------------------------------------------------------
+// 常驻资源
+// ---------------------------------------------------------
+static SkinnedModelRes* GetModelRes(int h) {
+    return (h >= 0 && h < (int)gModels.size()) ? gModels[h].get() : nullptr;
+}
+static const AnimClip* GetClipRes(int h) {
+    return (h >= 0 && h < (int)gClips.size()) ? gClips[h].get() : nullptr;
+}
 
-    // 可选：用 InvBind 反推 bindLocal 一致性（保持你当前稳定做法）
-    {
-        const size_t J = gJoints.size();
-        if (J) {
-            g_temp_globals.resize(J);
-            // 先用 bindLocal 递归出 Bj
-            for (size_t j = 0; j < J; ++j)
-                if (gJoints[j].parent == -1)
-                    ComputeGlobalBindPoseRecursively(j, XMMatrixIdentity());
-
-            // 用平均 MeshGlobalAtBind 统一坐标后回填（略去细节注释，逻辑与之前一致）
-            double sum[16] = { 0 };
-            for (size_t j = 0; j < J; ++j) {
-                XMMATRIX Bj = g_temp_globals[j];
-                XMMATRIX InvB = XMLoadFloat4x4(&gJoints[j].invBind);
-                XMMATRIX Mj = Bj * InvB;
-                XMFLOAT4X4 fm; XMStoreFloat4x4(&fm, Mj);
-                const float* p = &fm._11;
-                for (int k = 0; k < 16; ++k) sum[k] += p[k];
-            }
-            float avg[16]; for (int k = 0; k < 16; ++k) avg[k] = float(sum[k] / double(J));
-            XMFLOAT4X4 favg{}; std::memcpy(&favg._11, avg, sizeof(avg));
-            XMMATRIX MeshGlobalAtBind = XMLoadFloat4x4(&favg);
-
-            std::vector<XMMATRIX> G(J);
-            for (size_t j = 0; j < J; ++j) {
-                XMMATRIX InvBj = XMLoadFloat4x4(&gJoints[j].invBind);
-                XMMATRIX Bj = MeshGlobalAtBind * XMMatrixInverse(nullptr, InvBj);
-                G[j] = Bj;
-            }
-            for (size_t j = 0; j < J; ++j) {
-                XMMATRIX parentG = (gJoints[j].parent >= 0) ? G[gJoints[j].parent] : XMMatrixIdentity();
-                XMMATRIX local = XMMatrixInverse(nullptr, parentG) * G[j];
-                XMVECTOR S, R, T; if (!XMMatrixDecompose(&S, &R, &T, local)) continue;
-                XMStoreFloat3(&gJoints[j].bindT, T);
-                XMStoreFloat4(&gJoints[j].bindR, R);
-                XMStoreFloat3(&gJoints[j].bindS, S);
-            }
+// 剪辑能否在模型骨架上播放：能则 *outMap = 重定向表（nullptr = 同序），第一次用到这一对时按骨骼名建表
+static bool GetRetarget(const SkinnedModelRes* m, const AnimClip* c, const AnimRetargetMap** outMap) {
+    for (const auto& e : gRetargets) {
+        if (e->model == m && e->clip == c) {
+            *outMap = e->map.sourceJoint.empty() ? nullptr : &e->map;
+            return e->ok;
         }
     }
-
-    if (!LoadAnim(d.animPath)) return false;
-
-    // 贴图：override > .mat > none
-    if (!d.baseColorTexOverride.empty()) {
-        gTexId = Texture_Load(d.baseColorTexOverride.c_str());
+    auto e = std::make_unique<RetargetEntry>();
+    e->model = m;
+    e->clip = c;
+    e->ok = AnimClip_BuildRetargetMap(*c, m->jointNames, m->skel.bindLocal.data(), e->map);
+    if (!e->ok) {
+        OutputDebugStringA("[ModelSkinned] clip does not match the skeleton (joint count differs and no joint names match)\n");
     }
-    else {
-        std::wstring matPath = d.matPath.empty()
-            ? fs::path(d.meshPath).replace_extension(L".mat").wstring()
-            : d.matPath;
-        if (!TryLoadBaseColorFromMat(matPath)) {
-            gTexId = -1;
-        }
+    else if (!e->map.sourceJoint.empty()) {
+        char buf[160];
+        sprintf_s(buf, "[ModelSkinned] retarget: %u / %u joints matched by name (clip has %u)\n",
+            e->map.matched, m->skel.jointCount, c->jointCount);
+        OutputDebugStringA(buf);
     }
-
-    gWorld = XMMatrixIdentity();
-    gTime = 0.0f;
-    return true;
+    *outMap = e->map.sourceJoint.empty() ? nullptr : &e->map;
+    const bool ok = e->ok;
+    gRetargets.push_back(std::move(e));
+    return ok;
 }
 
-void ModelSkinned_Finalize() {
-    SAFE_RELEASE(gCBDirectional);
-    SAFE_RELEASE(gCBAmbient);
-    SAFE_RELEASE(gCBBones);
-    SAFE_RELEASE(gVB);
-    SAFE_RELEASE(gIB);
-    SAFE_RELEASE(gVS);
-    SAFE_RELEASE(gIL);
-
-    gJoints.clear();
-    gAnimFrames.clear();
-    gPalette.clear();
-    g_temp_globals.clear();
+static void DropRetargets(const SkinnedModelRes* m, const AnimClip* c) {
+    gRetargets.erase(std::remove_if(gRetargets.begin(), gRetargets.end(),
+        [&](const std::unique_ptr<RetargetEntry>& e) { return e->model == m || e->clip == c; }), gRetargets.end());
+}
 
-    gIndexCount = 0;
-    gTexId = -1;
-    gMotionRootIndex = -1;
+// .mat 的默认路径：mesh 同名
+static std::wstring ResolveMatPath(const ModelSkinnedDesc& d) {
+    if (!d.baseColorTexOverride.empty()) return L"";   // 有覆盖贴图就不读 .mat
+    return d.matPath.empty() ? fs::path(d.meshPath).replace_extension(L".mat").wstring() : d.matPath;
 }
 
-void ModelSkinned_Update(double dtSec) {
-    if (gFrameCount == 0 || gJoints.empty()) return;
-    gTime += float(dtSec) * gPlayback;
-    if (gLoop) {
-        if (gDurationSec > 0.0f) {
-            while (gTime >= gDurationSec) gTime -= gDurationSec;
-            while (gTime < 0.0f)         gTime += gDurationSec;
+// 模型的 CPU 部分（任意线程）：mesh 表 / 骨架 / bind-pose 修正 / LOD 骨骼表 / 贴图路径
+static bool DecodeModel(const ModelSkinnedDesc& d, const AssetViewRef& mesh, const AssetView* skel, const AssetView* mat,
+    SkinnedModelRes& m, MeshUpload& up, std::wstring& texPath, std::vector<std::wstring>& matTexPaths)
+{
+    if (!ParseMesh(mesh, m, up) || !skel || !AnimPose_LoadSkeletonFromView(*skel, m.skel, &m.jointNames))
+        return false;
+    if (!m.skel.bindLocalFixed) AnimPose_FixupBindPose(m.skel);   // 'SMET'：cook 阶段已修正
+    AnimPose_BuildLodJointMask(m.skel, m.jointNames, nullptr, 0, m.lodJointKeep);
+
+    // 拆分表必须指向本骨架；未拆分的网格超过 b5 容量时只能上传前 MAX_BONES 个
+    for (uint16_t b : m.paletteBones) {
+        if (b >= m.skel.jointCount) {
+            OutputDebugStringA("[ModelSkinned] .mesh bone palette references a joint outside the skeleton\n");
+            return false;
         }
     }
-    else {
-        gTime = std::clamp(gTime, 0.0f, gDurationSec);
+    if (m.paletteBones.empty() && m.skel.jointCount > MAX_BONES) {
+        char buf[160];
+        sprintf_s(buf, "[ModelSkinned] %u joints > %u: palette is truncated, split the mesh with cook_tool.py mesh-split\n",
+            m.skel.jointCount, MAX_BONES);
+        OutputDebugStringA(buf);
     }
-}
 
-void ModelSkinned_SetWorldMatrix(const XMMATRIX& world) { gWorld = world; }
-void ModelSkinned_SetLoop(bool loop) { gLoop = loop; }
-void ModelSkinned_SetPlaybackRate(float rate) { gPlayback = rate; }
-void ModelSkinned_Seek(float t) { gTime = t; }
-bool ModelSkinned_LoadAnimOnly(const std::wstring& p) { return LoadAnim(p); }
-
-int ModelSkinned_GetRootJointIndex() {
-    for (int i = 0; i < (int)gJoints.size(); ++i)
-        if (gJoints[i].parent == -1) return i;
-    return -1;
+    // 贴图：override（所有材质共用）> .mat 每条材质各自的 > none
+    texPath.clear();
+    matTexPaths.clear();
+    if (!d.baseColorTexOverride.empty()) {
+        texPath = d.baseColorTexOverride;
+        return true;
+    }
+    matTexPaths = ReadBaseColorPathsFromMat(mat, ResolveMatPath(d));
+    for (const std::wstring& t : matTexPaths) {
+        if (!t.empty()) { texPath = t; break; }
+    }
+    return true;
 }
 
-// 采样线性插值（辅助）
-static AnimTRS SampleJointTRS_Linear(int joint, float tSec) {
-    AnimTRS out{};
-    if (gFrameCount == 0 || gJoints.empty()) return out;
-
-    const float rate = gSampleRate;
-    const float f = tSec * rate;
-    int   f0 = (int)floorf(f);
-    float a = f - f0;
+// 模型的 GPU 部分（主线程）：VB/IB + 贴图
+static bool FinishModel(SkinnedModelRes& m, const MeshUpload& up, const std::wstring& texPath,
+    const std::vector<std::wstring>& matTexPaths)
+{
+    // v2 但没有压缩版 VS：解成 v1 上传（临时的，上传完即释放）
+    MeshUpload vb = up;
+    std::vector<SkinnedVertexV1> decoded;
+    if (m.quantized && !(gVSQ && gILQ)) {
+        decoded.resize(m.cpuVertCount);
+        MeshQuant_DecodeSkinned((const SkinnedVertexV2*)up.vbData, m.cpuVertCount, m.bounds, decoded.data());
+        vb.vbData = decoded.data();
+        vb.vbBytes = decoded.size() * sizeof(SkinnedVertexV1);
+        m.vertexStride = sizeof(SkinnedVertexV1);
+        m.quantized = false;
+    }
+    if (!CreateMeshBuffers(m, vb)) {
+        SAFE_RELEASE(m.vb);
+        SAFE_RELEASE(m.ib);
+        return false;
+    }
 
-    auto wrap = [&](int x) {
-        if (gFrameCount == 0) return 0;
-        while (x < 0) x += (int)gFrameCount;
-        while (x >= (int)gFrameCount) x -= (int)gFrameCount;
-        return x;
+    // b6：反量化参数，模型加载后不变
+    SAFE_RELEASE(m.cbDequant);
+    if (m.quantized) {
+        XMFLOAT4 dq[2] = {
+            { m.bounds.minv[0], m.bounds.minv[1], m.bounds.minv[2], 0.0f },
+            { m.bounds.maxv[0] - m.bounds.minv[0], m.bounds.maxv[1] - m.bounds.minv[1], m.bounds.maxv[2] - m.bounds.minv[2], 0.0f },
         };
-    int f1 = wrap(f0 + 1);
-    f0 = wrap(f0);
-
-    const size_t J = gJoints.size();
-    const AnimTRS& A = gAnimFrames[(size_t)f0 * J + joint];
-    const AnimTRS& B = gAnimFrames[(size_t)f1 * J + joint];
-
-    out.T[0] = A.T[0] + (B.T[0] - A.T[0]) * a;
-    out.T[1] = A.T[1] + (B.T[1] - A.T[1]) * a;
-    out.T[2] = A.T[2] + (B.T[2] - A.T[2]) * a;
-
-    out.S[0] = A.S[0] + (B.S[0] - A.S[0]) * a;
-    out.S[1] = A.S[1] + (B.S[1] - A.S[1]) * a;
-    out.S[2] = A.S[2] + (B.S[2] - A.S[2]) * a;
-
-    XMVECTOR qA = XMVectorSet(A.R[0], A.R[1], A.R[2], A.R[3]);
-    XMVECTOR qB = XMVectorSet(B.R[0], B.R[1], B.R[2], B.R[3]);
-    XMVECTOR q = XMQuaternionSlerp(qA, qB, a);
-    XMFLOAT4 qf; XMStoreFloat4(&qf, q);
-    out.R[0] = qf.x; out.R[1] = qf.y; out.R[2] = qf.z; out.R[3] = qf.w;
-    return out;
+        D3D11_BUFFER_DESC bd{};
+        bd.Usage = D3D11_USAGE_IMMUTABLE;
+        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bd.ByteWidth = sizeof(dq);
+        D3D11_SUBRESOURCE_DATA sd{};
+        sd.pSysMem = dq;
+        if (FAILED(gDev->CreateBuffer(&bd, &sd, &m.cbDequant))) {
+            SAFE_RELEASE(m.vb);
+            SAFE_RELEASE(m.ib);
+            return false;
+        }
+    }
+    // 每条材质的贴图只解析一次；同一路径的材质共用一个贴图
+    m.texId = texPath.empty() ? -1 : Texture_Load(texPath.c_str());
+    m.matTex.assign(matTexPaths.size(), m.texId);
+    for (size_t i = 0; i < matTexPaths.size(); ++i) {
+        if (matTexPaths[i].empty()) continue;
+        const size_t first = size_t(std::find(matTexPaths.begin(), matTexPaths.end(), matTexPaths[i]) - matTexPaths.begin());
+        m.matTex[i] = (first < i) ? m.matTex[first] : Texture_Load(matTexPaths[i].c_str());
+    }
+    return true;
 }
 
-// === 以 MotionRoot 为根：采样位移 ΔT ===
-bool ModelSkinned_SampleRootDelta_Local(float dt, XMFLOAT3* outDeltaT) {
-    if (!outDeltaT) return false;
-    outDeltaT->x = outDeltaT->y = outDeltaT->z = 0.0f;
-
-    if (gFrameCount == 0 || gJoints.empty()) return false;
-    int root = ModelSkinned_GetMotionRootIndex();
-    if (root < 0) root = ModelSkinned_GetRootJointIndex();
-    if (root < 0) return false;
-
-    const float t0 = gTime;
-    const float t1 = gLoop ? (t0 + dt) : std::min(t0 + dt, gDurationSec);
+int ModelSkinned_CreateModel(const ModelSkinnedDesc& d) {
+    if (!EnsureSkinnedShader()) return -1;
+
+    auto m = std::make_unique<SkinnedModelRes>();
+    MeshUpload up;
+    std::wstring texPath;
+    std::vector<std::wstring> matTexPaths;
+    const std::wstring matPath = ResolveMatPath(d);
+    AssetViewRef skel = AssetView_Open(d.skelPath);
+    AssetViewRef mat = matPath.empty() ? nullptr : AssetView_Open(matPath);
+    if (!DecodeModel(d, AssetView_Open(d.meshPath), skel.get(), mat.get(), *m, up, texPath, matTexPaths) ||
+        !FinishModel(*m, up, texPath, matTexPaths))
+        return -1;
+
+    gModels.push_back(std::move(m));
+    gModelLoad.emplace_back();
+    return (int)gModels.size() - 1;
+}
 
-    AnimTRS R0 = SampleJointTRS_Linear(root, t0);
-    AnimTRS R1 = SampleJointTRS_Linear(root, t1);
+int ModelSkinned_CreateClip(const std::wstring& animPath) {
+    if (animPath.empty()) return -1;
+    auto c = std::make_unique<AnimClip>();
+    if (!AnimClip_Load(animPath, *c)) return -1;
+    gClips.push_back(std::move(c));
+    gClipLoad.emplace_back();
+    return (int)gClips.size() - 1;
+}
 
-    outDeltaT->x = (R1.T[0] - R0.T[0]);
-    outDeltaT->y = (R1.T[1] - R0.T[1]);
-    outDeltaT->z = (R1.T[2] - R0.T[2]);
-    return true;
+int ModelSkinned_CreateModelAsync(const ModelSkinnedDesc& d, AssetStreamPriority priority) {
+    if (!EnsureSkinnedShader()) return -1;
+
+    const int h = (int)gModels.size();
+    auto p = std::make_shared<PendingModel>();
+    p->desc = d;
+    gModels.emplace_back();
+    gModelLoad.push_back(ModelLoadSlot{ p, AssetStreamState::Queued });
+
+    p->stream = AssetStream_Request({ d.meshPath, d.skelPath, ResolveMatPath(d) }, priority,
+        [p](const AssetViewRef* v, uint32_t) {
+            return DecodeModel(p->desc, v[0], v[1].get(), v[2].get(), *p->res, p->upload, p->texPath, p->matTexPaths);
+        },
+        [p, h](AssetStreamState s) {
+            if (h >= (int)gModelLoad.size() || gModelLoad[h].pending != p) return;   // 已释放 / Finalize
+            gModelLoad[h].pending.reset();
+            if (s == AssetStreamState::Ready && !FinishModel(*p->res, p->upload, p->texPath, p->matTexPaths)) s = AssetStreamState::Failed;
+            p->upload = MeshUpload{};
+            gModelLoad[h].state = s;
+            if (s == AssetStreamState::Ready) { gModels[h] = std::move(p->res); return; }
+            if (s == AssetStreamState::Failed) {
+                char buf[300];
+                sprintf_s(buf, "[ModelSkinned] async load FAILED: %ls\n", p->desc.meshPath.c_str());
+                OutputDebugStringA(buf);
+            }
+        });
+    return h;
 }
 
-// === 以 MotionRoot 为根：采样 ΔYaw（局部） ===
-bool ModelSkinned_SampleRootYawDelta(float dt, float* outDeltaYaw) {
-    if (!outDeltaYaw) return false;
-    *outDeltaYaw = 0.0f;
+int ModelSkinned_CreateClipAsync(const std::wstring& animPath, AssetStreamPriority priority) {
+    if (animPath.empty()) return -1;
+
+    const int h = (int)gClips.size();
+    auto p = std::make_shared<PendingClip>();
+    gClips.emplace_back();
+    gClipLoad.push_back(ClipLoadSlot{ p, AssetStreamState::Queued });
+
+    p->stream = AssetStream_Request({ animPath }, priority,
+        [p](const AssetViewRef* v, uint32_t) { return AnimClip_LoadFromView(v[0], *p->clip); },
+        [p, h, animPath](AssetStreamState s) {
+            if (h >= (int)gClipLoad.size() || gClipLoad[h].pending != p) return;
+            gClipLoad[h].pending.reset();
+            gClipLoad[h].state = s;
+            if (s == AssetStreamState::Ready) { gClips[h] = std::move(p->clip); return; }
+            if (s == AssetStreamState::Failed) {
+                char buf[300];
+                sprintf_s(buf, "[ModelSkinned] async load FAILED: %ls\n", animPath.c_str());
+                OutputDebugStringA(buf);
+            }
+        });
+    return h;
+}
 
-    if (gFrameCount == 0 || gJoints.empty()) return false;
-    int root = ModelSkinned_GetMotionRootIndex();
-    if (root < 0) root = ModelSkinned_GetRootJointIndex();
-    if (root < 0) return false;
+// 加载中：区分排队 / 读取解码中；其余按槽位记录的最终状态
+template <class Slot>
+static AssetStreamState LoadState(const std::vector<Slot>& slots, bool resident, int h) {
+    if (h < 0 || h >= (int)slots.size()) return AssetStreamState::None;
+    if (resident) return AssetStreamState::Ready;
+    if (slots[h].pending) {
+        const AssetStreamState s = AssetStream_GetState(slots[h].pending->stream);
+        return (s == AssetStreamState::Queued) ? s : AssetStreamState::Loading;
+    }
+    return (slots[h].state == AssetStreamState::Ready) ? AssetStreamState::None : slots[h].state;   // Ready 但已释放
+}
 
-    const float t0 = gTime;
-    const float t1 = gLoop ? (t0 + dt) : std::min(t0 + dt, gDurationSec);
+AssetStreamState ModelSkinned_GetModelState(int model) {
+    return LoadState(gModelLoad, GetModelRes(model) != nullptr, model);
+}
 
-    const AnimTRS R0 = SampleJointTRS_Linear(root, t0);
-    const AnimTRS R1 = SampleJointTRS_Linear(root, t1);
+AssetStreamState ModelSkinned_GetClipState(int clip) {
+    return LoadState(gClipLoad, GetClipRes(clip) != nullptr, clip);
+}
 
-    auto YawFromQuat = [](const AnimTRS& r)->float {
-        XMVECTOR q = XMQuaternionNormalize(XMVectorSet(r.R[0], r.R[1], r.R[2], r.R[3]));
-        XMVECTOR f = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), q);
-        f = XMVector3Normalize(f);
-        XMFLOAT3 fv; XMStoreFloat3(&fv, f);
-        return std::atan2f(fv.x, fv.z);
-        };
+void ModelSkinned_SetModelLoadPriority(int model, AssetStreamPriority priority) {
+    if (model >= 0 && model < (int)gModelLoad.size() && gModelLoad[model].pending)
+        AssetStream_SetPriority(gModelLoad[model].pending->stream, priority);
+}
 
-    const float y0 = YawFromQuat(R0);
-    const float y1 = YawFromQuat(R1);
-    *outDeltaYaw = AngleDelta(y1 - y0);
-    return true;
+void ModelSkinned_SetClipLoadPriority(int clip, AssetStreamPriority priority) {
+    if (clip >= 0 && clip < (int)gClipLoad.size() && gClipLoad[clip].pending)
+        AssetStream_SetPriority(gClipLoad[clip].pending->stream, priority);
 }
 
-// —— 入场对齐 —— 
-void ModelSkinned_SetRootYawAlignTarget(float yawTargetRad) { gRootYawAlignTarget = yawTargetRad; gRootYawAlignEnabled = true; }
-void ModelSkinned_ResetRootYawTrack(float yawStartRad) { gRootYawStart = yawStartRad; }
+void ModelSkinned_ReleaseModel(int model) {
+    if (model >= 0 && model < (int)gModelLoad.size() && gModelLoad[model].pending) {
+        AssetStream_Cancel(gModelLoad[model].pending->stream);
+        gModelLoad[model].pending.reset();   // finish 回调看到槽位已换就直接丢弃
+        gModelLoad[model].state = AssetStreamState::Cancelled;
+        return;
+    }
+    SkinnedModelRes* m = GetModelRes(model);
+    if (!m) return;
+    // 仍引用它的实例一律解绑
+    for (auto& I : gInstances) {
+        if (I.model == m) {
+            ReleaseBoneCB(I);
+            I.model = nullptr; I.clip = nullptr; I.clipMap = nullptr; I.fadeClip = nullptr; I.blendCount = 0;
+            I.motionRootIndex = -1; I.poseDirty = true;
+        }
+    }
+    DropRetargets(m, nullptr);
+    SAFE_RELEASE(m->vb);
+    SAFE_RELEASE(m->ib);
+    SAFE_RELEASE(m->cbDequant);
+    gModels[model].reset();
+}
 
-// —— Node 层修正 —— 
-void  ModelSkinned_SetNodeYawFix(float r) { gNodeYawFixRad = r; }
-float ModelSkinned_GetNodeYawFix() { return gNodeYawFixRad; }
+void ModelSkinned_ReleaseClip(int clip) {
+    if (clip >= 0 && clip < (int)gClipLoad.size() && gClipLoad[clip].pending) {
+        AssetStream_Cancel(gClipLoad[clip].pending->stream);
+        gClipLoad[clip].pending.reset();
+        gClipLoad[clip].state = AssetStreamState::Cancelled;
+        return;
+    }
+    const AnimClip* c = GetClipRes(clip);
+    if (!c) return;
+    for (auto& I : gInstances) {
+        if (I.clip == c) { I.clip = nullptr; I.clipMap = nullptr; I.poseDirty = true; }
+        if (I.fadeClip == c) { I.fadeClip = nullptr; I.fadeMap = nullptr; I.poseDirty = true; }
+        if (I.evClip == c) I.evClip = nullptr;
+        for (int k = 0; k < I.blendCount; ++k)
+            if (I.blendClip[k] == c) { I.blendCount = 0; I.poseDirty = true; break; }
+        for (SkinnedLayer& L : I.layers) {
+            if (L.clip == c) { L.clip = nullptr; L.map = nullptr; L.weight = 0.0f; I.poseDirty = true; }
+            if (L.evClip == c) L.evClip = nullptr;
+        }
+    }
+    DropRetargets(nullptr, c);
+    gClips[clip].reset();
+}
 
 // ---------------------------------------------------------
-// Draw
+// 实例内部实现
 // ---------------------------------------------------------
-void ModelSkinned_Draw() {
-    if (!gVB || !gIB || !gVS || !gIL) return;
-
-    const size_t J = gJoints.size();
-    if (J == 0) return;
-
-    g_temp_globals.resize(J);
-
-    if (gFrameCount > 0) {
-        // 取当前帧
-        float frameF = gTime * gSampleRate;
-        uint32_t f0 = (uint32_t)std::floor(frameF);
-        if (f0 >= gFrameCount) f0 = gFrameCount - 1;
-
-        const AnimTRS* currentFramePose = gAnimFrames.data() + size_t(f0) * J;
-
-        // 只读/可写姿态双指针
-        const AnimTRS* poseRO = currentFramePose;
-        std::vector<AnimTRS> tempPose;
-        AnimTRS* poseRW = nullptr;
-
-        // MotionRoot
-        int root = ModelSkinned_GetMotionRootIndex();
-        if (root < 0) root = ModelSkinned_GetRootJointIndex();
-        if (root < 0) root = 0;
+static SkinnedInstance* GetInstance(int h) {
+    return (h >= 0 && h < (int)gInstances.size() && gInstances[h].used) ? &gInstances[h] : nullptr;
+}
 
-        // 清除根 XZ 平移（Velocity-driven 模式）
-        if (gZeroRootTransXZ && J > 0) {
-            tempPose.assign(currentFramePose, currentFramePose + J);
-            tempPose[root].T[0] = 0.0f;
-            tempPose[root].T[2] = 0.0f;
-            poseRW = tempPose.data();
+static int AllocInstance() {
+    for (int i = 0; i < (int)gInstances.size(); ++i) {
+        if (!gInstances[i].used) {
+            gInstances[i] = SkinnedInstance{};
+            gInstances[i].used = true;
+            return i;
         }
+    }
+    gInstances.emplace_back();
+    gInstances.back().used = true;
+    return (int)gInstances.size() - 1;
+}
 
-        // 根局部旋转：入场对齐（可选是否保留Δ，当前默认不保留，以便把 Δ 交给 RootMotion）
-        if (gRootYawAlignEnabled && J > 0) {
-            if (!poseRW) { tempPose.assign(currentFramePose, currentFramePose + J); poseRW = tempPose.data(); }
-
-            auto AngleWrap = [](float a)->float {
-                const float PI = 3.14159265358979323846f, TWO = 6.283185307179586f;
-                while (a > PI) a -= TWO;
-                while (a <= -PI) a += TWO;
-                return a;
-                };
-            auto YawFromLocal = [](const AnimTRS& t)->float {
-                XMVECTOR q = XMQuaternionNormalize(XMVectorSet(t.R[0], t.R[1], t.R[2], t.R[3]));
-                XMVECTOR f = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), q);
-                f = XMVector3Normalize(f);
-                XMFLOAT3 fv; XMStoreFloat3(&fv, f);
-                return std::atan2f(fv.x, fv.z);
-                };
-
-            const float yawCurr = YawFromLocal(poseRW[root]);
-            const float visualOffset = AngleWrap(gRootYawAlignTarget - gRootYawStart);
-            const float deltaCum = AngleWrap(yawCurr - gRootYawStart);
-            const float fixYaw = AngleWrap(visualOffset - deltaCum);
+// 旧接口用的默认实例（第一次用到时创建）
+static SkinnedInstance& Def() {
+    if (!GetInstance(gDefaultInstance)) gDefaultInstance = AllocInstance();
+    return gInstances[gDefaultInstance];
+}
 
-            XMVECTOR qLocal = XMQuaternionNormalize(XMVectorSet(
-                poseRW[root].R[0], poseRW[root].R[1], poseRW[root].R[2], poseRW[root].R[3]));
-            XMVECTOR qFix = XMQuaternionRotationRollPitchYaw(0.0f, fixYaw, 0.0f);
-            XMVECTOR qOut = XMQuaternionMultiply(qFix, qLocal);
+static inline bool HasSkeleton(const SkinnedInstance& I) { return I.model && I.model->skel.jointCount > 0; }
+static inline bool HasClip(const SkinnedInstance& I) { return HasSkeleton(I) && I.clip && I.clip->frameCount > 0; }
 
-            XMFLOAT4 out; XMStoreFloat4(&out, qOut);
-            poseRW[root].R[0] = out.x; poseRW[root].R[1] = out.y;
-            poseRW[root].R[2] = out.z; poseRW[root].R[3] = out.w;
-        }
+static int FindTrueRootIndex(const SkinnedInstance& I) {
+    if (!I.model) return -1;
+    const auto& parent = I.model->skel.parent;
+    for (int i = 0; i < (int)parent.size(); ++i)
+        if (parent[i] == -1) return i;
+    return -1;
+}
 
-        const AnimTRS* finalPose = poseRW ? (const AnimTRS*)poseRW : poseRO;
+static void ResolveMotionRoot(SkinnedInstance& I) {
+    I.motionRootIndex = -1;
+    I.poseDirty = true;
+    if (!HasSkeleton(I)) return;
+    const auto& names = I.model->jointNames;
+    const auto& parent = I.model->skel.parent;
 
-        // 递归：局部→全局
-        for (size_t j = 0; j < J; ++j) {
-            if (gJoints[j].parent == -1) {
-                ComputeAnimationPoseRecursively(j, XMMatrixIdentity(), finalPose);
+    // 1) 指定名优先
+    if (!I.motionRootNameUTF8.empty()) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == I.motionRootNameUTF8) {
+                I.motionRootIndex = (int)i;
+                break;
             }
         }
     }
-    else {
-        // 无动画：展示 bind pose
-        for (size_t j = 0; j < J; ++j) {
-            if (gJoints[j].parent == -1) {
-                ComputeGlobalBindPoseRecursively(j, XMMatrixIdentity());
+    // 2) cook 阶段按默认策略解析好的（.skel 'SMET'）
+    if (I.motionRootIndex < 0) I.motionRootIndex = I.model->skel.motionRoot;
+    // 3) 常见别名
+    if (I.motionRootIndex < 0) {
+        static const char* kCandidates[] = {
+            "mixamorig:Hips","Hips","Root","root","Armature","Motion","motion"
+        };
+        for (auto s : kCandidates) {
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (names[i] == s) { I.motionRootIndex = (int)i; break; }
             }
+            if (I.motionRootIndex >= 0) break;
         }
     }
-
-    // 调色板：invBind * currentGlobal
-    for (size_t j = 0; j < J; ++j) {
-        XMMATRIX invB = XMLoadFloat4x4(&gJoints[j].invBind);
-        XMMATRIX M = invB * g_temp_globals[j];
-        XMStoreFloat4x4(&gPalette[j], XMMatrixTranspose(M));
+    // 4) 退回真正根
+    if (I.motionRootIndex < 0) {
+        for (size_t i = 0; i < parent.size(); ++i) {
+            if (parent[i] == -1) { I.motionRootIndex = (int)i; break; }
+        }
     }
 
-    // 上传到 VS b5
-    D3D11_MAPPED_SUBRESOURCE mp{};
-    if (SUCCEEDED(gCtx->Map(gCBBones, 0, D3D11_MAP_WRITE_DISCARD, 0, &mp))) {
-        size_t copyJ = std::min(J, size_t(MAX_BONES));
-        std::memcpy(mp.pData, gPalette.data(), copyJ * sizeof(XMFLOAT4X4));
-        gCtx->Unmap(gCBBones, 0);
+#if defined(DEBUG) || defined(_DEBUG)
+    if (I.motionRootIndex >= 0) {
+        char buf[256];
+        sprintf_s(buf, "[Skinned] MotionRoot = #%d (%s)\n",
+            I.motionRootIndex, names[I.motionRootIndex].c_str());
+        OutputDebugStringA(buf);
+    }
+    else {
+        OutputDebugStringA("[Skinned] MotionRoot resolve FAILED\n");
     }
+#endif
+}
+
+static int MotionRootIndex(SkinnedInstance& I) {
+    if (!I.model) return -1;
+    if (I.motionRootIndex >= 0 && I.motionRootIndex < (int)I.model->skel.jointCount)
+        return I.motionRootIndex;
+    ResolveMotionRoot(I);
+    return I.motionRootIndex;
+}
+
+// —— 动画层 ——
+static SkinnedLayer* GetLayer(SkinnedInstance& I, int layer) {
+    return (layer >= 0 && layer < MODEL_SKINNED_MAX_LAYERS) ? &I.layers[layer] : nullptr;
+}
+
+// 遮罩、重定向表、Additive 参考姿态都依赖模型：绑定模型 / 改遮罩 / 换剪辑时重建（主线程）
+static void RebuildLayer(const SkinnedInstance& I, SkinnedLayer& L) {
+    L.maskModel = nullptr;
+    if (!I.model) return;
+    const AnimSkeleton& sk = I.model->skel;
+
+    std::vector<const char*> roots;
+    for (const std::string& r : L.maskRoots) roots.push_back(r.c_str());
+    AnimPose_BuildSubtreeMask(sk, I.model->jointNames, roots.data(), L.maskRootWeights.data(),
+        (uint32_t)roots.size(), L.jointWeight);
+    L.jointKeep.resize(sk.jointCount);
+    for (uint32_t j = 0; j < sk.jointCount; ++j) L.jointKeep[j] = (L.jointWeight[j] > 0.0f) ? 1 : 0;
+    L.maskModel = I.model;
+
+    if (L.clip && !GetRetarget(I.model, L.clip, &L.map)) L.clip = nullptr;
+    L.refPose.clear();
+    if (L.clip && L.mode == AnimLayerBlend::Additive) {
+        std::vector<float> scratch;
+        L.refPose.resize(sk.jointCount);
+        AnimClip_SamplePose(*L.clip, 0.0f, L.refPose.data(), scratch, nullptr, L.map);
+    }
+}
+
+static bool SetLayerMask(SkinnedInstance& I, int layer, AnimLayerBlend mode, const char* const* roots,
+    const float* rootWeights, int count) {
+    SkinnedLayer* L = GetLayer(I, layer);
+    if (!L) return false;
+    L->mode = mode;
+    L->maskRoots.clear();
+    L->maskRootWeights.clear();
+    for (int k = 0; k < count; ++k) {
+        if (!roots[k]) continue;
+        L->maskRoots.emplace_back(roots[k]);
+        L->maskRootWeights.push_back(rootWeights ? rootWeights[k] : 1.0f);
+    }
+    RebuildLayer(I, *L);
+    I.poseDirty = true;
+    return true;
+}
+
+// 层剪辑从 0 开始；权重从当前值在 fadeSec 内移到 weight（同层换剪辑时姿态是硬切，权重连续）
+static bool PlayLayer(SkinnedInstance& I, int layer, int clip, float weight, float fadeSec, bool loop, float rate) {
+    SkinnedLayer* L = GetLayer(I, layer);
+    const AnimClip* c = GetClipRes(clip);
+    if (!L || !I.model || !c) return false;
+
+    L->clip = c;
+    L->time = 0.0f;
+    L->loop = loop;
+    L->playback = rate;
+    RebuildLayer(I, *L);
+    if (!L->clip) return false;   // 对不上骨架
+
+    L->targetWeight = std::clamp(weight, 0.0f, 1.0f);
+    L->fadeSpeed = (fadeSec > 0.0f) ? std::fabs(L->targetWeight - L->weight) / fadeSec : 0.0f;
+    if (fadeSec <= 0.0f) L->weight = L->targetWeight;
+    I.poseDirty = true;
+    return true;
+}
+
+static void StopLayer(SkinnedInstance& I, int layer, float fadeSec) {
+    SkinnedLayer* L = GetLayer(I, layer);
+    if (!L || !L->clip) return;
+    L->targetWeight = 0.0f;
+    L->fadeSpeed = (fadeSec > 0.0f) ? L->weight / fadeSec : 0.0f;
+    if (fadeSec <= 0.0f) { L->weight = 0.0f; L->clip = nullptr; }
+    I.poseDirty = true;
+}
+
+static bool BindModel(SkinnedInstance& I, int model) {
+    SkinnedModelRes* m = GetModelRes(model);
+    if (!m) return false;
+    if (I.model != m) {
+        ReleaseBoneCB(I);
+        I.model = m;
+        I.fadeClip = nullptr; // 换骨架：不做过渡
+        I.poseDirty = true;
+        I.clip = nullptr; // 骨架变了，旧剪辑不一定匹配
+        I.clipMap = nullptr;
+        I.blendCount = 0;
+        I.palette.resize(std::max<size_t>(1, m->skel.jointCount));
+
+        // 解析一次 MotionRoot（默认策略可解析出 Hips）
+        ResolveMotionRoot(I);
+
+        // 层遮罩 / 重定向表 / 参考姿态都按新骨架重建
+        for (SkinnedLayer& L : I.layers) RebuildLayer(I, L);
+    }
+    return true;
+}
+
+// 两个模型画出来一样、剪辑可以互换：骨骼数 / 父子关系 / 骨骼名 / invBind 一致，
+// 且 .mesh 内容相同（包内去重的文件映射到同一处，散文件逐字节比较）、贴图相同
+static bool ModelsInterchangeable(const SkinnedModelRes* a, const SkinnedModelRes* b) {
+    if (!a || !b) return false;
+    if (a == b) return true;
+    if (a->skel.jointCount != b->skel.jointCount || a->skel.parent != b->skel.parent || a->jointNames != b->jointNames)
+        return false;
+
+    for (uint32_t j = 0; j < a->skel.jointCount; ++j) {
+        const float* ma = &a->skel.invBind[j]._11;
+        const float* mb = &b->skel.invBind[j]._11;
+        for (int k = 0; k < 16; ++k)
+            if (std::fabs(ma[k] - mb[k]) > 1e-4f) return false;
+    }
+
+    if (!a->meshFile || !b->meshFile) return false;
+    const AssetView& fa = *a->meshFile;
+    const AssetView& fb = *b->meshFile;
+    if (fa.size != fb.size) return false;
+    if (fa.data != fb.data && std::memcmp(fa.data, fb.data, fa.size) != 0) return false;
+    return a->texId == b->texId && a->matTex == b->matTex;
+}
+
+// 换到可互换的模型（ModelsInterchangeable）：剪辑 / 时间 / 淡出 / 混合 / 层都保留，只重新查重定向表
+static bool SwapModel(SkinnedInstance& I, int model) {
+    SkinnedModelRes* m = GetModelRes(model);
+    if (!m) return false;
+    if (I.model == m) return true;
+    if (!ModelsInterchangeable(I.model, m)) return false;
+
+    // 骨架一样，重定向表照样能建出来；先全部查完，失败时不动实例
+    const AnimRetargetMap* clipMap = nullptr;
+    const AnimRetargetMap* fadeMap = nullptr;
+    const AnimRetargetMap* blendMap[SkinnedInstance::kMaxBlendClips] = {};
+    if (I.clip && !GetRetarget(m, I.clip, &clipMap)) return false;
+    if (I.fadeClip && !GetRetarget(m, I.fadeClip, &fadeMap)) return false;
+    for (int k = 0; k < I.blendCount; ++k)
+        if (!GetRetarget(m, I.blendClip[k], &blendMap[k])) return false;
+
+    ReleaseBoneCB(I);
+    I.model = m;
+    I.clipMap = clipMap;
+    I.fadeMap = fadeMap;
+    for (int k = 0; k < I.blendCount; ++k) I.blendMap[k] = blendMap[k];
+    ResolveMotionRoot(I);
+    for (SkinnedLayer& L : I.layers) RebuildLayer(I, L);
+    I.lodKeyValid = false;
+    I.poseDirty = true;
+    return true;
+}
+
+static bool BindClip(SkinnedInstance& I, int clip) {
+    if (!I.model) return false;
+    I.poseDirty = true;
+    I.blendCount = 0;
+    if (clip < 0) { I.clip = nullptr; I.clipMap = nullptr; I.time = 0.0f; return true; } // 无动画：bind pose
+
+    const AnimClip* c = GetClipRes(clip);
+    if (!c) return false;
+    // 骨骼数 / 顺序不同时按骨骼名重定向（表按（骨架, 剪辑）缓存）
+    const AnimRetargetMap* map = nullptr;
+    if (!GetRetarget(I.model, c, &map)) return false;
+    I.clip = c;
+    I.clipMap = map;
+    I.time = 0.0f;
+    return true;
+}
+
+// 按 loop 折回 / 夹紧
+static float AdvanceClipTime(float t, float dt, float dur, bool loop) {
+    t += dt;
+    if (loop) {
+        if (dur > 0.0f) {
+            while (t >= dur) t -= dur;
+            while (t < 0.0f) t += dur;
+        }
+    }
+    else {
+        t = std::clamp(t, 0.0f, dur);
+    }
+    return t;
+}
+
+// 层：权重淡入 / 淡出 + 时间推进；淡出到 0 的层回到空闲
+static void UpdateLayers(SkinnedInstance& I, float dt) {
+    for (SkinnedLayer& L : I.layers) {
+        L.evClip = nullptr;
+        if (!L.clip) continue;
+        const float w0 = L.weight, t0 = L.time;
+
+        if (L.weight != L.targetWeight) {
+            const float step = (L.fadeSpeed > 0.0f) ? L.fadeSpeed * dt : 1.0f;
+            L.weight = (L.weight < L.targetWeight) ? std::min(L.targetWeight, L.weight + step)
+                                                   : std::max(L.targetWeight, L.weight - step);
+        }
+        if (L.targetWeight <= 0.0f && L.weight <= 0.0f) { L.clip = nullptr; I.poseDirty = true; continue; }
+
+        const float dur = L.clip->durationSec;
+        const float advance = dt * L.playback;
+        L.evT0 = L.time;
+        L.time = AdvanceClipTime(L.time, advance, dur, L.loop);
+        L.evClip = L.clip;
+        L.evLoop = L.loop;
+        L.evT1 = L.loop ? L.evT0 + advance : std::clamp(L.evT0 + advance, 0.0f, dur);
+        if (L.weight != w0 || L.time != t0) I.poseDirty = true;
+    }
+}
+
+static void UpdateInstance(SkinnedInstance& I, double dtSec) {
+    UpdateLayers(I, float(dtSec));
+    if (I.fadeClip) {
+        const float fadeT0 = I.fadeTime, elapsed0 = I.fadeElapsed;
+        I.fadeTime = AdvanceClipTime(I.fadeTime, float(dtSec) * I.fadePlayback, I.fadeClip->durationSec, I.fadeLoop);
+        I.fadeElapsed += float(dtSec);
+        if (I.fadeElapsed >= I.fadeDuration) I.fadeClip = nullptr;
+        if (!I.fadeClip || I.fadeTime != fadeT0 || I.fadeElapsed != elapsed0) I.poseDirty = true;
+    }
+    I.evClip = nullptr;
+    if (!HasClip(I)) return;
+    const float time0 = I.time, phase0 = I.phase;
+
+    // 事件区间：推进前的时间 + 本帧推进量（不回绕；非循环夹到终点）
+    const float dur = I.clip->durationSec;
+    float advance = float(dtSec) * I.playback;
+
+    if (I.blendCount > 0) {
+        // 一个周期的时长 = 各剪辑周期按权重加权 → 相位推进后各剪辑脚步保持同步
+        float cycle = 0.0f;
+        for (int k = 0; k < I.blendCount; ++k)
+            cycle += I.blendWeight[k] * I.blendClip[k]->durationSec / std::max(I.blendRate[k], 1e-3f);
+        advance = (cycle > 0.0f) ? float(dtSec) * I.playback / cycle * dur : 0.0f;
+        if (cycle > 0.0f)
+            I.phase = AdvanceClipTime(I.phase, float(dtSec) * I.playback / cycle, 1.0f, I.loop);
+        I.evT0 = I.time;
+        I.time = I.phase * dur;
+    }
+    else {
+        I.evT0 = I.time;
+        I.time = AdvanceClipTime(I.time, advance, dur, I.loop);
+    }
+    I.evClip = I.clip;
+    I.evLoop = I.loop;
+    I.evT1 = I.loop ? I.evT0 + advance : std::clamp(I.evT0 + advance, 0.0f, dur);
+    if (I.time != time0 || I.phase != phase0) I.poseDirty = true;
+}
+
+// 剪辑事件 → AnimEventHit（下标暂存在静态区，只在主线程调用）
+static uint32_t CollectEvents(const AnimClip* c, float t0, float t1, bool loop, AnimEventHit* out, uint32_t maxOut) {
+    if (!c || !out || maxOut == 0 || c->events.empty()) return 0;
+    static std::vector<uint32_t> s_idx;
+    s_idx.resize(maxOut);
+    const uint32_t n = AnimClip_QueryEvents(*c, t0, t1, loop, s_idx.data(), maxOut);
+    for (uint32_t i = 0; i < n; ++i) {
+        const AnimClipEvent& ev = c->events[s_idx[i]];
+        out[i] = { c->eventNames[ev.nameIndex].c_str(), ev.timeSec, ev.payload };
+    }
+    return n;
+}
+
+// 设置混合空间的剪辑与权重（权重和应为 1；对不上骨架的剪辑忽略）
+// 进入混合时相位取当前剪辑的归一化时间；之后每帧调用只改权重，相位连续
+static bool SetBlendClips(SkinnedInstance& I, const int* clips, const float* weights, const float* rates, int count) {
+    if (!I.model) return false;
+
+    const bool entering = (I.blendCount == 0);
+    int n = 0;
+    float sum = 0.0f;
+    for (int k = 0; k < count && n < SkinnedInstance::kMaxBlendClips; ++k) {
+        const AnimClip* c = GetClipRes(clips[k]);
+        const AnimRetargetMap* map = nullptr;
+        if (!c || weights[k] <= 0.0f || !GetRetarget(I.model, c, &map)) continue;
+        I.blendClip[n] = c;
+        I.blendMap[n] = map;
+        I.blendWeight[n] = weights[k];
+        I.blendRate[n] = rates ? rates[k] : 1.0f;
+        sum += weights[k];
+        ++n;
+    }
+    if (n == 0) { I.blendCount = 0; return false; }
+    for (int k = 0; k < n; ++k) I.blendWeight[k] /= sum;
+
+    if (entering) {
+        I.phase = (HasClip(I) && I.clip->durationSec > 0.0f) ? I.time / I.clip->durationSec : 0.0f;
+    }
+    I.blendCount = n;
+
+    // 主剪辑 = 权重最大者
+    int main = 0;
+    for (int k = 1; k < n; ++k) if (I.blendWeight[k] > I.blendWeight[main]) main = k;
+    I.clip = I.blendClip[main];
+    I.clipMap = I.blendMap[main];
+    I.time = I.phase * I.clip->durationSec;
+    I.poseDirty = true;
+    return true;
+}
+
+// 交叉淡入：当前剪辑连同时间/速率/循环一起转为“淡出剪辑”，再绑定新剪辑（时间归零）
+// seconds <= 0、没有当前剪辑、或切到 bind pose 时等同 BindClip（硬切）
+static bool CrossFade(SkinnedInstance& I, int clip, float seconds, AnimBlendCurve curve) {
+    const AnimClip* from = HasClip(I) ? I.clip : nullptr;
+    const AnimRetargetMap* fromMap = I.clipMap;
+    const float fromTime = I.time;
+    const float fromPlayback = I.playback;
+    const bool  fromLoop = I.loop;
+    const float fromYawFix = I.nodeYawFixRad;
+
+    if (!BindClip(I, clip)) return false;
+
+    I.fadeClip = nullptr;
+    if (seconds <= 0.0f || !from || !HasClip(I)) return true;
+
+    I.fadeClip = from;
+    I.fadeMap = fromMap;
+    I.fadeTime = fromTime;
+    I.fadePlayback = fromPlayback;
+    I.fadeLoop = fromLoop;
+    I.fadeElapsed = 0.0f;
+    I.fadeDuration = seconds;
+    I.fadeCurve = curve;
+    I.fadeNodeYawFixRad = fromYawFix;
+    return true;
+}
+
+// 整个姿态在模型空间绕 Y 转 yaw（只改根骨骼：M * RotY = S * (R*Ry) * (T*Ry)）
+static void RotatePoseRootsY(const AnimSkeleton& sk, AnimTRS* pose, float yaw) {
+    const XMVECTOR qy = XMQuaternionRotationRollPitchYaw(0.0f, yaw, 0.0f);
+    for (uint32_t j = 0; j < sk.jointCount; ++j) {
+        if (sk.parent[j] >= 0) continue;
+        AnimTRS& r = pose[j];
+        XMVECTOR q = XMQuaternionMultiply(XMVectorSet(r.R[0], r.R[1], r.R[2], r.R[3]), qy);
+        XMVECTOR t = XMVector3Rotate(XMVectorSet(r.T[0], r.T[1], r.T[2], 0.0f), qy);
+        XMFLOAT4 qf; XMStoreFloat4(&qf, q);
+        XMFLOAT3 tf; XMStoreFloat3(&tf, t);
+        r.R[0] = qf.x; r.R[1] = qf.y; r.R[2] = qf.z; r.R[3] = qf.w;
+        r.T[0] = tf.x; r.T[1] = tf.y; r.T[2] = tf.z;
+    }
+}
+
+// 采样线性插值（辅助）；joint 是模型骨架的下标，剪辑里没有这根骨骼时取 bind pose
+static AnimTRS SampleJointTRS_Linear(const SkinnedInstance& I, int joint, float tSec) {
+    if (!HasClip(I)) return AnimTRS{};
+    const int src = AnimClip_SourceJoint(I.clipMap, (uint32_t)joint);
+    if (src < 0) return I.model->skel.bindLocal[joint];
+    return AnimClip_SampleJoint(*I.clip, (uint32_t)src, tSec);
+}
+
+// 同上，取第 frame 帧
+static AnimTRS JointAtFrame(const SkinnedInstance& I, int joint, uint32_t frame) {
+    const int src = AnimClip_SourceJoint(I.clipMap, (uint32_t)joint);
+    if (src < 0) return I.model->skel.bindLocal[joint];
+    return AnimClip_GetJointAtFrame(*I.clip, (uint32_t)src, frame);
+}
+
+static float YawFromLocalQuat(float qx, float qy, float qz, float qw) {
+    XMVECTOR q = XMQuaternionNormalize(XMVectorSet(qx, qy, qz, qw));
+    XMVECTOR f = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), q);
+    f = XMVector3Normalize(f);
+    XMFLOAT3 fv; XMStoreFloat3(&fv, f);
+    return std::atan2f(fv.x, fv.z);
+}
+
+// === MotionRoot 在 [t, t+dt] 的增量（ΔT 局部平移 + Δyaw）===
+// 剪辑带根运动曲线（cook_tool.py root-motion）且提取骨骼就是当前 MotionRoot：两次查表
+// 否则逐次采样骨骼；两条路径在循环时都按整圈增量处理跨过终点的区间
+static bool SampleRootMotionDelta(SkinnedInstance& I, float dt, float outT[3], float* outYaw) {
+    outT[0] = outT[1] = outT[2] = 0.0f;
+    *outYaw = 0.0f;
+
+    if (!HasClip(I)) return false;
+    int root = MotionRootIndex(I);
+    if (root < 0) root = FindTrueRootIndex(I);
+    if (root < 0) return false;
+
+    const AnimClip& c = *I.clip;
+    const float t0 = I.time;
+    if (AnimClip_HasRootMotion(c) && c.rootMotionJoint == AnimClip_SourceJoint(I.clipMap, (uint32_t)root))
+        return AnimClip_RootMotionDelta(c, t0, t0 + dt, I.loop, outT, outYaw);
+
+    const float dur = c.durationSec;
+    const float t1 = I.loop ? (t0 + dt) : std::clamp(t0 + dt, 0.0f, dur);
+    auto sampleAt = [&](float t, float out[4]) {
+        const AnimTRS R = SampleJointTRS_Linear(I, root, t);
+        out[0] = R.T[0]; out[1] = R.T[1]; out[2] = R.T[2];
+        out[3] = YawFromLocalQuat(R.R[0], R.R[1], R.R[2], R.R[3]);
+        };
+
+    float a[4], b[4];
+    float cycles = 0.0f;
+    if (I.loop && dur > 0.0f) {
+        const float c0 = std::floor(t0 / dur), c1 = std::floor(t1 / dur);
+        sampleAt(t0 - c0 * dur, a);
+        sampleAt(t1 - c1 * dur, b);
+        cycles = c1 - c0;
+    }
+    else {
+        sampleAt(t0, a);
+        sampleAt(t1, b);
+    }
+
+    float d[4] = { b[0] - a[0], b[1] - a[1], b[2] - a[2], AngleDelta(b[3] - a[3]) };
+    if (cycles != 0.0f) {
+        float s[4], e[4];
+        sampleAt(0.0f, s);
+        sampleAt(dur, e);
+        for (int k = 0; k < 3; ++k) d[k] += cycles * (e[k] - s[k]);
+        d[3] = AngleDelta(d[3] + cycles * AngleDelta(e[3] - s[3]));
+    }
+    outT[0] = d[0]; outT[1] = d[1]; outT[2] = d[2];
+    *outYaw = d[3];
+    return true;
+}
+
+// === 以 MotionRoot 为根：采样位移 ΔT ===
+static bool SampleRootDelta_Local(SkinnedInstance& I, float dt, XMFLOAT3* outDeltaT) {
+    if (!outDeltaT) return false;
+    float t[3], yaw;
+    const bool ok = SampleRootMotionDelta(I, dt, t, &yaw);
+    *outDeltaT = XMFLOAT3(t[0], t[1], t[2]);
+    return ok;
+}
+
+// === 以 MotionRoot 为根：采样 ΔYaw（局部） ===
+static bool SampleRootYawDelta(SkinnedInstance& I, float dt, float* outDeltaYaw) {
+    if (!outDeltaYaw) return false;
+    float t[3];
+    return SampleRootMotionDelta(I, dt, t, outDeltaYaw);
+}
+
+// DualQuat 模式：palette（最终结果，含 LOD 插值）→ dqPalette
+static void BuildDualQuatPalette(SkinnedInstance& I) {
+    if (I.skinning != SkinningMode::DualQuat) return;
+    const uint32_t n = (uint32_t)I.palette.size();
+    I.dqPalette.resize(size_t(n) * 2);
+    AnimPose_PaletteToDualQuat(I.palette.data(), n, I.dqPalette.data());
+}
+
+// 动画层合成到基础姿态上：每层只采样遮罩内（且 LOD 保留）的骨骼，逐骨骼加权混合
+// 多一层 ≈ 多一次部分采样 + 一遍混合；层级合成（LocalToModel）仍然只在最后做一次
+static void ApplyLayers(const SkinnedInstance& I, PoseScratch& S, AnimTRS* pose, const uint8_t* lodKeep) {
+    const uint32_t J = I.model->skel.jointCount;
+    for (const SkinnedLayer& L : I.layers) {
+        if (!L.clip || L.weight <= 0.0f || L.maskModel != I.model) continue;
+        if (L.mode == AnimLayerBlend::Additive && L.refPose.size() != J) continue;
+
+        const uint8_t* keep = L.jointKeep.data();
+        if (lodKeep) {
+            S.layerKeep.resize(J);
+            for (uint32_t j = 0; j < J; ++j) S.layerKeep[j] = L.jointKeep[j] & lodKeep[j];
+            keep = S.layerKeep.data();
+        }
+        S.layerPose.resize(J);
+        AnimClip_SamplePose(*L.clip, L.time, S.layerPose.data(), S.sample, keep, L.map);
+
+        if (L.mode == AnimLayerBlend::Additive)
+            AnimPose_AddMasked(pose, S.layerPose.data(), L.refPose.data(), L.jointWeight.data(), L.weight, J);
+        else
+            AnimPose_BlendMasked(pose, S.layerPose.data(), L.jointWeight.data(), L.weight, J);
+    }
+}
+
+// 姿态 → 调色板（写入 I.palette）
+// 只读写 I 自己和 S，可在工作线程上并行执行（共享的 model/clip 只读）
+static void EvaluatePalette(SkinnedInstance& I, PoseScratch& S) {
+    const AnimSkeleton& sk = I.model->skel;
+    const size_t J = sk.jointCount;
+
+    S.globals.resize(J);
+
+    // LOD：被省略的末端骨骼不采样，最后统一放回 bind pose
+    const uint8_t* mask = (I.lodReduceJoints && I.model->lodJointKeep.size() == J)
+        ? I.model->lodJointKeep.data() : nullptr;
+
+    if (HasClip(I)) {
+        // 当前时间的姿态（f0/f1 插值，整姿态一次混合）
+        S.pose.resize(J);
+        AnimTRS* pose = S.pose.data();
+        if (I.blendCount > 1) {
+            // 混合空间：按相位采样每个剪辑，逐个累加（nlerp 的权重按累计和折算）
+            S.blendPose.resize(J);
+            AnimClip_SamplePose(*I.blendClip[0], I.phase * I.blendClip[0]->durationSec, pose, S.sample, mask, I.blendMap[0]);
+            float acc = I.blendWeight[0];
+            for (int k = 1; k < I.blendCount; ++k) {
+                AnimClip_SamplePose(*I.blendClip[k], I.phase * I.blendClip[k]->durationSec, S.blendPose.data(), S.sample, mask,
+                    I.blendMap[k]);
+                acc += I.blendWeight[k];
+                AnimPose_Blend(pose, S.blendPose.data(), I.blendWeight[k] / acc, (uint32_t)J, pose);
+            }
+        }
+        else {
+            AnimClip_SamplePose(*I.clip, I.time, pose, S.sample, mask, I.clipMap);
+        }
+
+        // 交叉淡入：淡出剪辑 → 当前剪辑（局部空间混合）
+        if (I.fadeClip && I.fadeDuration > 0.0f) {
+            const float w = AnimPose_ApplyBlendCurve(I.fadeCurve, I.fadeElapsed / I.fadeDuration);
+            S.fadePose.resize(J);
+            AnimClip_SamplePose(*I.fadeClip, I.fadeTime, S.fadePose.data(), S.sample, mask, I.fadeMap);
+
+            // 两个剪辑的 NodeYawFix 不同：把淡出姿态转到当前 fix 下，否则切换瞬间整体会跳一下
+            const float dYaw = I.fadeNodeYawFixRad - I.nodeYawFixRad;
+            if (std::fabs(dYaw) > 1e-6f) RotatePoseRootsY(sk, S.fadePose.data(), dYaw);
+
+            AnimPose_Blend(S.fadePose.data(), pose, w, (uint32_t)J, pose);
+        }
+        ApplyLayers(I, S, pose, mask);
+        if (mask) AnimPose_ApplyBindToMasked(sk, mask, pose);
+
+        // MotionRoot
+        int root = MotionRootIndex(I);
+        if (root < 0) root = FindTrueRootIndex(I);
+        if (root < 0) root = 0;
+
+        // 清除根 XZ 平移（Velocity-driven 模式）
+        if (I.zeroRootTransXZ && J > 0) {
+            pose[root].T[0] = 0.0f;
+            pose[root].T[2] = 0.0f;
+        }
+
+        // 根局部旋转：入场对齐（可选是否保留Δ，当前默认不保留，以便把 Δ 交给 RootMotion）
+        if (I.rootYawAlignEnabled && J > 0) {
+            const float yawCurr = YawFromLocalQuat(pose[root].R[0], pose[root].R[1], pose[root].R[2], pose[root].R[3]);
+            const float visualOffset = AngleDelta(I.rootYawAlignTarget - I.rootYawStart);
+            const float deltaCum = AngleDelta(yawCurr - I.rootYawStart);
+            const float fixYaw = AngleDelta(visualOffset - deltaCum);
+
+            XMVECTOR qLocal = XMQuaternionNormalize(XMVectorSet(
+                pose[root].R[0], pose[root].R[1], pose[root].R[2], pose[root].R[3]));
+            XMVECTOR qFix = XMQuaternionRotationRollPitchYaw(0.0f, fixYaw, 0.0f);
+            XMVECTOR qOut = XMQuaternionMultiply(qFix, qLocal);
+
+            XMFLOAT4 out; XMStoreFloat4(&out, qOut);
+            pose[root].R[0] = out.x; pose[root].R[1] = out.y;
+            pose[root].R[2] = out.z; pose[root].R[3] = out.w;
+        }
+
+        // 局部→模型空间（拓扑序线性一遍）
+        AnimPose_LocalToModel(sk, pose, S.globals.data());
+    }
+    else {
+        // 无动画：展示 bind pose
+        AnimPose_LocalToModel(sk, sk.bindLocal.data(), S.globals.data());
+    }
+
+    // 调色板：invBind * currentGlobal
+    I.palette.resize(std::max<size_t>(1, J));
+    AnimPose_BuildPalette(sk, S.globals.data(), I.palette.data(), (uint32_t)J);
+    BuildDualQuatPalette(I);
+    I.poseDirty = false;
+    I.poseLagging = false;
+    ++I.poseVersion;
+}
+
+// LOD 档位：强制档优先，否则按实例原点到相机的距离
+static int SelectLod(const SkinnedInstance& I, const XMVECTOR& camPos) {
+    if (g_lodLevels.empty()) return -1;
+    const int last = (int)g_lodLevels.size() - 1;
+    if (I.lodOverride >= 0) return std::min(I.lodOverride, last);
+
+    const float dist = XMVectorGetX(XMVector3Length(XMVectorSubtract(I.world.r[3], camPos)));
+    for (int i = 0; i < last; ++i)
+        if (dist < g_lodLevels[i].maxDistance) return i;
+    return last;
+}
+
+// 按 I.lod 求值：降频档只在第 N 帧完整求值，中间帧对最近两次结果插值（显示滞后 N-1 帧）
+// 冻结档只在第一次 / 换剪辑时求值一次
+static void EvaluateWithLod(SkinnedInstance& I, PoseScratch& S, uint32_t stagger) {
+    if (I.lod < 0 || I.lod >= (int)g_lodLevels.size()) {
+        I.lodReduceJoints = false;
+        I.lodKeyValid = false;
+        EvaluatePalette(I, S);
+        return;
+    }
+    const ModelSkinnedLodLevel& L = g_lodLevels[I.lod];
+    const uint32_t N = L.frozen ? 1u : std::max(1u, L.updateInterval);
+    I.lodReduceJoints = L.reduceJoints;
+
+    const bool rekey = !I.lodKeyValid || I.lodKeyClip != I.clip || I.lodNext.size() != I.palette.size();
+    if (L.frozen && !rekey) { I.poseDirty = false; return; }
+
+    if (N == 1 || rekey) {
+        EvaluatePalette(I, S);
+        I.lodKeyClip = I.clip;
+        I.lodKeyValid = (N > 1) || L.frozen;
+        if (I.lodKeyValid) {
+            // 之后换到降频档时从这一姿态开始插值
+            I.lodPrev = I.palette;
+            I.lodNext = I.palette;
+            I.lodFrame = stagger % N;   // 错开各实例的完整求值帧
+        }
+        return;
+    }
+
+    if (++I.lodFrame >= N) {
+        I.lodFrame = 0;
+        EvaluatePalette(I, S);
+        I.lodPrev.swap(I.lodNext);
+        I.lodNext = I.palette;
+    }
+    const float t = float(I.lodFrame + 1) / float(N);
+    AnimPose_LerpPalette(I.lodPrev.data(), I.lodNext.data(), t, (uint32_t)I.palette.size(), I.palette.data());
+    BuildDualQuatPalette(I);
+    I.poseDirty = false;
+    I.poseLagging = true;
+    ++I.poseVersion;
+}
+
+static void DrawInstance(SkinnedInstance& I) {
+    if (!I.model || !I.model->vb || !I.model->ib || !gVS || !gIL) return;
+
+    const size_t J = I.model->skel.jointCount;
+    if (J == 0) return;
+
+    // 已由 ModelSkinned_EvaluatePoses 算好则直接用；否则在这里补算
+    if (I.poseDirty) EvaluatePalette(I, g_scratch[0]);
+
+    // DQ 模式：每骨骼 32 字节（矩阵版 64 字节）
+    const bool quantized = I.model->quantized;
+    ID3D11VertexShader* vsDQ = quantized ? gVSDQQ : gVSDQ;
+    const bool useDQ = I.skinning == SkinningMode::DualQuat && vsDQ
+        && I.dqPalette.size() >= 2 * J;
+
+    // 调色板从上次上传以来没变（同一帧的阴影 / 反射 pass、静止或冻结的实例）→ 直接绑定实例自己的 b5
+    if (I.boneCB.size() != I.model->draws.size() + 1) {
+        ReleaseBoneCB(I);
+        I.boneCB.assign(I.model->draws.size() + 1, nullptr);
+    }
+    const bool upload = I.gpuVersion != I.poseVersion || I.gpuDQ != useDQ;
 
     // 绑定着色器 & 常量
     Shader3d_Begin();
     Shader3d_SetColor({ 1,1,1,1 });
 
-    gCtx->VSSetShader(gVS, nullptr, 0);
-    gCtx->IASetInputLayout(gIL);
+    gCtx->VSSetShader(useDQ ? vsDQ : (quantized ? gVSQ : gVS), nullptr, 0);
+    gCtx->IASetInputLayout(quantized ? gILQ : gIL);
 
-    // world 乘以 NodeYawFix（不要写回 gWorld，避免累乘）
-    const float nodeFix = ModelSkinned_GetNodeYawFix();
-    const XMMATRIX W = XMMatrixRotationY(nodeFix) * gWorld;
-    //Shader3d_SetWorldMatrix(XMMatrixIdentity());
+    // world 乘以 NodeYawFix（不要写回 world，避免累乘）
+    const XMMATRIX W = XMMatrixRotationY(I.nodeYawFixRad) * I.world;
     Shader3d_SetWorldMatrix(W);
 
-    // VS b5（避免被 Shader3d_Begin 覆盖）
-    gCtx->VSSetConstantBuffers(5, 1, &gCBBones);
+    if (quantized) gCtx->VSSetConstantBuffers(6, 1, &I.model->cbDequant);
 
-    // 纹理/采样
-    if (gTexId >= 0) Texture_SetTexture(gTexId);
+    // 采样（贴图按材质在下面绑定）
     Sampler_SetFillterAnisotropic();
 
     // Draw
-    UINT stride = 56, offset = 0;
-    gCtx->IASetVertexBuffers(0, 1, &gVB, &stride, &offset);
-    gCtx->IASetIndexBuffer(gIB, gIndexFormat, 0);
+    UINT stride = I.model->vertexStride, offset = 0;
+    gCtx->IASetVertexBuffers(0, 1, &I.model->vb, &stride, &offset);
+    gCtx->IASetIndexBuffer(I.model->ib, I.model->indexFormat, 0);
     gCtx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    gCtx->DrawIndexed(gIndexCount, 0, 0);
+
+    // 网格 LOD：每个子网格按自己的包围盒在屏幕上的大小选档
+    const SkinnedModelRes& M = *I.model;
+    const XMFLOAT3& eye = Camera_GetPosition();
+    const float fov = Camera_GetFov();
+
+    // 每个子网格：绑定它那段调色板所在的 b5（版本变了才上传，只有这一步必须在渲染线程），再画
+    // 未拆分的网格（多个子网格 = LOD 按子网格画）共用 boneCB[0]
+    // draws 已按材质排序：贴图只在和上一次不同时绑定
+    const uint16_t* remap = M.paletteBones.data();
+    bool allUploaded = true;
+    bool wholeUploaded = false;
+    int boundTex = -1;
+    ID3D11Buffer* boundCB = nullptr;
+    for (size_t d = 0; d < M.draws.size(); ++d) {
+        const SkinnedDrawRange& r = M.draws[d];
+        const int tex = (r.material < M.matTex.size()) ? M.matTex[r.material] : M.texId;
+        if (tex >= 0 && tex != boundTex) {
+            Texture_SetTexture(tex);
+            boundTex = tex;
+        }
+
+        UINT indexOffset = r.indexOffset, indexCount = r.indexCount;
+        if (M.lodCount > 1) {
+            const int lod = I.meshLodOverride >= 0
+                ? std::min(I.meshLodOverride, int(M.lodCount) - 1)
+                : MeshLod_Select(MeshLod_ScreenSize(r.bounds, W, eye, fov),
+                    g_meshLodThresholds.data(), (int)g_meshLodThresholds.size(), (int)M.lodCount);
+            const MeshLodRange& lr = M.lodRanges[r.lodFirst + lod];
+            indexOffset = lr.indexOffset;
+            indexCount = lr.indexCount;
+        }
+        // 未拆分的 draw 共用 [0]：本次 Draw 里只在第一次遇到时上传
+        const size_t slot = (r.boneCount == 0) ? 0 : 1 + d;
+        ID3D11Buffer*& cb = I.boneCB[slot];
+        bool fresh = false;
+        if (!cb) {
+            cb = CreateBoneCB();
+            fresh = true;
+            if (!cb) { allUploaded = false; continue; }
+        }
+        if (cb != boundCB) {
+            // VS b5（避免被 Shader3d_Begin 覆盖）
+            gCtx->VSSetConstantBuffers(5, 1, &cb);
+            boundCB = cb;
+        }
+        if (!(upload || fresh) || (slot == 0 && wholeUploaded)) {
+            gCtx->DrawIndexed(indexCount, indexOffset, 0);
+            continue;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mp{};
+        if (FAILED(gCtx->Map(cb, 0, D3D11_MAP_WRITE_DISCARD, 0, &mp))) { allUploaded = false; continue; }
+        if (r.boneCount == 0) {
+            wholeUploaded = true;
+            // 未拆分：全局下标，前 MAX_BONES 个
+            size_t copyJ = std::min(J, size_t(MAX_BONES));
+            if (useDQ) std::memcpy(mp.pData, I.dqPalette.data(), copyJ * 2 * sizeof(XMFLOAT4));
+            else       std::memcpy(mp.pData, I.palette.data(), copyJ * sizeof(XMFLOAT4X4));
+        }
+        else if (useDQ) {
+            XMFLOAT4* dst = (XMFLOAT4*)mp.pData;
+            for (UINT k = 0; k < r.boneCount; ++k) {
+                const size_t b = remap[r.boneOffset + k];
+                dst[2 * k + 0] = I.dqPalette[2 * b + 0];
+                dst[2 * k + 1] = I.dqPalette[2 * b + 1];
+            }
+        }
+        else {
+            XMFLOAT4X4* dst = (XMFLOAT4X4*)mp.pData;
+            for (UINT k = 0; k < r.boneCount; ++k) dst[k] = I.palette[remap[r.boneOffset + k]];
+        }
+        gCtx->Unmap(cb, 0);
+        gCtx->DrawIndexed(indexCount, indexOffset, 0);
+    }
+    if (allUploaded) {
+        I.gpuVersion = I.poseVersion;
+        I.gpuDQ = useDQ;
+    }
 }
 
 // ---------------------------------------------------------
-// DEBUG & Meta
+// 实例 API
 // ---------------------------------------------------------
-static int MS_FindTrueRootIndex() {
-    for (size_t i = 0; i < gJoints.size(); ++i)
-        if (gJoints[i].parent == -1) return (int)i;
-    return gJoints.empty() ? -1 : 0;
+int ModelSkinned_CreateInstance(int model) {
+    if (!GetModelRes(model)) return -1;
+    const int h = AllocInstance();
+    BindModel(gInstances[h], model);
+    return h;
 }
-static float MS_YawFromLocalQuat(float qx, float qy, float qz, float qw) {
-    XMVECTOR q = XMQuaternionNormalize(XMVectorSet(qx, qy, qz, qw));
-    XMVECTOR f = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), q);
-    f = XMVector3Normalize(f);
-    XMFLOAT3 fv; XMStoreFloat3(&fv, f);
-    return std::atan2f(fv.x, fv.z);
+
+void ModelSkinned_DestroyInstance(int inst) {
+    SkinnedInstance* I = GetInstance(inst);
+    if (!I) return;
+    ReleaseBoneCB(*I);
+    *I = SkinnedInstance{};   // used=false，释放调色板
+    if (inst == gDefaultInstance) gDefaultInstance = -1;
+}
+
+int ModelSkinned_GetDefaultInstance() {
+    Def();
+    return gDefaultInstance;
+}
+
+bool ModelSkinned_BindModel(int inst, int model) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? BindModel(*I, model) : false;
+}
+
+bool ModelSkinned_BindClip(int inst, int clip) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? BindClip(*I, clip) : false;
+}
+
+void ModelSkinned_Update(int inst, double dtSec) {
+    if (SkinnedInstance* I = GetInstance(inst)) UpdateInstance(*I, dtSec);
+}
+
+uint32_t ModelSkinned_QueryEvents(int inst, float t0, float t1, AnimEventHit* out, uint32_t maxOut) {
+    const SkinnedInstance* I = GetInstance(inst);
+    if (!I || !HasClip(*I)) return 0;
+    return CollectEvents(I->clip, t0, t1, I->loop, out, maxOut);
+}
+
+uint32_t ModelSkinned_GetUpdateEvents(int inst, AnimEventHit* out, uint32_t maxOut) {
+    const SkinnedInstance* I = GetInstance(inst);
+    if (!I) return 0;
+    return CollectEvents(I->evClip, I->evT0, I->evT1, I->evLoop, out, maxOut);
+}
+
+void ModelSkinned_SetWorldMatrix(int inst, const XMMATRIX& world) {
+    if (SkinnedInstance* I = GetInstance(inst)) I->world = world;
+}
+
+void ModelSkinned_SetLoop(int inst, bool loop) {
+    if (SkinnedInstance* I = GetInstance(inst)) I->loop = loop;
+}
+
+void ModelSkinned_SetPlaybackRate(int inst, float rate) {
+    if (SkinnedInstance* I = GetInstance(inst)) I->playback = rate;
+}
+
+void ModelSkinned_Seek(int inst, float timeSec) {
+    if (SkinnedInstance* I = GetInstance(inst)) { I->time = timeSec; I->poseDirty = true; }
+}
+
+float ModelSkinned_GetTime(int inst) {
+    const SkinnedInstance* I = GetInstance(inst);
+    return I ? I->time : 0.0f;
+}
+
+void ModelSkinned_SetNodeYawFix(int inst, float rad) {
+    if (SkinnedInstance* I = GetInstance(inst)) { I->nodeYawFixRad = rad; I->poseDirty = true; }
+}
+
+void ModelSkinned_SetZeroRootTranslationXZ(int inst, bool enable) {
+    if (SkinnedInstance* I = GetInstance(inst)) { I->zeroRootTransXZ = enable; I->poseDirty = true; }
+}
+
+bool ModelSkinned_SetMotionRootByName(int inst, const char* utf8Name) {
+    SkinnedInstance* I = GetInstance(inst);
+    if (!I || !utf8Name) return false;
+    I->motionRootNameUTF8 = utf8Name;
+    if (HasSkeleton(*I)) ResolveMotionRoot(*I);
+    return true;
+}
+
+void ModelSkinned_Draw(int inst) {
+    if (SkinnedInstance* I = GetInstance(inst)) DrawInstance(*I);
+}
+
+bool ModelSkinned_AreModelsInterchangeable(int modelA, int modelB) {
+    return ModelsInterchangeable(GetModelRes(modelA), GetModelRes(modelB));
+}
+
+bool ModelSkinned_SwapModel(int inst, int model) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? SwapModel(*I, model) : false;
+}
+
+bool ModelSkinned_CrossFade(int inst, int clip, float blendSec, AnimBlendCurve curve) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? CrossFade(*I, clip, blendSec, curve) : false;
+}
+
+bool ModelSkinned_SetBlendClips(int inst, const int* clips, const float* weights, const float* rates, int count) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? SetBlendClips(*I, clips, weights, rates, count) : false;
+}
+
+void ModelSkinned_SetLodLevels(const ModelSkinnedLodLevel* levels, int count) {
+    g_lodLevels.assign(levels, levels + std::max(0, count));
+    for (auto& I : gInstances) { I.lodKeyValid = false; I.poseDirty = true; }
+}
+
+bool ModelSkinned_SetLodJointPatterns(int model, const char* const* patterns, int count) {
+    SkinnedModelRes* m = GetModelRes(model);
+    if (!m) return false;
+    AnimPose_BuildLodJointMask(m->skel, m->jointNames, patterns, (uint32_t)std::max(0, count), m->lodJointKeep);
+    for (auto& I : gInstances) if (I.model == m) { I.lodKeyValid = false; I.poseDirty = true; }
+    return true;
+}
+
+void ModelSkinned_SetLodOverride(int inst, int lod) {
+    if (SkinnedInstance* I = GetInstance(inst)) { I->lodOverride = lod; I->poseDirty = true; }
+}
+
+void ModelSkinned_SetMeshLodThresholds(const float* thresholds, int count) {
+    g_meshLodThresholds.assign(thresholds, thresholds + std::max(0, count));
+}
+
+void ModelSkinned_SetMeshLodOverride(int inst, int lod) {
+    if (SkinnedInstance* I = GetInstance(inst)) I->meshLodOverride = lod;
+}
+
+int ModelSkinned_GetLod(int inst) {
+    const SkinnedInstance* I = GetInstance(inst);
+    return I ? I->lod : -1;
+}
+
+uint32_t ModelSkinned_SkinOnCPU(int inst, XMFLOAT3* outPos, XMFLOAT3* outNrm, uint32_t capacity) {
+    SkinnedInstance* I = GetInstance(inst);
+    if (!I || !I->model || I->model->skel.jointCount == 0) return 0;
+    const SkinnedModelRes& M = *I->model;
+    const uint32_t n = M.cpuVertCount;
+    if (n == 0 || !outPos || capacity < n) return n;
+
+    if (I->poseDirty) EvaluatePalette(*I, g_scratch[0]);
+    const uint32_t J = I->model->skel.jointCount;
+    const bool dq = I->skinning == SkinningMode::DualQuat && I->dqPalette.size() >= 2 * size_t(J);
+
+    // 与 Draw 相同：每个子网格用自己的那段调色板（未拆分 = 整个调色板，前 MAX_BONES 个）
+    static std::vector<XMFLOAT4X4> s_subPalette;
+    static std::vector<XMFLOAT4>   s_subDQ;
+    static std::vector<SkinnedVertexV1> s_decoded;   // v2 网格：当前子网格解出的 v1 顶点
+    const uint16_t* remap = I->model->paletteBones.data();
+    bool wholeDone = false;   // 未拆分：各子网格共用整个 VB，只蒙皮一次
+    for (const SkinnedDrawRange& r : I->model->draws) {
+        if (r.boneCount == 0) {
+            if (wholeDone) continue;
+            wholeDone = true;
+        }
+        const SkinnedVertexV1* v;
+        if (M.cpuVertsV2) {
+            s_decoded.resize(r.vertexCount);
+            MeshQuant_DecodeSkinned((const SkinnedVertexV2*)M.cpuVerts + r.vertexOffset, r.vertexCount, M.bounds, s_decoded.data());
+            v = s_decoded.data();
+        } else {
+            v = (const SkinnedVertexV1*)M.cpuVerts + r.vertexOffset;
+        }
+        XMFLOAT3* pos = outPos + r.vertexOffset;
+        XMFLOAT3* nrm = outNrm ? outNrm + r.vertexOffset : nullptr;
+        const XMFLOAT4X4* pal = I->palette.data();
+        const XMFLOAT4* dqPal = I->dqPalette.data();
+        uint32_t bones = std::min<uint32_t>(J, MAX_BONES);
+        if (r.boneCount > 0) {
+            bones = r.boneCount;
+            s_subPalette.resize(bones);
+            s_subDQ.resize(size_t(bones) * 2);
+            for (uint32_t k = 0; k < bones; ++k) {
+                const size_t b = remap[r.boneOffset + k];
+                s_subPalette[k] = I->palette[b];
+                if (dq) { s_subDQ[2 * k] = I->dqPalette[2 * b]; s_subDQ[2 * k + 1] = I->dqPalette[2 * b + 1]; }
+            }
+            pal = s_subPalette.data();
+            dqPal = s_subDQ.data();
+        }
+        if (dq) AnimSkin_RunDualQuat(v, r.vertexCount, dqPal, bones, pos, nrm);
+        else    AnimSkin_Run(AnimSkin_BestPath(), v, r.vertexCount, pal, bones, pos, nrm);
+    }
+    return n;
+}
+
+void ModelSkinned_SetSkinningMode(int inst, SkinningMode mode) {
+    SkinnedInstance* I = GetInstance(inst);
+    if (!I || I->skinning == mode) return;
+    I->skinning = mode;
+    if (mode == SkinningMode::Linear) I->dqPalette.clear();
+    I->lodKeyValid = false;   // 冻结/降频档也要按新模式重建一次
+    I->poseDirty = true;
+}
+
+SkinningMode ModelSkinned_GetSkinningMode(int inst) {
+    const SkinnedInstance* I = GetInstance(inst);
+    return I ? I->skinning : SkinningMode::Linear;
+}
+
+bool ModelSkinned_ComputeSkinnedBounds(int inst, XMFLOAT3* outMin, XMFLOAT3* outMax) {
+    if (!outMin || !outMax) return false;
+    static std::vector<XMFLOAT3> s_pos;
+    const uint32_t n = ModelSkinned_SkinOnCPU(inst, nullptr, nullptr, 0);
+    if (n == 0) return false;
+    s_pos.resize(n);
+    ModelSkinned_SkinOnCPU(inst, s_pos.data(), nullptr, n);
+
+    XMVECTOR mn = XMLoadFloat3(&s_pos[0]), mx = mn;
+    for (uint32_t i = 1; i < n; ++i) {
+        const XMVECTOR p = XMLoadFloat3(&s_pos[i]);
+        mn = XMVectorMin(mn, p);
+        mx = XMVectorMax(mx, p);
+    }
+    XMStoreFloat3(outMin, mn);
+    XMStoreFloat3(outMax, mx);
+    return true;
+}
+
+uint32_t ModelSkinned_GetPoseVersion(int inst) {
+    const SkinnedInstance* I = GetInstance(inst);
+    return I ? I->poseVersion : 0;
+}
+
+bool ModelSkinned_IsCrossFading(int inst) {
+    const SkinnedInstance* I = GetInstance(inst);
+    return I && I->fadeClip != nullptr;
+}
+
+bool ModelSkinned_SetLayerMask(int inst, int layer, AnimLayerBlend mode, const char* const* roots,
+    const float* rootWeights, int count) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? SetLayerMask(*I, layer, mode, roots, rootWeights, count) : false;
+}
+
+bool ModelSkinned_PlayLayer(int inst, int layer, int clip, float weight, float fadeSec, bool loop, float rate) {
+    SkinnedInstance* I = GetInstance(inst);
+    return I ? PlayLayer(*I, layer, clip, weight, fadeSec, loop, rate) : false;
+}
+
+void ModelSkinned_StopLayer(int inst, int layer, float fadeSec) {
+    if (SkinnedInstance* I = GetInstance(inst)) StopLayer(*I, layer, fadeSec);
+}
+
+bool ModelSkinned_IsLayerActive(int inst, int layer) {
+    SkinnedInstance* I = GetInstance(inst);
+    const SkinnedLayer* L = I ? GetLayer(*I, layer) : nullptr;
+    return L && L->clip != nullptr;
+}
+
+bool ModelSkinned_GetLayerTime(int inst, int layer, float* outTime, float* outDuration) {
+    SkinnedInstance* I = GetInstance(inst);
+    const SkinnedLayer* L = I ? GetLayer(*I, layer) : nullptr;
+    if (!L || !L->clip) return false;
+    if (outTime) *outTime = L->time;
+    if (outDuration) *outDuration = L->clip->durationSec;
+    return true;
+}
+
+uint32_t ModelSkinned_GetLayerUpdateEvents(int inst, int layer, AnimEventHit* out, uint32_t maxOut) {
+    SkinnedInstance* I = GetInstance(inst);
+    const SkinnedLayer* L = I ? GetLayer(*I, layer) : nullptr;
+    if (!L) return 0;
+    return CollectEvents(L->evClip, L->evT0, L->evT1, L->evLoop, out, maxOut);
+}
+
+void ModelSkinned_EvaluatePoses() {
+    const XMFLOAT3& cam = Camera_GetPosition();
+    const XMVECTOR camPos = XMLoadFloat3(&cam);
+
+    g_evalList.clear();
+    for (int i = 0; i < (int)gInstances.size(); ++i) {
+        SkinnedInstance& I = gInstances[i];
+        if (!I.used || !I.model || I.model->skel.jointCount == 0) continue;
+        const int lod = SelectLod(I, camPos);
+        if (!I.poseDirty && (lod != I.lod || I.poseLagging)) {
+            // 时间没走，但换了档（省略的末端骨骼不同）或停在降频插值的中途 → 按当前时间精确求值一次
+            I.lodKeyValid = false;
+            I.poseDirty = true;
+        }
+        if (!I.poseDirty) continue;
+        I.lod = lod;
+        g_evalList.push_back(i);
+    }
+    if (g_evalList.empty()) return;
+
+    if (g_scratch.size() < JobPool_GetThreadCount()) g_scratch.resize(JobPool_GetThreadCount());
+
+    // 每个实例只写自己的 palette，临时区按 slot 分开 → 无需加锁
+    JobPool_ParallelFor((uint32_t)g_evalList.size(), 8, [](uint32_t begin, uint32_t end, uint32_t slot) {
+        for (uint32_t k = begin; k < end; ++k)
+            EvaluateWithLod(gInstances[g_evalList[k]], g_scratch[slot], (uint32_t)g_evalList[k]);
+        });
+}
+
+// ---------------------------------------------------------
+// 旧接口（默认实例）
+// ---------------------------------------------------------
+bool ModelSkinned_BindModel(int model) { return BindModel(Def(), model); }
+bool ModelSkinned_BindClip(int clip) { return BindClip(Def(), clip); }
+bool ModelSkinned_CrossFade(int clip, float blendSec, AnimBlendCurve curve) { return CrossFade(Def(), clip, blendSec, curve); }
+bool ModelSkinned_SetBlendClips(const int* clips, const float* weights, const float* rates, int count) {
+    return SetBlendClips(Def(), clips, weights, rates, count);
+}
+
+bool ModelSkinned_Load(const ModelSkinnedDesc& d) {
+    // 旧接口：自己持有一份资源，再次 Load 时替换
+    ModelSkinned_ReleaseClip(gLegacyClip);   gLegacyClip = -1;
+    ModelSkinned_ReleaseModel(gLegacyModel); gLegacyModel = -1;
+
+    gLegacyModel = ModelSkinned_CreateModel(d);
+    if (gLegacyModel < 0) return false;
+    if (!d.animPath.empty()) {
+        gLegacyClip = ModelSkinned_CreateClip(d.animPath);
+        if (gLegacyClip < 0) return false;
+    }
+
+    SkinnedInstance& I = Def();
+    if (!BindModel(I, gLegacyModel)) return false;
+    if (!BindClip(I, gLegacyClip)) return false;
+
+    I.world = XMMatrixIdentity();
+    I.time = 0.0f;
+    I.poseDirty = true;
+    return true;
+}
+
+void ModelSkinned_Finalize() {
+    SAFE_RELEASE(gCBDirectional);
+    SAFE_RELEASE(gCBAmbient);
+    for (auto& I : gInstances) ReleaseBoneCB(I);
+    SAFE_RELEASE(gVS);
+    SAFE_RELEASE(gVSDQ);
+    SAFE_RELEASE(gIL);
+    SAFE_RELEASE(gVSQ);
+    SAFE_RELEASE(gVSDQQ);
+    SAFE_RELEASE(gILQ);
+
+    for (int i = 0; i < (int)gModels.size(); ++i) ModelSkinned_ReleaseModel(i);
+    for (int i = 0; i < (int)gClips.size(); ++i) ModelSkinned_ReleaseClip(i);
+    gModels.clear();
+    gClips.clear();
+    gModelLoad.clear();
+    gClipLoad.clear();
+    gInstances.clear();
+    gDefaultInstance = -1;
+    gLegacyModel = gLegacyClip = -1;
+
+    g_temp_globals.clear();
+    g_decode_pose.clear();
+    gRetargets.clear();
+    g_scratch.assign(1, PoseScratch{});
+    g_evalList.clear();
+}
+
+void ModelSkinned_Update(double dtSec) { UpdateInstance(Def(), dtSec); }
+uint32_t ModelSkinned_GetUpdateEvents(AnimEventHit* out, uint32_t maxOut) { return ModelSkinned_GetUpdateEvents(gDefaultInstance, out, maxOut); }
+uint32_t ModelSkinned_QueryEvents(float t0, float t1, AnimEventHit* out, uint32_t maxOut) { return ModelSkinned_QueryEvents(gDefaultInstance, t0, t1, out, maxOut); }
+
+void ModelSkinned_SetWorldMatrix(const XMMATRIX& world) { Def().world = world; }
+void ModelSkinned_SetLoop(bool loop) { Def().loop = loop; }
+void ModelSkinned_SetPlaybackRate(float rate) { Def().playback = rate; }
+void ModelSkinned_Seek(float t) { ModelSkinned_Seek(ModelSkinned_GetDefaultInstance(), t); }
+
+bool ModelSkinned_LoadAnimOnly(const std::wstring& p) {
+    if (!Def().model) return false;
+    ModelSkinned_ReleaseClip(gLegacyClip);
+    gLegacyClip = ModelSkinned_CreateClip(p);
+    if (gLegacyClip < 0) return false;
+    return BindClip(Def(), gLegacyClip);
+}
+
+int ModelSkinned_GetRootJointIndex() { return FindTrueRootIndex(Def()); }
+
+bool ModelSkinned_SampleRootDelta_Local(float dt, XMFLOAT3* outDeltaT) { return SampleRootDelta_Local(Def(), dt, outDeltaT); }
+bool ModelSkinned_SampleRootYawDelta(float dt, float* outDeltaYaw) { return SampleRootYawDelta(Def(), dt, outDeltaYaw); }
+
+// —— 入场对齐 ——
+void ModelSkinned_SetRootYawAlignTarget(float yawTargetRad) {
+    SkinnedInstance& I = Def();
+    I.rootYawAlignTarget = yawTargetRad; I.rootYawAlignEnabled = true; I.poseDirty = true;
+}
+void ModelSkinned_ResetRootYawTrack(float yawStartRad) { Def().rootYawStart = yawStartRad; Def().poseDirty = true; }
+
+// —— Node 层修正 ——
+void  ModelSkinned_SetNodeYawFix(float r) { Def().nodeYawFixRad = r; Def().poseDirty = true; }
+float ModelSkinned_GetNodeYawFix() { return Def().nodeYawFixRad; }
+
+// ---------------------------------------------------------
+// Draw
+// ---------------------------------------------------------
+void ModelSkinned_Draw() { DrawInstance(Def()); }
+
+// ---------------------------------------------------------
+// DEBUG & Meta
+// ---------------------------------------------------------
+// 剪辑的 'META' 可用：同序骨架（不重定向）且 MotionRoot 与 cook 时相同
+static bool HasCookedF0(const SkinnedInstance& I, int root) {
+    return I.clip->metaJoint >= 0 && I.clip->metaJoint == root && !I.clipMap &&
+        I.clip->jointCount == I.model->skel.jointCount;
 }
 
 bool ModelSkinned_DebugGetRootYaw_F0(float* yaw0) {
     if (!yaw0) return false;
-    if (gFrameCount <= 0 || gJoints.empty() || gAnimFrames.empty()) return false;
+    SkinnedInstance& I = Def();
+    if (!HasClip(I)) return false;
 
-    int root = ModelSkinned_GetMotionRootIndex();
-    if (root < 0) root = MS_FindTrueRootIndex();
+    int root = MotionRootIndex(I);
+    if (root < 0) root = FindTrueRootIndex(I);
     if (root < 0) return false;
 
-    const AnimTRS& r0 = gAnimFrames[root]; // 第0帧
-    *yaw0 = MS_YawFromLocalQuat(r0.R[0], r0.R[1], r0.R[2], r0.R[3]);
+    if (HasCookedF0(I, root)) { *yaw0 = I.clip->rootYawLocalF0; return true; }
+    const AnimTRS r0 = JointAtFrame(I, root, 0); // 第0帧
+    *yaw0 = YawFromLocalQuat(r0.R[0], r0.R[1], r0.R[2], r0.R[3]);
     return true;
 }
 bool ModelSkinned_DebugGetRootYaw_Current(float* yawNow) {
     if (!yawNow) return false;
-    if (gFrameCount <= 0 || gJoints.empty() || gAnimFrames.empty()) return false;
+    SkinnedInstance& I = Def();
+    if (!HasClip(I)) return false;
 
-    int root = ModelSkinned_GetMotionRootIndex();
-    if (root < 0) root = MS_FindTrueRootIndex();
+    int root = MotionRootIndex(I);
+    if (root < 0) root = FindTrueRootIndex(I);
     if (root < 0) return false;
 
-    const size_t J = gJoints.size();
-    float frameF = gTime * gSampleRate;
+    float frameF = I.time * I.clip->sampleRate;
     uint32_t f0 = (uint32_t)floorf(frameF);
-    if (f0 >= (uint32_t)gFrameCount) f0 = (uint32_t)gFrameCount - 1;
+    if (f0 >= I.clip->frameCount) f0 = I.clip->frameCount - 1;
 
-    const AnimTRS& rc = gAnimFrames[size_t(f0) * J + root];
-    *yawNow = MS_YawFromLocalQuat(rc.R[0], rc.R[1], rc.R[2], rc.R[3]);
+    const AnimTRS rc = JointAtFrame(I, root, f0);
+    *yawNow = YawFromLocalQuat(rc.R[0], rc.R[1], rc.R[2], rc.R[3]);
     return true;
 }
 
-uint32_t ModelSkinned_GetFrameCount() { return gFrameCount; }
-float    ModelSkinned_GetSampleRate() { return gSampleRate; }
+uint32_t ModelSkinned_GetFrameCount() { return Def().clip ? Def().clip->frameCount : 0; }
+float    ModelSkinned_GetSampleRate() { return Def().clip ? Def().clip->sampleRate : 30.0f; }
 
 // 计算“第0帧 MotionRoot 的模型空间 yaw”
 bool ModelSkinned_ComputeRootYaw_ModelSpace_FirstFrame(float* outRad) {
     if (!outRad) return false;
-    const size_t J = gJoints.size();
-    if (J == 0 || gFrameCount == 0) return false;
+    SkinnedInstance& I = Def();
+    if (!HasClip(I)) return false;
+    const AnimSkeleton& sk = I.model->skel;
 
-    int root = ModelSkinned_GetMotionRootIndex();
-    if (root < 0) root = MS_FindTrueRootIndex();
+    int root = MotionRootIndex(I);
+    if (root < 0) root = FindTrueRootIndex(I);
     if (root < 0) root = 0;
 
-    const AnimTRS* pose0 = gAnimFrames.data(); // f0
-    for (size_t j = 0; j < J; ++j)
-        if (gJoints[j].parent == -1)
-            ComputeAnimationPoseRecursively(j, XMMatrixIdentity(), pose0);
+    // 'META'：cook 阶段算好的值，不用再求整帧姿态
+    if (HasCookedF0(I, root)) { *outRad = I.clip->rootYawModelF0; return true; }
+
+    g_temp_globals.resize(sk.jointCount);
+    g_decode_pose.resize(sk.jointCount);
+    const AnimTRS* pose0 = I.clipMap   // f0（重定向的剪辑按目标骨架聚集）
+        ? (AnimClip_SamplePose(*I.clip, 0.0f, g_decode_pose.data(), g_scratch[0].sample, nullptr, I.clipMap), g_decode_pose.data())
+        : AnimClip_GetFramePose(*I.clip, 0, g_decode_pose.data());
+    AnimPose_LocalToModel(sk, pose0, g_temp_globals.data());
 
     XMMATRIX M = g_temp_globals[root];
     XMVECTOR f = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(0, 0, 1, 0), M));
@@ -835,69 +2242,18 @@ bool ModelSkinned_ComputeRootYaw_ModelSpace_FirstFrame(float* outRad) {
 
 void ModelSkinned_SetZeroRootTranslationXZ(bool enable)
 {
-    gZeroRootTransXZ = enable;
+    ModelSkinned_SetZeroRootTranslationXZ(ModelSkinned_GetDefaultInstance(), enable);
 }
 
 // ---------------------------------------------------------
 // MotionRoot 选择/解析
 // ---------------------------------------------------------
 bool  ModelSkinned_SetMotionRootByName(const char* utf8Name) {
-    if (!utf8Name) return false;
-    gMotionRootNameUTF8 = utf8Name;
-    if (!gJoints.empty()) ModelSkinned_ResolveMotionRoot();
-    return true;
-}
-int   ModelSkinned_GetMotionRootIndex() {
-    if (gMotionRootIndex >= 0 && gMotionRootIndex < (int)gJoints.size())
-        return gMotionRootIndex;
-    ModelSkinned_ResolveMotionRoot();
-    return gMotionRootIndex;
+    return ModelSkinned_SetMotionRootByName(ModelSkinned_GetDefaultInstance(), utf8Name);
 }
+int   ModelSkinned_GetMotionRootIndex() { return MotionRootIndex(Def()); }
 const char* ModelSkinned_GetMotionRootName() {
-    return gMotionRootNameUTF8.c_str();
+    return Def().motionRootNameUTF8.c_str();
 }
 
-void  ModelSkinned_ResolveMotionRoot() {
-    gMotionRootIndex = -1;
-    if (gJoints.empty()) return;
-
-    // 1) 指定名优先
-    if (!gMotionRootNameUTF8.empty()) {
-        for (size_t i = 0; i < gJoints.size(); ++i) {
-            if (gJoints[i].name == gMotionRootNameUTF8) {
-                gMotionRootIndex = (int)i;
-                break;
-            }
-        }
-    }
-    // 2) 常见别名
-    if (gMotionRootIndex < 0) {
-        static const char* kCandidates[] = {
-            "mixamorig:Hips","Hips","Root","root","Armature","Motion","motion"
-        };
-        for (auto s : kCandidates) {
-            for (size_t i = 0; i < gJoints.size(); ++i) {
-                if (gJoints[i].name == s) { gMotionRootIndex = (int)i; break; }
-            }
-            if (gMotionRootIndex >= 0) break;
-        }
-    }
-    // 3) 退回真正根
-    if (gMotionRootIndex < 0) {
-        for (size_t i = 0; i < gJoints.size(); ++i) {
-            if (gJoints[i].parent == -1) { gMotionRootIndex = (int)i; break; }
-        }
-    }
-
-#if defined(DEBUG) || defined(_DEBUG)
-    if (gMotionRootIndex >= 0) {
-        char buf[256];
-        sprintf_s(buf, "[Skinned] MotionRoot = #%d (%s)\n",
-            gMotionRootIndex, gJoints[gMotionRootIndex].name.c_str());
-        OutputDebugStringA(buf);
-    }
-    else {
-        OutputDebugStringA("[Skinned] MotionRoot resolve FAILED\n");
-    }
-#endif
-}
+void  ModelSkinned_ResolveMotionRoot() { ResolveMotionRoot(Def()); }
@@ -4,13 +4,17 @@
 #include <DirectXMath.h>
 #include <d3d11.h>
 
+#include "anim_pose.h"   // AnimBlendCurve
+#include "anim_clip.h"   // AnimEventHit
+#include "asset_stream.h" // AssetStreamPriority / AssetStreamState
+
 // 运行时接口（简单版，内部保存全局状态；Draw() 无参数）
 struct ModelSkinnedDesc {
     std::wstring meshPath;                 // 必填：.mesh（v1，HAS_SKIN）
     std::wstring skelPath;                 // 必填：.skel
     std::wstring animPath;                 // 可选：.anim（没有也能用 bind pose）
-    std::wstring matPath;                  // 可选：.mat（如果不指定，默认 = mesh 同名 .mat）
-    std::wstring baseColorTexOverride;     // 可选：强制覆盖一张漫反射贴图
+    std::wstring matPath;                  // 可选：.mat（如果不指定，默认 = mesh 同名 .mat）；子网格按 materialIndex 取各自的贴图
+    std::wstring baseColorTexOverride;     // 可选：强制覆盖一张漫反射贴图（所有材质共用）
 };
 
 // 初始化：传入 D3D 设备与上下文（与 Shader3d 相同）
@@ -19,16 +23,145 @@ bool ModelSkinned_Initialize(ID3D11Device* dev, ID3D11DeviceContext* ctx);
 // 加载资源（mesh/skel/anim/mat/贴图；内部保存世界矩阵，默认单位阵）
 bool ModelSkinned_Load(const ModelSkinnedDesc& d);
 
-// 卸载 / 释放
+// —— 常驻资源（句柄）——
+// CreateModel：加载 mesh+skel（+mat/贴图），建 GPU 缓冲、做 bind-pose 修正；失败返回 -1
+// CreateClip ：加载并解码 .anim；失败返回 -1
+// Bind*      ：只切换“当前绑定”的指针，不做任何 IO（BindClip 把时间归零；clip<0 = bind pose）
+//              剪辑与骨架骨骼数 / 顺序不同时按骨骼名重定向（.anim 需带名字表：cook_tool.py anim-joints），
+//              映射表按（模型, 剪辑）建一次并缓存，剪辑不用再配一份自己的 mesh+skel；一根都对不上则失败
+int  ModelSkinned_CreateModel(const ModelSkinnedDesc& d);
+int  ModelSkinned_CreateClip(const std::wstring& animPath);
+bool ModelSkinned_BindModel(int model);
+bool ModelSkinned_BindClip(int clip);
+// 交叉淡入：旧剪辑继续播放，在 blendSec 秒内按曲线过渡到新剪辑（局部姿态混合，不做 IO）
+// blendSec <= 0 / 当前没有剪辑 / clip<0 时等同 BindClip
+bool ModelSkinned_CrossFade(int clip, float blendSec, AnimBlendCurve curve);
+// 混合空间：最多 3 个剪辑按权重混合，共用归一化相位（走/跑脚步同步）
+// rates[i]：剪辑 i 自身的播放速率（可为 nullptr = 全 1）；一个周期时长 = Σ w_i * duration_i / rate_i
+// 每帧可重复调用只改权重；BindClip / CrossFade 会退出混合
+bool ModelSkinned_SetBlendClips(const int* clips, const float* weights, const float* rates, int count);
+// 异步版（asset_stream）：立即返回句柄，IO / 解码在后台线程，GPU 缓冲和贴图在 AssetStream_Update 里创建
+// 加载完成前句柄按“空资源”处理（Bind 失败、Draw 跳过）；用 Get*State 轮询
+// Release* 对加载中的句柄 = 取消
+int  ModelSkinned_CreateModelAsync(const ModelSkinnedDesc& d, AssetStreamPriority priority);
+int  ModelSkinned_CreateClipAsync(const std::wstring& animPath, AssetStreamPriority priority);
+AssetStreamState ModelSkinned_GetModelState(int model);   // 已释放 / 无效句柄 = None
+AssetStreamState ModelSkinned_GetClipState(int clip);
+void ModelSkinned_SetModelLoadPriority(int model, AssetStreamPriority priority);
+void ModelSkinned_SetClipLoadPriority(int clip, AssetStreamPriority priority);
+void ModelSkinned_ReleaseModel(int model);
+void ModelSkinned_ReleaseClip(int clip);
+// 两个模型是否可以互换（骨骼数、父子关系、骨骼名、invBind 都一致，.mesh 内容和贴图也相同；
+// 不同路径下内容相同的 mesh+skel 时成立）：剪辑在两边画出来完全一样
+bool ModelSkinned_AreModelsInterchangeable(int modelA, int modelB);
+
+// —— 多实例 ——
+// 实例只持有轻量状态（时间/速率/循环/world/MotionRoot/调色板），mesh/skel/clip 由所有实例共享
+// 下面带 inst 参数的函数与无参数版本含义相同；无参数版本操作“默认实例”
+int  ModelSkinned_CreateInstance(int model);           // 失败返回 -1
+void ModelSkinned_DestroyInstance(int inst);
+int  ModelSkinned_GetDefaultInstance();
+bool ModelSkinned_BindModel(int inst, int model);
+bool ModelSkinned_BindClip(int inst, int clip);
+bool ModelSkinned_CrossFade(int inst, int clip, float blendSec, AnimBlendCurve curve);
+bool ModelSkinned_SetBlendClips(int inst, const int* clips, const float* weights, const float* rates, int count);
+bool ModelSkinned_IsCrossFading(int inst);
+// 换到与当前模型可互换（AreModelsInterchangeable）的模型：剪辑 / 时间 / 淡入淡出 / 层都保留
+// 不可互换或模型未就绪时返回 false，实例不变
+bool ModelSkinned_SwapModel(int inst, int model);
+// —— 动画层 ——
+// 基础姿态（Bind / CrossFade / 混合空间）之上最多 MODEL_SKINNED_MAX_LAYERS 层，按层号从小到大依次合成
+//  每层 = 剪辑 × 层权重 × 逐骨骼遮罩；只采样遮罩内的骨骼，局部→模型的层级合成仍然只做一次
+//  Override：局部姿态按权重插值到层姿态；Additive：层剪辑相对自身第 0 帧的差值按权重叠加
+// 遮罩：roots 里每个骨骼名连同全部子孙（如 "mixamorig:Spine" = 上半身）；count = 0 = 全身
+//  rootWeights 可为 nullptr（全 1），子孙继承最近的根；按骨骼名解析，换模型时自动重建
+static const int MODEL_SKINNED_MAX_LAYERS = 4;
+bool ModelSkinned_SetLayerMask(int inst, int layer, AnimLayerBlend mode, const char* const* roots,
+    const float* rootWeights, int count);
+// 层剪辑从 0 开始播放，层权重在 fadeSec 秒内从当前值移到 weight（不做 IO；剪辑按骨骼名重定向）
+bool ModelSkinned_PlayLayer(int inst, int layer, int clip, float weight, float fadeSec, bool loop, float rate);
+// 层权重在 fadeSec 秒内降到 0，之后层空闲（非循环剪辑播完停在最后一帧，直到 Stop）
+void ModelSkinned_StopLayer(int inst, int layer, float fadeSec);
+bool ModelSkinned_IsLayerActive(int inst, int layer);
+// 层剪辑的当前时间 / 时长（秒，未乘速率）；层空闲返回 false
+bool ModelSkinned_GetLayerTime(int inst, int layer, float* outTime, float* outDuration);
+// 上一次 Update 中该层剪辑越过的事件
+uint32_t ModelSkinned_GetLayerUpdateEvents(int inst, int layer, AnimEventHit* out, uint32_t maxOut);
+// CPU 蒙皮（与 GPU 同一算法，AVX2 + 线程池）：输出模型空间位置 / 单位法线（outNrm 可为 nullptr）
+// 返回顶点数；outPos 为 nullptr 或 capacity 不够时只返回顶点数
+uint32_t ModelSkinned_SkinOnCPU(int inst, DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm, uint32_t capacity);
+// 蒙皮方式：Linear = 矩阵线性混合（LBS）；DualQuat = 双四元数混合（DLB，关节处不塌陷）
+//  DualQuat 每骨骼上传 8 个 float（矩阵版 16 个），只支持刚体骨骼变换（缩放会被丢掉）
+//  找不到 shader_vertex_skinned_dq_3d.cso 时 Draw 退回 Linear；SkinOnCPU 按实例的模式计算
+enum class SkinningMode : uint8_t { Linear = 0, DualQuat };
+void ModelSkinned_SetSkinningMode(int inst, SkinningMode mode);
+SkinningMode ModelSkinned_GetSkinningMode(int inst);
+// 当前姿态下的模型空间包围盒（CPU 蒙皮后统计）
+bool ModelSkinned_ComputeSkinnedBounds(int inst, DirectX::XMFLOAT3* outMin, DirectX::XMFLOAT3* outMax);
+void ModelSkinned_Update(int inst, double dtSec);
+// 动画事件（.anim 事件轨道）：当前剪辑在 [t0, t1)（剪辑时间，秒）越过的事件，按发生顺序，返回个数
+//  循环播放时 t1 可以越过终点（回绕）；二分查找，O(log n + k)
+uint32_t ModelSkinned_QueryEvents(int inst, float t0, float t1, AnimEventHit* out, uint32_t maxOut);
+// 上一次 Update 推进的那段时间（已乘播放速率；混合空间按主剪辑）越过的事件
+uint32_t ModelSkinned_GetUpdateEvents(int inst, AnimEventHit* out, uint32_t maxOut);
+void ModelSkinned_SetWorldMatrix(int inst, const DirectX::XMMATRIX& world);
+void ModelSkinned_SetLoop(int inst, bool loop);
+void ModelSkinned_SetPlaybackRate(int inst, float rate);
+void ModelSkinned_Seek(int inst, float timeSec);
+float ModelSkinned_GetTime(int inst);
+void ModelSkinned_SetNodeYawFix(int inst, float rad);
+void ModelSkinned_SetZeroRootTranslationXZ(int inst, bool enable);
+bool ModelSkinned_SetMotionRootByName(int inst, const char* utf8Name);
+void ModelSkinned_Draw(int inst);
+// 调色板版本：每次重算（完整求值 / LOD 插值）+1；时间 / 相位 / 淡入淡出 / 层权重 / 剪辑 / 根设置都没变时不变
+// （dt 或播放速度为 0、非循环剪辑停在终点、单次层停在目标权重的帧不重算也不上传）
+// 可用来缓存由调色板派生的数据（CPU 蒙皮包围盒等）
+uint32_t ModelSkinned_GetPoseVersion(int inst);
+
+// 并行姿态阶段：所有需要重算的实例（时间/剪辑变过）在线程池上采样 + 层级合成 + 建调色板
+// 每帧在全部 Update 之后、Draw 之前调用一次；Draw 不再求值，只在调色板版本变了时上传常量缓冲
+// （b5 由实例自己持有：同一帧画多次——阴影 / 反射等 pass——或静止 / 冻结的实例都不重复上传）
+// 不调用也能用：Draw 时会在渲染线程上补算（不走 LOD，完整求值）
+// 动画 LOD 在这里按实例到相机（Camera_GetPosition）的距离选档
+void ModelSkinned_EvaluatePoses();
+
+// —— 动画 LOD ——
+struct ModelSkinnedLodLevel {
+    float    maxDistance;     // 距离 < maxDistance 用本档（按升序排列；最后一档接住所有更远的）
+    uint32_t updateInterval;  // 每 N 帧完整求值一次（1 = 每帧），中间帧对前后两次的调色板插值
+    bool     reduceJoints;    // 省略末端骨骼（手指/眼睛/头发等，保持 bind pose）
+    bool     frozen;          // 冻结：只在第一次 / 换剪辑时求值
+};
+// 替换档位表（count = 0 关闭 LOD）；默认 15m / 30m / 60m / 冻结
+void ModelSkinned_SetLodLevels(const ModelSkinnedLodLevel* levels, int count);
+// 重新指定“可省略骨骼”的名字子串（patterns=nullptr 恢复内置表：Thumb/Index/Middle/Ring/Pinky/Eye/Hair/_End）
+bool ModelSkinned_SetLodJointPatterns(int model, const char* const* patterns, int count);
+void ModelSkinned_SetLodOverride(int inst, int lod);  // -1 = 按距离
+int  ModelSkinned_GetLod(int inst);                   // 上一次 EvaluatePoses 选的档（-1 = 未启用）
+
+// —— 网格 LOD（.mesh 带 LOD 表时；cook_tool.py mesh-lod）——
+// Draw 时每个子网格按 AABB 外接球在屏幕上的大小（直径 / 屏幕高度，Camera_GetFov）选档
+// thresholds 降序：大小 < thresholds[i] 时至少用 LOD i+1；默认 0.5 / 0.25 / 0.1，count = 0 总是 LOD0
+void ModelSkinned_SetMeshLodThresholds(const float* thresholds, int count);
+void ModelSkinned_SetMeshLodOverride(int inst, int lod);  // -1 = 按屏幕大小
+
+// 卸载 / 释放（含所有常驻资源与实例）
 void ModelSkinned_Finalize();
 
 // 每帧推进动画时间（秒）；没有 .anim 则忽略
 void ModelSkinned_Update(double dtSec);
+uint32_t ModelSkinned_GetUpdateEvents(AnimEventHit* out, uint32_t maxOut);
+uint32_t ModelSkinned_QueryEvents(float t0, float t1, AnimEventHit* out, uint32_t maxOut);
 
 // 设世界矩阵（如不调用，默认 I）
 void ModelSkinned_SetWorldMatrix(const DirectX::XMMATRIX& world);
 
-// 渲染（内部会：Shader3d_Begin(); 绑定蒙皮 VS；设置 VB/IB/布局；上传骨矩阵；绑定贴图；DrawIndexed）
+// 渲染（内部会：Shader3d_Begin(); 绑定蒙皮 VS；设置 VB/IB/布局；绑定骨矩阵（版本变了才上传）；
+//       按材质分组逐子网格 DrawIndexed，贴图只在材质变化时重新绑定）
+// 按骨骼拆分过的 .mesh（cook_tool.py mesh-split）每个子网格画一次，只上传该子网格用到的骨骼；
+// 未拆分的网格骨骼数超过 128 时只能上传前 128 个（加载时会输出警告）
+// .mesh v2（cook_tool.py mesh-quantize，28 字节顶点）用 shader_vertex_skinned_q_3d 在 VS 里解压；
+// 找不到该 .cso 时加载时解成 v1 上传
 void ModelSkinned_Draw();
 
 // （可选）切换是否循环播放
@@ -47,6 +180,7 @@ int  ModelSkinned_GetRootJointIndex();
 
 // 以“当前时间 t”为起点，采样区间 [t, t+dt] 的“MotionRoot 局部位移 ΔT（单位：模型局部空间，米）”
 // 成功返回 true；若没有动画/根不存在返回 false
+// 剪辑带根运动曲线（cook_tool.py root-motion）时直接查表；循环播放跨过终点时按整圈增量累加
 bool ModelSkinned_SampleRootDelta_Local(float dt, DirectX::XMFLOAT3* outDeltaT);
 
 // VelocityDriven 时把 MotionRoot 局部平移的 XZ 清零（保留 Y），启/停
@@ -1,6 +1,7 @@
 ﻿//#define NOMINMAX
 #include "ModelStatic.h"
 
+#include <algorithm>
 #include <vector>
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -14,6 +15,10 @@ namespace fs = std::experimental::filesystem;
 #include <cstdio>
 #include <cstring>
 
+#include "asset_view.h"  // .mesh 只读映射
+#include "mesh_quant.h"  // .mesh v2 压缩顶点解码
+#include "mesh_lod.h"    // 网格 LOD 表 / 按屏幕大小选档
+#include "camera.h"      // Camera_GetPosition / Camera_GetFov
 #include "shader3d.h"  // Shader3d_Begin/SetWorldMatrix
 #include "texture.h"   // Texture_Load(const wchar_t*), Texture_SetTexture(int)
 #include "sampler.h"
@@ -28,12 +33,22 @@ struct VertexForYourShader {
     float u, v;                  // TEXCOORD0
 };
 
+// 一次 DrawIndexed：一个子网格（或首尾相接的同材质子网格）
+struct StaticDraw {
+    UINT indexOffset = 0, indexCount = 0;
+    UINT material = 0;           // Submesh::materialIndex（draws 按它排序）
+    UINT submesh = 0;            // LOD 表的下标
+};
+
 struct ModelStatic {
     ID3D11Buffer* vb = nullptr;
     ID3D11Buffer* ib = nullptr;
     DXGI_FORMAT   idxFmt = DXGI_FORMAT_R16_UINT;
     UINT          indexCount = 0;
-    int           texId = -1;    // PS t0
+    int           texId = -1;    // PS t0：默认贴图（覆盖贴图 / 第一张有贴图的材质 / 白图）
+    std::vector<int>        matTex;  // [materialIndex] → 贴图（没有贴图的材质 = texId）
+    std::vector<StaticDraw> draws;   // 按材质排序
+    MeshLodInfo   lod;           // lodCount > 1：按子网格选档画
 };
 
 // --------- 全局静态 ----------
@@ -50,8 +65,6 @@ static int                  s_defHandle = -1;
 static XMMATRIX             s_defWorld = XMMatrixIdentity();
 
 // --------- 小工具 ----------
-static bool ReadAll(FILE* f, void* p, size_t n) { return std::fread(p, 1, n, f) == n; }
-
 static void EnsureWhiteTexture() {
     if (s_whiteTexId >= 0) return;
     s_whiteTexId = Texture_Load(L"resources/white.png"); // 放一张 1x1 白图
@@ -76,69 +89,121 @@ static int TryLoadTextureNearMat(const std::wstring& matPathW, const char* fileN
     return -1;
 }
 
-static int LoadBaseColorFromMat(const std::wstring& matPathW)
+// 每条材质的 baseColorTex（下标 = materialIndex；没有 / 找不到贴图的为 -1）
+// 同名贴图只查找一次
+static std::vector<int> LoadBaseColorsFromMat(const std::wstring& matPathW)
 {
-    if (matPathW.empty()) return -1;
+    std::vector<int> out;
+    if (matPathW.empty()) return out;
 
-    FILE* f = nullptr;
-    if (_wfopen_s(&f, matPathW.c_str(), L"rb") != 0 || !f) return -1;
+    AssetViewRef file = AssetView_Open(matPathW);
+    if (!file || file->size < sizeof(FileHeader) + sizeof(MaterialHeader)) return out;
+    const uint8_t* p = file->data;
 
     FileHeader fh{};
-    if (!ReadAll(f, &fh, sizeof(fh))) { std::fclose(f); return -1; }
-    if (std::string(fh.magic, fh.magic + 4) != "MATL") { std::fclose(f); return -1; }
+    std::memcpy(&fh, p, sizeof(fh)); p += sizeof(fh);
+    if (std::string(fh.magic, fh.magic + 4) != "MATL") return out;
 
     MaterialHeader mh{};
-    if (!ReadAll(f, &mh, sizeof(mh))) { std::fclose(f); return -1; }
-    if (mh.materialCount == 0) { std::fclose(f); return -1; }
-
-    MaterialRec rec{};
-    if (!ReadAll(f, &rec, sizeof(rec))) { std::fclose(f); return -1; }
-    std::fclose(f);
+    std::memcpy(&mh, p, sizeof(mh)); p += sizeof(mh);
+    const size_t count = std::min<size_t>(mh.materialCount, (file->size - (p - file->data)) / sizeof(MaterialRec));
+
+    std::vector<std::string> names(count);
+    out.assign(count, -1);
+    for (size_t i = 0; i < count; ++i) {
+        MaterialRec rec{};
+        std::memcpy(&rec, p + i * sizeof(MaterialRec), sizeof(rec));
+        if (rec.baseColorTex[0] == '\0') continue;
+        names[i].assign(rec.baseColorTex, strnlen(rec.baseColorTex, sizeof(rec.baseColorTex)));
+        const size_t first = size_t(std::find(names.begin(), names.end(), names[i]) - names.begin());
+        out[i] = (first < i) ? out[first] : TryLoadTextureNearMat(matPathW, names[i].c_str());
+    }
+    return out;
+}
 
-    if (rec.baseColorTex[0] != '\0') {
-        int id = TryLoadTextureNearMat(matPathW, rec.baseColorTex);
-        if (id >= 0) return id;
+// Submesh 表 → 每个子网格一次绘制；没有表的旧文件整体画一次
+static bool ReadSubmeshDraws(const uint8_t* p, const uint8_t* e, const MeshHeader& mh, std::vector<StaticDraw>& out)
+{
+    out.clear();
+    const size_t sbBytes = sizeof(Submesh) * mh.submeshCount;
+    if (mh.submeshCount == 0 || (size_t)(e - p) < sbBytes) {
+        out.push_back({ 0, mh.indexCount, 0, 0 });
+        return true;
     }
-    return -1;
+    for (uint32_t i = 0; i < mh.submeshCount; ++i) {
+        Submesh sm;
+        std::memcpy(&sm, p + i * sizeof(Submesh), sizeof(sm));
+        if (size_t(sm.indexOffset) + sm.indexCount > mh.indexCount) return false;
+        out.push_back({ sm.indexOffset, sm.indexCount, sm.materialIndex, i });
+    }
+    return true;
 }
 
+// .mesh 映射后原地解析：IB 直接从映射页上传，顶点从映射逐个转换成 VertexForYourShader
+// （输入布局不同，顶点这一份转换省不掉；省掉的是整文件读进堆的那次拷贝）
 static bool LoadMeshToVBIB(const std::wstring& meshPathW,
     std::vector<VertexForYourShader>& outVB,
-    std::vector<uint8_t>& outIB,
+    AssetViewRef& outFile,
+    const uint8_t*& outIB,
+    size_t& outIBBytes,
     DXGI_FORMAT& outFmt,
-    UINT& outIndexCount)
+    UINT& outIndexCount,
+    std::vector<StaticDraw>& outDraws)
 {
-    FILE* f = nullptr;
-    if (_wfopen_s(&f, meshPathW.c_str(), L"rb") != 0 || !f) return false;
+    AssetViewRef file = AssetView_Open(meshPathW);
+    if (!file) return false;
 
+    const uint8_t* p = file->data;
+    const uint8_t* e = file->data + file->size;
+    auto need = [&](size_t n) { return (size_t)(e - p) >= n; };
+
+    if (!need(sizeof(FileHeader) + sizeof(MeshHeader))) return false;
     FileHeader fh{};
-    if (!ReadAll(f, &fh, sizeof(fh))) { std::fclose(f); return false; }
-    if (std::string(fh.magic, fh.magic + 4) != "MESH") { std::fclose(f); return false; }
+    std::memcpy(&fh, p, sizeof(fh)); p += sizeof(fh);
+    if (std::string(fh.magic, fh.magic + 4) != "MESH") return false;
 
     MeshHeader mh{};
-    if (!ReadAll(f, &mh, sizeof(mh))) { std::fclose(f); return false; }
+    std::memcpy(&mh, p, sizeof(mh)); p += sizeof(mh);
 
     const size_t vbBytes = size_t(mh.vertexCount) * mh.vertexStride;
-    std::vector<uint8_t> vbRaw(vbBytes);
-    if (!ReadAll(f, vbRaw.data(), vbBytes)) { std::fclose(f); return false; }
+    if (!need(vbBytes)) return false;
+    const uint8_t* vbRaw = p; p += vbBytes;
 
     const bool use32 = (mh.vertexCount > 65535);
     const size_t ibBytes = size_t(mh.indexCount) * (use32 ? 4 : 2);
-    outIB.resize(ibBytes);
-    if (!ReadAll(f, outIB.data(), ibBytes)) { std::fclose(f); return false; }
-
-    if (mh.submeshCount) {
-        std::vector<Submesh> tmp(mh.submeshCount);
-        ReadAll(f, tmp.data(), sizeof(Submesh) * mh.submeshCount);
+    if (!need(ibBytes)) return false;
+    outIB = p;
+    outIBBytes = ibBytes;
+    if (!ReadSubmeshDraws(p + ibBytes, e, mh, outDraws)) return false;
+
+    // v2：压缩顶点（20 / 28 字节），逐顶点解码
+    if (fh.version == MESH_VERSION_V2) {
+        if (mh.vertexStride < sizeof(MeshVertexV2)) return false;
+        outVB.resize(mh.vertexCount);
+        for (uint32_t i = 0; i < mh.vertexCount; ++i) {
+            MeshVertexV2 q;
+            std::memcpy(&q, vbRaw + size_t(i) * mh.vertexStride, sizeof(q));   // 蒙皮顶点的前 20 字节布局相同
+            float pos[3], nrm[3], tan[4], uv[2];
+            MeshQuant_DecodeStatic(q, mh.bounds, pos, nrm, tan, uv);
+
+            outVB[i].px = pos[0]; outVB[i].py = pos[1]; outVB[i].pz = pos[2];
+            outVB[i].nx = nrm[0]; outVB[i].ny = nrm[1]; outVB[i].nz = nrm[2];
+            outVB[i].cr = 1.0f; outVB[i].cg = 1.0f; outVB[i].cb = 1.0f; outVB[i].ca = 1.0f;
+            outVB[i].u = uv[0];
+            outVB[i].v = uv[1];
+        }
+        outFmt = use32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+        outIndexCount = mh.indexCount;
+        outFile = std::move(file);
+        return true;
     }
-    std::fclose(f);
 
     if (mh.vertexStride < 48) return false;
 
     outVB.resize(mh.vertexCount);
     for (uint32_t i = 0; i < mh.vertexCount; ++i) {
         const float* src = reinterpret_cast<const float*>(
-            vbRaw.data() + size_t(i) * mh.vertexStride);
+            vbRaw + size_t(i) * mh.vertexStride);
 
         outVB[i].px = src[0];
         outVB[i].py = src[1];
@@ -156,6 +221,7 @@ static bool LoadMeshToVBIB(const std::wstring& meshPathW,
 
     outFmt = use32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
     outIndexCount = mh.indexCount;
+    outFile = std::move(file);
     return true;
 }
 
@@ -188,10 +254,13 @@ bool ModelStatic_Load(const ModelStaticDesc& desc, int* outHandle)
     if (h < 0) return false;
 
     std::vector<VertexForYourShader> verts;
-    std::vector<uint8_t> ib;
+    AssetViewRef file;                  // IB 上传完就释放映射
+    const uint8_t* ib = nullptr;
+    size_t ibBytes = 0;
     DXGI_FORMAT fmt = DXGI_FORMAT_R16_UINT;
     UINT icount = 0;
-    if (!LoadMeshToVBIB(desc.meshPath, verts, ib, fmt, icount)) return false;
+    std::vector<StaticDraw> draws;
+    if (!LoadMeshToVBIB(desc.meshPath, verts, file, ib, ibBytes, fmt, icount, draws)) return false;
 
     D3D11_BUFFER_DESC vbd{}; vbd.Usage = D3D11_USAGE_DEFAULT; vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vbd.ByteWidth = UINT(verts.size() * sizeof(VertexForYourShader));
@@ -199,19 +268,38 @@ bool ModelStatic_Load(const ModelStaticDesc& desc, int* outHandle)
     if (FAILED(s_dev->CreateBuffer(&vbd, &vinit, &s_models[h].vb))) return false;
 
     D3D11_BUFFER_DESC ibd{}; ibd.Usage = D3D11_USAGE_DEFAULT; ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    ibd.ByteWidth = UINT(ib.size());
-    D3D11_SUBRESOURCE_DATA iinit{ ib.data(),0,0 };
+    ibd.ByteWidth = UINT(ibBytes);
+    D3D11_SUBRESOURCE_DATA iinit{ ib,0,0 };
     if (FAILED(s_dev->CreateBuffer(&ibd, &iinit, &s_models[h].ib))) {
         s_models[h].vb->Release(); s_models[h].vb = nullptr; return false;
     }
 
     s_models[h].idxFmt = fmt;
     s_models[h].indexCount = icount;
+    if (!MeshLod_Parse(file->data, file->size, s_models[h].lod) ||
+        s_models[h].lod.submeshBounds.size() != draws.size()) s_models[h].lod = MeshLodInfo{};
+
+    // 按材质排序；没有 LOD 时首尾相接的同材质子网格合并成一次 DrawIndexed
+    std::stable_sort(draws.begin(), draws.end(),
+        [](const StaticDraw& a, const StaticDraw& b) { return a.material < b.material; });
+    auto& out = s_models[h].draws;
+    out.clear();
+    for (const StaticDraw& d : draws) {
+        if (s_models[h].lod.lodCount == 1 && !out.empty() && out.back().material == d.material &&
+            out.back().indexOffset + out.back().indexCount == d.indexOffset) {
+            out.back().indexCount += d.indexCount;
+            continue;
+        }
+        out.push_back(d);
+    }
 
+    // 贴图：每条材质各自的；没有贴图的材质用第一张有贴图的材质，再没有就白图
+    s_models[h].matTex = LoadBaseColorsFromMat(desc.matPath);
     int tex = -1;
-    if (!desc.matPath.empty()) tex = LoadBaseColorFromMat(desc.matPath);
+    for (int t : s_models[h].matTex) if (t >= 0) { tex = t; break; }
     if (tex < 0) { EnsureWhiteTexture(); tex = s_whiteTexId; }
     s_models[h].texId = tex;
+    for (int& t : s_models[h].matTex) if (t < 0) t = tex;
 
     *outHandle = h;
     return true;
@@ -233,7 +321,6 @@ void ModelStatic_Draw(int handle, const XMMATRIX& world)
     if (!m.vb || !m.ib) return;
 
     Shader3d_Begin();
-    if (m.texId >= 0) Texture_SetTexture(m.texId);
 
     UINT stride = sizeof(VertexForYourShader), offset = 0;
     s_ctx->IASetVertexBuffers(0, 1, &m.vb, &stride, &offset);
@@ -241,7 +328,27 @@ void ModelStatic_Draw(int handle, const XMMATRIX& world)
     s_ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
     Shader3d_SetWorldMatrix(world);
-    s_ctx->DrawIndexed(m.indexCount, 0, 0);
+
+    // draws 已按材质排序：贴图只在和上一次不同时绑定
+    // 网格 LOD：每个子网格按包围盒在屏幕上的大小选档
+    const XMFLOAT3& eye = Camera_GetPosition();
+    const float fov = Camera_GetFov();
+    int boundTex = -1;
+    for (const StaticDraw& d : m.draws) {
+        const int tex = (d.material < m.matTex.size()) ? m.matTex[d.material] : m.texId;
+        if (tex >= 0 && tex != boundTex) {
+            Texture_SetTexture(tex);
+            boundTex = tex;
+        }
+        if (m.lod.lodCount <= 1) {
+            s_ctx->DrawIndexed(d.indexCount, d.indexOffset, 0);
+            continue;
+        }
+        const int lod = MeshLod_Select(MeshLod_ScreenSize(m.lod.submeshBounds[d.submesh], world, eye, fov),
+            MESH_LOD_DEFAULT_THRESHOLDS, (int)std::size(MESH_LOD_DEFAULT_THRESHOLDS), (int)m.lod.lodCount);
+        const MeshLodRange& r = m.lod.ranges[d.submesh * m.lod.lodCount + lod];
+        s_ctx->DrawIndexed(r.indexCount, r.indexOffset, 0);
+    }
 }
 
 bool ModelStatic_OverrideBaseColorTex(int handle, const wchar_t* texturePath)
@@ -250,6 +357,7 @@ bool ModelStatic_OverrideBaseColorTex(int handle, const wchar_t* texturePath)
     int id = Texture_Load(texturePath);
     if (id < 0) return false;
     s_models[handle].texId = id;
+    s_models[handle].matTex.assign(s_models[handle].matTex.size(), id);   // 覆盖所有材质
     return true;
 }
 
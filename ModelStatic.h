@@ -11,7 +11,7 @@ void ModelStatic_Finalize();
 // ------------ 多模型（可选：保留原能力） ------------
 struct ModelStaticDesc {
     std::wstring meshPath;       // L".../xxx.mesh"
-    std::wstring matPath;        // 可空：L".../xxx.mat"
+    std::wstring matPath;        // 可空：L".../xxx.mat"（子网格按 materialIndex 取各自的贴图）
 };
 bool ModelStatic_Load(const ModelStaticDesc& desc, int* outHandle);
 void ModelStatic_Unload(int handle);
@@ -0,0 +1,1066 @@
+﻿#include "anim_benchmark.h"
+#include "anim_pose.h"
+#include "anim_clip.h"
+#include "anim_skinning.h"
+#include "anim_blend_space.h"
+#include "job_pool.h"
+#include "mesh_quant.h"
+#include "mesh_lod.h"
+#include "asset_view.h"
+
+#include <DirectXMath.h>
+#include <Windows.h>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+using namespace DirectX;
+
+// ---------------------------------------------------------
+// 计时
+// ---------------------------------------------------------
+static double NowSec()
+{
+    static LARGE_INTEGER freq{};
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER t; QueryPerformanceCounter(&t);
+    return double(t.QuadPart) / double(freq.QuadPart);
+}
+
+static void Log(const char* s)
+{
+    OutputDebugStringA(s);
+}
+
+// 防止优化器把结果整个删掉
+static volatile float gSink = 0.0f;
+
+// ---------------------------------------------------------
+// 参考实现：改动前 ModelSkinned 的写法（AoS + 名字在热结构里 + 每节点全表扫描找子节点）
+// ---------------------------------------------------------
+namespace ref {
+
+struct Joint {
+    int        parent = -1;
+    XMFLOAT4X4 invBind;
+    XMFLOAT3   bindT{ 0,0,0 };
+    XMFLOAT4   bindR{ 0,0,0,1 };
+    XMFLOAT3   bindS{ 1,1,1 };
+    std::string name;
+};
+
+static void ComputeAnimationPoseRecursively(const std::vector<Joint>& joints, std::vector<XMMATRIX>& globals,
+    size_t boneIndex, const XMMATRIX& parentGlobalTransform, const AnimTRS* currentFramePose)
+{
+    XMMATRIX localTransform = AnimPose_MakeLocalMatrix(currentFramePose[boneIndex]);
+    XMMATRIX globalTransform = localTransform * parentGlobalTransform;
+    globals[boneIndex] = globalTransform;
+
+    for (size_t i = 0; i < joints.size(); ++i) {
+        if (joints[i].parent == (int)boneIndex) {
+            ComputeAnimationPoseRecursively(joints, globals, i, globalTransform, currentFramePose);
+        }
+    }
+}
+
+static void EvalPalette(const std::vector<Joint>& joints, std::vector<XMMATRIX>& globals,
+    const AnimTRS* pose, XMFLOAT4X4* palette)
+{
+    const size_t J = joints.size();
+    for (size_t j = 0; j < J; ++j)
+        if (joints[j].parent == -1)
+            ComputeAnimationPoseRecursively(joints, globals, j, XMMatrixIdentity(), pose);
+
+    for (size_t j = 0; j < J; ++j) {
+        XMMATRIX invB = XMLoadFloat4x4(&joints[j].invBind);
+        XMStoreFloat4x4(&palette[j], XMMatrixTranspose(invB * globals[j]));
+    }
+}
+
+} // namespace ref
+
+// ---------------------------------------------------------
+// 测试数据
+// ---------------------------------------------------------
+
+// 由 parent 数组合成一副骨架（bind：沿 +Y 的小偏移；invBind = bind 模型矩阵的逆）
+static bool MakeSyntheticSkeleton(const std::vector<int>& parent, AnimSkeleton& sk, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+    sk.jointCount = (uint32_t)parent.size();
+    sk.parent = parent;
+    sk.bindLocal.resize(parent.size());
+    for (auto& b : sk.bindLocal) {
+        b = AnimTRS{};
+        b.T[0] = 0.02f * u(rng); b.T[1] = 0.1f; b.T[2] = 0.02f * u(rng);
+        b.R[3] = 1.0f;
+        b.S[0] = b.S[1] = b.S[2] = 1.0f;
+    }
+    if (!AnimPose_BuildEvalOrder(sk)) return false;
+
+    std::vector<XMMATRIX> model(sk.jointCount);
+    AnimPose_LocalToModel(sk, sk.bindLocal.data(), model.data());
+    sk.invBind.resize(sk.jointCount);
+    for (uint32_t j = 0; j < sk.jointCount; ++j)
+        XMStoreFloat4x4(&sk.invBind[j], XMMatrixInverse(nullptr, model[j]));
+    return true;
+}
+
+// 在 bind pose 上加随机旋转，做出 frames 帧姿态
+static void MakePoses(const AnimSkeleton& sk, int frames, std::vector<AnimTRS>& out, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-0.5f, 0.5f);
+    const size_t J = sk.jointCount;
+    out.resize(J * size_t(frames));
+    for (int f = 0; f < frames; ++f) {
+        for (size_t j = 0; j < J; ++j) {
+            AnimTRS t = sk.bindLocal[j];
+            XMVECTOR q = XMQuaternionMultiply(
+                XMVectorSet(t.R[0], t.R[1], t.R[2], t.R[3]),
+                XMQuaternionRotationRollPitchYaw(u(rng), u(rng), u(rng)));
+            XMFLOAT4 qf; XMStoreFloat4(&qf, XMQuaternionNormalize(q));
+            t.R[0] = qf.x; t.R[1] = qf.y; t.R[2] = qf.z; t.R[3] = qf.w;
+            out[size_t(f) * J + j] = t;
+        }
+    }
+}
+
+static void ToRefJoints(const AnimSkeleton& sk, const std::vector<std::string>& names, std::vector<ref::Joint>& out)
+{
+    out.resize(sk.jointCount);
+    for (uint32_t j = 0; j < sk.jointCount; ++j) {
+        ref::Joint& r = out[j];
+        r.parent = sk.parent[j];
+        r.invBind = sk.invBind[j];
+        const AnimTRS& b = sk.bindLocal[j];
+        r.bindT = XMFLOAT3(b.T[0], b.T[1], b.T[2]);
+        r.bindR = XMFLOAT4(b.R[0], b.R[1], b.R[2], b.R[3]);
+        r.bindS = XMFLOAT3(b.S[0], b.S[1], b.S[2]);
+        r.name = (j < names.size()) ? names[j] : ("joint_" + std::to_string(j));
+    }
+}
+
+// ---------------------------------------------------------
+// 一组对比
+// ---------------------------------------------------------
+static void RunPoseCase(const char* label, const AnimSkeleton& sk, const std::vector<std::string>& names, std::mt19937& rng)
+{
+    const size_t J = sk.jointCount;
+    if (J == 0) return;
+
+    const int kFrames = 16;
+    std::vector<AnimTRS> poses;
+    MakePoses(sk, kFrames, poses, rng);
+
+    std::vector<ref::Joint> refJoints;
+    ToRefJoints(sk, names, refJoints);
+
+    std::vector<XMMATRIX>   globals(J);
+    std::vector<XMFLOAT4X4> palOld(J), palNew(J);
+
+    // 结果一致性（所有帧取最大误差）
+    float maxErr = 0.0f;
+    for (int f = 0; f < kFrames; ++f) {
+        const AnimTRS* pose = poses.data() + size_t(f) * J;
+        ref::EvalPalette(refJoints, globals, pose, palOld.data());
+        AnimPose_LocalToModel(sk, pose, globals.data());
+        AnimPose_BuildPalette(sk, globals.data(), palNew.data(), (uint32_t)J);
+        for (size_t j = 0; j < J; ++j) {
+            const float* a = &palOld[j]._11;
+            const float* b = &palNew[j]._11;
+            for (int k = 0; k < 16; ++k) maxErr = std::max(maxErr, std::fabs(a[k] - b[k]));
+        }
+    }
+
+    const int iters = std::max(200, int(200000 / J));
+
+    double t0 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        ref::EvalPalette(refJoints, globals, poses.data() + size_t(i % kFrames) * J, palOld.data());
+        gSink += palOld[J - 1]._41;
+    }
+    double t1 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        AnimPose_LocalToModel(sk, poses.data() + size_t(i % kFrames) * J, globals.data());
+        AnimPose_BuildPalette(sk, globals.data(), palNew.data(), (uint32_t)J);
+        gSink += palNew[J - 1]._41;
+    }
+    double t2 = NowSec();
+
+    const double usOld = (t1 - t0) * 1e6 / iters;
+    const double usNew = (t2 - t1) * 1e6 / iters;
+
+    char buf[256];
+    sprintf_s(buf, "[AnimBench] pose %-20s J=%3u  old %8.2f us  new %7.2f us  x%5.1f  maxErr %.2e\n",
+        label, (unsigned)J, usOld, usNew, (usNew > 0.0) ? usOld / usNew : 0.0, maxErr);
+    Log(buf);
+}
+
+// ---------------------------------------------------------
+// 整姿态采样：逐骨骼 SampleJoint（slerp）vs SamplePose（SoA + SSE）
+// ---------------------------------------------------------
+static void RunSampleCase(const char* label, const AnimClip& clip, std::mt19937& rng)
+{
+    const uint32_t J = clip.jointCount;
+    if (J == 0 || clip.frameCount < 2) return;
+
+    const float last = float(clip.frameCount - 1) / clip.sampleRate;
+    std::uniform_real_distribution<float> u(0.0f, last);
+    const int kTimes = 64;
+    std::vector<float> times(kTimes);
+    for (float& t : times) t = u(rng);
+
+    std::vector<AnimTRS> poseOld(J), poseNew(J);
+    std::vector<float> scratch;
+
+    // 结果一致性：旋转用夹角（弧度），平移/缩放用绝对差
+    float maxErrR = 0.0f, maxErrTS = 0.0f;
+    for (float t : times) {
+        for (uint32_t j = 0; j < J; ++j) poseOld[j] = AnimClip_SampleJoint(clip, j, t);
+        AnimClip_SamplePose(clip, t, poseNew.data(), scratch);
+        for (uint32_t j = 0; j < J; ++j) {
+            const AnimTRS& a = poseOld[j];
+            const AnimTRS& b = poseNew[j];
+            for (int k = 0; k < 3; ++k) {
+                maxErrTS = std::max(maxErrTS, std::fabs(a.T[k] - b.T[k]));
+                maxErrTS = std::max(maxErrTS, std::fabs(a.S[k] - b.S[k]));
+            }
+            const float la = std::sqrt(a.R[0] * a.R[0] + a.R[1] * a.R[1] + a.R[2] * a.R[2] + a.R[3] * a.R[3]);
+            const float d = std::fabs(a.R[0] * b.R[0] + a.R[1] * b.R[1] + a.R[2] * b.R[2] + a.R[3] * b.R[3]);
+            if (la > 0.0f) maxErrR = std::max(maxErrR, 2.0f * std::acos(std::min(1.0f, d / la)));
+        }
+    }
+
+    const int iters = std::max(200, int(400000 / J));
+
+    double t0 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        const float t = times[i % kTimes];
+        for (uint32_t j = 0; j < J; ++j) poseOld[j] = AnimClip_SampleJoint(clip, j, t);
+        gSink += poseOld[J - 1].T[1];
+    }
+    double t1 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        AnimClip_SamplePose(clip, times[i % kTimes], poseNew.data(), scratch);
+        gSink += poseNew[J - 1].T[1];
+    }
+    double t2 = NowSec();
+
+    const double usOld = (t1 - t0) * 1e6 / iters;
+    const double usNew = (t2 - t1) * 1e6 / iters;
+
+    char buf[256];
+    sprintf_s(buf, "[AnimBench] sample %-18s J=%3u  per-joint %7.2f us (%6.1f j/us)  batch %6.2f us (%6.1f j/us)  x%5.1f  maxErr R %.1e rad TS %.1e\n",
+        label, (unsigned)J, usOld, (usOld > 0.0) ? J / usOld : 0.0, usNew, (usNew > 0.0) ? J / usNew : 0.0,
+        (usNew > 0.0) ? usOld / usNew : 0.0, maxErrR, maxErrTS);
+    Log(buf);
+}
+
+// ---------------------------------------------------------
+// 多实例并行：采样 + 层级合成 + 调色板（与 ModelSkinned_EvaluatePoses 相同的三步，无 D3D）
+// ---------------------------------------------------------
+struct BenchInstance {
+    float                   time = 0.0f;
+    std::vector<XMFLOAT4X4> palette;
+};
+
+struct BenchScratch {
+    std::vector<AnimTRS>  pose;
+    std::vector<float>    sample;
+    std::vector<XMMATRIX> globals;
+};
+
+static void RunParallelCase(const AnimSkeleton& sk, const AnimClip& clip, uint32_t instanceCount, std::mt19937& rng)
+{
+    const uint32_t J = sk.jointCount;
+    std::uniform_real_distribution<float> u(0.0f, clip.durationSec);
+
+    std::vector<BenchInstance> inst(instanceCount);
+    for (auto& I : inst) {
+        I.time = u(rng);
+        I.palette.resize(J);
+    }
+
+    const uint32_t maxThreads = JobPool_GetThreadCount();
+    std::vector<BenchScratch> scratch(maxThreads);
+    for (auto& S : scratch) {
+        S.pose.resize(J);
+        S.globals.resize(J);
+    }
+
+    auto evalAll = [&](uint32_t threads) {
+        for (auto& I : inst) {
+            I.time += 1.0f / 60.0f;
+            if (I.time >= clip.durationSec) I.time -= clip.durationSec;
+        }
+        JobPool_ParallelFor(instanceCount, 8, [&](uint32_t begin, uint32_t end, uint32_t slot) {
+            BenchScratch& S = scratch[slot];
+            for (uint32_t k = begin; k < end; ++k) {
+                BenchInstance& I = inst[k];
+                AnimClip_SamplePose(clip, I.time, S.pose.data(), S.sample);
+                AnimPose_LocalToModel(sk, S.pose.data(), S.globals.data());
+                AnimPose_BuildPalette(sk, S.globals.data(), I.palette.data(), J);
+            }
+            }, threads);
+    };
+
+    // 线程数：1, 2, 4, ... , 最大
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    const int frames = std::max(20, int(20000 / instanceCount));
+    double usSingle = 0.0;
+    for (uint32_t threads : threadCounts) {
+        evalAll(threads);   // 预热
+        const double t0 = NowSec();
+        for (int f = 0; f < frames; ++f) {
+            evalAll(threads);
+            gSink += inst[instanceCount - 1].palette[J - 1]._41;
+        }
+        const double us = (NowSec() - t0) * 1e6 / frames;
+        if (threads == 1) usSingle = us;
+
+        char buf[256];
+        sprintf_s(buf, "[AnimBench] parallel N=%4u threads=%2u  %9.1f us/frame  %7.2f us/instance  x%4.1f\n",
+            instanceCount, threads, us, us / instanceCount, (us > 0.0) ? usSingle / us : 0.0);
+        Log(buf);
+    }
+}
+
+// ---------------------------------------------------------
+// 动画 LOD：降频 + 调色板插值 + 省略末端骨骼 + 冻结（单线程，看每实例成本）
+// ---------------------------------------------------------
+struct BenchLodInstance {
+    float                   time = 0.0f;
+    int                     lod = 0;
+    uint32_t                frame = 0;
+    std::vector<XMFLOAT4X4> palette, prev, next;
+};
+
+static void RunLodCase(const AnimSkeleton& sk, const std::vector<uint8_t>& keep, const AnimClip& clip,
+    uint32_t instanceCount, std::mt19937& rng)
+{
+    // 档位与 ModelSkinned 默认值一致：15m 每帧 / 30m 隔帧+省略 / 60m 每 4 帧+省略 / 更远冻结
+    const float    kMaxDist[] = { 15.0f, 30.0f, 60.0f };
+    const uint32_t kInterval[] = { 1, 2, 4, 0 };
+
+    const uint32_t J = sk.jointCount;
+    std::uniform_real_distribution<float> ut(0.0f, clip.durationSec);
+    std::uniform_real_distribution<float> ud(0.0f, 100.0f);
+
+    std::vector<BenchLodInstance> inst(instanceCount);
+    uint32_t perLod[4] = {};
+    for (uint32_t i = 0; i < instanceCount; ++i) {
+        BenchLodInstance& I = inst[i];
+        I.time = ut(rng);
+        const float d = ud(rng);
+        I.lod = 3;
+        for (int l = 0; l < 3; ++l) if (d < kMaxDist[l]) { I.lod = l; break; }
+        I.frame = i % std::max(1u, kInterval[I.lod]);
+        I.palette.resize(J); I.prev.resize(J); I.next.resize(J);
+        ++perLod[I.lod];
+    }
+
+    BenchScratch S;
+    S.pose.resize(J);
+    S.globals.resize(J);
+
+    auto evalFull = [&](BenchLodInstance& I, const uint8_t* mask) {
+        AnimClip_SamplePose(clip, I.time, S.pose.data(), S.sample, mask);
+        if (mask) AnimPose_ApplyBindToMasked(sk, mask, S.pose.data());
+        AnimPose_LocalToModel(sk, S.pose.data(), S.globals.data());
+        AnimPose_BuildPalette(sk, S.globals.data(), I.palette.data(), J);
+    };
+    auto advance = [&]() {
+        for (auto& I : inst) {
+            I.time += 1.0f / 60.0f;
+            if (I.time >= clip.durationSec) I.time -= clip.durationSec;
+        }
+    };
+    auto frameFull = [&]() {
+        advance();
+        for (auto& I : inst) evalFull(I, nullptr);
+    };
+    auto frameLod = [&]() {
+        advance();
+        for (auto& I : inst) {
+            const uint32_t N = kInterval[I.lod];
+            if (N == 0) continue;                        // 冻结
+            if (N == 1) { evalFull(I, nullptr); continue; }
+            if (++I.frame >= N) {
+                I.frame = 0;
+                evalFull(I, keep.data());
+                I.prev.swap(I.next);
+                I.next = I.palette;
+            }
+            AnimPose_LerpPalette(I.prev.data(), I.next.data(), float(I.frame + 1) / float(N), J, I.palette.data());
+        }
+    };
+
+    const int frames = std::max(20, int(20000 / instanceCount));
+    double us[2] = {};
+    int k = 0;
+    for (auto fn : { std::function<void()>(frameFull), std::function<void()>(frameLod) }) {
+        fn();   // 预热
+        const double t0 = NowSec();
+        for (int f = 0; f < frames; ++f) {
+            fn();
+            gSink += inst[instanceCount - 1].palette[J - 1]._41;
+        }
+        us[k++] = (NowSec() - t0) * 1e6 / frames;
+    }
+
+    char buf[256];
+    sprintf_s(buf, "[AnimBench] lod N=%4u (L0 %u / L1 %u / L2 %u / frozen %u)  full %9.1f us  lod %9.1f us  %6.2f -> %6.2f us/instance  x%4.1f\n",
+        instanceCount, perLod[0], perLod[1], perLod[2], perLod[3], us[0], us[1],
+        us[0] / instanceCount, us[1] / instanceCount, (us[1] > 0.0) ? us[0] / us[1] : 0.0);
+    Log(buf);
+}
+
+// ---------------------------------------------------------
+// CPU 蒙皮
+// ---------------------------------------------------------
+// 只读 .mesh v1 的顶点部分
+static bool LoadSkinnedVertices(const wchar_t* path, std::vector<SkinnedVertexV1>& out)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    FileHeader fh{};
+    MeshHeader mh{};
+    if (!f.read((char*)&fh, sizeof(fh)) || std::memcmp(fh.magic, "MESH", 4) != 0) return false;
+    if (!f.read((char*)&mh, sizeof(mh))) return false;
+    if ((mh.flags & HAS_SKIN) == 0) return false;
+    out.resize(mh.vertexCount);
+    if (fh.version == MESH_VERSION_V2 && mh.vertexStride == sizeof(SkinnedVertexV2)) {
+        std::vector<SkinnedVertexV2> q(mh.vertexCount);   // 压缩顶点：解成 v1 再测（蒙皮吞吐与格式无关）
+        if (!f.read((char*)q.data(), std::streamsize(q.size() * sizeof(SkinnedVertexV2)))) return false;
+        MeshQuant_DecodeSkinned(q.data(), mh.vertexCount, mh.bounds, out.data());
+        return true;
+    }
+    if (mh.vertexStride != sizeof(SkinnedVertexV1)) return false;
+    return (bool)f.read((char*)out.data(), std::streamsize(out.size() * sizeof(SkinnedVertexV1)));
+}
+
+static void RunSkinCase(const std::vector<SkinnedVertexV1>& verts, const std::vector<XMFLOAT4X4>& palette)
+{
+    const uint32_t N = (uint32_t)verts.size();
+    const uint32_t B = (uint32_t)palette.size();
+    std::vector<XMFLOAT3> refPos(N), refNrm(N), pos(N), nrm(N);
+
+    auto measure = [&](AnimSkinPath path, uint32_t threads) {
+        AnimSkin_Run(path, verts.data(), N, palette.data(), B, pos.data(), nrm.data(), threads); // 预热
+        const int reps = std::max(10, int(2000000 / std::max(1u, N)));
+        const double t0 = NowSec();
+        for (int r = 0; r < reps; ++r) {
+            AnimSkin_Run(path, verts.data(), N, palette.data(), B, pos.data(), nrm.data(), threads);
+            gSink += pos[N - 1].x;
+        }
+        return (NowSec() - t0) * 1e3 / reps;   // ms / 回
+    };
+
+    // 参考
+    AnimSkin_Scalar(verts.data(), N, palette.data(), B, refPos.data(), refNrm.data());
+
+    char buf[256];
+    const double msScalar = measure(AnimSkinPath::Scalar, 1);
+    sprintf_s(buf, "[AnimBench] skin %u verts  scalar   threads= 1  %8.3f ms  %9.0f verts/ms\n", N, msScalar, N / msScalar);
+    Log(buf);
+
+    if (!AnimSkin_HasAVX2()) {
+        Log("[AnimBench] skin: AVX2 not supported on this CPU, skipped\n");
+        return;
+    }
+
+    // AVX2 与参考的差
+    AnimSkin_AVX2(verts.data(), N, palette.data(), B, pos.data(), nrm.data());
+    float dPos = 0.0f, dNrm = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        dPos = std::max({ dPos, std::fabs(pos[i].x - refPos[i].x), std::fabs(pos[i].y - refPos[i].y), std::fabs(pos[i].z - refPos[i].z) });
+        dNrm = std::max({ dNrm, std::fabs(nrm[i].x - refNrm[i].x), std::fabs(nrm[i].y - refNrm[i].y), std::fabs(nrm[i].z - refNrm[i].z) });
+    }
+    sprintf_s(buf, "[AnimBench] skin AVX2 vs scalar: max |dPos| = %.2e  max |dNrm| = %.2e\n", dPos, dNrm);
+    Log(buf);
+
+    const uint32_t maxThreads = JobPool_GetThreadCount();
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+    for (uint32_t threads : threadCounts) {
+        const double ms = measure(AnimSkinPath::AVX2, threads);
+        sprintf_s(buf, "[AnimBench] skin %u verts  AVX2     threads=%2u  %8.3f ms  %9.0f verts/ms  x%4.1f\n",
+            N, threads, ms, N / ms, (ms > 0.0) ? msScalar / ms : 0.0);
+        Log(buf);
+    }
+}
+
+// ---------------------------------------------------------
+// Public
+// ---------------------------------------------------------
+void AnimBenchmark_PoseEval()
+{
+    std::mt19937 rng(1234);
+    Log("[AnimBench] ---- pose eval: recursive O(J^2) vs linear eval order ----\n");
+
+    // 1) 实际资源
+    {
+        AnimSkeleton sk;
+        std::vector<std::string> names;
+        if (AnimPose_LoadSkeleton(L"resources/player_anim/cooked/melee_idle.skel", sk, &names)) {
+            RunPoseCase("melee_idle.skel", sk, names, rng);
+        }
+        else {
+            Log("[AnimBench] melee_idle.skel not found, skipped\n");
+        }
+    }
+
+    // 2) 合成 256 骨骼
+    const int kJ = 256;
+    std::vector<std::string> noNames;
+    {
+        std::vector<int> parent(kJ);
+        for (int j = 0; j < kJ; ++j) parent[j] = j - 1;
+        AnimSkeleton sk;
+        if (MakeSyntheticSkeleton(parent, sk, rng)) RunPoseCase("synthetic chain", sk, noNames, rng);
+    }
+    {
+        std::vector<int> parent(kJ, 0);
+        parent[0] = -1;
+        AnimSkeleton sk;
+        if (MakeSyntheticSkeleton(parent, sk, rng)) RunPoseCase("synthetic fan", sk, noNames, rng);
+    }
+    {
+        // 随机树（父在前 8 个以内），再打乱下标：父下标不一定小于子
+        std::vector<int> parentOrdered(kJ);
+        parentOrdered[0] = -1;
+        for (int j = 1; j < kJ; ++j) {
+            std::uniform_int_distribution<int> d(std::max(0, j - 8), j - 1);
+            parentOrdered[j] = d(rng);
+        }
+        std::vector<int> perm(kJ);
+        for (int j = 0; j < kJ; ++j) perm[j] = j;
+        std::shuffle(perm.begin(), perm.end(), rng);
+
+        std::vector<int> parent(kJ);
+        for (int j = 0; j < kJ; ++j)
+            parent[perm[j]] = (parentOrdered[j] < 0) ? -1 : perm[parentOrdered[j]];
+
+        AnimSkeleton sk;
+        if (MakeSyntheticSkeleton(parent, sk, rng)) RunPoseCase("synthetic tree(shuf)", sk, noNames, rng);
+    }
+}
+
+void AnimBenchmark_PoseSample()
+{
+    std::mt19937 rng(5678);
+    Log("[AnimBench] ---- pose sample: per-joint slerp vs SoA batch nlerp ----\n");
+
+    // 1) 实际资源
+    const wchar_t* clips[] = {
+        L"resources/player_anim/cooked/melee_idle.anim",
+        L"resources/player_anim/cooked/player_move.anim",
+    };
+    for (const wchar_t* path : clips) {
+        AnimClip clip;
+        if (!AnimClip_Load(path, clip)) {
+            Log("[AnimBench] clip not found, skipped\n");
+            continue;
+        }
+        const std::wstring w(path);
+        const std::string name(w.begin() + w.find_last_of(L'/') + 1, w.end());
+        RunSampleCase(name.c_str(), clip, rng);
+    }
+
+    // 2) 合成 256 骨骼 × 64 帧
+    {
+        const int kJ = 256, kF = 64;
+        std::vector<int> parent(kJ);
+        for (int j = 0; j < kJ; ++j) parent[j] = j - 1;
+        AnimSkeleton sk;
+        if (MakeSyntheticSkeleton(parent, sk, rng)) {
+            std::vector<AnimTRS> poses;
+            MakePoses(sk, kF, poses, rng);
+            AnimClip clip;
+            AnimClip_InitFromPoses(clip, kJ, kF, 30.0f, poses.data());
+            RunSampleCase("synthetic 256", clip, rng);
+        }
+    }
+}
+
+void AnimBenchmark_ParallelPoses()
+{
+    std::mt19937 rng(9012);
+    char buf[128];
+    sprintf_s(buf, "[AnimBench] ---- parallel pose update: 1/100/1000 instances, up to %u threads ----\n", JobPool_GetThreadCount());
+    Log(buf);
+
+    AnimSkeleton sk;
+    AnimClip clip;
+    if (!AnimPose_LoadSkeleton(L"resources/player_anim/cooked/melee_idle.skel", sk, nullptr) ||
+        !AnimClip_Load(L"resources/player_anim/cooked/melee_idle.anim", clip) ||
+        clip.jointCount != sk.jointCount) {
+        Log("[AnimBench] melee_idle.skel/.anim not found, skipped\n");
+        return;
+    }
+
+    for (uint32_t n : { 1u, 100u, 1000u }) RunParallelCase(sk, clip, n, rng);
+}
+
+void AnimBenchmark_Lod()
+{
+    std::mt19937 rng(3456);
+    Log("[AnimBench] ---- animation LOD: full rate vs distance tiers ----\n");
+
+    AnimSkeleton sk;
+    AnimClip clip;
+    std::vector<std::string> names;
+    if (!AnimPose_LoadSkeleton(L"resources/player_anim/cooked/melee_idle.skel", sk, &names) ||
+        !AnimClip_Load(L"resources/player_anim/cooked/melee_idle.anim", clip) ||
+        clip.jointCount != sk.jointCount) {
+        Log("[AnimBench] melee_idle.skel/.anim not found, skipped\n");
+        return;
+    }
+
+    std::vector<uint8_t> keep;
+    const uint32_t kept = AnimPose_BuildLodJointMask(sk, names, nullptr, 0, keep);
+    char buf[128];
+    sprintf_s(buf, "[AnimBench] lod joint mask: %u / %u joints kept\n", kept, sk.jointCount);
+    Log(buf);
+
+    for (uint32_t n : { 100u, 1000u }) RunLodCase(sk, keep, clip, n, rng);
+}
+
+void AnimBenchmark_Skinning()
+{
+    Log("[AnimBench] ---- CPU skinning: scalar vs AVX2 ----\n");
+
+    std::vector<SkinnedVertexV1> verts;
+    AnimSkeleton sk;
+    AnimClip clip;
+    if (!LoadSkinnedVertices(L"resources/player_anim/cooked/player_move.mesh", verts) ||
+        !AnimPose_LoadSkeleton(L"resources/player_anim/cooked/player_move.skel", sk, nullptr) ||
+        !AnimClip_Load(L"resources/player_anim/cooked/player_move.anim", clip) ||
+        clip.jointCount != sk.jointCount || verts.empty()) {
+        Log("[AnimBench] player_move.mesh/.skel/.anim not found, skipped\n");
+        return;
+    }
+
+    // 剪辑中间时刻的调色板
+    std::vector<AnimTRS> pose(sk.jointCount);
+    std::vector<float> scratch;
+    std::vector<XMMATRIX> globals(sk.jointCount);
+    std::vector<XMFLOAT4X4> palette(sk.jointCount);
+    AnimClip_SamplePose(clip, clip.durationSec * 0.5f, pose.data(), scratch);
+    AnimPose_LocalToModel(sk, pose.data(), globals.data());
+    AnimPose_BuildPalette(sk, globals.data(), palette.data(), sk.jointCount);
+
+    RunSkinCase(verts, palette);
+
+    // 双四元数：与线性蒙皮的差（刚体骨骼 + 权重集中时应很小；差异集中在大角度的关节处）
+    {
+        const uint32_t N = (uint32_t)verts.size();
+        const uint32_t B = (uint32_t)palette.size();
+        std::vector<XMFLOAT4> dq(size_t(B) * 2);
+        std::vector<XMFLOAT3> lbsPos(N), dqPos(N), dqNrm(N);
+        AnimPose_PaletteToDualQuat(palette.data(), B, dq.data());
+        AnimSkin_Scalar(verts.data(), N, palette.data(), B, lbsPos.data(), nullptr);
+        AnimSkin_DualQuatScalar(verts.data(), N, dq.data(), B, dqPos.data(), dqNrm.data());
+
+        float dMax = 0.0f; double dSum = 0.0;
+        for (uint32_t i = 0; i < N; ++i) {
+            const float d = std::sqrt(
+                (dqPos[i].x - lbsPos[i].x) * (dqPos[i].x - lbsPos[i].x) +
+                (dqPos[i].y - lbsPos[i].y) * (dqPos[i].y - lbsPos[i].y) +
+                (dqPos[i].z - lbsPos[i].z) * (dqPos[i].z - lbsPos[i].z));
+            dMax = std::max(dMax, d); dSum += d;
+        }
+
+        const int reps = std::max(10, int(2000000 / std::max(1u, N)));
+        double t0 = NowSec();
+        for (int r = 0; r < reps; ++r) { AnimPose_PaletteToDualQuat(palette.data(), B, dq.data()); gSink += dq[1].x; }
+        const double usConvert = (NowSec() - t0) * 1e6 / reps;
+        t0 = NowSec();
+        for (int r = 0; r < reps; ++r) {
+            AnimSkin_DualQuatScalar(verts.data(), N, dq.data(), B, dqPos.data(), dqNrm.data());
+            gSink += dqPos[N - 1].x;
+        }
+        const double msDQ = (NowSec() - t0) * 1e3 / reps;
+
+        char buf[256];
+        sprintf_s(buf, "[AnimBench] skin DQ vs linear: max |dPos| = %.2e  mean = %.2e  (upload %u -> %u bytes)\n",
+            dMax, N ? dSum / N : 0.0, unsigned(B * sizeof(XMFLOAT4X4)), unsigned(B * 2 * sizeof(XMFLOAT4)));
+        Log(buf);
+        sprintf_s(buf, "[AnimBench] skin %u verts  DQ scalar threads= 1  %8.3f ms  %9.0f verts/ms  (palette->DQ %.2f us)\n",
+            N, msDQ, N / msDQ, usConvert);
+        Log(buf);
+    }
+
+    // 大网格：同一批顶点重复 16 次（看多线程扩展性）
+    std::vector<SkinnedVertexV1> big;
+    big.reserve(verts.size() * 16);
+    for (int k = 0; k < 16; ++k) big.insert(big.end(), verts.begin(), verts.end());
+    RunSkinCase(big, palette);
+}
+
+// ---------------------------------------------------------
+// 网格 LOD：各档三角形数 / 误差 + 选档阈值
+// ---------------------------------------------------------
+void AnimBenchmark_MeshLod()
+{
+    Log("[AnimBench] ---- mesh LOD ----\n");
+    char buf[256];
+    bool ok = true;
+
+    // 1) cooked 网格的 LOD 表：每个子网格逐档减少三角形，误差不减
+    AssetViewRef file = AssetView_Open(L"resources/player_anim/cooked/player_move.mesh");
+    MeshLodInfo info;
+    if (!file || !MeshLod_Parse(file->data, file->size, info) || info.lodCount < 2) {
+        Log("[AnimBench] player_move.mesh has no LOD table (cook_tool.py mesh-lod), skipped\n");
+    }
+    else {
+        const uint32_t L = info.lodCount;
+        std::vector<uint32_t> tris(L, 0);
+        std::vector<float> err(L, 0.0f);
+        for (size_t s = 0; s < info.submeshBounds.size(); ++s) {
+            for (uint32_t l = 0; l < L; ++l) {
+                const MeshLodRange& r = info.ranges[s * L + l];
+                tris[l] += r.indexCount / 3;
+                err[l] = std::max(err[l], r.error);
+                if (l > 0) {
+                    const MeshLodRange& p = info.ranges[s * L + l - 1];
+                    if (r.indexCount >= p.indexCount || r.error < p.error) ok = false;
+                }
+            }
+        }
+        for (uint32_t l = 0; l < L; ++l) {
+            sprintf_s(buf, "[AnimBench] mesh lod %u: %6u tris (%5.1f%%)  error %.2f mm\n",
+                l, tris[l], 100.0 * tris[l] / std::max(1u, tris[0]), err[l] * 1000.0f);
+            Log(buf);
+        }
+    }
+
+    // 2) 选档：1.8m 的包围盒，fov 60°；阈值对应的距离两侧各取 1%
+    const AABB box = { { -0.4f, 0.0f, -0.2f }, { 0.4f, 1.8f, 0.2f } };
+    const float fov = XMConvertToRadians(60.0f);
+    const float* T = MESH_LOD_DEFAULT_THRESHOLDS;
+    const int TN = (int)std::size(MESH_LOD_DEFAULT_THRESHOLDS);
+    const int lodCount = TN + 1;
+    const float radius = 0.5f * std::sqrt(0.8f * 0.8f + 1.8f * 1.8f + 0.4f * 0.4f);
+    const XMFLOAT3 center = { 0.0f, 0.9f, 0.0f };
+    auto lodAt = [&](float dist, FXMMATRIX world) {
+        const XMFLOAT3 eye = { center.x, center.y, center.z - dist };
+        return MeshLod_Select(MeshLod_ScreenSize(box, world, eye, fov), T, TN, lodCount);
+    };
+    for (int i = 0; i < TN; ++i) {
+        const float d = radius / (T[i] * std::tan(0.5f * fov));
+        const int nearLod = lodAt(d * 0.99f, XMMatrixIdentity());
+        const int farLod = lodAt(d * 1.01f, XMMatrixIdentity());
+        sprintf_s(buf, "[AnimBench] mesh lod threshold %.2f at %6.2f m: LOD %d -> %d\n", T[i], d, nearLod, farLod);
+        Log(buf);
+        if (nearLod != i || farLod != i + 1) ok = false;
+    }
+    if (lodAt(radius * 0.5f, XMMatrixIdentity()) != 0) ok = false;            // 相机在包围球内
+    if (lodAt(1000.0f, XMMatrixIdentity()) != lodCount - 1) ok = false;         // 很远：最后一档
+    if (MeshLod_Select(0.0f, T, TN, 2) != 1) ok = false;                        // 夹到网格的档数
+    {
+        // 放大 2 倍：同一距离下屏幕大小翻倍（缩放绕包围盒中心，中心不动）
+        const float d = radius / (T[0] * std::tan(0.5f * fov));
+        const XMMATRIX w = XMMatrixTranslation(0.0f, -0.9f, 0.0f) * XMMatrixScaling(2.0f, 2.0f, 2.0f)
+            * XMMatrixTranslation(0.0f, 0.9f, 0.0f);
+        if (lodAt(d * 1.5f, w) != 0 || lodAt(d * 2.02f, w) != 1) ok = false;
+    }
+    Log(ok ? "[AnimBench] mesh lod checks: OK\n" : "[AnimBench] mesh lod checks: FAILED\n");
+}
+
+// ---------------------------------------------------------
+// cook 阶段的预计算（.skel 'SMET' / .anim 'META'）与运行时计算一致 + 省下的时间
+// ---------------------------------------------------------
+void AnimBenchmark_Metadata()
+{
+    Log("[AnimBench] ---- precomputed skeleton / clip metadata ----\n");
+    char buf[256];
+    bool ok = true;
+
+    static const wchar_t* kNames[] = { L"melee_idle", L"player_move" };
+    for (const wchar_t* name : kNames) {
+        const std::wstring base = std::wstring(L"resources/player_anim/cooked/") + name;
+        AssetViewRef file = AssetView_Open(base + L".skel");
+        AnimSkeleton sk;
+        AnimClip clip;
+        if (!file || !AnimPose_LoadSkeletonFromView(*file, sk, nullptr) || !AnimClip_Load(base + L".anim", clip)) {
+            sprintf_s(buf, "[AnimBench] %ls: load failed, skipped\n", name);
+            Log(buf);
+            continue;
+        }
+        if (!sk.bindLocalFixed || clip.metaJoint < 0) {
+            sprintf_s(buf, "[AnimBench] %ls: no SMET / META chunk (cook_tool.py skel-meta / anim-meta), skipped\n", name);
+            Log(buf);
+            continue;
+        }
+
+        // 1) bind-pose 修正：JointRec 里的原始值跑一遍运行时的修正，与 cooked 比较
+        AnimSkeleton raw = sk;
+        const JointRec* jr = (const JointRec*)(file->data + sizeof(FileHeader) + sizeof(SkeletonHeader));
+        for (uint32_t j = 0; j < sk.jointCount; ++j) {
+            std::memcpy(raw.bindLocal[j].T, jr[j].bindLocalT, sizeof(float) * 3);
+            std::memcpy(raw.bindLocal[j].R, jr[j].bindLocalR, sizeof(float) * 4);
+            std::memcpy(raw.bindLocal[j].S, jr[j].bindLocalS, sizeof(float) * 3);
+        }
+        const int iters = 200;
+        std::vector<AnimTRS> rawBind = raw.bindLocal;
+        const double t0 = NowSec();
+        for (int i = 0; i < iters; ++i) {
+            raw.bindLocal = rawBind;
+            AnimPose_FixupBindPose(raw);
+        }
+        const double fixupUs = (NowSec() - t0) * 1e6 / iters;
+
+        float dT = 0.0f, dR = 0.0f, dS = 0.0f;
+        for (uint32_t j = 0; j < sk.jointCount; ++j) {
+            const AnimTRS& a = raw.bindLocal[j];
+            const AnimTRS& b = sk.bindLocal[j];
+            // 分解出的四元数不一定是单位长度（bind 矩阵带切变时），逐分量比较（q 与 -q 等价）
+            float dPos = 0.0f, dNeg = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                dPos = std::max(dPos, std::fabs(a.R[k] - b.R[k]));
+                dNeg = std::max(dNeg, std::fabs(a.R[k] + b.R[k]));
+            }
+            dR = std::max(dR, std::min(dPos, dNeg));
+            for (int k = 0; k < 3; ++k) {
+                dT = std::max(dT, std::fabs(a.T[k] - b.T[k]));
+                dS = std::max(dS, std::fabs(a.S[k] - b.S[k]));
+            }
+        }
+        if (dT > 1e-4f || dR > 1e-4f || dS > 1e-4f) ok = false;
+
+        // 2) 第 0 帧 MotionRoot 的 yaw：局部 + 模型空间（整帧 LocalToModel）
+        const int root = clip.metaJoint;
+        std::vector<AnimTRS> pose(clip.jointCount);
+        std::vector<XMMATRIX> model(sk.jointCount);
+        float yawModel = 0.0f;
+        const double t1 = NowSec();
+        for (int i = 0; i < iters; ++i) {
+            AnimPose_LocalToModel(sk, AnimClip_GetFramePose(clip, 0, pose.data()), model.data());
+            const XMVECTOR f = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(0, 0, 1, 0), model[root]));
+            yawModel = std::atan2(XMVectorGetX(f), XMVectorGetZ(f));
+        }
+        const double yawUs = (NowSec() - t1) * 1e6 / iters;
+        const AnimTRS r0 = AnimClip_GetJointAtFrame(clip, root, 0);
+        const XMVECTOR fl = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), XMVectorSet(r0.R[0], r0.R[1], r0.R[2], r0.R[3]));
+        const float yawLocal = std::atan2(XMVectorGetX(fl), XMVectorGetZ(fl));
+        auto angleDiff = [](float a, float b) { return std::fabs(std::remainder(a - b, XM_2PI)); };
+        const float dYaw = std::max(angleDiff(yawModel, clip.rootYawModelF0), angleDiff(yawLocal, clip.rootYawLocalF0));
+        if (dYaw > XMConvertToRadians(0.01f) || root != sk.motionRoot) ok = false;
+
+        sprintf_s(buf, "[AnimBench] meta %-12ls J=%3u  bind fixup %7.1f us (max dT %.1e m, dR %.1e, dS %.1e)"
+            "  f0 yaw %5.1f us (max d %.4f deg)  root #%d\n",
+            name, sk.jointCount, fixupUs, dT, dR, dS, yawUs, XMConvertToDegrees(dYaw), root);
+        Log(buf);
+    }
+    Log(ok ? "[AnimBench] metadata checks: OK\n" : "[AnimBench] metadata checks: FAILED\n");
+}
+
+void AnimBenchmark_Layers()
+{
+    Log("[AnimBench] ---- animation layers: upper-body override on locomotion ----\n");
+    char buf[256];
+
+    AnimSkeleton sk;
+    std::vector<std::string> names;
+    AnimClip base, layer;
+    if (!AnimPose_LoadSkeleton(L"resources/player_anim/cooked/player_move.skel", sk, &names) ||
+        !AnimClip_Load(L"resources/player_anim/cooked/player_move.anim", base) ||
+        !AnimClip_Load(L"resources/player_anim/cooked/player_attack.anim", layer) ||
+        base.jointCount != sk.jointCount || layer.jointCount != sk.jointCount) {
+        Log("[AnimBench] player_move / player_attack not found, skipped\n");
+        return;
+    }
+    const uint32_t J = sk.jointCount;
+    bool ok = true;
+
+    // 1) 遮罩：权重 1 ⇔ 自己或某个祖先叫 mixamorig:Spine
+    const char* roots[] = { "mixamorig:Spine" };
+    std::vector<float> weight;
+    const uint32_t active = AnimPose_BuildSubtreeMask(sk, names, roots, nullptr, 1, weight);
+    for (uint32_t j = 0; j < J; ++j) {
+        bool inside = false;
+        for (int a = (int)j; a >= 0 && !inside; a = sk.parent[a]) inside = (names[a] == roots[0]);
+        if ((weight[j] == 1.0f) != inside || (weight[j] != 0.0f && weight[j] != 1.0f)) ok = false;
+    }
+    std::vector<uint8_t> keep(J);
+    for (uint32_t j = 0; j < J; ++j) keep[j] = weight[j] > 0.0f ? 1 : 0;
+
+    // 2) 覆盖：遮罩内 = 层姿态，遮罩外 = 基础姿态（层只采样遮罩内的骨骼）
+    std::vector<float> scratch;
+    std::vector<AnimTRS> pb(J), pl(J), ref(J), out(J);
+    const float tb = base.durationSec * 0.37f, tl = layer.durationSec * 0.61f;
+    AnimClip_SamplePose(base, tb, pb.data(), scratch);
+    AnimClip_SamplePose(layer, tl, pl.data(), scratch, keep.data());
+    out = pb;
+    AnimPose_BlendMasked(out.data(), pl.data(), weight.data(), 1.0f, J);
+    float dOverride = 0.0f;
+    for (uint32_t j = 0; j < J; ++j) {
+        const AnimTRS& want = keep[j] ? pl[j] : pb[j];
+        float dPos = 0.0f, dNeg = 0.0f;
+        for (int k = 0; k < 4; ++k) {
+            dPos = std::max(dPos, std::fabs(out[j].R[k] - want.R[k]));
+            dNeg = std::max(dNeg, std::fabs(out[j].R[k] + want.R[k]));
+        }
+        dOverride = std::max(dOverride, std::min(dPos, dNeg));
+        for (int k = 0; k < 3; ++k) {
+            dOverride = std::max(dOverride, std::fabs(out[j].T[k] - want.T[k]));
+            dOverride = std::max(dOverride, std::fabs(out[j].S[k] - want.S[k]));
+        }
+    }
+    if (dOverride > 1e-5f) ok = false;
+
+    // 3) 叠加：基础 = 参考姿态时，权重 1 的结果应等于层姿态；权重 0 不改变基础姿态
+    AnimClip_SamplePose(layer, 0.0f, ref.data(), scratch);
+    AnimClip_SamplePose(layer, tl, pl.data(), scratch);
+    std::vector<float> ones(J, 1.0f);
+    out = ref;
+    AnimPose_AddMasked(out.data(), pl.data(), ref.data(), ones.data(), 1.0f, J);
+    float dAdditive = 0.0f;
+    for (uint32_t j = 0; j < J; ++j) {
+        // 参考四元数可能不是单位长度（cooked bind 带切变）：只比较方向
+        const XMVECTOR a = XMQuaternionNormalize(XMLoadFloat4((const XMFLOAT4*)out[j].R));
+        const XMVECTOR b = XMQuaternionNormalize(XMLoadFloat4((const XMFLOAT4*)pl[j].R));
+        dAdditive = std::max(dAdditive, 1.0f - std::fabs(XMVectorGetX(XMVector4Dot(a, b))));
+        for (int k = 0; k < 3; ++k) dAdditive = std::max(dAdditive, std::fabs(out[j].T[k] - pl[j].T[k]));
+    }
+    out = pb;
+    AnimPose_AddMasked(out.data(), pl.data(), ref.data(), ones.data(), 0.0f, J);
+    if (std::memcmp(out.data(), pb.data(), sizeof(AnimTRS) * J) != 0) ok = false;
+    if (dAdditive > 1e-4f) ok = false;
+
+    // 4) 每帧耗时
+    const int iters = 2000;
+    std::vector<XMMATRIX> model(J), model2(J);
+    std::vector<XMFLOAT4X4> palette(J), palette2(J);
+    auto frameTime = [&](int i) { return float(i % 97) / 97.0f; };
+
+    double t0 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        AnimClip_SamplePose(base, frameTime(i) * base.durationSec, pb.data(), scratch);
+        AnimPose_LocalToModel(sk, pb.data(), model.data());
+        AnimPose_BuildPalette(sk, model.data(), palette.data(), J);
+    }
+    const double baseUs = (NowSec() - t0) * 1e6 / iters;
+
+    t0 = NowSec();
+    for (int i = 0; i < iters; ++i) AnimClip_SamplePose(base, frameTime(i) * base.durationSec, pb.data(), scratch);
+    const double sampleUs = (NowSec() - t0) * 1e6 / iters;
+
+    t0 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        AnimClip_SamplePose(base, frameTime(i) * base.durationSec, pb.data(), scratch);
+        AnimClip_SamplePose(layer, frameTime(i) * layer.durationSec, pl.data(), scratch, keep.data());
+        AnimPose_BlendMasked(pb.data(), pl.data(), weight.data(), 0.8f, J);
+        AnimPose_LocalToModel(sk, pb.data(), model.data());
+        AnimPose_BuildPalette(sk, model.data(), palette.data(), J);
+    }
+    const double layeredUs = (NowSec() - t0) * 1e6 / iters;
+
+    // 对照：两个姿态各自完整求值，再按骨骼遮罩挑调色板
+    t0 = NowSec();
+    for (int i = 0; i < iters; ++i) {
+        AnimClip_SamplePose(base, frameTime(i) * base.durationSec, pb.data(), scratch);
+        AnimPose_LocalToModel(sk, pb.data(), model.data());
+        AnimPose_BuildPalette(sk, model.data(), palette.data(), J);
+        AnimClip_SamplePose(layer, frameTime(i) * layer.durationSec, pl.data(), scratch);
+        AnimPose_LocalToModel(sk, pl.data(), model2.data());
+        AnimPose_BuildPalette(sk, model2.data(), palette2.data(), J);
+        for (uint32_t j = 0; j < J; ++j) if (keep[j]) palette[j] = palette2[j];
+    }
+    const double twoFullUs = (NowSec() - t0) * 1e6 / iters;
+    gSink = gSink + palette[J - 1]._44;
+
+    sprintf_s(buf, "[AnimBench] layer mask: %u / %u joints under %s  (override max d %.1e, additive max d %.1e)\n",
+        active, J, roots[0], dOverride, dAdditive);
+    Log(buf);
+    sprintf_s(buf, "[AnimBench] per frame: base %6.2f us | + layer %6.2f us (extra %5.2f us = %.2f x full sample %.2f us)"
+        " | two full evals %6.2f us\n",
+        baseUs, layeredUs, layeredUs - baseUs, (layeredUs - baseUs) / std::max(sampleUs, 1e-9), sampleUs, twoFullUs);
+    Log(buf);
+    Log(ok ? "[AnimBench] layer checks: OK\n" : "[AnimBench] layer checks: FAILED\n");
+}
+
+// ---------------------------------------------------------
+// 2D 混合空间：共圆样本（正方形 / 3×3 网格 / 十字）只出一种剖分，
+// 参数穿过三角形的公共边时权重连续
+// ---------------------------------------------------------
+void AnimBenchmark_BlendSpace()
+{
+    Log("[AnimBench] ---- 2D blend space ----\n");
+    char buf[256];
+    bool ok = true;
+
+    struct Layout { const char* name; std::vector<float> x, y; size_t tris; bool diamond; };   // diamond：凸包是 |x|+|y|<=1
+    const Layout layouts[] = {
+        { "square", { 0, 1, 0, 1 }, { 0, 0, 1, 1 }, 2, false },
+        { "grid3x3", { -1, 0, 1, -1, 0, 1, -1, 0, 1 }, { -1, -1, -1, 0, 0, 0, 1, 1, 1 }, 8, false },
+        { "cross", { 0, 0, 1, 0, -1 }, { 0, 1, 0, -1, 0 }, 4, true },
+    };
+    for (const Layout& L : layouts) {
+        AnimBlendSpace bs;
+        bs.dims = 2;
+        bs.posX = L.x;
+        bs.posY = L.y;
+        if (!AnimBlendSpace_Build(bs)) { Log("[AnimBench] blend space build failed\n"); ok = false; continue; }
+        const size_t n = bs.posX.size();
+
+        auto full = [&](float x, float y) {
+            const AnimBlendWeights w = AnimBlendSpace_Evaluate(bs, x, y);
+            std::vector<float> v(n, 0.0f);
+            for (uint32_t i = 0; i < w.count; ++i) v[w.sample[i]] = w.weight[i];
+            return v;
+        };
+
+        // 网格上逐点：与右 / 上方 1e-3 处的权重差（跨公共边时也应是 O(1e-3)），以及重心坐标还原出参数
+        const float lo = *std::min_element(L.x.begin(), L.x.end()), hi = *std::max_element(L.x.begin(), L.x.end());
+        const float step = (hi - lo) / 64.0f, d = 1e-3f;
+        float maxJump = 0.0f, maxPosErr = 0.0f;
+        for (float y = lo; y <= hi; y += step)
+        for (float x = lo; x <= hi; x += step) {
+            const std::vector<float> w0 = full(x, y), wx = full(x + d, y), wy = full(x, y + d);
+            float jx = 0.0f, jy = 0.0f, px = 0.0f, py = 0.0f;
+            for (size_t i = 0; i < n; ++i) {
+                jx += std::fabs(w0[i] - wx[i]);
+                jy += std::fabs(w0[i] - wy[i]);
+                px += w0[i] * bs.posX[i];
+                py += w0[i] * bs.posY[i];
+            }
+            maxJump = std::max(maxJump, std::max(jx, jy));
+            if (!L.diamond || std::fabs(x) + std::fabs(y) <= 1.0f)   // 凸包外投影到边上，不还原参数
+                maxPosErr = std::max(maxPosErr, std::max(std::fabs(px - x), std::fabs(py - y)));
+        }
+        const size_t triCount = bs.tris.size() / 3;
+        const bool good = triCount == L.tris && maxJump < 0.02f && maxPosErr < 2e-3f;
+        if (!good) ok = false;
+
+        sprintf_s(buf, "[AnimBench] blend space %-8s samples=%zu tris=%zu (expect %zu)  max weight jump over 1e-3 = %.4f  max param err = %.1e\n",
+            L.name, n, triCount, L.tris, maxJump, maxPosErr);
+        Log(buf);
+    }
+    Log(ok ? "[AnimBench] blend space checks: OK\n" : "[AnimBench] blend space checks: FAILED\n");
+}
+
+void AnimBenchmark_RunAll()
+{
+    AnimBenchmark_PoseEval();
+    AnimBenchmark_PoseSample();
+    AnimBenchmark_ParallelPoses();
+    AnimBenchmark_Lod();
+    AnimBenchmark_Skinning();
+    AnimBenchmark_MeshLod();
+    AnimBenchmark_Metadata();
+    AnimBenchmark_Layers();
+    AnimBenchmark_BlendSpace();
+}
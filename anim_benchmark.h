@@ -0,0 +1,44 @@
+﻿#pragma once
+
+// 动画 CPU 路径的基准测试（开发用；结果用 OutputDebugStringA 输出 "[AnimBench]"）
+// 请在 Release 构建下运行，Debug 构建的数字没有参考意义
+
+// 姿态计算：旧的递归 O(J²) 路径 vs 拓扑序线性路径
+// 对象：melee_idle.skel（72 骨骼）+ 合成 256 骨骼骨架（链 / 宽扇 / 随机树）
+void AnimBenchmark_PoseEval();
+
+// 整姿态采样：逐骨骼 SampleJoint（slerp）vs SamplePose（SoA + SSE，nlerp），输出 joints/us
+// 对象：melee_idle / player_move.anim + 合成 256 骨骼剪辑
+void AnimBenchmark_PoseSample();
+
+// 多实例姿态更新的扩展性：melee_idle × 1/100/1000 实例，线程数 1,2,4,...,JobPool 最大
+// 线程池未初始化时只测单线程
+void AnimBenchmark_ParallelPoses();
+
+// 动画 LOD：melee_idle × 100/1000 实例随机分布在 0..100m，
+// 全部每帧完整求值 vs 按距离降频 + 省略末端骨骼 + 远处冻结（与 ModelSkinned 默认档位相同）
+void AnimBenchmark_Lod();
+
+// CPU 蒙皮：player_move.mesh × 当前姿态调色板，Scalar vs AVX2，线程数 1..最大，输出 verts/ms
+// 同时以 Scalar 为参考输出 AVX2 的最大误差（GPU 结果的校验也以 Scalar 为准）
+// 双四元数：DQ 参考实现与线性蒙皮的位置差、调色板转换耗时、上传字节数
+void AnimBenchmark_Skinning();
+
+// 网格 LOD：player_move.mesh 各档的三角形数 / 误差（逐档减少），
+// 以及选档阈值两侧的档位、相机在包围球内、很远、缩放后的边界检查（输出 OK / FAILED）
+void AnimBenchmark_MeshLod();
+
+// cook 阶段预计算（.skel 'SMET' / .anim 'META'）：melee_idle / player_move 上
+// 运行时的 bind-pose 修正 / 第 0 帧 yaw 与 cooked 值的差（输出 OK / FAILED），以及每次省下的时间
+void AnimBenchmark_Metadata();
+
+// 动画层：player_move（基础）+ player_attack（"mixamorig:Spine" 子树覆盖层）
+// 遮罩 / 覆盖 / 叠加的正确性（输出 OK / FAILED），以及每帧耗时：只有基础层、加一层（部分采样 + 混合）、
+// 两次完整求值（各自采样 + 层级合成）
+void AnimBenchmark_Layers();
+
+// 2D 混合空间：正方形 / 3×3 网格 / 十字布局的三角形数，以及参数跨过公共边时的权重连续性（输出 OK / FAILED）
+void AnimBenchmark_BlendSpace();
+
+// 全部基准
+void AnimBenchmark_RunAll();
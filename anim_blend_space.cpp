@@ -0,0 +1,209 @@
+﻿#include "anim_blend_space.h"
+#include <algorithm>
+#include <cmath>
+#include <Windows.h>
+
+// 权重小于它的样本不参与（省一次采样）
+static const float kMinWeight = 1e-3f;
+
+// ---------------------------------------------------------
+// 构建
+// ---------------------------------------------------------
+static double Cross(const float* X, const float* Y, uint16_t a, uint16_t b, uint16_t c)
+{
+    return (double(X[b]) - X[a]) * (double(Y[c]) - Y[a]) - (double(Y[b]) - Y[a]) * (double(X[c]) - X[a]);
+}
+
+// 两个三角形内部是否相交（分离轴：任一条边把另一个三角形整个隔在外侧 / 边上即不相交）
+static bool Overlaps(const float* X, const float* Y, const uint16_t* t0, const uint16_t* t1)
+{
+    const uint16_t* tri[2] = { t0, t1 };
+    for (int s = 0; s < 2; ++s) {
+        const uint16_t* p = tri[s];
+        const uint16_t* q = tri[1 - s];
+        const double orient = (Cross(X, Y, p[0], p[1], p[2]) > 0.0) ? 1.0 : -1.0;
+        for (int e = 0; e < 3; ++e) {
+            const uint16_t a = p[e], b = p[(e + 1) % 3];
+            const double ex = double(X[b]) - X[a], ey = double(Y[b]) - Y[a];
+            const double eps = 1e-9 * (ex * ex + ey * ey);
+            bool separated = true;
+            for (int k = 0; k < 3 && separated; ++k)
+                if (orient * Cross(X, Y, a, b, q[k]) > eps) separated = false;
+            if (separated) return false;
+        }
+    }
+    return true;
+}
+
+static bool BuildTriangles(AnimBlendSpace& bs)
+{
+    const size_t n = bs.posX.size();
+    const float* X = bs.posX.data();
+    const float* Y = bs.posY.data();
+
+    // 暴力 Delaunay：外接圆内没有其他样本的三角形
+    // 4 个以上样本共圆（正方形 / 网格 / 十字）时这样的三角形会互相重叠，
+    // 与已接受的三角形重叠的丢掉，只留一种剖分（否则评估时落在哪个三角形取决于顺序，权重会跳）
+    for (size_t a = 0; a < n; ++a)
+    for (size_t b = a + 1; b < n; ++b)
+    for (size_t c = b + 1; c < n; ++c) {
+        const double ax = X[a], ay = Y[a], bx = X[b], by = Y[b], cx = X[c], cy = Y[c];
+        const double d = 2.0 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+        if (std::fabs(d) < 1e-12) continue;   // 共线
+
+        const double a2 = ax * ax + ay * ay, b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+        const double ux = (a2 * (by - cy) + b2 * (cy - ay) + c2 * (ay - by)) / d;
+        const double uy = (a2 * (cx - bx) + b2 * (ax - cx) + c2 * (bx - ax)) / d;
+        const double r2 = (ax - ux) * (ax - ux) + (ay - uy) * (ay - uy);
+
+        bool empty = true;
+        for (size_t k = 0; k < n && empty; ++k) {
+            if (k == a || k == b || k == c) continue;
+            const double dx = X[k] - ux, dy = Y[k] - uy;
+            if (dx * dx + dy * dy < r2 * (1.0 - 1e-9)) empty = false;
+        }
+        if (!empty) continue;
+
+        const uint16_t cand[3] = { (uint16_t)a, (uint16_t)b, (uint16_t)c };
+        bool overlap = false;
+        for (size_t t = 0; t < bs.tris.size() && !overlap; t += 3)
+            overlap = Overlaps(X, Y, &bs.tris[t], cand);
+        if (overlap) continue;
+
+        bs.tris.insert(bs.tris.end(), cand, cand + 3);
+    }
+    return !bs.tris.empty();
+}
+
+bool AnimBlendSpace_Build(AnimBlendSpace& bs)
+{
+    bs.order.clear();
+    bs.tris.clear();
+
+    const size_t n = bs.posX.size();
+    if (n == 0 || n > 0xFFFF) return false;
+    bs.posY.resize(n, 0.0f);
+
+    if (bs.dims != 2) {
+        bs.dims = 1;
+        bs.order.resize(n);
+        for (size_t i = 0; i < n; ++i) bs.order[i] = (uint16_t)i;
+        std::stable_sort(bs.order.begin(), bs.order.end(),
+            [&](uint16_t a, uint16_t b) { return bs.posX[a] < bs.posX[b]; });
+        return true;
+    }
+
+    if (n < 3 || !BuildTriangles(bs)) {
+#if defined(DEBUG) || defined(_DEBUG)
+        OutputDebugStringA("[BlendSpace] 2D blend space needs >= 3 non-collinear samples\n");
+#endif
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// 评估
+// ---------------------------------------------------------
+static void Push(AnimBlendWeights& w, uint16_t s, float v)
+{
+    if (v < kMinWeight) return;
+    w.sample[w.count] = s;
+    w.weight[w.count] = v;
+    ++w.count;
+}
+
+// 丢掉太小的权重后重新归一化，按权重降序
+static void Finish(AnimBlendWeights& w)
+{
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < w.count; ++i) sum += w.weight[i];
+    if (sum <= 0.0f) { w.count = 0; return; }
+    for (uint32_t i = 0; i < w.count; ++i) w.weight[i] /= sum;
+
+    for (uint32_t i = 1; i < w.count; ++i)
+        for (uint32_t k = i; k > 0 && w.weight[k] > w.weight[k - 1]; --k) {
+            std::swap(w.weight[k], w.weight[k - 1]);
+            std::swap(w.sample[k], w.sample[k - 1]);
+        }
+}
+
+static AnimBlendWeights Evaluate1D(const AnimBlendSpace& bs, float x)
+{
+    AnimBlendWeights w{};
+    const auto& o = bs.order;
+    const float* X = bs.posX.data();
+
+    if (x <= X[o.front()]) { Push(w, o.front(), 1.0f); Finish(w); return w; }
+    if (x >= X[o.back()]) { Push(w, o.back(), 1.0f); Finish(w); return w; }
+
+    for (size_t i = 0; i + 1 < o.size(); ++i) {
+        const float x0 = X[o[i]], x1 = X[o[i + 1]];
+        if (x < x0 || x > x1) continue;
+        const float t = (x1 > x0) ? (x - x0) / (x1 - x0) : 0.0f;
+        Push(w, o[i], 1.0f - t);
+        Push(w, o[i + 1], t);
+        break;
+    }
+    Finish(w);
+    return w;
+}
+
+static AnimBlendWeights Evaluate2D(const AnimBlendSpace& bs, float x, float y)
+{
+    AnimBlendWeights w{};
+    const float* X = bs.posX.data();
+    const float* Y = bs.posY.data();
+    const size_t triCount = bs.tris.size() / 3;
+
+    // 1) 所在三角形：重心坐标
+    for (size_t t = 0; t < triCount; ++t) {
+        const uint16_t a = bs.tris[t * 3 + 0], b = bs.tris[t * 3 + 1], c = bs.tris[t * 3 + 2];
+        const float v0x = X[b] - X[a], v0y = Y[b] - Y[a];
+        const float v1x = X[c] - X[a], v1y = Y[c] - Y[a];
+        const float v2x = x - X[a], v2y = y - Y[a];
+        const float den = v0x * v1y - v1x * v0y;
+        if (den == 0.0f) continue;
+        const float wb = (v2x * v1y - v1x * v2y) / den;
+        const float wc = (v0x * v2y - v2x * v0y) / den;
+        const float wa = 1.0f - wb - wc;
+        const float eps = -1e-5f;
+        if (wa >= eps && wb >= eps && wc >= eps) {
+            Push(w, a, std::max(0.0f, wa));
+            Push(w, b, std::max(0.0f, wb));
+            Push(w, c, std::max(0.0f, wc));
+            Finish(w);
+            return w;
+        }
+    }
+
+    // 2) 凸包外：投影到最近的三角形边
+    float bestD2 = 3.4e38f, bestT = 0.0f;
+    uint16_t bestA = bs.tris[0], bestB = bs.tris[1];
+    for (size_t t = 0; t < triCount; ++t) {
+        for (int e = 0; e < 3; ++e) {
+            const uint16_t a = bs.tris[t * 3 + e], b = bs.tris[t * 3 + (e + 1) % 3];
+            const float ex = X[b] - X[a], ey = Y[b] - Y[a];
+            const float len2 = ex * ex + ey * ey;
+            float s = (len2 > 0.0f) ? ((x - X[a]) * ex + (y - Y[a]) * ey) / len2 : 0.0f;
+            s = std::clamp(s, 0.0f, 1.0f);
+            const float dx = X[a] + ex * s - x, dy = Y[a] + ey * s - y;
+            const float d2 = dx * dx + dy * dy;
+            if (d2 < bestD2) { bestD2 = d2; bestT = s; bestA = a; bestB = b; }
+        }
+    }
+    Push(w, bestA, 1.0f - bestT);
+    Push(w, bestB, bestT);
+    Finish(w);
+    return w;
+}
+
+AnimBlendWeights AnimBlendSpace_Evaluate(const AnimBlendSpace& bs, float x, float y)
+{
+    if (bs.dims == 2) {
+        if (bs.tris.empty()) return AnimBlendWeights{};
+        return Evaluate2D(bs, x, y);
+    }
+    if (bs.order.empty()) return AnimBlendWeights{};
+    return Evaluate1D(bs, x);
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------
+// 混合空间（纯 CPU）：参数 (x[,y]) → 最多 3 个样本 + 权重
+//  - 1D：样本按位置排序，取相邻两个线性插值（两端夹紧）
+//  - 2D：样本做 Delaunay 三角化，取所在三角形的重心坐标；
+//        在凸包外时投影到最近的边（两个样本）
+// 样本数很小（通常 < 16），构建时暴力三角化，评估时线性扫描
+// ---------------------------------------------------------
+struct AnimBlendSpace {
+    uint32_t              dims = 1;     // 1 或 2
+    std::vector<float>    posX, posY;   // 每个样本的位置（1D 只用 posX）
+
+    // AnimBlendSpace_Build 生成
+    std::vector<uint16_t> order;        // 1D：按 posX 升序的样本下标
+    std::vector<uint16_t> tris;         // 2D：三角形，3 个一组
+};
+
+struct AnimBlendWeights {
+    uint32_t count = 0;
+    uint16_t sample[3] = {};
+    float    weight[3] = {};            // 和为 1；按权重降序（sample[0] 为主样本）
+};
+
+// posX/posY/dims 填好后调用一次；样本为空 / 2D 全部共线时返回 false
+bool AnimBlendSpace_Build(AnimBlendSpace& bs);
+
+AnimBlendWeights AnimBlendSpace_Evaluate(const AnimBlendSpace& bs, float x, float y);
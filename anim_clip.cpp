@@ -0,0 +1,683 @@
+﻿#include "anim_clip.h"
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+
+using namespace DirectX;
+
+// ---------------------------------------------------------
+// 读取
+// ---------------------------------------------------------
+// 'ROOT'：曲线原地引用（块 4 字节对齐，float 可直接读）
+//  返回块之后的位置；块不完整 / 与剪辑不符返回 nullptr（之后的块也不再读）
+static const uint8_t* LoadRootMotion(const uint8_t* p, const uint8_t* e, AnimClip& c)
+{
+    AnimRootMotionHeader rh;
+    std::memcpy(&rh, p, sizeof(rh)); p += sizeof(rh);
+    if (rh.frameCount != c.frameCount || rh.jointIndex >= c.jointCount || c.frameCount == 0) return nullptr;
+
+    const size_t bytes = size_t(rh.frameCount) * 4 * sizeof(float);
+    if (size_t(e - p) < bytes) return nullptr;
+    c.rootMotionJoint = (int32_t)rh.jointIndex;
+    c.rootMotion = (const float*)p;
+    return p + bytes;
+}
+
+// 'EVNT'：名字按字节偏移去重成下标；时间不升序视为坏块
+static const uint8_t* LoadEvents(const uint8_t* p, const uint8_t* e, AnimClip& c)
+{
+    AnimEventHeader eh;
+    std::memcpy(&eh, p, sizeof(eh)); p += sizeof(eh);
+
+    const size_t recBytes = size_t(eh.eventCount) * sizeof(AnimEventRec);
+    if (size_t(e - p) < recBytes + eh.nameBytes) return nullptr;
+    const uint8_t* names = p + recBytes;
+
+    std::vector<AnimClipEvent> events(eh.eventCount);
+    std::vector<std::string> eventNames;
+    std::vector<uint32_t> offsets;   // eventNames[i] 的原始偏移
+    float prev = -1.0f;
+    for (uint32_t i = 0; i < eh.eventCount; ++i) {
+        AnimEventRec r;
+        std::memcpy(&r, p + i * sizeof(AnimEventRec), sizeof(r));
+        if (r.nameOffset >= eh.nameBytes || !(r.timeSec >= prev)) return nullptr;
+        prev = r.timeSec;
+
+        auto it = std::find(offsets.begin(), offsets.end(), r.nameOffset);
+        if (it == offsets.end()) {
+            const char* s = (const char*)names + r.nameOffset;
+            eventNames.emplace_back(s, strnlen(s, eh.nameBytes - r.nameOffset));
+            offsets.push_back(r.nameOffset);
+            it = offsets.end() - 1;
+        }
+        events[i] = { r.timeSec, uint32_t(it - offsets.begin()), r.payload };
+    }
+    c.events.swap(events);
+    c.eventNames.swap(eventNames);
+    return names + eh.nameBytes;
+}
+
+// 'JNTS'：名字表原地引用（定长 64 字节一项）
+static const uint8_t* LoadJointNames(const uint8_t* p, const uint8_t* e, AnimClip& c)
+{
+    AnimJointNamesHeader nh;
+    std::memcpy(&nh, p, sizeof(nh)); p += sizeof(nh);
+    if (nh.jointCount != c.jointCount) return nullptr;
+
+    const size_t bytes = size_t(nh.jointCount) * ANIM_JOINT_NAME_BYTES;
+    if (size_t(e - p) < bytes) return nullptr;
+    c.jointNames = (const char*)p;
+    return p + bytes;
+}
+
+// 'META'：定长，值直接拷出
+static const uint8_t* LoadMeta(const uint8_t* p, const uint8_t*, AnimClip& c)
+{
+    AnimMetaHeader mh;
+    std::memcpy(&mh, p, sizeof(mh));
+    if (mh.jointIndex >= c.jointCount) return nullptr;
+    c.metaJoint = (int32_t)mh.jointIndex;
+    c.rootYawLocalF0 = mh.rootYawLocal;
+    c.rootYawModelF0 = mh.rootYawModel;
+    return p + sizeof(mh);
+}
+
+// 正文之后的可选块（各块从文件头起 4 字节对齐）；不认识的块 / 坏块之后不再读
+static void LoadTrailingChunks(const uint8_t* base, const uint8_t* p, const uint8_t* e, AnimClip& c)
+{
+    while (p) {
+        p = base + ((size_t(p - base) + 3) & ~size_t(3));
+        if (p >= e || size_t(e - p) < 16) return;
+        if (std::memcmp(p, "ROOT", 4) == 0 && size_t(e - p) >= sizeof(AnimRootMotionHeader))
+            p = LoadRootMotion(p, e, c);
+        else if (std::memcmp(p, "EVNT", 4) == 0 && size_t(e - p) >= sizeof(AnimEventHeader))
+            p = LoadEvents(p, e, c);
+        else if (std::memcmp(p, "JNTS", 4) == 0 && size_t(e - p) >= sizeof(AnimJointNamesHeader))
+            p = LoadJointNames(p, e, c);
+        else if (std::memcmp(p, "META", 4) == 0 && size_t(e - p) >= sizeof(AnimMetaHeader))
+            p = LoadMeta(p, e, c);
+        else
+            return;
+    }
+}
+
+bool AnimClip_Load(const std::wstring& animPath, AnimClip& c)
+{
+    c = AnimClip{};
+    AssetViewRef file = AssetView_Open(animPath);
+    return file && AnimClip_LoadFromView(file, c);
+}
+
+bool AnimClip_LoadFromView(const AssetViewRef& file, AnimClip& c)
+{
+    c = AnimClip{};
+    if (!file) return false;
+
+    const uint8_t* p = file->data;
+    const uint8_t* e = file->data + file->size;
+    auto need = [&](size_t n) { return (size_t)(e - p) >= n; };
+
+    if (!need(sizeof(FileHeader))) return false;
+    auto fh = (const FileHeader*)p; p += sizeof(FileHeader);
+    if (std::memcmp(fh->magic, "ANIM", 4) != 0) return false;
+
+    if (fh->version == ANIM_VERSION_V2) {
+        if (!need(sizeof(AnimHeaderV2))) return false;
+        auto ah = (const AnimHeaderV2*)p; p += sizeof(AnimHeaderV2);
+
+        const size_t trackCount = size_t(ah->jointCount) * ANIM_CH_COUNT;
+        const size_t kfBytes = (size_t(ah->keyFrameCount) * sizeof(uint16_t) + 3) & ~size_t(3);
+        if (!need(trackCount * sizeof(AnimTrackV2) + kfBytes + ah->keyDataBytes)) return false;
+
+        c.jointCount = ah->jointCount;
+        c.sampleRate = ah->sampleRate;
+        c.frameCount = ah->frameCount;
+        c.durationSec = ah->durationSec;
+
+        // 各段都在 4 字节边界上（映射基址按页对齐），直接引用
+        c.file = file;
+        c.tracks = (const AnimTrackV2*)p;
+        p += trackCount * sizeof(AnimTrackV2);
+
+        c.keyFrames = (const uint16_t*)p;
+        c.keyFrameCount = ah->keyFrameCount;
+        p += kfBytes;
+
+        c.keyData = p;
+        c.keyDataBytes = ah->keyDataBytes;
+        p += ah->keyDataBytes;
+
+        // 越界检查：之后采样不再检查
+        for (size_t i = 0; i < trackCount; ++i) {
+            const AnimTrackV2& t = c.tracks[i];
+            if (t.keyCount == 0) return false;
+            if (t.flags & ANIM_TRACK_CONSTANT) {
+                const size_t bytes = (i % ANIM_CH_COUNT == ANIM_CH_R) ? 16 : 12;
+                if (size_t(t.keyDataOffset) + bytes > c.keyDataBytes) return false;
+            }
+            else {
+                const size_t rangeBytes = (i % ANIM_CH_COUNT == ANIM_CH_R) ? 0 : sizeof(float) * 6;
+                if (size_t(t.keyFrameOffset) + t.keyCount > c.keyFrameCount) return false;
+                if (size_t(t.keyDataOffset) + rangeBytes + size_t(t.keyCount) * 6 > c.keyDataBytes) return false;
+            }
+        }
+        LoadTrailingChunks(file->data, p, e, c);
+        return true;
+    }
+
+    // v1
+    if (!need(sizeof(AnimHeader))) return false;
+    auto ah = (const AnimHeader*)p; p += sizeof(AnimHeader);
+
+    size_t framesBytes = size_t(ah->frameCount) * size_t(ah->jointCount) * sizeof(AnimTRS);
+    if (!need(framesBytes)) return false;
+
+    // 逐帧 TRS 直接从映射转成 SoA（中间不再有整文件的堆拷贝）
+    AnimClip_InitFromPoses(c, ah->jointCount, ah->frameCount, ah->sampleRate, (const AnimTRS*)p);
+    c.durationSec = ah->durationSec;
+    LoadTrailingChunks(file->data, p + framesBytes, e, c);
+    if (c.rootMotion || c.jointNames) c.file = file;   // 曲线 / 名字表还指着映射
+    return true;
+}
+
+// ---------------------------------------------------------
+// 根运动曲线
+// ---------------------------------------------------------
+void AnimClip_SampleRootMotion(const AnimClip& c, float tSec, float out[4])
+{
+    out[0] = out[1] = out[2] = out[3] = 0.0f;
+    if (!c.rootMotion) return;
+
+    const uint32_t last = c.frameCount - 1;
+    const float f = std::clamp(tSec * c.sampleRate, 0.0f, float(last));
+    const uint32_t f0 = std::min((uint32_t)f, last);
+    const uint32_t f1 = std::min(f0 + 1, last);
+    const float a = f - float(f0);
+
+    const float* A = &c.rootMotion[size_t(f0) * 4];
+    const float* B = &c.rootMotion[size_t(f1) * 4];
+    for (int k = 0; k < 4; ++k) out[k] = A[k] + (B[k] - A[k]) * a;
+}
+
+bool AnimClip_RootMotionDelta(const AnimClip& c, float t0, float t1, bool loop, float outDeltaT[3], float* outDeltaYaw)
+{
+    if (outDeltaT) outDeltaT[0] = outDeltaT[1] = outDeltaT[2] = 0.0f;
+    if (outDeltaYaw) *outDeltaYaw = 0.0f;
+    if (!c.rootMotion) return false;
+
+    const float dur = c.durationSec;
+    float d[4];
+    if (!loop || dur <= 0.0f) {
+        float a[4], b[4];
+        AnimClip_SampleRootMotion(c, std::clamp(t0, 0.0f, dur), a);
+        AnimClip_SampleRootMotion(c, std::clamp(t1, 0.0f, dur), b);
+        for (int k = 0; k < 4; ++k) d[k] = b[k] - a[k];
+    }
+    else {
+        // 展开的曲线：C(t) = C(t mod dur) + floor(t / dur) * (C(end) - C(0))
+        const float* first = &c.rootMotion[0];
+        const float* last = &c.rootMotion[size_t(c.frameCount - 1) * 4];
+        auto unwrapped = [&](float t, float out[4]) {
+            const float cycles = std::floor(t / dur);
+            AnimClip_SampleRootMotion(c, t - cycles * dur, out);
+            for (int k = 0; k < 4; ++k) out[k] += cycles * (last[k] - first[k]);
+            };
+        float a[4], b[4];
+        unwrapped(t0, a);
+        unwrapped(t1, b);
+        for (int k = 0; k < 4; ++k) d[k] = b[k] - a[k];
+    }
+
+    if (outDeltaT) { outDeltaT[0] = d[0]; outDeltaT[1] = d[1]; outDeltaT[2] = d[2]; }
+    if (outDeltaYaw) *outDeltaYaw = d[3];
+    return true;
+}
+
+// ---------------------------------------------------------
+// 事件
+// ---------------------------------------------------------
+uint32_t AnimClip_QueryEvents(const AnimClip& c, float t0, float t1, bool loop, uint32_t* outIdx, uint32_t maxOut)
+{
+    if (c.events.empty() || !outIdx || maxOut == 0) return 0;
+
+    const AnimClipEvent* first = c.events.data();
+    const AnimClipEvent* last = first + c.events.size();
+    uint32_t n = 0;
+
+    // [a, b)（inclEnd：[a, b]）内的事件；写满返回 false
+    auto emit = [&](float a, float b, bool inclEnd) {
+        const AnimClipEvent* it = std::lower_bound(first, last, a,
+            [](const AnimClipEvent& ev, float t) { return ev.timeSec < t; });
+        for (; it != last && (it->timeSec < b || (inclEnd && it->timeSec <= b)); ++it) {
+            if (n == maxOut) return false;
+            outIdx[n++] = uint32_t(it - first);
+        }
+        return true;
+        };
+
+    const float dur = c.durationSec;
+    if (!loop || dur <= 0.0f) {
+        const float a = std::clamp(t0, 0.0f, dur);
+        const float b = std::clamp(t1, 0.0f, dur);
+        if (b > a) emit(a, b, t1 >= dur);
+        return n;
+    }
+
+    if (!(t1 > t0)) return 0;
+    const float c0 = std::floor(t0 / dur), c1 = std::floor(t1 / dur);
+    const float a = t0 - c0 * dur, b = t1 - c1 * dur;
+    if (c0 == c1) {
+        emit(a, b, false);
+        return n;
+    }
+    // 跨过终点：本圈剩余 → 中间整圈 → 新一圈开头
+    if (!emit(a, dur, false)) return n;
+    for (float k = c0 + 1.0f; k < c1; k += 1.0f)
+        if (!emit(0.0f, dur, false)) return n;
+    emit(0.0f, b, false);
+    return n;
+}
+
+// ---------------------------------------------------------
+// v1 SoA
+// ---------------------------------------------------------
+enum SoaStream : uint32_t { SOA_TX = 0, SOA_RX = 3, SOA_SX = 7 };
+
+static inline void ScatterJoint(float* frame, uint32_t stride, uint32_t j, const AnimTRS& t)
+{
+    for (int i = 0; i < 3; ++i) frame[(SOA_TX + i) * stride + j] = t.T[i];
+    for (int i = 0; i < 4; ++i) frame[(SOA_RX + i) * stride + j] = t.R[i];
+    for (int i = 0; i < 3; ++i) frame[(SOA_SX + i) * stride + j] = t.S[i];
+}
+
+static inline AnimTRS GatherJoint(const float* frame, uint32_t stride, uint32_t j)
+{
+    AnimTRS t{};
+    for (int i = 0; i < 3; ++i) t.T[i] = frame[(SOA_TX + i) * stride + j];
+    for (int i = 0; i < 4; ++i) t.R[i] = frame[(SOA_RX + i) * stride + j];
+    for (int i = 0; i < 3; ++i) t.S[i] = frame[(SOA_SX + i) * stride + j];
+    return t;
+}
+
+static inline const float* SoaFrame(const AnimClip& c, uint32_t frame)
+{
+    return c.soa.data() + size_t(frame) * ANIM_SOA_STREAMS * c.soaStride;
+}
+
+void AnimClip_InitFromPoses(AnimClip& c, uint32_t jointCount, uint32_t frameCount, float sampleRate, const AnimTRS* poses)
+{
+    c = AnimClip{};
+    c.jointCount = jointCount;
+    c.frameCount = frameCount;
+    c.sampleRate = sampleRate;
+    c.durationSec = (frameCount > 1 && sampleRate > 0.0f) ? float(frameCount - 1) / sampleRate : 0.0f;
+
+    c.soaStride = (jointCount + 3u) & ~3u;
+    c.soa.assign(size_t(frameCount) * ANIM_SOA_STREAMS * c.soaStride, 0.0f);
+    for (uint32_t f = 0; f < frameCount; ++f) {
+        float* dst = c.soa.data() + size_t(f) * ANIM_SOA_STREAMS * c.soaStride;
+        for (uint32_t j = 0; j < jointCount; ++j)
+            ScatterJoint(dst, c.soaStride, j, poses[size_t(f) * jointCount + j]);
+    }
+}
+
+size_t AnimClip_MemoryBytes(const AnimClip& c)
+{
+    const size_t trackCount = c.tracks ? size_t(c.jointCount) * ANIM_CH_COUNT : 0;
+    return c.soa.size() * sizeof(float)
+        + trackCount * sizeof(AnimTrackV2)
+        + size_t(c.keyFrameCount) * sizeof(uint16_t)
+        + c.keyDataBytes;
+}
+
+size_t AnimClip_HeapBytes(const AnimClip& c)
+{
+    size_t n = c.soa.capacity() * sizeof(float) + c.events.capacity() * sizeof(AnimClipEvent);
+    for (const std::string& s : c.eventNames) n += sizeof(std::string) + s.capacity();
+    return n;
+}
+
+// ---------------------------------------------------------
+// v2 解码
+// ---------------------------------------------------------
+static const float kInvSqrt2 = 0.70710678118654752f;
+
+// range：keyData 里轨道开头的 rangeMin[3], rangeExt[3]
+static inline void DecodeVec3(const float* range, const uint16_t* q, float out[3])
+{
+    const float s = 1.0f / 65535.0f;
+    out[0] = range[0] + float(q[0]) * s * range[3];
+    out[1] = range[1] + float(q[1]) * s * range[4];
+    out[2] = range[2] + float(q[2]) * s * range[5];
+}
+
+static inline void DecodeQuat(const uint16_t* q, float out[4])
+{
+    const uint32_t largest = ((q[0] >> 15) << 1) | (q[1] >> 15);
+    const float s = (2.0f * kInvSqrt2) / 32767.0f;
+    const float a = float(q[0] & 0x7FFF) * s - kInvSqrt2;
+    const float b = float(q[1] & 0x7FFF) * s - kInvSqrt2;
+    const float c = float(q[2] & 0x7FFF) * s - kInvSqrt2;
+    const float w = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+
+    int k = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (i == largest) { out[i] = w; continue; }
+        out[i] = (k == 0) ? a : (k == 1) ? b : c;
+        ++k;
+    }
+}
+
+// nlerp（符号修正）
+static inline void NlerpQuat(const float a[4], const float b[4], float t, float out[4])
+{
+    const float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    const float sb = (d < 0.0f) ? -1.0f : 1.0f;
+    float len2 = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        out[i] = a[i] + (sb * b[i] - a[i]) * t;
+        len2 += out[i] * out[i];
+    }
+    const float inv = (len2 > 0.0f) ? 1.0f / std::sqrt(len2) : 0.0f;
+    for (int i = 0; i < 4; ++i) out[i] *= inv;
+}
+
+// 解一个通道在整数帧 frame 的值（out 长度：T/S=3，R=4）
+static void DecodeTrack(const AnimClip& c, const AnimTrackV2& t, uint32_t ch, uint32_t frame, float* out)
+{
+    const uint8_t* data = c.keyData + t.keyDataOffset;
+
+    if (t.flags & ANIM_TRACK_CONSTANT) {
+        std::memcpy(out, data, (ch == ANIM_CH_R) ? sizeof(float) * 4 : sizeof(float) * 3);
+        return;
+    }
+
+    // T/S：量化区间在前，key 紧随其后
+    float range[6] = {};
+    if (ch != ANIM_CH_R) {
+        std::memcpy(range, data, sizeof(range));
+        data += sizeof(range);
+    }
+
+    // 最后一个 <= frame 的关键帧
+    const uint16_t* kf = c.keyFrames + t.keyFrameOffset;
+    const uint32_t n = t.keyCount;
+    uint32_t k = uint32_t(std::upper_bound(kf, kf + n, uint16_t(std::min<uint32_t>(frame, 0xFFFF))) - kf);
+    k = (k > 0) ? k - 1 : 0;
+
+    const uint16_t* q0 = (const uint16_t*)data + size_t(k) * 3;
+    if (kf[k] >= frame || k + 1 >= n) {
+        if (ch == ANIM_CH_R) DecodeQuat(q0, out);
+        else DecodeVec3(range, q0, out);
+        return;
+    }
+
+    const uint16_t* q1 = q0 + 3;
+    const float a = float(frame - kf[k]) / float(kf[k + 1] - kf[k]);
+    if (ch == ANIM_CH_R) {
+        float r0[4], r1[4];
+        DecodeQuat(q0, r0);
+        DecodeQuat(q1, r1);
+        NlerpQuat(r0, r1, a, out);
+    }
+    else {
+        float v0[3], v1[3];
+        DecodeVec3(range, q0, v0);
+        DecodeVec3(range, q1, v1);
+        for (int i = 0; i < 3; ++i) out[i] = v0[i] + (v1[i] - v0[i]) * a;
+    }
+}
+
+static AnimTRS DecodeJoint(const AnimClip& c, uint32_t joint, uint32_t frame)
+{
+    AnimTRS out{};
+    const AnimTrackV2* t = c.tracks + size_t(joint) * ANIM_CH_COUNT;
+    DecodeTrack(c, t[ANIM_CH_T], ANIM_CH_T, frame, out.T);
+    DecodeTrack(c, t[ANIM_CH_R], ANIM_CH_R, frame, out.R);
+    DecodeTrack(c, t[ANIM_CH_S], ANIM_CH_S, frame, out.S);
+    return out;
+}
+
+// ---------------------------------------------------------
+// 采样
+// ---------------------------------------------------------
+const AnimTRS* AnimClip_GetFramePose(const AnimClip& c, uint32_t frame, AnimTRS* scratch)
+{
+    if (c.frameCount == 0) return nullptr;
+    if (frame >= c.frameCount) frame = c.frameCount - 1;
+
+    if (!AnimClip_IsCompressed(c)) {
+        const float* src = SoaFrame(c, frame);
+        for (uint32_t j = 0; j < c.jointCount; ++j)
+            scratch[j] = GatherJoint(src, c.soaStride, j);
+        return scratch;
+    }
+
+    for (uint32_t j = 0; j < c.jointCount; ++j)
+        scratch[j] = DecodeJoint(c, j, frame);
+    return scratch;
+}
+
+AnimTRS AnimClip_GetJointAtFrame(const AnimClip& c, uint32_t joint, uint32_t frame)
+{
+    if (c.frameCount == 0 || joint >= c.jointCount) return AnimTRS{};
+    if (frame >= c.frameCount) frame = c.frameCount - 1;
+
+    if (!AnimClip_IsCompressed(c))
+        return GatherJoint(SoaFrame(c, frame), c.soaStride, joint);
+    return DecodeJoint(c, joint, frame);
+}
+
+AnimTRS AnimClip_SampleJoint(const AnimClip& c, uint32_t joint, float tSec)
+{
+    AnimTRS out{};
+    if (c.frameCount == 0 || joint >= c.jointCount) return out;
+
+    const uint32_t frameCount = c.frameCount;
+    const float f = tSec * c.sampleRate;
+    int   f0 = (int)floorf(f);
+    float a = f - f0;
+
+    auto wrap = [&](int x) {
+        while (x < 0) x += (int)frameCount;
+        while (x >= (int)frameCount) x -= (int)frameCount;
+        return x;
+        };
+    int f1 = wrap(f0 + 1);
+    f0 = wrap(f0);
+
+    const AnimTRS A = AnimClip_GetJointAtFrame(c, joint, (uint32_t)f0);
+    const AnimTRS B = AnimClip_GetJointAtFrame(c, joint, (uint32_t)f1);
+
+    out.T[0] = A.T[0] + (B.T[0] - A.T[0]) * a;
+    out.T[1] = A.T[1] + (B.T[1] - A.T[1]) * a;
+    out.T[2] = A.T[2] + (B.T[2] - A.T[2]) * a;
+
+    out.S[0] = A.S[0] + (B.S[0] - A.S[0]) * a;
+    out.S[1] = A.S[1] + (B.S[1] - A.S[1]) * a;
+    out.S[2] = A.S[2] + (B.S[2] - A.S[2]) * a;
+
+    XMVECTOR qA = XMVectorSet(A.R[0], A.R[1], A.R[2], A.R[3]);
+    XMVECTOR qB = XMVectorSet(B.R[0], B.R[1], B.R[2], B.R[3]);
+    XMVECTOR q = XMQuaternionSlerp(qA, qB, a);
+    XMFLOAT4 qf; XMStoreFloat4(&qf, q);
+    out.R[0] = qf.x; out.R[1] = qf.y; out.R[2] = qf.z; out.R[3] = qf.w;
+    return out;
+}
+
+// ---------------------------------------------------------
+// 整姿态采样（SoA + SSE）
+// ---------------------------------------------------------
+
+// a/b：两帧 SoA（各 ANIM_SOA_STREAMS * stride 个 float），按 t 混合写入 out[0..J)
+static void BlendSoA(const float* a, const float* b, uint32_t stride, uint32_t J, float t, AnimTRS* out,
+    const uint8_t* mask)
+{
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 tiny = _mm_set1_ps(1e-30f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (uint32_t j = 0; j < J; j += 4) {
+        if (mask) {
+            // 整组都被省略 → 跳过
+            bool any = false;
+            for (uint32_t i = j; i < j + 4 && i < J; ++i) any |= (mask[i] != 0);
+            if (!any) continue;
+        }
+
+        __m128 v[ANIM_SOA_STREAMS];
+        for (uint32_t k = 0; k < ANIM_SOA_STREAMS; ++k) {
+            v[k] = _mm_loadu_ps(a + k * stride + j);
+        }
+
+        // T / S：lerp
+        for (uint32_t k : { SOA_TX + 0u, SOA_TX + 1u, SOA_TX + 2u, SOA_SX + 0u, SOA_SX + 1u, SOA_SX + 2u }) {
+            const __m128 B = _mm_loadu_ps(b + k * stride + j);
+            v[k] = _mm_add_ps(v[k], _mm_mul_ps(_mm_sub_ps(B, v[k]), vt));
+        }
+
+        // R：dot<0 时翻转 b，lerp 后归一化
+        __m128 bx = _mm_loadu_ps(b + (SOA_RX + 0) * stride + j);
+        __m128 by = _mm_loadu_ps(b + (SOA_RX + 1) * stride + j);
+        __m128 bz = _mm_loadu_ps(b + (SOA_RX + 2) * stride + j);
+        __m128 bw = _mm_loadu_ps(b + (SOA_RX + 3) * stride + j);
+        __m128 ax = v[SOA_RX + 0], ay = v[SOA_RX + 1], az = v[SOA_RX + 2], aw = v[SOA_RX + 3];
+
+        const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                                      _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+        const __m128 sign = _mm_and_ps(dot, signMask);
+        bx = _mm_xor_ps(bx, sign); by = _mm_xor_ps(by, sign);
+        bz = _mm_xor_ps(bz, sign); bw = _mm_xor_ps(bw, sign);
+
+        __m128 rx = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), vt));
+        __m128 ry = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), vt));
+        __m128 rz = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), vt));
+        __m128 rw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), vt));
+        const __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+                                       _mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw)));
+        const __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(len2, tiny)));
+        rx = _mm_mul_ps(rx, inv); ry = _mm_mul_ps(ry, inv);
+        rz = _mm_mul_ps(rz, inv); rw = _mm_mul_ps(rw, inv);
+
+        // SoA → AoS：AnimTRS 正好是 3 个 16 字节（T|pad, R, S|pad）
+        __m128 t0 = v[SOA_TX + 0], t1 = v[SOA_TX + 1], t2 = v[SOA_TX + 2], t3 = zero;
+        __m128 s0 = v[SOA_SX + 0], s1 = v[SOA_SX + 1], s2 = v[SOA_SX + 2], s3 = zero;
+        _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+        _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+
+        AnimTRS tail[4];
+        AnimTRS* dst = (j + 4 <= J) ? out + j : tail;
+        _mm_storeu_ps(dst[0].T, t0); _mm_storeu_ps(dst[0].R, rx); _mm_storeu_ps(dst[0].S, s0);
+        _mm_storeu_ps(dst[1].T, t1); _mm_storeu_ps(dst[1].R, ry); _mm_storeu_ps(dst[1].S, s1);
+        _mm_storeu_ps(dst[2].T, t2); _mm_storeu_ps(dst[2].R, rz); _mm_storeu_ps(dst[2].S, s2);
+        _mm_storeu_ps(dst[3].T, t3); _mm_storeu_ps(dst[3].R, rw); _mm_storeu_ps(dst[3].S, s3);
+        if (dst == tail) {
+            for (uint32_t i = 0; j + i < J; ++i) out[j + i] = tail[i];
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// 重定向
+// ---------------------------------------------------------
+static std::string JointName(const AnimClip& c, uint32_t j)
+{
+    const char* s = c.jointNames + size_t(j) * ANIM_JOINT_NAME_BYTES;
+    return std::string(s, strnlen(s, ANIM_JOINT_NAME_BYTES));
+}
+
+bool AnimClip_BuildRetargetMap(const AnimClip& c, const std::vector<std::string>& targetNames,
+    const AnimTRS* targetBind, AnimRetargetMap& out)
+{
+    out = AnimRetargetMap{};
+    const uint32_t J = (uint32_t)targetNames.size();
+    if (!c.jointNames) return c.jointCount == J;   // 没有名字表：只能按下标
+
+    bool same = (c.jointCount == J);
+    for (uint32_t j = 0; same && j < J; ++j) same = (JointName(c, j) == targetNames[j]);
+    if (same) return true;
+    if (!targetBind) return false;
+
+    out.sourceJoint.assign(J, -1);
+    out.targetBind = targetBind;
+    for (uint32_t s = 0; s < c.jointCount; ++s) {
+        const std::string name = JointName(c, s);
+        for (uint32_t j = 0; j < J; ++j) {
+            if (out.sourceJoint[j] < 0 && targetNames[j] == name) {
+                out.sourceJoint[j] = (int16_t)s;
+                ++out.matched;
+                break;
+            }
+        }
+    }
+    if (out.matched == 0) { out = AnimRetargetMap{}; return false; }
+    return true;
+}
+
+// 目标骨架 SoA 的一帧：按映射从剪辑聚集（v1 直接搬 SoA 里的 10 个通道，v2 解码对应骨骼）
+static void GatherFrame(const AnimClip& c, const AnimRetargetMap& remap, uint32_t frame,
+    float* dst, uint32_t stride, const uint8_t* mask)
+{
+    const uint32_t J = (uint32_t)remap.sourceJoint.size();
+    const float* src = AnimClip_IsCompressed(c) ? nullptr : SoaFrame(c, frame);
+    for (uint32_t j = 0; j < J; ++j) {
+        if (mask && !mask[j]) continue;
+        const int s = remap.sourceJoint[j];
+        if (s < 0) ScatterJoint(dst, stride, j, remap.targetBind[j]);
+        else if (src) {
+            for (uint32_t k = 0; k < ANIM_SOA_STREAMS; ++k) dst[k * stride + j] = src[k * c.soaStride + s];
+        }
+        else ScatterJoint(dst, stride, j, DecodeJoint(c, (uint32_t)s, frame));
+    }
+}
+
+void AnimClip_SamplePose(const AnimClip& c, float tSec, AnimTRS* out, std::vector<float>& scratch,
+    const uint8_t* jointMask, const AnimRetargetMap* remap)
+{
+    if (c.frameCount == 0 || c.jointCount == 0) return;
+
+    const uint32_t last = c.frameCount - 1;
+    const float f = std::max(0.0f, tSec * c.sampleRate);
+    uint32_t f0 = (uint32_t)f;
+    float a = f - float(f0);
+    if (f0 >= last) { f0 = last; a = 0.0f; }
+    const uint32_t f1 = std::min(f0 + 1, last);
+
+    if (remap && !remap->sourceJoint.empty()) {
+        const uint32_t J = (uint32_t)remap->sourceJoint.size();
+        const uint32_t stride = (J + 3u) & ~3u;
+        const size_t frameFloats = size_t(ANIM_SOA_STREAMS) * stride;
+        if (scratch.size() < frameFloats * 2) scratch.assign(frameFloats * 2, 0.0f);
+
+        float* s0 = scratch.data();
+        float* s1 = s0 + frameFloats;
+        GatherFrame(c, *remap, f0, s0, stride, jointMask);
+        if (a > 0.0f) GatherFrame(c, *remap, f1, s1, stride, jointMask);
+        BlendSoA(s0, (a > 0.0f) ? s1 : s0, stride, J, a, out, jointMask);
+        return;
+    }
+
+    if (!AnimClip_IsCompressed(c)) {
+        BlendSoA(SoaFrame(c, f0), SoaFrame(c, f1), c.soaStride, c.jointCount, a, out, jointMask);
+        return;
+    }
+
+    // v2：两帧解码进 SoA 临时区再走同一条混合
+    const uint32_t stride = (c.jointCount + 3u) & ~3u;
+    const size_t frameFloats = size_t(ANIM_SOA_STREAMS) * stride;
+    if (scratch.size() < frameFloats * 2) scratch.assign(frameFloats * 2, 0.0f);
+
+    float* s0 = scratch.data();
+    float* s1 = s0 + frameFloats;
+    for (uint32_t j = 0; j < c.jointCount; ++j) {
+        if (jointMask && !jointMask[j]) continue;
+        ScatterJoint(s0, stride, j, DecodeJoint(c, j, f0));
+        if (a > 0.0f) ScatterJoint(s1, stride, j, DecodeJoint(c, j, f1));
+    }
+    BlendSoA(s0, (a > 0.0f) ? s1 : s0, stride, c.jointCount, a, out, jointMask);
+}
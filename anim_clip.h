@@ -0,0 +1,140 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "asset_format.h"   // AnimTRS / AnimTrackV2
+#include "asset_view.h"
+
+// ---------------------------------------------------------
+// 事件（.anim 'EVNT' 块）：名字去重后用下标引用
+struct AnimClipEvent {
+    float    timeSec;
+    uint32_t nameIndex;       // AnimClip::eventNames 下标
+    float    payload;
+};
+
+// 事件查询结果（name 指向剪辑自己的名字表，剪辑释放前有效）
+struct AnimEventHit {
+    const char* name;
+    float       timeSec;
+    float       payload;
+};
+
+// 动画剪辑（纯 CPU）
+//  - v1：逐帧 TRS，加载时转成 SoA（每帧 10 条 float 流），整姿态采样可直接 SIMD
+//  - v2：压缩流（常量轨道 / smallest-three / 区间量化 / 关键帧删减），
+//        采样时直接从压缩数据解码，不展开成逐帧数组；
+//        压缩数据和根运动曲线都直接指向映射的 .anim（file），不拷进堆
+// ---------------------------------------------------------
+static const uint32_t ANIM_SOA_STREAMS = 10;
+
+struct AnimClip {
+    uint32_t jointCount = 0;
+    float    sampleRate = 30.0f;
+    float    durationSec = 0.0f;
+    uint32_t frameCount = 0;
+
+    // v1：SoA。每帧 ANIM_SOA_STREAMS 条流（Tx Ty Tz Rx Ry Rz Rw Sx Sy Sz），
+    //     每条 soaStride 个 float（jointCount 向上取 4 的倍数，多出的通道填 0）
+    uint32_t           soaStride = 0;
+    std::vector<float> soa;
+
+    // v2：tracks[joint * 3 + channel]（指向 file）
+    const AnimTrackV2* tracks = nullptr;
+    const uint16_t*    keyFrames = nullptr;
+    const uint8_t*     keyData = nullptr;
+    uint32_t           keyFrameCount = 0;
+    uint32_t           keyDataBytes = 0;
+
+    // 根运动曲线（可选，.anim 尾部 'ROOT' 块）：rootMotion[frame * 4 + {tx, ty, tz, yaw}]（指向 file）
+    int32_t            rootMotionJoint = -1;
+    const float*       rootMotion = nullptr;
+
+    // 骨骼名（可选，'JNTS' 块）：jointNames + j * ANIM_JOINT_NAME_BYTES（指向 file）
+    const char*        jointNames = nullptr;
+
+    // 第 0 帧 MotionRoot 的朝向（可选，'META' 块；metaJoint = -1 表示没有）
+    int32_t            metaJoint = -1;
+    float              rootYawLocalF0 = 0.0f;
+    float              rootYawModelF0 = 0.0f;
+
+    // 上面的指针所在的映射（AnimClip_InitFromPoses 建的剪辑为空）
+    AssetViewRef       file;
+
+    // 事件轨道（可选，'EVNT' 块）：按 timeSec 升序
+    std::vector<AnimClipEvent> events;
+    std::vector<std::string>   eventNames;
+};
+
+// 读取 .anim（v1 / v2 自动识别）
+bool AnimClip_Load(const std::wstring& animPath, AnimClip& out);
+// 从已映射的 .anim 解析（asset_stream 解码线程用；纯 CPU，可在任意线程调用）
+bool AnimClip_LoadFromView(const AssetViewRef& file, AnimClip& out);
+
+// 由逐帧姿态（poses[frame * jointCount + joint]）建一个 v1 剪辑
+void AnimClip_InitFromPoses(AnimClip& c, uint32_t jointCount, uint32_t frameCount, float sampleRate, const AnimTRS* poses);
+
+inline bool AnimClip_IsCompressed(const AnimClip& c) { return c.tracks != nullptr; }
+
+// 关键帧数据大小（字节；v2 在映射里）
+size_t AnimClip_MemoryBytes(const AnimClip& c);
+// 剪辑占用的进程堆（字节；v1 的 SoA + 事件表，v2 只有事件表）
+size_t AnimClip_HeapBytes(const AnimClip& c);
+
+// 第 frame 帧的整帧姿态：写入 scratch（长度 >= jointCount）并返回 scratch
+const AnimTRS* AnimClip_GetFramePose(const AnimClip& c, uint32_t frame, AnimTRS* scratch);
+
+// 单个骨骼第 frame 帧的 TRS
+AnimTRS AnimClip_GetJointAtFrame(const AnimClip& c, uint32_t joint, uint32_t frame);
+
+// 单个骨骼任意时间的 TRS（帧间 T/S 线性、R slerp，帧号按循环回绕）
+AnimTRS AnimClip_SampleJoint(const AnimClip& c, uint32_t joint, float tSec);
+
+// —— 根运动 ——
+inline bool AnimClip_HasRootMotion(const AnimClip& c) { return c.rootMotion != nullptr; }
+
+// 曲线在 tSec 的值 {tx, ty, tz, yaw}（帧间线性；tSec 夹到 [0, duration]）
+void AnimClip_SampleRootMotion(const AnimClip& c, float tSec, float out[4]);
+
+// 区间 [t0, t1] 的增量：ΔT（MotionRoot 局部）与 Δyaw（弧度）
+//  loop：每跨过一次终点加一圈的整圈增量（t1 可以越过终点多圈，也可以小于 t0）；否则时间夹到 [0, duration]
+//  没有曲线时返回 false
+bool AnimClip_RootMotionDelta(const AnimClip& c, float t0, float t1, bool loop, float outDeltaT[3], float* outDeltaYaw);
+
+// —— 事件 ——
+// 区间 [t0, t1) 越过的事件，按发生顺序把 events 下标写入 outIdx（最多 maxOut 个），返回个数
+//  二分定位起点：O(log n + k)
+//  loop：t1 越过终点时回绕（可跨多圈）；time == duration 的事件与 0 重合，不单独触发
+//  非 loop：时间夹到 [0, duration]，t1 到达终点时包含 time == duration 的事件
+uint32_t AnimClip_QueryEvents(const AnimClip& c, float t0, float t1, bool loop, uint32_t* outIdx, uint32_t maxOut);
+
+// —— 重定向（按骨骼名把剪辑映射到另一副骨架）——
+// sourceJoint[目标骨骼] = 剪辑骨骼下标；-1 = 剪辑里没有这根骨骼（采样结果取 targetBind）
+// 只依赖（骨架, 剪辑）：由使用方按这一对缓存，所有实例共用；剪辑数据本身不复制
+struct AnimRetargetMap {
+    std::vector<int16_t> sourceJoint;
+    const AnimTRS*       targetBind = nullptr;   // 目标骨架的 bind pose 局部 TRS（jointCount 个，由骨架持有）
+    uint32_t             matched = 0;            // 按名字找到的骨骼数
+};
+
+// 建映射：剪辑与目标骨架同序（名字逐个相同，或剪辑没有名字表但骨骼数相同）时返回 true 且 out 为空（不需要重映射）；
+// 否则按名字匹配，至少匹配到一根骨骼返回 true；剪辑没有名字表又数不对 / 一根都对不上返回 false
+bool AnimClip_BuildRetargetMap(const AnimClip& c, const std::vector<std::string>& targetNames,
+    const AnimTRS* targetBind, AnimRetargetMap& out);
+
+// 目标骨骼 → 剪辑骨骼下标（remap 为 nullptr / 空 = 同序；-1 = 剪辑里没有）
+inline int AnimClip_SourceJoint(const AnimRetargetMap* remap, uint32_t joint)
+{
+    return (remap && !remap->sourceJoint.empty()) ? remap->sourceJoint[joint] : (int)joint;
+}
+
+// 整个姿态在 tSec 的插值：f0/f1 两帧一次混合全部骨骼（SSE，4 骨骼一组）
+//  T/S 线性，R nlerp（符号修正）；tSec 夹到 [0, 最后一帧]，不回绕（循环由调用方把时间折回）
+//  out 长度 >= jointCount；scratch 给 v2 解码用，由调用方持有（各线程各用各的）
+//  jointMask（可选，LOD 用）：mask[j] == 0 的骨骼可以不采样，out[j] 内容不确定，由调用方补上
+//  （v1 按 4 骨骼一组跳过，v2 逐骨骼跳过解码）
+//  remap（可选，重定向）：输出与 jointMask 都按目标骨架排列（长度 = sourceJoint.size()），
+//  两帧按映射聚集（gather）进目标骨架的 SoA 临时区后走同一条混合；v2 只解码用到的剪辑骨骼
+void AnimClip_SamplePose(const AnimClip& c, float tSec, AnimTRS* out, std::vector<float>& scratch,
+    const uint8_t* jointMask = nullptr, const AnimRetargetMap* remap = nullptr);
@@ -0,0 +1,396 @@
+﻿#include "anim_pose.h"
+#include <cstring>
+#include <algorithm>
+#include <cctype>
+#include <Windows.h>
+
+using namespace DirectX;
+
+// ---------------------------------------------------------
+// .skel 读取
+// ---------------------------------------------------------
+bool AnimPose_LoadSkeleton(const std::wstring& skelPath, AnimSkeleton& out, std::vector<std::string>* outNames)
+{
+    // 关节表直接在映射上读，解析完映射随 file 释放
+    AssetViewRef file = AssetView_Open(skelPath);
+    return file && AnimPose_LoadSkeletonFromView(*file, out, outNames);
+}
+
+bool AnimPose_LoadSkeletonFromView(const AssetView& file, AnimSkeleton& out, std::vector<std::string>* outNames)
+{
+    const uint8_t* p = file.data;
+    const uint8_t* e = file.data + file.size;
+    auto need = [&](size_t k) { return (size_t)(e - p) >= k; };
+
+    if (!need(sizeof(FileHeader))) return false;
+    auto fh = (const FileHeader*)p; p += sizeof(FileHeader);
+    if (std::memcmp(fh->magic, "SKEL", 4) != 0) return false;
+
+    if (!need(sizeof(SkeletonHeader))) return false;
+    auto sh = (const SkeletonHeader*)p; p += sizeof(SkeletonHeader);
+
+    const uint32_t J = sh->jointCount;
+    if (!need(sizeof(JointRec) * size_t(J))) return false;
+
+    out.jointCount = J;
+    out.parent.resize(J);
+    out.invBind.resize(J);
+    out.bindLocal.resize(J);
+    if (outNames) outNames->resize(J);
+
+    out.bindLocalFixed = false;
+    out.motionRoot = -1;
+    for (uint32_t i = 0; i < J; ++i) {
+        auto jr = (const JointRec*)p; p += sizeof(JointRec);
+
+        out.parent[i] = jr->parent;
+        // invBind：与之前一致，直接 memcpy 到 XMFLOAT4X4
+        std::memcpy(&out.invBind[i], jr->invBind, sizeof(float) * 16);
+
+        AnimTRS& b = out.bindLocal[i];
+        b = AnimTRS{};
+        std::memcpy(b.T, jr->bindLocalT, sizeof(b.T));
+        std::memcpy(b.R, jr->bindLocalR, sizeof(b.R));
+        std::memcpy(b.S, jr->bindLocalS, sizeof(b.S));
+
+        if (outNames) {
+            const size_t len = strnlen(jr->name, sizeof(jr->name));
+            (*outNames)[i].assign(jr->name, jr->name + len);
+        }
+    }
+
+    // 'SMET'（可选）：cook 阶段修正好的 bindLocal + MotionRoot；块不完整 / 与骨架不符时忽略
+    p = file.data + ((size_t(p - file.data) + 3) & ~size_t(3));
+    if (p < e && need(sizeof(SkelMetaHeader)) && std::memcmp(p, "SMET", 4) == 0) {
+        SkelMetaHeader mh;
+        std::memcpy(&mh, p, sizeof(mh)); p += sizeof(mh);
+        if (mh.jointCount == J && mh.motionRoot < (int32_t)J && need(sizeof(AnimTRS) * size_t(J))) {
+            std::memcpy(out.bindLocal.data(), p, sizeof(AnimTRS) * size_t(J));
+            out.bindLocalFixed = true;
+            out.motionRoot = mh.motionRoot;
+        }
+    }
+
+    return AnimPose_BuildEvalOrder(out);
+}
+
+// ---------------------------------------------------------
+// 拓扑排序：根按下标顺序入队，广度优先展开子节点
+// ---------------------------------------------------------
+bool AnimPose_BuildEvalOrder(AnimSkeleton& s)
+{
+    const uint32_t J = s.jointCount;
+    s.evalOrder.clear();
+    if (J == 0) return true;
+    if (J > 0xFFFFu) return false;
+
+    // 子节点表（CSR）
+    std::vector<uint32_t> childStart(J + 1, 0);
+    for (uint32_t j = 0; j < J; ++j) {
+        const int p = s.parent[j];
+        if (p >= (int)J || p == (int)j) return false;
+        if (p >= 0) ++childStart[p + 1];
+    }
+    for (uint32_t j = 0; j < J; ++j) childStart[j + 1] += childStart[j];
+
+    std::vector<uint16_t> children(childStart[J]);
+    std::vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (uint32_t j = 0; j < J; ++j) {
+        const int p = s.parent[j];
+        if (p >= 0) children[fill[p]++] = (uint16_t)j;
+    }
+
+    s.evalOrder.reserve(J);
+    for (uint32_t j = 0; j < J; ++j)
+        if (s.parent[j] < 0) s.evalOrder.push_back((uint16_t)j);
+
+    for (size_t k = 0; k < s.evalOrder.size(); ++k) {
+        const uint16_t j = s.evalOrder[k];
+        for (uint32_t c = childStart[j]; c < childStart[j + 1]; ++c)
+            s.evalOrder.push_back(children[c]);
+    }
+
+    // 有环的骨骼永远到不了根：数量对不上
+    if (s.evalOrder.size() != J) {
+#if defined(DEBUG) || defined(_DEBUG)
+        OutputDebugStringA("[AnimPose] skeleton has a cycle, eval order incomplete\n");
+#endif
+        s.evalOrder.clear();
+        return false;
+    }
+    return true;
+}
+
+XMMATRIX AnimPose_MakeLocalMatrix(const AnimTRS& t)
+{
+    XMVECTOR T = XMVectorSet(t.T[0], t.T[1], t.T[2], 0.0f);
+    XMVECTOR R = XMVectorSet(t.R[0], t.R[1], t.R[2], t.R[3]);
+    XMVECTOR S = XMVectorSet(t.S[0], t.S[1], t.S[2], 1.0f);
+    return XMMatrixScalingFromVector(S) * XMMatrixRotationQuaternion(R) * XMMatrixTranslationFromVector(T);
+}
+
+// ---------------------------------------------------------
+// 局部 → 模型空间：按 evalOrder 线性一遍，父矩阵必然已算好
+// ---------------------------------------------------------
+void AnimPose_LocalToModel(const AnimSkeleton& s, const AnimTRS* local, XMMATRIX* outModel)
+{
+    const uint16_t* order = s.evalOrder.data();
+    const int* parent = s.parent.data();
+    const size_t J = s.evalOrder.size();
+
+    for (size_t k = 0; k < J; ++k) {
+        const uint16_t j = order[k];
+        const XMMATRIX L = AnimPose_MakeLocalMatrix(local[j]);
+        const int p = parent[j];
+        outModel[j] = (p >= 0) ? L * outModel[p] : L;
+    }
+}
+
+void AnimPose_BuildPalette(const AnimSkeleton& s, const XMMATRIX* model,
+    XMFLOAT4X4* outPalette, uint32_t maxCount)
+{
+    const uint32_t J = std::min(s.jointCount, maxCount);
+    for (uint32_t j = 0; j < J; ++j) {
+        const XMMATRIX invB = XMLoadFloat4x4(&s.invBind[j]);
+        XMStoreFloat4x4(&outPalette[j], XMMatrixTranspose(invB * model[j]));
+    }
+}
+
+// ---------------------------------------------------------
+// bind-pose 修正：用 InvBind 反推 bindLocal（.skel 带 'SMET' 块时已在 cook 阶段算好）
+// ---------------------------------------------------------
+void AnimPose_FixupBindPose(AnimSkeleton& sk)
+{
+    const size_t J = sk.jointCount;
+    if (!J) return;
+
+    // 先用 bindLocal 算出 Bj（局部数组：异步加载时在解码线程上跑）
+    std::vector<XMMATRIX> globals(J);
+    AnimPose_LocalToModel(sk, sk.bindLocal.data(), globals.data());
+
+    // 用平均 MeshGlobalAtBind 统一坐标后回填（略去细节注释，逻辑与之前一致）
+    double sum[16] = { 0 };
+    for (size_t j = 0; j < J; ++j) {
+        XMMATRIX Bj = globals[j];
+        XMMATRIX InvB = XMLoadFloat4x4(&sk.invBind[j]);
+        XMMATRIX Mj = Bj * InvB;
+        XMFLOAT4X4 fm; XMStoreFloat4x4(&fm, Mj);
+        const float* p = &fm._11;
+        for (int k = 0; k < 16; ++k) sum[k] += p[k];
+    }
+    float avg[16]; for (int k = 0; k < 16; ++k) avg[k] = float(sum[k] / double(J));
+    XMFLOAT4X4 favg{}; std::memcpy(&favg._11, avg, sizeof(avg));
+    XMMATRIX MeshGlobalAtBind = XMLoadFloat4x4(&favg);
+
+    std::vector<XMMATRIX> G(J);
+    for (size_t j = 0; j < J; ++j) {
+        XMMATRIX InvBj = XMLoadFloat4x4(&sk.invBind[j]);
+        XMMATRIX Bj = MeshGlobalAtBind * XMMatrixInverse(nullptr, InvBj);
+        G[j] = Bj;
+    }
+    for (size_t j = 0; j < J; ++j) {
+        XMMATRIX parentG = (sk.parent[j] >= 0) ? G[sk.parent[j]] : XMMatrixIdentity();
+        XMMATRIX local = XMMatrixInverse(nullptr, parentG) * G[j];
+        XMVECTOR S, R, T; if (!XMMatrixDecompose(&S, &R, &T, local)) continue;
+        AnimTRS& b = sk.bindLocal[j];
+        XMStoreFloat3((XMFLOAT3*)b.T, T);
+        XMStoreFloat4((XMFLOAT4*)b.R, R);
+        XMStoreFloat3((XMFLOAT3*)b.S, S);
+    }
+    sk.bindLocalFixed = true;
+}
+
+void AnimPose_PaletteToDualQuat(const XMFLOAT4X4* palette, uint32_t count, XMFLOAT4* outDQ)
+{
+    for (uint32_t j = 0; j < count; ++j) {
+        // 调色板存的是转置：转回行向量约定的 invBind * model
+        XMMATRIX M = XMMatrixTranspose(XMLoadFloat4x4(&palette[j]));
+        M.r[0] = XMVector3Normalize(M.r[0]);
+        M.r[1] = XMVector3Normalize(M.r[1]);
+        M.r[2] = XMVector3Normalize(M.r[2]);
+
+        const XMVECTOR q = XMQuaternionNormalize(XMQuaternionRotationMatrix(M));
+        const XMVECTOR t = XMVectorSetW(M.r[3], 0.0f);          // (tx, ty, tz, 0)
+
+        // 对偶部 = 0.5 * t ⊗ q（XMQuaternionMultiply(a, b) = b ⊗ a）
+        const XMVECTOR d = XMVectorScale(XMQuaternionMultiply(q, t), 0.5f);
+        XMStoreFloat4(&outDQ[2 * j + 0], q);
+        XMStoreFloat4(&outDQ[2 * j + 1], d);
+    }
+}
+
+// ---------------------------------------------------------
+// 两姿态混合
+// ---------------------------------------------------------
+static bool EqualsNoCase(const char* a, const char* b)
+{
+    for (; *a && *b; ++a, ++b)
+        if (std::tolower((unsigned char)*a) != std::tolower((unsigned char)*b)) return false;
+    return *a == *b;
+}
+
+AnimBlendCurve AnimPose_ParseBlendCurve(const char* name)
+{
+    if (!name) return AnimBlendCurve::Linear;
+    if (EqualsNoCase(name, "ease_in")) return AnimBlendCurve::EaseIn;
+    if (EqualsNoCase(name, "ease_out")) return AnimBlendCurve::EaseOut;
+    if (EqualsNoCase(name, "ease_in_out")) return AnimBlendCurve::EaseInOut;
+    return AnimBlendCurve::Linear;
+}
+
+float AnimPose_ApplyBlendCurve(AnimBlendCurve curve, float t)
+{
+    t = std::clamp(t, 0.0f, 1.0f);
+    switch (curve) {
+    case AnimBlendCurve::EaseIn:    return t * t;
+    case AnimBlendCurve::EaseOut:   return 1.0f - (1.0f - t) * (1.0f - t);
+    case AnimBlendCurve::EaseInOut: return t * t * (3.0f - 2.0f * t);
+    default:                        return t;
+    }
+}
+
+void AnimPose_Blend(const AnimTRS* a, const AnimTRS* b, float w, uint32_t count, AnimTRS* out)
+{
+    for (uint32_t j = 0; j < count; ++j) {
+        // AnimTRS 的 T/S 后面各有 4 字节 pad：按 float4 读写，pad 保持 0
+        const XMVECTOR ta = XMLoadFloat4((const XMFLOAT4*)a[j].T);
+        const XMVECTOR tb = XMLoadFloat4((const XMFLOAT4*)b[j].T);
+        const XMVECTOR sa = XMLoadFloat4((const XMFLOAT4*)a[j].S);
+        const XMVECTOR sb = XMLoadFloat4((const XMFLOAT4*)b[j].S);
+        const XMVECTOR ra = XMLoadFloat4((const XMFLOAT4*)a[j].R);
+        XMVECTOR rb = XMLoadFloat4((const XMFLOAT4*)b[j].R);
+
+        if (XMVectorGetX(XMVector4Dot(ra, rb)) < 0.0f) rb = XMVectorNegate(rb);
+
+        XMStoreFloat4((XMFLOAT4*)out[j].T, XMVectorLerp(ta, tb, w));
+        XMStoreFloat4((XMFLOAT4*)out[j].S, XMVectorLerp(sa, sb, w));
+        XMStoreFloat4((XMFLOAT4*)out[j].R, XMQuaternionNormalize(XMVectorLerp(ra, rb, w)));
+    }
+}
+
+// ---------------------------------------------------------
+// 动画层
+// ---------------------------------------------------------
+uint32_t AnimPose_BuildSubtreeMask(const AnimSkeleton& s, const std::vector<std::string>& names,
+    const char* const* roots, const float* rootWeights, uint32_t rootCount, std::vector<float>& outWeight)
+{
+    const uint32_t J = s.jointCount;
+    outWeight.assign(J, rootCount == 0 ? 1.0f : 0.0f);
+    if (rootCount == 0) return J;
+
+    uint32_t active = 0;
+    for (uint16_t j : s.evalOrder) {   // 父先于子：先继承父的权重，自己是根时覆盖
+        const int p = s.parent[j];
+        float w = (p >= 0) ? outWeight[p] : 0.0f;
+        if (j < names.size()) {
+            for (uint32_t k = 0; k < rootCount; ++k) {
+                if (roots[k] && names[j] == roots[k]) { w = rootWeights ? rootWeights[k] : 1.0f; break; }
+            }
+        }
+        outWeight[j] = std::clamp(w, 0.0f, 1.0f);
+        if (outWeight[j] > 0.0f) ++active;
+    }
+    return active;
+}
+
+void AnimPose_BlendMasked(AnimTRS* base, const AnimTRS* layer, const float* jointWeight, float weight, uint32_t count)
+{
+    if (weight <= 0.0f) return;
+    for (uint32_t j = 0; j < count; ++j) {
+        const float w = weight * jointWeight[j];
+        if (w <= 0.0f) continue;
+
+        // 与 AnimPose_Blend 相同：T/R/S 各一个 float4（pad 保持 0）
+        const XMVECTOR ta = XMLoadFloat4((const XMFLOAT4*)base[j].T);
+        const XMVECTOR tb = XMLoadFloat4((const XMFLOAT4*)layer[j].T);
+        const XMVECTOR sa = XMLoadFloat4((const XMFLOAT4*)base[j].S);
+        const XMVECTOR sb = XMLoadFloat4((const XMFLOAT4*)layer[j].S);
+        const XMVECTOR ra = XMLoadFloat4((const XMFLOAT4*)base[j].R);
+        XMVECTOR rb = XMLoadFloat4((const XMFLOAT4*)layer[j].R);
+
+        if (XMVectorGetX(XMVector4Dot(ra, rb)) < 0.0f) rb = XMVectorNegate(rb);
+
+        XMStoreFloat4((XMFLOAT4*)base[j].T, XMVectorLerp(ta, tb, w));
+        XMStoreFloat4((XMFLOAT4*)base[j].S, XMVectorLerp(sa, sb, w));
+        XMStoreFloat4((XMFLOAT4*)base[j].R, XMQuaternionNormalize(XMVectorLerp(ra, rb, w)));
+    }
+}
+
+void AnimPose_AddMasked(AnimTRS* base, const AnimTRS* layer, const AnimTRS* reference,
+    const float* jointWeight, float weight, uint32_t count)
+{
+    if (weight <= 0.0f) return;
+    const XMVECTOR qIdentity = XMQuaternionIdentity();
+    for (uint32_t j = 0; j < count; ++j) {
+        const float w = weight * jointWeight[j];
+        if (w <= 0.0f) continue;
+
+        const XMVECTOR wv = XMVectorReplicate(w);
+        const XMVECTOR dT = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)layer[j].T), XMLoadFloat4((const XMFLOAT4*)reference[j].T));
+        const XMVECTOR dS = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)layer[j].S), XMLoadFloat4((const XMFLOAT4*)reference[j].S));
+        XMStoreFloat4((XMFLOAT4*)base[j].T, XMVectorMultiplyAdd(dT, wv, XMLoadFloat4((const XMFLOAT4*)base[j].T)));
+        XMStoreFloat4((XMFLOAT4*)base[j].S, XMVectorMultiplyAdd(dS, wv, XMLoadFloat4((const XMFLOAT4*)base[j].S)));
+
+        // Hamilton 积：差值 d = ref⁻¹ ⊗ layer，结果 = base ⊗ d（XMQuaternionMultiply(a, b) = b ⊗ a）
+        const XMVECTOR rRef = XMLoadFloat4((const XMFLOAT4*)reference[j].R);
+        const XMVECTOR rLayer = XMLoadFloat4((const XMFLOAT4*)layer[j].R);
+        XMVECTOR d = XMQuaternionMultiply(rLayer, XMQuaternionConjugate(rRef));
+        if (XMVectorGetW(d) < 0.0f) d = XMVectorNegate(d);   // 走短弧
+        d = XMQuaternionNormalize(XMVectorLerp(qIdentity, d, w));
+
+        const XMVECTOR rBase = XMLoadFloat4((const XMFLOAT4*)base[j].R);
+        XMStoreFloat4((XMFLOAT4*)base[j].R, XMQuaternionNormalize(XMQuaternionMultiply(d, rBase)));
+    }
+}
+
+// ---------------------------------------------------------
+// 动画 LOD
+// ---------------------------------------------------------
+uint32_t AnimPose_BuildLodJointMask(const AnimSkeleton& s, const std::vector<std::string>& names,
+    const char* const* patterns, uint32_t patternCount, std::vector<uint8_t>& outKeep)
+{
+    // Mixamo 系骨架：手指 4×5×2、眼睛、头发、各末端 _End
+    static const char* kDefault[] = {
+        "Thumb", "Index", "Middle", "Ring", "Pinky", "Eye", "Hair", "_End",
+    };
+    if (!patterns) {
+        patterns = kDefault;
+        patternCount = (uint32_t)(sizeof(kDefault) / sizeof(kDefault[0]));
+    }
+
+    const uint32_t J = s.jointCount;
+    outKeep.assign(J, 1);
+    uint32_t kept = 0;
+    for (uint16_t j : s.evalOrder) {   // 父先于子：父已省略 → 子也省略
+        const int p = s.parent[j];
+        bool drop = (p >= 0 && !outKeep[p]);
+        if (!drop && j < names.size()) {
+            for (uint32_t k = 0; k < patternCount && !drop; ++k)
+                drop = names[j].find(patterns[k]) != std::string::npos;
+        }
+        outKeep[j] = drop ? 0 : 1;
+        kept += outKeep[j];
+    }
+    return kept;
+}
+
+void AnimPose_ApplyBindToMasked(const AnimSkeleton& s, const uint8_t* keep, AnimTRS* pose)
+{
+    for (uint32_t j = 0; j < s.jointCount; ++j)
+        if (!keep[j]) pose[j] = s.bindLocal[j];
+}
+
+void AnimPose_LerpPalette(const XMFLOAT4X4* a, const XMFLOAT4X4* b, float t,
+    uint32_t count, XMFLOAT4X4* out)
+{
+    for (uint32_t j = 0; j < count; ++j) {
+        const XMMATRIX ma = XMLoadFloat4x4(&a[j]);
+        const XMMATRIX mb = XMLoadFloat4x4(&b[j]);
+        XMMATRIX m;
+        m.r[0] = XMVectorLerp(ma.r[0], mb.r[0], t);
+        m.r[1] = XMVectorLerp(ma.r[1], mb.r[1], t);
+        m.r[2] = XMVectorLerp(ma.r[2], mb.r[2], t);
+        m.r[3] = XMVectorLerp(ma.r[3], mb.r[3], t);
+        XMStoreFloat4x4(&out[j], m);
+    }
+}
@@ -0,0 +1,106 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "asset_format.h"   // AnimTRS
+#include "asset_view.h"
+
+// ---------------------------------------------------------
+// 姿态计算（纯 CPU，无 D3D 依赖）
+//  - 骨架以 SoA 存放；evalOrder 为拓扑序（父先于子），
+//    局部→模型空间只需一次线性遍历
+//  - 下标始终是“原始骨骼下标”（与 .mesh BLENDINDICES / .anim 一致）
+// ---------------------------------------------------------
+struct AnimSkeleton {
+    uint32_t                         jointCount = 0;
+    std::vector<int>                 parent;      // -1 = 根
+    std::vector<uint16_t>            evalOrder;   // 拓扑序
+    std::vector<DirectX::XMFLOAT4X4> invBind;     // 行主存储
+    std::vector<AnimTRS>             bindLocal;   // bind pose 局部 TRS
+
+    // .skel 'SMET' 块（cook_tool.py skel-meta）：加载时不用再修正 / 解析
+    bool                             bindLocalFixed = false;   // bindLocal 已经过 AnimPose_FixupBindPose
+    int                              motionRoot = -1;          // 默认策略的 MotionRoot（-1 = 没有预计算）
+};
+
+// 过渡曲线（fsm_player.json 的 "curve"）
+enum class AnimBlendCurve : uint8_t {
+    Linear = 0,
+    EaseIn,
+    EaseOut,
+    EaseInOut,
+};
+
+// 读取 .skel：骨骼名单独输出（不进入热路径）；outNames 可为 nullptr
+bool AnimPose_LoadSkeleton(const std::wstring& skelPath, AnimSkeleton& out, std::vector<std::string>* outNames);
+// 从已映射的 .skel 解析（纯 CPU，可在任意线程调用）
+bool AnimPose_LoadSkeletonFromView(const AssetView& file, AnimSkeleton& out, std::vector<std::string>* outNames);
+
+// 根据 parent 数组建立 evalOrder（加载后调用一次；有环/越界返回 false）
+bool AnimPose_BuildEvalOrder(AnimSkeleton& s);
+
+// bind-pose 修正：由 invBind 反推 bindLocal（统一到平均的 MeshGlobalAtBind），设置 bindLocalFixed
+// 加载时每个模型一次；.skel 带 'SMET' 块时已经做过（bindLocalFixed = true），不用再调
+void AnimPose_FixupBindPose(AnimSkeleton& sk);
+
+// 局部 TRS → 局部矩阵（S * R * T，行向量约定）
+DirectX::XMMATRIX AnimPose_MakeLocalMatrix(const AnimTRS& t);
+
+// 局部姿态 → 模型空间矩阵（outModel 长度 >= jointCount）
+void AnimPose_LocalToModel(const AnimSkeleton& s, const AnimTRS* local, DirectX::XMMATRIX* outModel);
+
+// 调色板：transpose(invBind * model)，写入前 min(jointCount, maxCount) 个
+void AnimPose_BuildPalette(const AnimSkeleton& s, const DirectX::XMMATRIX* model,
+    DirectX::XMFLOAT4X4* outPalette, uint32_t maxCount);
+
+// 双四元数调色板：由（转置的）矩阵调色板转换，每骨骼 2 个 float4
+//  outDQ[2j] = 实部（旋转四元数），outDQ[2j+1] = 对偶部（0.5 * t ⊗ q）
+//  只保留刚体部分：调色板里的缩放会被丢掉
+void AnimPose_PaletteToDualQuat(const DirectX::XMFLOAT4X4* palette, uint32_t count, DirectX::XMFLOAT4* outDQ);
+
+// —— 两姿态混合 ——
+// "linear" / "ease_in" / "ease_out" / "ease_in_out"（大小写不敏感）；未知名或 nullptr → Linear
+AnimBlendCurve AnimPose_ParseBlendCurve(const char* name);
+
+// t ∈ [0,1] → 曲线后的权重（超出范围先夹紧）
+float AnimPose_ApplyBlendCurve(AnimBlendCurve curve, float t);
+
+// out = lerp(a, b, w)：T/S 线性，R nlerp（符号修正）；w=0 → a，w=1 → b
+// 不分配内存；out 可以与 a 或 b 相同
+void AnimPose_Blend(const AnimTRS* a, const AnimTRS* b, float w, uint32_t count, AnimTRS* out);
+
+// —— 动画层（按骨骼子树遮罩）——
+enum class AnimLayerBlend : uint8_t {
+    Override = 0,   // 按权重插值到层姿态
+    Additive,       // 层姿态相对参考姿态的差值按权重叠加到基础姿态
+};
+
+// 按骨骼名子树建逐骨骼权重：roots[k] 及其全部子孙 = rootWeights[k]（子孙继承最近的根；rootWeights 可为 nullptr = 全 1），
+// 其余骨骼 = 0；rootCount = 0 表示全身 = 1。返回权重 > 0 的骨骼数（找不到的名字忽略）
+uint32_t AnimPose_BuildSubtreeMask(const AnimSkeleton& s, const std::vector<std::string>& names,
+    const char* const* roots, const float* rootWeights, uint32_t rootCount, std::vector<float>& outWeight);
+
+// 覆盖层：base[j] = lerp(base[j], layer[j], weight * jointWeight[j])（T/S 线性，R nlerp）
+// 权重为 0 的骨骼不读 layer（采样时可以用遮罩跳过）；就地修改 base
+void AnimPose_BlendMasked(AnimTRS* base, const AnimTRS* layer, const float* jointWeight, float weight, uint32_t count);
+
+// 叠加层：差值 = layer 相对 reference（T/S 相减，R = reference⁻¹ · layer），按 weight * jointWeight[j] 缩放后
+// 叠加到 base（T/S 相加，R = base · nlerp(1, 差值, w)，局部空间）；就地修改 base
+void AnimPose_AddMasked(AnimTRS* base, const AnimTRS* layer, const AnimTRS* reference,
+    const float* jointWeight, float weight, uint32_t count);
+
+// —— 动画 LOD ——
+// 按骨骼名标出远处可省略的末端骨骼（手指 / 眼睛 / 头发 / *_End 等）：outKeep[j] = 1 保留，0 省略
+// patterns：名字子串（大小写敏感）；nullptr 用内置表。被省略骨骼的子孙一并省略
+// 返回保留的骨骼数
+uint32_t AnimPose_BuildLodJointMask(const AnimSkeleton& s, const std::vector<std::string>& names,
+    const char* const* patterns, uint32_t patternCount, std::vector<uint8_t>& outKeep);
+
+// 被省略的骨骼（keep[j] == 0）回到 bind pose
+void AnimPose_ApplyBindToMasked(const AnimSkeleton& s, const uint8_t* keep, AnimTRS* pose);
+
+// 调色板逐元素线性插值（降频更新时在两次完整求值之间用）；out 可以与 a 或 b 相同
+void AnimPose_LerpPalette(const DirectX::XMFLOAT4X4* a, const DirectX::XMFLOAT4X4* b, float t,
+    uint32_t count, DirectX::XMFLOAT4X4* out);
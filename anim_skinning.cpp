@@ -0,0 +1,242 @@
+﻿#include "anim_skinning.h"
+#include "job_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <intrin.h>
+#include <immintrin.h>
+
+using namespace DirectX;
+
+// ---------------------------------------------------------
+// CPU 特性检测
+// ---------------------------------------------------------
+bool AnimSkin_HasAVX2()
+{
+    static int s_has = -1;
+    if (s_has < 0) {
+        int r[4] = {};
+        __cpuidex(r, 1, 0);
+        const bool fma = (r[2] & (1 << 12)) != 0;
+        const bool osxsave = (r[2] & (1 << 27)) != 0;
+        const bool avx = (r[2] & (1 << 28)) != 0;
+        // OS 需要保存 YMM 寄存器（XCR0 的 bit1/bit2）
+        const bool ymm = osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6);
+
+        __cpuidex(r, 7, 0);
+        const bool avx2 = (r[1] & (1 << 5)) != 0;
+        s_has = (ymm && fma && avx2) ? 1 : 0;
+    }
+    return s_has != 0;
+}
+
+// ---------------------------------------------------------
+// 参考实现（与 HLSL 一一对应）
+// palette[j] 已转置：第 r 行 = 行向量约定下矩阵的第 r 列 → out.x = dot(row0, (p,1))
+// ---------------------------------------------------------
+void AnimSkin_Scalar(const SkinnedVertexV1* verts, uint32_t count,
+    const XMFLOAT4X4* palette, uint32_t boneCount,
+    XMFLOAT3* outPos, XMFLOAT3* outNrm)
+{
+    if (boneCount == 0) return;
+    for (uint32_t i = 0; i < count; ++i) {
+        const SkinnedVertexV1& v = verts[i];
+        const float wsum = std::max(1e-6f,
+            float(v.boneW[0] + v.boneW[1] + v.boneW[2] + v.boneW[3]) * (1.0f / 255.0f));
+
+        float p[3] = {}, n[3] = {};
+        for (int k = 0; k < 4; ++k) {
+            if (v.boneW[k] == 0) continue;
+            const float w = float(v.boneW[k]) * (1.0f / 255.0f) / wsum;
+            const XMFLOAT4X4& M = palette[std::min<uint32_t>(v.boneIdx[k], boneCount - 1)];
+            for (int r = 0; r < 3; ++r) {
+                p[r] += w * (M.m[r][0] * v.pos[0] + M.m[r][1] * v.pos[1] + M.m[r][2] * v.pos[2] + M.m[r][3]);
+                n[r] += w * (M.m[r][0] * v.nrm[0] + M.m[r][1] * v.nrm[1] + M.m[r][2] * v.nrm[2]);
+            }
+        }
+        outPos[i] = XMFLOAT3(p[0], p[1], p[2]);
+        if (outNrm) {
+            const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            const float inv = (len > 1e-12f) ? 1.0f / len : 0.0f;
+            outNrm[i] = XMFLOAT3(n[0] * inv, n[1] * inv, n[2] * inv);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// AVX2：8 个顶点一组
+//  1) 顶点按 56 字节跨度 gather 成 SoA
+//  2) 每个影响：用骨骼下标 gather 调色板的 12 个分量，按权重 FMA 累加出混合矩阵
+//  3) 混合矩阵变换位置 / 法线（与 HLSL 一样，先混合后变换结果相同）
+// ---------------------------------------------------------
+void AnimSkin_AVX2(const SkinnedVertexV1* verts, uint32_t count,
+    const XMFLOAT4X4* palette, uint32_t boneCount,
+    XMFLOAT3* outPos, XMFLOAT3* outNrm)
+{
+    if (boneCount == 0) return;
+
+    const uint32_t full = count & ~7u;
+    const float* pal = &palette[0].m[0][0];
+    const int kStride = int(sizeof(SkinnedVertexV1) / sizeof(float)); // 14
+
+    const __m256i vOffs = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(kStride));
+    const __m256i maxBone = _mm256_set1_epi32(int(boneCount) - 1);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256 inv255 = _mm256_set1_ps(1.0f / 255.0f);
+    const __m256 eps = _mm256_set1_ps(1e-6f);
+    const __m256 tiny = _mm256_set1_ps(1e-24f);
+
+    // SkinnedVertexV1 内的 float 偏移
+    const int kPos = 0, kNrm = 3, kIdx = 12, kW = 13;
+
+    for (uint32_t base = 0; base < full; base += 8) {
+        const float* vb = reinterpret_cast<const float*>(verts + base);
+
+        const __m256 px = _mm256_i32gather_ps(vb + kPos + 0, vOffs, 4);
+        const __m256 py = _mm256_i32gather_ps(vb + kPos + 1, vOffs, 4);
+        const __m256 pz = _mm256_i32gather_ps(vb + kPos + 2, vOffs, 4);
+        const __m256 nx = _mm256_i32gather_ps(vb + kNrm + 0, vOffs, 4);
+        const __m256 ny = _mm256_i32gather_ps(vb + kNrm + 1, vOffs, 4);
+        const __m256 nz = _mm256_i32gather_ps(vb + kNrm + 2, vOffs, 4);
+        const __m256i idx4 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(vb + kIdx), vOffs, 4);
+        const __m256i w4 = _mm256_i32gather_epi32(reinterpret_cast<const int*>(vb + kW), vOffs, 4);
+
+        // 权重 u8×4 → float，按和归一化
+        __m256 w[4];
+        for (int k = 0; k < 4; ++k)
+            w[k] = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(w4, 8 * k), byteMask)), inv255);
+        const __m256 wsum = _mm256_max_ps(eps, _mm256_add_ps(_mm256_add_ps(w[0], w[1]), _mm256_add_ps(w[2], w[3])));
+        const __m256 winv = _mm256_div_ps(_mm256_set1_ps(1.0f), wsum);
+
+        // 混合矩阵（转置调色板的前三行，12 个分量）
+        __m256 M[12];
+        for (int c = 0; c < 12; ++c) M[c] = _mm256_setzero_ps();
+        for (int k = 0; k < 4; ++k) {
+            const __m256 wk = _mm256_mul_ps(w[k], winv);
+            if (_mm256_movemask_ps(_mm256_cmp_ps(wk, _mm256_setzero_ps(), _CMP_GT_OQ)) == 0) continue;
+
+            __m256i bone = _mm256_and_si256(_mm256_srli_epi32(idx4, 8 * k), byteMask);
+            bone = _mm256_min_epi32(bone, maxBone);
+            const __m256i off = _mm256_slli_epi32(bone, 4);   // × 16 float
+            for (int c = 0; c < 12; ++c)
+                M[c] = _mm256_fmadd_ps(_mm256_i32gather_ps(pal + c, off, 4), wk, M[c]);
+        }
+
+        // 位置：out_r = M[r][0..2]·p + M[r][3]；法线：M[r][0..2]·n
+        __m256 op[3], on[3];
+        for (int r = 0; r < 3; ++r) {
+            const __m256* R = M + r * 4;
+            op[r] = _mm256_fmadd_ps(R[0], px, _mm256_fmadd_ps(R[1], py, _mm256_fmadd_ps(R[2], pz, R[3])));
+            on[r] = _mm256_fmadd_ps(R[0], nx, _mm256_fmadd_ps(R[1], ny, _mm256_mul_ps(R[2], nz)));
+        }
+
+        // SoA → XMFLOAT3
+        alignas(32) float sx[8], sy[8], sz[8];
+        _mm256_store_ps(sx, op[0]); _mm256_store_ps(sy, op[1]); _mm256_store_ps(sz, op[2]);
+        for (int i = 0; i < 8; ++i) outPos[base + i] = XMFLOAT3(sx[i], sy[i], sz[i]);
+
+        if (outNrm) {
+            const __m256 len2 = _mm256_fmadd_ps(on[0], on[0], _mm256_fmadd_ps(on[1], on[1], _mm256_mul_ps(on[2], on[2])));
+            const __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(_mm256_max_ps(len2, tiny)));
+            _mm256_store_ps(sx, _mm256_mul_ps(on[0], inv));
+            _mm256_store_ps(sy, _mm256_mul_ps(on[1], inv));
+            _mm256_store_ps(sz, _mm256_mul_ps(on[2], inv));
+            for (int i = 0; i < 8; ++i) outNrm[base + i] = XMFLOAT3(sx[i], sy[i], sz[i]);
+        }
+    }
+
+    // 尾部不足 8 个
+    if (full < count)
+        AnimSkin_Scalar(verts + full, count - full, palette, boneCount,
+            outPos + full, outNrm ? outNrm + full : nullptr);
+}
+
+// ---------------------------------------------------------
+// 双四元数（DLB）
+// ---------------------------------------------------------
+static inline void Cross3(const float a[3], const float b[3], float out[3])
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void AnimSkin_DualQuatScalar(const SkinnedVertexV1* verts, uint32_t count,
+    const XMFLOAT4* dq, uint32_t boneCount,
+    XMFLOAT3* outPos, XMFLOAT3* outNrm)
+{
+    if (boneCount == 0) return;
+    for (uint32_t i = 0; i < count; ++i) {
+        const SkinnedVertexV1& v = verts[i];
+        const float wsum = std::max(1e-6f,
+            float(v.boneW[0] + v.boneW[1] + v.boneW[2] + v.boneW[3]) * (1.0f / 255.0f));
+
+        const XMFLOAT4* first = &dq[2 * std::min<uint32_t>(v.boneIdx[0], boneCount - 1)];
+        float r[4] = {}, d[4] = {};
+        for (int k = 0; k < 4; ++k) {
+            float w = float(v.boneW[k]) * (1.0f / 255.0f) / wsum;
+            const XMFLOAT4* b = &dq[2 * std::min<uint32_t>(v.boneIdx[k], boneCount - 1)];
+            if (first->x * b->x + first->y * b->y + first->z * b->z + first->w * b->w < 0.0f) w = -w;
+            r[0] += w * b[0].x; r[1] += w * b[0].y; r[2] += w * b[0].z; r[3] += w * b[0].w;
+            d[0] += w * b[1].x; d[1] += w * b[1].y; d[2] += w * b[1].z; d[3] += w * b[1].w;
+        }
+        const float len = std::max(1e-8f, std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]));
+        for (int k = 0; k < 4; ++k) { r[k] /= len; d[k] /= len; }
+
+        // t = 2 (r.w d.xyz - d.w r.xyz + r.xyz × d.xyz)
+        float rxd[3]; Cross3(r, d, rxd);
+        const float t[3] = {
+            2.0f * (r[3] * d[0] - d[3] * r[0] + rxd[0]),
+            2.0f * (r[3] * d[1] - d[3] * r[1] + rxd[1]),
+            2.0f * (r[3] * d[2] - d[3] * r[2] + rxd[2]),
+        };
+
+        // 旋转：v + 2 r.xyz × (r.xyz × v + r.w v)
+        auto rotate = [&](const float in[3], float out[3]) {
+            float c[3]; Cross3(r, in, c);
+            for (int k = 0; k < 3; ++k) c[k] += r[3] * in[k];
+            float c2[3]; Cross3(r, c, c2);
+            for (int k = 0; k < 3; ++k) out[k] = in[k] + 2.0f * c2[k];
+        };
+
+        float p[3];
+        rotate(v.pos, p);
+        outPos[i] = XMFLOAT3(p[0] + t[0], p[1] + t[1], p[2] + t[2]);
+        if (outNrm) {
+            float n[3];
+            rotate(v.nrm, n);
+            const float nl = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            const float inv = (nl > 1e-12f) ? 1.0f / nl : 0.0f;
+            outNrm[i] = XMFLOAT3(n[0] * inv, n[1] * inv, n[2] * inv);
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// 并行
+// ---------------------------------------------------------
+void AnimSkin_Run(AnimSkinPath path, const SkinnedVertexV1* verts, uint32_t count,
+    const XMFLOAT4X4* palette, uint32_t boneCount,
+    XMFLOAT3* outPos, XMFLOAT3* outNrm, uint32_t maxThreads)
+{
+    const bool avx2 = (path == AnimSkinPath::AVX2) && AnimSkin_HasAVX2();
+
+    // 8 的倍数切块：AVX2 每块内部不产生尾部
+    JobPool_ParallelFor((count + 7) / 8, 256, [&](uint32_t begin, uint32_t end, uint32_t) {
+        const uint32_t v0 = begin * 8;
+        const uint32_t n = std::min(end * 8, count) - v0;
+        XMFLOAT3* nrm = outNrm ? outNrm + v0 : nullptr;
+        if (avx2) AnimSkin_AVX2(verts + v0, n, palette, boneCount, outPos + v0, nrm);
+        else      AnimSkin_Scalar(verts + v0, n, palette, boneCount, outPos + v0, nrm);
+        }, maxThreads);
+}
+
+void AnimSkin_RunDualQuat(const SkinnedVertexV1* verts, uint32_t count,
+    const XMFLOAT4* dq, uint32_t boneCount,
+    XMFLOAT3* outPos, XMFLOAT3* outNrm, uint32_t maxThreads)
+{
+    JobPool_ParallelFor(count, 2048, [&](uint32_t begin, uint32_t end, uint32_t) {
+        AnimSkin_DualQuatScalar(verts + begin, end - begin, dq, boneCount,
+            outPos + begin, outNrm ? outNrm + begin : nullptr);
+        }, maxThreads);
+}
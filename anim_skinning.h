@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <cstdint>
+#include <DirectXMath.h>
+
+#include "asset_format.h"   // SkinnedVertexV1
+
+// ---------------------------------------------------------
+// CPU 蒙皮（纯 CPU，与 shader_vertex_skinned_3d.hlsl 同一算法）
+//  - 输入：v1 顶点（56 字节）+ 与 b5 相同的转置调色板（AnimPose_BuildPalette 的输出）
+//  - 输出：模型空间位置 / 单位法线
+//  - 用途：校验 GPU 结果、CPU 侧的蒙皮包围盒 / 射线检测、吞吐基准
+// 权重先按和归一化；骨骼下标夹到 [0, boneCount)
+// ---------------------------------------------------------
+enum class AnimSkinPath : uint8_t {
+    Scalar = 0,   // 参考实现
+    AVX2,         // 8 顶点一组（gather + FMA）
+};
+
+// CPU 与 OS 是否支持 AVX2 + FMA（第一次调用时检测）
+bool AnimSkin_HasAVX2();
+
+// 单线程；outNrm 可为 nullptr（只要位置）
+void AnimSkin_Scalar(const SkinnedVertexV1* verts, uint32_t count,
+    const DirectX::XMFLOAT4X4* palette, uint32_t boneCount,
+    DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm);
+void AnimSkin_AVX2(const SkinnedVertexV1* verts, uint32_t count,
+    const DirectX::XMFLOAT4X4* palette, uint32_t boneCount,
+    DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm);
+
+// 按顶点区间在 JobPool 上并行；path 不支持时退回 Scalar
+//  maxThreads = 0：不限制
+void AnimSkin_Run(AnimSkinPath path, const SkinnedVertexV1* verts, uint32_t count,
+    const DirectX::XMFLOAT4X4* palette, uint32_t boneCount,
+    DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm, uint32_t maxThreads = 0);
+
+// —— 双四元数蒙皮（参考实现，与 shader_vertex_skinned_dq_3d.hlsl 同一算法）——
+// dq：每骨骼 2 个 float4（AnimPose_PaletteToDualQuat 的输出）；DLB 混合（与第一个影响对齐符号后归一化）
+void AnimSkin_DualQuatScalar(const SkinnedVertexV1* verts, uint32_t count,
+    const DirectX::XMFLOAT4* dq, uint32_t boneCount,
+    DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm);
+void AnimSkin_RunDualQuat(const SkinnedVertexV1* verts, uint32_t count,
+    const DirectX::XMFLOAT4* dq, uint32_t boneCount,
+    DirectX::XMFLOAT3* outPos, DirectX::XMFLOAT3* outNrm, uint32_t maxThreads = 0);
+
+// 能用就用 AVX2
+inline AnimSkinPath AnimSkin_BestPath() { return AnimSkin_HasAVX2() ? AnimSkinPath::AVX2 : AnimSkinPath::Scalar; }
@@ -5,6 +5,12 @@ void AnimRegister()
 {
     AnimatorRegistry_Clear();
 
+    // 玩家的几个动作共用一套 mesh/skel/mat：常驻缓存按路径区分，路径相同才只加载一份模型；
+    // 剪辑按骨骼名重定向到这套骨架（各动作导出的 .skel 骨骼名 / 父子 / invBind 都一致）
+    const wchar_t* kPlayerMesh = L"resources/player_anim/cooked/player_move.mesh";
+    const wchar_t* kPlayerSkel = L"resources/player_anim/cooked/player_move.skel";
+    const wchar_t* kPlayerMat  = L"resources/player_anim/cooked/player_move.mat";
+
     // 例1：Idle（完全用动画，循环）
     {
         AnimClipDesc c{};
@@ -16,10 +22,10 @@ void AnimRegister()
         //// 如需强制贴图（覆盖 .mat）：
         //c.baseColorOverride = L"D:/AssetCooker/resources/test/ninja_T.fbm/Ch24_1001_Diffuse.png";
 
-        c.meshPath = L"resources/player_anim/cooked/player_idle_test.mesh";
-        c.skelPath = L"resources/player_anim/cooked/player_idle_test.skel";
+        c.meshPath = kPlayerMesh;
+        c.skelPath = kPlayerSkel;
         c.animPath = L"resources/player_anim/cooked/player_idle_test.anim";
-        c.matPath =  L"resources/player_anim/cooked/player_idle_test.mat";
+        c.matPath =  kPlayerMat;
         // 如需强制贴图（覆盖 .mat）：
         c.baseColorOverride = L"resources/player_anim/cooked/Textures/Mutant_diffuse.png";
 
@@ -35,10 +41,10 @@ void AnimRegister()
     {
         AnimClipDesc c{};
         c.name = L"Walk";
-        c.meshPath = L"resources/player_anim/cooked/player_move.mesh";
-        c.skelPath = L"resources/player_anim/cooked/player_move.skel";
+        c.meshPath = kPlayerMesh;
+        c.skelPath = kPlayerSkel;
         c.animPath = L"resources/player_anim/cooked/player_move.anim";
-        c.matPath =  L"resources/player_anim/cooked/player_move.mat";
+        c.matPath =  kPlayerMat;
         // 如需强制贴图（覆盖 .mat）：
         c.baseColorOverride = L"resources/player_anim/cooked/Textures/Mutant_diffuse.png";
         c.loop = true;
@@ -53,10 +59,10 @@ void AnimRegister()
     {
         AnimClipDesc c{};
         c.name = L"Attack";
-        c.meshPath = L"resources/player_anim/cooked/player_attack.mesh";
-        c.skelPath = L"resources/player_anim/cooked/player_attack.skel";
+        c.meshPath = kPlayerMesh;
+        c.skelPath = kPlayerSkel;
         c.animPath = L"resources/player_anim/cooked/player_attack.anim";
-        c.matPath =  L"resources/player_anim/cooked/player_attack.mat";
+        c.matPath =  kPlayerMat;
         // 如需强制贴图（覆盖 .mat）：
         c.baseColorOverride = L"resources/player_anim/cooked/Textures/Mutant_diffuse.png";
         c.loop = false;
@@ -71,6 +77,6 @@ void AnimRegister()
     }
 
 
-    // 注册完可（可选）调用一次加载校验
-    AnimatorRegistry_LoadAll();
+    // 注册完在后台预加载（低优先级）；先要播放的动作会被提到高优先级
+    AnimatorRegistry_LoadAllAsync(AssetStreamPriority::Low);
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
-﻿// ====== 通用 ======
+﻿#pragma once
+#include <cstdint>
+
+// ====== 通用 ======
 struct FileHeader {
     char     magic[4];    // 'MESH' / 'MATL' / 'SKEL' / 'ANIM'
     uint32_t version;     // 0x00010000
@@ -11,6 +14,8 @@ struct AABB { float minv[3]; float maxv[3]; };
 enum MeshFlags : uint32_t {
     HAS_TANGENT = 1u << 0,
     HAS_SKIN = 1u << 1,   // <<< 新增：网格含骨权重
+    HAS_BONE_PALETTES = 1u << 2,   // 已按骨骼数拆分：boneIdx 是子网格内的局部下标（见 MeshBonePalette）
+    HAS_LODS = 1u << 3,   // 每个子网格带 lodCount 档索引区间（见 MeshLodRange）
 };
 
 // ====== 网格（v0/v1 兼容）======
@@ -24,8 +29,50 @@ struct MeshHeader {
     AABB     bounds;
     // v1 追加：若 HAS_SKIN，便于 sanity check
     uint32_t jointCount;       // = skeleton joint 数；v0 可为 0
-    uint32_t _pad0[3];
+    uint32_t lodCount;         // HAS_LODS：每个子网格的档数（含 LOD0）；否则 0
+    uint32_t _pad0[2];
+};
+
+// v1 蒙皮顶点（56 字节；与 shader_vertex_skinned_3d.hlsl 的输入布局一致）
+struct SkinnedVertexV1 {
+    float   pos[3];
+    float   nrm[3];
+    float   tangent[4];
+    float   uv[2];
+    uint8_t boneIdx[4];    // R8G8B8A8_UINT
+    uint8_t boneW[4];      // R8G8B8A8_UNORM
+};
+static_assert(sizeof(SkinnedVertexV1) == 56, "SkinnedVertexV1 must match the 56-byte v1 layout");
+
+// ====== 网格：.mesh v2（压缩顶点；cook_tool.py mesh-quantize 生成）======
+// FileHeader.version = MESH_VERSION_V2，其余布局（索引 / Submesh / 调色板表）与 v1 相同
+//  pos     : uint16 x3，在 MeshHeader::bounds 内量化：q = round((p - minv) / (maxv - minv) * 65535)
+//            第 4 个分量存切线手性（0 → -1，65535 → +1），整体按 R16G16B16A16_UNORM 读
+//  nrm/tan : 八面体编码的单位向量，int16 x2（R16G16_SNORM）
+//  uv      : half x2（R16G16_FLOAT）
+// 解码：MeshQuant_*（mesh_quant.h）与 shader_vertex_skinned_q_3d.hlsl 一致
+static const uint32_t MESH_VERSION_V1 = 0x00010000;
+static const uint32_t MESH_VERSION_V2 = 0x00020000;
+
+// v2 静态顶点（20 字节；v0 为 48）
+struct MeshVertexV2 {
+    uint16_t pos[4];
+    int16_t  nrm[2];
+    int16_t  tangent[2];
+    uint16_t uv[2];
 };
+static_assert(sizeof(MeshVertexV2) == 20, "MeshVertexV2 must match the 20-byte v2 layout");
+
+// v2 蒙皮顶点（28 字节；v1 为 56）
+struct SkinnedVertexV2 {
+    uint16_t pos[4];
+    int16_t  nrm[2];
+    int16_t  tangent[2];
+    uint16_t uv[2];
+    uint8_t  boneIdx[4];   // R8G8B8A8_UINT
+    uint8_t  boneW[4];     // R8G8B8A8_UNORM
+};
+static_assert(sizeof(SkinnedVertexV2) == 28, "SkinnedVertexV2 must match the 28-byte v2 layout");
 
 struct Submesh {
     uint32_t indexOffset;
@@ -34,6 +81,38 @@ struct Submesh {
     AABB     bounds;
 };
 
+// ====== 骨骼调色板拆分（flags & HAS_BONE_PALETTES；cook_tool.py mesh-split 生成）======
+// 布局：... | Submesh[submeshCount] | MeshBonePaletteHeader | MeshBonePalette[submeshCount]
+//       | uint16 boneIndex[boneIndexCount]（补齐到 4 字节）
+// 每个子网格只引用 boneCount（<= maxBonesPerSubmesh）个骨骼，顶点的 boneIdx 是这张表里的下标：
+//   全局骨骼 = boneIndex[boneOffset + boneIdx]
+// 子网格的顶点连续存放在 [vertexOffset, vertexOffset + vertexCount)（跨子网格共用的顶点已复制）
+struct MeshBonePaletteHeader {
+    uint32_t maxBonesPerSubmesh;
+    uint32_t boneIndexCount;
+    uint32_t _pad[2];
+};
+
+struct MeshBonePalette {
+    uint32_t boneOffset;
+    uint32_t boneCount;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+};
+
+// ====== 网格 LOD（flags & HAS_LODS；cook_tool.py mesh-lod 生成）======
+// 布局：... | Submesh[] | [调色板表] | 补齐到 4 字节 | MeshLodRange[submeshCount][lodCount]
+// 所有档共用一个 VB（简化只删三角形、不加顶点）；索引缓冲 = LOD0（即 Submesh 的区间）+ 其后各档
+// indexCount 含全部档；拆分过的网格每档仍只引用本子网格调色板的顶点区间
+static const uint32_t MESH_MAX_LODS = 4;
+
+struct MeshLodRange {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    float    error;            // 相对 LOD0 的几何误差（模型空间距离，二次误差度量的平方根；LOD0 = 0）
+    uint32_t _pad;
+};
+
 // ====== 材质（与旧版一致）======
 struct MaterialHeader { uint32_t materialCount; };
 
@@ -65,6 +144,17 @@ struct JointRec {
     float   bindLocalS[3];  uint32_t _pad1;
 };
 
+// —— 'SMET' 预计算元数据（.skel 尾部可选块；cook_tool.py skel-meta 生成）——
+// 布局：JointRec[] 之后补齐到 4 字节 | SkelMetaHeader | AnimTRS bindLocal[jointCount]
+//  bindLocal ：bind-pose 修正后的局部 TRS（= AnimPose_FixupBindPose 的结果），加载时直接替换 JointRec 里的值
+//  motionRoot：默认策略（常见别名 → 第一个根）解析出的 MotionRoot 下标
+struct SkelMetaHeader {
+    char     magic[4];        // 'SMET'
+    uint32_t jointCount;      // = SkeletonHeader::jointCount
+    int32_t  motionRoot;
+    uint32_t _pad;
+};
+
 // ====== 动画：.anim（逐帧姿势版本，简单可用）======
 struct AnimHeader {
     uint32_t jointCount;
@@ -78,4 +168,123 @@ struct AnimTRS {
     float R[4];                 // quaternion (x,y,z,w)
     float S[3];  uint32_t _pad1;
 };
-// 紧随其后：AnimTRS pose[frameCount][jointCount]
\ No newline at end of file
+// 紧随其后：AnimTRS pose[frameCount][jointCount]
+// ====== 动画：.anim v2（压缩版）======
+// FileHeader.version = ANIM_VERSION_V2
+// 布局：FileHeader | AnimHeaderV2 | AnimTrackV2[jointCount * 3]
+//       | uint16 keyFrames[keyFrameCount]（补齐到 4 字节）| uint8 keyData[keyDataBytes]
+// 轨道顺序：joint0 的 T,R,S，joint1 的 T,R,S ...
+static const uint32_t ANIM_VERSION_V1 = 0x00010000;
+static const uint32_t ANIM_VERSION_V2 = 0x00020001;   // .1：T/S 量化区间移进 keyData，轨道表 16 字节
+
+enum AnimChannel : uint32_t {
+    ANIM_CH_T = 0,
+    ANIM_CH_R = 1,
+    ANIM_CH_S = 2,
+    ANIM_CH_COUNT = 3,
+};
+
+enum AnimTrackFlags : uint32_t {
+    ANIM_TRACK_CONSTANT = 1u << 0,   // 整条轨道只有一个值
+};
+
+struct AnimHeaderV2 {
+    uint32_t jointCount;
+    float    durationSec;
+    float    sampleRate;
+    uint32_t frameCount;
+    uint32_t keyFrameCount;   // keyFrames[] 总数
+    uint32_t keyDataBytes;
+    uint32_t _pad[2];
+};
+
+struct AnimTrackV2 {
+    uint32_t flags;           // AnimTrackFlags
+    uint32_t keyCount;        // 常量轨道 = 1
+    uint32_t keyFrameOffset;  // 在 keyFrames[] 中的起始下标（升序帧号；首尾帧必在其中；关键帧相同的轨道可共用）
+    uint32_t keyDataOffset;   // 在 keyData[] 中的字节偏移（4 字节对齐）
+};
+// keyData：
+//  常量轨道：T/S = float[3]，R = float[4]（x,y,z,w）
+//  动画轨道：T/S 先是 float rangeMin[3], rangeExt[3]（量化区间，只有这类轨道需要），之后每个 key 3 x uint16；
+//            R 直接是每个 key 3 x uint16
+//    T/S：v = rangeMin + q / 65535 * rangeExt
+//    R  ：smallest-three。w0、w1 的最高位拼成最大分量下标（w0 为高位），
+//         三个低 15 位依次为其余分量 c：q = (c + 1/√2) / √2 * 32767；最大分量取正
+// 关键帧之间：T/S 线性插值，R nlerp（符号修正）
+
+// ====== 动画：尾部可选块（.anim v1/v2）======
+// 正文之后依次排列，每块以 4 字符 magic 开头、从文件头起 4 字节对齐；FileHeader.byteSize 包含全部块
+// 不认识的 magic 之后的内容忽略
+
+// —— 'ROOT' 根运动曲线（cook_tool.py root-motion 生成）——
+// 布局：AnimRootMotionHeader | float samples[frameCount * 4]
+//  每帧 (tx, ty, tz, yaw)：MotionRoot 局部平移；yaw = 局部朝向（+Z 绕 Y）相对第 0 帧的累计角，
+//  逐帧展开（不在 ±π 处回绕），区间查询只需要两次查表相减
+struct AnimRootMotionHeader {
+    char     magic[4];        // 'ROOT'
+    uint32_t jointIndex;      // 提取时的 MotionRoot 骨骼下标
+    uint32_t frameCount;      // = 剪辑 frameCount
+    uint32_t _pad;
+    char     jointName[64];   // UTF-8
+};
+
+// —— 'EVNT' 事件轨道（cook_tool.py anim-events 生成）——
+// 布局：AnimEventHeader | AnimEventRec[eventCount]（按 timeSec 升序）| char names[nameBytes]（补齐到 4 字节）
+//  names：UTF-8，'\0' 结尾，AnimEventRec.nameOffset 为字节偏移（同名事件共用一份）
+struct AnimEventHeader {
+    char     magic[4];        // 'EVNT'
+    uint32_t eventCount;
+    uint32_t nameBytes;
+    uint32_t _pad;
+};
+
+struct AnimEventRec {
+    float    timeSec;         // [0, durationSec]
+    uint32_t nameOffset;
+    float    payload;         // 自定义数值（脚步左右 / 伤害倍率等）
+    uint32_t _pad;
+};
+
+// —— 'JNTS' 骨骼名（cook_tool.py anim-joints 生成）——
+// 布局：AnimJointNamesHeader | char names[jointCount][64]（UTF-8，与 JointRec.name 相同）
+//  剪辑导出时所用骨架的骨骼名，按剪辑骨骼下标排列；运行时按名字把剪辑映射到别的骨架（重定向）
+struct AnimJointNamesHeader {
+    char     magic[4];        // 'JNTS'
+    uint32_t jointCount;      // = 剪辑 jointCount
+    uint32_t _pad[2];
+};
+static const uint32_t ANIM_JOINT_NAME_BYTES = 64;
+
+// —— 'META' 第 0 帧的预计算值（cook_tool.py anim-meta 生成）——
+// 在剪辑导出时所用的骨架（同名 .skel）上算好；运行时只在骨架同序（不重定向）且 MotionRoot 相同时直接用
+struct AnimMetaHeader {
+    char     magic[4];        // 'META'
+    uint32_t jointIndex;      // 计算时的 MotionRoot 骨骼下标
+    float    rootYawLocal;    // 第 0 帧 MotionRoot 的局部朝向（+Z 绕 Y，同 'ROOT'）
+    float    rootYawModel;    // 第 0 帧 MotionRoot 的模型空间朝向
+};
+
+// ====== 资源包：.pak（cook_tool.py pack 生成）======
+// 布局：FileHeader{'PACK', PACK_VERSION} | PackHeader | PackEntry[entryCount]（按 pathHash 升序）
+//       | 数据块（每块从文件头起按 alignment 对齐；内容相同的文件只存一份，条目共用 offset）
+// pathHash   ：规范化路径（'\\' → '/'，ASCII 转小写，去掉开头的 "./"）的 UTF-8 字节做 FNV-1a 64
+//              路径与运行时传给加载函数的一致（相对工作目录，如 resources/player_anim/cooked/idle.mesh）
+// contentHash：文件内容的 FNV-1a 64（打包时去重用）
+static const uint32_t PACK_VERSION = 0x00010000;
+static const uint64_t PACK_FNV_OFFSET = 0xCBF29CE484222325ull;
+static const uint64_t PACK_FNV_PRIME = 0x00000100000001B3ull;
+
+struct PackHeader {
+    uint32_t entryCount;
+    uint32_t blobCount;       // 去重后的数据块数
+    uint32_t alignment;       // 2 的幂，>= 16
+    uint32_t _pad;
+};
+
+struct PackEntry {
+    uint64_t pathHash;
+    uint64_t contentHash;
+    uint64_t offset;          // 从文件头起
+    uint64_t size;
+};
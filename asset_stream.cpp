@@ -0,0 +1,267 @@
+﻿#include "asset_stream.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// ---------------------------------------------------------
+// 状态
+// ---------------------------------------------------------
+struct StreamRequest {
+    AssetStreamHandle         id = 0;
+    AssetStreamPriority       priority = AssetStreamPriority::Normal;
+    uint64_t                  seq = 0;          // 同优先级先来先做
+    AssetStreamState          state = AssetStreamState::Queued;
+    bool                      cancelled = false;
+    bool                      decodedOk = false;
+    std::vector<std::wstring> paths;
+    std::vector<AssetViewRef> views;
+    AssetStreamDecodeFn       decode;
+    AssetStreamFinishFn       finish;
+};
+using RequestPtr = std::shared_ptr<StreamRequest>;
+
+static std::mutex               gMutex;         // 保护下面全部（回调本身不在锁内执行）
+static std::condition_variable  gIOWake;
+static std::condition_variable  gDecodeWake;
+static std::thread              gIOThread;
+static std::vector<std::thread> gDecodeThreads;
+static bool                     gRunning = false;
+static bool                     gQuit = false;
+
+static std::vector<RequestPtr>  gIOQueue;       // 等 IO
+static std::vector<RequestPtr>  gDecodeQueue;   // 已映射，等解码
+static std::vector<RequestPtr>  gDone;          // 已解码 / 已取消，等主线程收尾
+static std::unordered_map<AssetStreamHandle, RequestPtr> gRequests;   // 还没收尾的
+static std::unordered_map<AssetStreamHandle, AssetStreamState> gFinished;   // 收尾后只留最终状态
+static AssetStreamHandle        gNextId = 1;
+static uint64_t                 gNextSeq = 0;
+
+// ---------------------------------------------------------
+// 小工具
+// ---------------------------------------------------------
+static bool Before(const RequestPtr& a, const RequestPtr& b)
+{
+    if (a->priority != b->priority) return a->priority > b->priority;
+    return a->seq < b->seq;
+}
+
+// 队列很短（几十个以内），线性找最高优先级即可；优先级可以在排队中途改
+static RequestPtr PopBest(std::vector<RequestPtr>& q)
+{
+    auto it = std::min_element(q.begin(), q.end(), Before);
+    RequestPtr r = std::move(*it);
+    *it = std::move(q.back());
+    q.pop_back();
+    return r;
+}
+
+// 每页读一个字节：缺页在 IO 线程上发生，解码线程 / 主线程拿到的是已调入的页面
+static void TouchPages(const AssetView& v)
+{
+    const size_t kPage = 4096;
+    uint8_t sum = 0;
+    for (size_t off = 0; off < v.size; off += kPage) sum ^= v.data[off];
+    volatile uint8_t sink = sum;
+    (void)sink;
+}
+
+static void ReadViews(StreamRequest& r)
+{
+    r.views.resize(r.paths.size());
+    for (size_t i = 0; i < r.paths.size(); ++i) {
+        if (r.paths[i].empty()) continue;
+        r.views[i] = AssetView_Open(r.paths[i]);
+        if (r.views[i]) TouchPages(*r.views[i]);
+    }
+}
+
+static void Decode(StreamRequest& r)
+{
+    r.decodedOk = r.decode ? r.decode(r.views.data(), (uint32_t)r.views.size()) : true;
+}
+
+static AssetStreamState FinalState(const StreamRequest& r)
+{
+    if (r.cancelled) return AssetStreamState::Cancelled;
+    return r.decodedOk ? AssetStreamState::Ready : AssetStreamState::Failed;
+}
+
+// ---------------------------------------------------------
+// 线程
+// ---------------------------------------------------------
+static void IOThreadMain()
+{
+    for (;;) {
+        RequestPtr r;
+        {
+            std::unique_lock<std::mutex> lk(gMutex);
+            gIOWake.wait(lk, [] { return gQuit || !gIOQueue.empty(); });
+            if (gQuit) return;
+            r = PopBest(gIOQueue);
+            r->state = AssetStreamState::Loading;
+        }
+
+        ReadViews(*r);
+
+        std::lock_guard<std::mutex> lk(gMutex);
+        if (r->cancelled) {
+            gDone.push_back(std::move(r));
+        }
+        else {
+            gDecodeQueue.push_back(std::move(r));
+            gDecodeWake.notify_one();
+        }
+    }
+}
+
+static void DecodeThreadMain()
+{
+    for (;;) {
+        RequestPtr r;
+        {
+            std::unique_lock<std::mutex> lk(gMutex);
+            gDecodeWake.wait(lk, [] { return gQuit || !gDecodeQueue.empty(); });
+            if (gQuit) return;
+            r = PopBest(gDecodeQueue);
+            if (r->cancelled) { gDone.push_back(std::move(r)); continue; }
+        }
+
+        Decode(*r);
+
+        std::lock_guard<std::mutex> lk(gMutex);
+        gDone.push_back(std::move(r));
+    }
+}
+
+// ---------------------------------------------------------
+// 对外
+// ---------------------------------------------------------
+bool AssetStream_Initialize(uint32_t decodeThreads)
+{
+    if (gRunning) return true;
+    if (decodeThreads == 0) decodeThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    gQuit = false;
+    gIOThread = std::thread(IOThreadMain);
+    for (uint32_t i = 0; i < decodeThreads; ++i) gDecodeThreads.emplace_back(DecodeThreadMain);
+    gRunning = true;
+    return true;
+}
+
+void AssetStream_Finalize()
+{
+    if (!gRunning) return;
+    {
+        std::lock_guard<std::mutex> lk(gMutex);
+        gQuit = true;
+    }
+    gIOWake.notify_all();
+    gDecodeWake.notify_all();
+    gIOThread.join();
+    for (auto& t : gDecodeThreads) t.join();
+    gDecodeThreads.clear();
+
+    gIOQueue.clear();
+    gDecodeQueue.clear();
+    gDone.clear();
+    gRequests.clear();
+    gFinished.clear();
+    gRunning = false;
+    gQuit = false;
+}
+
+AssetStreamHandle AssetStream_Request(const std::vector<std::wstring>& paths, AssetStreamPriority priority,
+    AssetStreamDecodeFn decode, AssetStreamFinishFn finish)
+{
+    auto r = std::make_shared<StreamRequest>();
+    r->priority = priority;
+    r->paths = paths;
+    r->decode = std::move(decode);
+    r->finish = std::move(finish);
+
+    if (!gRunning) {
+        // 同步：映射 → 解码 → 收尾，返回时已经是最终状态
+        r->id = gNextId++;
+        gRequests[r->id] = r;
+        ReadViews(*r);
+        Decode(*r);
+        const AssetStreamState s = FinalState(*r);
+        if (r->finish) r->finish(s);
+        gRequests.erase(r->id);
+        gFinished[r->id] = s;
+        return r->id;
+    }
+
+    std::lock_guard<std::mutex> lk(gMutex);
+    r->id = gNextId++;
+    r->seq = gNextSeq++;
+    gRequests[r->id] = r;
+    gIOQueue.push_back(r);
+    gIOWake.notify_one();
+    return r->id;
+}
+
+bool AssetStream_Cancel(AssetStreamHandle h)
+{
+    std::lock_guard<std::mutex> lk(gMutex);
+    auto it = gRequests.find(h);
+    if (it == gRequests.end()) return false;
+    StreamRequest& r = *it->second;
+    if (r.state != AssetStreamState::Queued && r.state != AssetStreamState::Loading) return false;
+    if (r.cancelled) return true;
+    r.cancelled = true;
+
+    auto q = std::find(gIOQueue.begin(), gIOQueue.end(), it->second);
+    if (q != gIOQueue.end()) {
+        gDone.push_back(*q);
+        gIOQueue.erase(q);
+    }
+    return true;
+}
+
+void AssetStream_SetPriority(AssetStreamHandle h, AssetStreamPriority priority)
+{
+    std::lock_guard<std::mutex> lk(gMutex);
+    auto it = gRequests.find(h);
+    if (it != gRequests.end()) it->second->priority = priority;
+}
+
+AssetStreamState AssetStream_GetState(AssetStreamHandle h)
+{
+    std::lock_guard<std::mutex> lk(gMutex);
+    auto it = gRequests.find(h);
+    if (it != gRequests.end()) return it->second->state;
+    auto f = gFinished.find(h);
+    return (f != gFinished.end()) ? f->second : AssetStreamState::None;
+}
+
+uint32_t AssetStream_Update(uint32_t maxFinish)
+{
+    std::vector<RequestPtr> batch;
+    {
+        std::lock_guard<std::mutex> lk(gMutex);
+        if (gDone.empty()) return 0;
+        std::sort(gDone.begin(), gDone.end(), Before);
+        const size_t n = (maxFinish == 0) ? gDone.size() : std::min<size_t>(maxFinish, gDone.size());
+        batch.assign(gDone.begin(), gDone.begin() + n);
+        gDone.erase(gDone.begin(), gDone.begin() + n);
+    }
+
+    for (RequestPtr& r : batch) {
+        AssetStreamState s;
+        {
+            std::lock_guard<std::mutex> lk(gMutex);
+            s = FinalState(*r);
+        }
+        if (r->finish) r->finish(s);
+
+        // 请求本身（路径 / 映射 / 回调）到此释放，句柄只留最终状态
+        std::lock_guard<std::mutex> lk(gMutex);
+        gRequests.erase(r->id);
+        gFinished[r->id] = s;
+    }
+    return (uint32_t)batch.size();
+}
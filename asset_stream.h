@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "asset_view.h"
+
+// ---------------------------------------------------------
+// 异步资源流式加载
+//  - 1 条 IO 线程：按优先级取请求，映射文件（asset_view，含 .pak）并预读页面
+//  - N 条解码线程：在映射上跑 decode 回调（纯 CPU：解析 / 修正 / 建表）
+//  - 主线程：AssetStream_Update（每帧一次，帧边界）按优先级调 finish 回调，
+//    GPU 资源统一在这里创建，游戏逻辑看到的状态只在帧边界变化
+//  - 未初始化时 Request 在调用线程上同步走完三步（工具 / 基准测试用）
+// ---------------------------------------------------------
+enum class AssetStreamPriority : uint8_t {
+    Low = 0,       // 预加载
+    Normal,
+    High,          // 马上要用（Play 等着的资源）
+    Critical,
+};
+
+enum class AssetStreamState : uint8_t {
+    None = 0,      // 无效句柄
+    Queued,        // 等 IO
+    Loading,       // 映射 / 解码中，或等主线程收尾
+    Ready,
+    Failed,
+    Cancelled,
+};
+
+using AssetStreamHandle = uint32_t;   // 0 = 无效
+
+// decode：解码线程上调用；views 与 paths 平行（空路径 / 打不开的文件为 nullptr），返回是否成功
+// finish：主线程上调用且只调一次，参数为最终状态 Ready / Failed / Cancelled（取消的请求也会收到，便于清理）
+using AssetStreamDecodeFn = std::function<bool(const AssetViewRef* views, uint32_t count)>;
+using AssetStreamFinishFn = std::function<void(AssetStreamState state)>;
+
+// decodeThreads = 0：硬件线程数的一半（至少 1）
+bool AssetStream_Initialize(uint32_t decodeThreads = 0);
+// 等待正在解码的请求结束后停线程；还没收尾的请求直接丢弃（不再调 finish）
+void AssetStream_Finalize();
+
+AssetStreamHandle AssetStream_Request(const std::vector<std::wstring>& paths, AssetStreamPriority priority,
+    AssetStreamDecodeFn decode, AssetStreamFinishFn finish);
+
+// 取消：还没解码的直接出队，解码中的丢弃结果；finish 在下一次 Update 以 Cancelled 调用
+bool AssetStream_Cancel(AssetStreamHandle h);
+// 调整排队中请求的优先级（预加载的资源突然要用时提到 High）
+void AssetStream_SetPriority(AssetStreamHandle h, AssetStreamPriority priority);
+// 轮询：finish 跑完之后才会变成 Ready / Failed / Cancelled
+AssetStreamState AssetStream_GetState(AssetStreamHandle h);
+
+// 帧边界调用：收尾已解码的请求（优先级高的先）；maxFinish = 0 不限个数，返回收尾的个数
+uint32_t AssetStream_Update(uint32_t maxFinish = 0);
@@ -0,0 +1,177 @@
+﻿#include "asset_view.h"
+#include "asset_format.h"   // PackHeader / PackEntry
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------------------------------------------------------
+// 映射 / 解除
+//  文件句柄和映射对象在 MapViewOfFile / mmap 之后就可以关掉，视图自己保持映射
+// ---------------------------------------------------------
+#ifdef _WIN32
+
+static AssetViewRef MapFile(const std::wstring& path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return nullptr;
+
+    const void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!p) return nullptr;
+
+    auto v = std::make_shared<AssetView>();
+    v->data = (const uint8_t*)p;
+    v->size = size_t(size.QuadPart);
+    return v;
+}
+
+AssetView::~AssetView()
+{
+    if (data && !pack) UnmapViewOfFile(data);
+}
+
+#else
+
+static AssetViewRef MapFile(const std::wstring& path)
+{
+    const int fd = open(std::filesystem::path(path).c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return nullptr;
+
+    auto v = std::make_shared<AssetView>();
+    v->data = (const uint8_t*)p;
+    v->size = size_t(st.st_size);
+    return v;
+}
+
+AssetView::~AssetView()
+{
+    if (data && !pack) munmap((void*)data, size);
+}
+
+#endif
+
+// ---------------------------------------------------------
+// 资源包
+// ---------------------------------------------------------
+struct MountedPack {
+    AssetViewRef     file;
+    const PackEntry* entries = nullptr;   // 按 pathHash 升序（指向映射）
+    uint32_t         entryCount = 0;
+};
+static std::vector<MountedPack> gPacks;
+
+// 规范化（'\\' → '/'，ASCII 小写，去掉开头的 "./"）后按 UTF-8 做 FNV-1a 64
+uint64_t AssetPack_HashPath(const std::wstring& path)
+{
+    size_t i = 0;
+    while (i + 1 < path.size() && path[i] == L'.' && (path[i + 1] == L'/' || path[i + 1] == L'\\')) i += 2;
+
+    uint64_t h = PACK_FNV_OFFSET;
+    auto put = [&](uint32_t b) { h = (h ^ uint8_t(b)) * PACK_FNV_PRIME; };
+    for (; i < path.size(); ++i) {
+        uint32_t c = uint32_t(path[i]);
+        if (c >= 0xD800 && c < 0xDC00 && i + 1 < path.size()) {   // UTF-16 代理对
+            const uint32_t lo = uint32_t(path[i + 1]);
+            if (lo >= 0xDC00 && lo < 0xE000) { c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00); ++i; }
+        }
+        if (c == L'\\') c = L'/';
+        else if (c >= L'A' && c <= L'Z') c += L'a' - L'A';
+
+        if (c < 0x80) put(c);
+        else if (c < 0x800) { put(0xC0 | (c >> 6)); put(0x80 | (c & 0x3F)); }
+        else if (c < 0x10000) { put(0xE0 | (c >> 12)); put(0x80 | ((c >> 6) & 0x3F)); put(0x80 | (c & 0x3F)); }
+        else { put(0xF0 | (c >> 18)); put(0x80 | ((c >> 12) & 0x3F)); put(0x80 | ((c >> 6) & 0x3F)); put(0x80 | (c & 0x3F)); }
+    }
+    return h;
+}
+
+bool AssetPack_Mount(const std::wstring& pakPath)
+{
+    AssetViewRef file = MapFile(pakPath);
+    if (!file) return false;
+
+    const uint8_t* p = file->data;
+    const size_t n = file->size;
+    if (n < sizeof(FileHeader) + sizeof(PackHeader)) return false;
+
+    FileHeader fh{};
+    PackHeader ph{};
+    std::memcpy(&fh, p, sizeof(fh));
+    std::memcpy(&ph, p + sizeof(fh), sizeof(ph));
+    if (std::memcmp(fh.magic, "PACK", 4) != 0 || fh.version != PACK_VERSION) return false;
+
+    const size_t tocOffset = sizeof(FileHeader) + sizeof(PackHeader);
+    if ((n - tocOffset) / sizeof(PackEntry) < ph.entryCount) return false;
+    const PackEntry* entries = (const PackEntry*)(p + tocOffset);
+
+    // 越界 / 顺序检查：之后查表不再检查
+    for (uint32_t i = 0; i < ph.entryCount; ++i) {
+        const PackEntry& e = entries[i];
+        if (e.offset > n || e.size > n - e.offset) return false;
+        if (i > 0 && !(entries[i - 1].pathHash < e.pathHash)) return false;
+    }
+
+    MountedPack mp;
+    mp.file = std::move(file);
+    mp.entries = entries;
+    mp.entryCount = ph.entryCount;
+    gPacks.push_back(std::move(mp));
+    return true;
+}
+
+void AssetPack_UnmountAll()
+{
+    gPacks.clear();
+}
+
+AssetViewRef AssetView_Open(const std::wstring& path)
+{
+    if (!gPacks.empty()) {
+        const uint64_t h = AssetPack_HashPath(path);
+        for (auto it = gPacks.rbegin(); it != gPacks.rend(); ++it) {
+            const PackEntry* first = it->entries;
+            const PackEntry* last = first + it->entryCount;
+            const PackEntry* e = std::lower_bound(first, last, h,
+                [](const PackEntry& pe, uint64_t key) { return pe.pathHash < key; });
+            if (e == last || e->pathHash != h || e->size == 0) continue;
+
+            auto v = std::make_shared<AssetView>();
+            v->data = it->file->data + e->offset;
+            v->size = size_t(e->size);
+            v->pack = it->file;
+            return v;
+        }
+    }
+    return MapFile(path);
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// ---------------------------------------------------------
+// 只读内存映射（Win32 文件映射 / POSIX mmap）
+//  - cooked 资源（.mesh/.skel/.anim）直接在映射上解析，头和数据原地使用，不再读进堆
+//  - 映射的生命周期由 shared_ptr 管理：谁还指着里面的数据，谁就持有一份引用
+//  - 页面按需调入，常驻的是系统页缓存而不是进程堆
+// ---------------------------------------------------------
+struct AssetView {
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+    std::shared_ptr<const AssetView> pack;   // 包内文件：所在 .pak 的映射（data 指向其中，不单独解除映射）
+
+    AssetView() = default;
+    AssetView(const AssetView&) = delete;
+    AssetView& operator=(const AssetView&) = delete;
+    ~AssetView();
+};
+
+using AssetViewRef = std::shared_ptr<const AssetView>;
+
+// 打开资源：先按路径在已挂载的包里找（后挂载的优先），找不到再映射散文件
+// 打不开 / 空文件返回 nullptr
+AssetViewRef AssetView_Open(const std::wstring& path);
+
+// —— 资源包（cook_tool.py pack）——
+// 整个包只映射一次，包内文件都是它的子视图（一次打开，没有逐文件的 open / seek）
+// 挂载 / 卸载只在主线程、没有加载进行中时调用；卸载后已打开的视图仍然有效
+bool AssetPack_Mount(const std::wstring& pakPath);
+void AssetPack_UnmountAll();
+
+// 包内路径的哈希（与 cook_tool.py 一致，见 asset_format.h）
+uint64_t AssetPack_HashPath(const std::wstring& path);
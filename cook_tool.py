@@ -0,0 +1,1969 @@
+﻿"""
+资源后处理工具（AssetCooker 输出的 .mesh/.skel/.anim 再加工）
+
+用法：
+    python cook_tool.py anim-compress <in.anim> [<in.anim> ...] [--out-dir DIR] [--skel X.skel]
+        .anim v1（逐帧 TRS）→ v2（压缩），输出压缩率与误差
+        --skel 省略时自动找同名 .skel，用于统计模型空间误差
+    python cook_tool.py mesh-split <in.mesh> [<in.mesh> ...] [--out-dir DIR] [--max-bones N]
+        蒙皮 .mesh 按骨骼数拆分子网格（每个子网格 <= N 个骨骼 + 局部骨骼下标表），
+        运行时每个子网格只上传自己用到的那段调色板
+    python cook_tool.py mesh-quantize <in.mesh> [<in.mesh> ...] [--out-dir DIR]
+        .mesh v1（float 顶点）→ v2（压缩顶点：bounds 内 16 位位置 / 八面体法线切线 / half UV），
+        蒙皮顶点 56 → 28 字节、静态顶点 48 → 20 字节，输出各分量的最大误差；
+        请在 mesh-split 之后执行（拆分只处理 v1）
+    python cook_tool.py mesh-optimize <in.mesh> [<in.mesh> ...] [--out-dir DIR] [--cache K]
+        顶点焊接（按位置分格比较属性）/ 骨骼权重裁剪排序 / Tipsify 顶点缓存重排 /
+        overdraw 簇排序 / 取顶点顺序重编号，输出前后的 ACMR / ATVR；
+        v1 / v2、拆分过的网格都可以（只在子网格 / 调色板顶点区间内部重排）
+    python cook_tool.py mesh-analyze <file|dir> [...] [--cache K]
+        不写文件：报告每个 .mesh 现在的 ACMR / ATVR，以及 mesh-optimize 之后的值
+    python cook_tool.py mesh-lod <in.mesh> [<in.mesh> ...] [--out-dir DIR] [--ratios 0.5,0.25,0.125]
+        二次误差简化：每个子网格追加 LOD1..N 的索引区间（共用 VB），输出各档三角形数与误差；
+        顺序：mesh-split → mesh-optimize → mesh-lod → mesh-quantize
+    python cook_tool.py root-motion <in.anim> [<in.anim> ...] [--out-dir DIR] [--skel X.skel] [--root NAME]
+        在 .anim v1 尾部写入 MotionRoot 的根运动曲线（局部平移 + 展开的 yaw），
+        运行时 [t, t+dt] 的根位移只需两次查表；请在 anim-compress 之前执行（压缩会原样带上该块）
+    python cook_tool.py anim-events <in.anim> [<in.anim> ...] [--out-dir DIR] [--events X.json]
+        把事件表（JSON）写入 .anim 的事件轨道（v1 / v2 都可以；替换已有的事件轨道）
+        --events 省略时找同名 .events.json；格式：
+        {"events": [{"name": "Hit", "time": 0.9, "payload": 1.0}, {"name": "Recover", "norm": 0.9}]}
+        时间三选一：time（秒）/ frame（帧号）/ norm（0..1，乘剪辑时长）
+    python cook_tool.py anim-joints <in.anim> [<in.anim> ...] [--out-dir DIR] [--skel X.skel]
+        把导出时所用骨架的骨骼名写入 .anim（v1 / v2；替换已有的名字表），
+        运行时按名字把剪辑重定向到别的骨架（骨骼数 / 顺序不同也能播放）
+    python cook_tool.py skel-meta <in.skel> [<in.skel> ...] [--out-dir DIR]
+        在 .skel 尾部写入预计算块：bind-pose 修正后的局部 TRS（运行时 AnimPose_FixupBindPose 的结果）
+        与默认策略的 MotionRoot 下标，加载时不再做 J 次求逆 / 分解
+    python cook_tool.py anim-meta <in.anim> [<in.anim> ...] [--out-dir DIR] [--skel X.skel] [--root NAME]
+        在 .anim 尾部写入第 0 帧 MotionRoot 的局部 / 模型空间 yaw（v1 / v2；替换已有的块），
+        Play 时的入场对齐不再求整帧姿态
+    python cook_tool.py pack <file|dir> [...] -o OUT.pak [--root DIR] [--align N] [--ext .mesh,.skel,.anim,.mat]
+        把 cooked 资源打成一个 .pak（TOC + 对齐的数据块；内容相同的文件只存一份）
+        包内路径 = 相对 --root（默认当前目录）的路径，须与运行时传给加载函数的路径一致
+
+格式定义见 asset_format.h，运行时解码见 anim_clip.cpp / mesh_quant.cpp（两边算法必须一致）
+"""
+import argparse
+import json
+import math
+import os
+import struct
+import sys
+
+# ---------------------------------------------------------
+# 常量（与 asset_format.h 一致）
+# ---------------------------------------------------------
+ANIM_VERSION_V1 = 0x00010000
+ANIM_VERSION_V2 = 0x00020001
+
+ANIM_CH_T, ANIM_CH_R, ANIM_CH_S = 0, 1, 2
+ANIM_TRACK_CONSTANT = 1
+
+MESH_VERSION_V1 = 0x00010000
+MESH_VERSION_V2 = 0x00020000
+
+HAS_SKIN = 1 << 1
+HAS_BONE_PALETTES = 1 << 2
+HAS_LODS = 1 << 3
+MESH_MAX_LODS = 4
+MAX_BONES = 128               # ModelSkinned.cpp / shader_vertex_skinned_*.hlsl 的 b5 容量
+
+INV_SQRT2 = 0.70710678118654752
+
+FILE_HEADER = struct.Struct('<4sIII')
+ANIM_HEADER_V1 = struct.Struct('<IffI')
+ANIM_TRS = struct.Struct('<3fI4f3fI')
+ANIM_HEADER_V2 = struct.Struct('<IffIII2I')
+ANIM_TRACK_V2 = struct.Struct('<IIII')
+ANIM_TRACK_RANGE = struct.Struct('<3f3f')   # 动画 T/S 轨道 keyData 开头的量化区间
+SKEL_HEADER = struct.Struct('<I3I')
+JOINT_REC = struct.Struct('<64si16f3fI4f3fI')
+ROOT_MOTION_HEADER = struct.Struct('<4sIII64s')
+ANIM_EVENT_HEADER = struct.Struct('<4sIII')
+ANIM_EVENT_REC = struct.Struct('<fIfI')
+ANIM_JOINT_NAMES_HEADER = struct.Struct('<4sI2I')
+ANIM_JOINT_NAME_BYTES = 64
+ANIM_META_HEADER = struct.Struct('<4sIff')
+SKEL_META_HEADER = struct.Struct('<4sIiI')
+MESH_HEADER = struct.Struct('<5I6fI3I')
+SUBMESH = struct.Struct('<3I6f')
+SKINNED_VERTEX_V1 = struct.Struct('<3f3f4f2f4B4B')
+MESH_VERTEX_V0 = struct.Struct('<3f3f4f2f')
+SKINNED_VERTEX_V2 = struct.Struct('<4H2h2h2e4B4B')
+MESH_VERTEX_V2 = struct.Struct('<4H2h2h2e')
+MESH_BONE_PALETTE_HEADER = struct.Struct('<II2I')
+MESH_BONE_PALETTE = struct.Struct('<4I')
+MESH_LOD_RANGE = struct.Struct('<IIfI')
+PACK_VERSION = 0x00010000
+PACK_HEADER = struct.Struct('<4I')
+PACK_ENTRY = struct.Struct('<4Q')
+FNV_OFFSET = 0xCBF29CE484222325
+FNV_PRIME = 0x00000100000001B3
+
+
+# ---------------------------------------------------------
+# 读取
+# ---------------------------------------------------------
+def read_anim_v1(path):
+    b = open(path, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'ANIM' or ver != ANIM_VERSION_V1:
+        raise ValueError(f'{path}: not a v1 .anim')
+    J, dur, rate, F = ANIM_HEADER_V1.unpack_from(b, FILE_HEADER.size)
+    off = FILE_HEADER.size + ANIM_HEADER_V1.size
+    frames = []
+    for f in range(F):
+        pose = []
+        for j in range(J):
+            v = ANIM_TRS.unpack_from(b, off + ANIM_TRS.size * (f * J + j))
+            pose.append((v[0:3], v[4:8], v[8:11]))
+        frames.append(pose)
+    body_end = off + ANIM_TRS.size * F * J
+    return {'J': J, 'dur': dur, 'rate': rate, 'F': F, 'frames': frames, 'bytes': len(b),
+            'body': b[:body_end], 'chunks': read_anim_chunks(b, body_end)}
+
+
+def anim_body_end(b):
+    """.anim v1 / v2 正文（不含尾部可选块）的结束位置"""
+    ver = FILE_HEADER.unpack_from(b, 0)[1]
+    off = FILE_HEADER.size
+    if ver == ANIM_VERSION_V2:
+        J, _, _, _, kf_count, kd_bytes, _, _ = ANIM_HEADER_V2.unpack_from(b, off)
+        return (off + ANIM_HEADER_V2.size + ANIM_TRACK_V2.size * J * 3
+                + ((kf_count * 2 + 3) & ~3) + kd_bytes)
+    J, _, _, F = ANIM_HEADER_V1.unpack_from(b, off)
+    return off + ANIM_HEADER_V1.size + ANIM_TRS.size * F * J
+
+
+def read_anim_chunks(b, body_end):
+    """正文之后的可选块：[(magic, 原样字节)]，顺序与文件一致（与 anim_clip.cpp LoadTrailingChunks 一致）"""
+    chunks = []
+    off = body_end
+    while True:
+        off = (off + 3) & ~3
+        magic = b[off:off + 4]
+        if magic == b'ROOT' and off + ROOT_MOTION_HEADER.size <= len(b):
+            size = ROOT_MOTION_HEADER.size + ROOT_MOTION_HEADER.unpack_from(b, off)[2] * 16
+        elif magic == b'EVNT' and off + ANIM_EVENT_HEADER.size <= len(b):
+            _, count, name_bytes, _ = ANIM_EVENT_HEADER.unpack_from(b, off)
+            size = ANIM_EVENT_HEADER.size + ANIM_EVENT_REC.size * count + name_bytes
+        elif magic == b'JNTS' and off + ANIM_JOINT_NAMES_HEADER.size <= len(b):
+            size = ANIM_JOINT_NAMES_HEADER.size + ANIM_JOINT_NAMES_HEADER.unpack_from(b, off)[1] * ANIM_JOINT_NAME_BYTES
+        elif magic == b'META' and off + ANIM_META_HEADER.size <= len(b):
+            size = ANIM_META_HEADER.size
+        else:
+            return chunks
+        chunks.append((magic, b[off:off + size]))
+        off += size
+
+
+def write_anim_with_chunks(dst, body, chunks):
+    """正文 + 可选块（各自 4 字节对齐），并改写 FileHeader.byteSize；返回总字节数"""
+    out = bytearray(body)
+    for _, data in chunks:
+        while len(out) % 4:
+            out.append(0)
+        out += data
+    while len(out) % 4:
+        out.append(0)
+    struct.pack_into('<I', out, 8, len(out))
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+    return len(out)
+
+
+def read_mesh_v1(path):
+    b = open(path, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'MESH':
+        raise ValueError(f'{path}: not a .mesh')
+    h = MESH_HEADER.unpack_from(b, FILE_HEADER.size)
+    vcount, icount, stride, scount, flags = h[0:5]
+    if ver == MESH_VERSION_V2:
+        raise ValueError(f'{path}: already quantized (run mesh-split before mesh-quantize)')
+    if not (flags & HAS_SKIN) or stride != SKINNED_VERTEX_V1.size:
+        raise ValueError(f'{path}: not a skinned v1 mesh (flags={flags:#x}, stride={stride})')
+    if flags & HAS_BONE_PALETTES:
+        raise ValueError(f'{path}: already split')
+    if flags & HAS_LODS:
+        raise ValueError(f'{path}: has LODs (run mesh-split before mesh-lod)')
+    off = FILE_HEADER.size + MESH_HEADER.size
+    verts = [list(SKINNED_VERTEX_V1.unpack_from(b, off + stride * i)) for i in range(vcount)]
+    off += stride * vcount
+    # 与运行时一致：顶点数 > 65535 才用 32 位索引
+    fmt = 'I' if vcount > 65535 else 'H'
+    indices = list(struct.unpack_from(f'<{icount}{fmt}', b, off))
+    off += icount * struct.calcsize(fmt)
+    submeshes = [SUBMESH.unpack_from(b, off + SUBMESH.size * i) for i in range(scount)]
+    return {'version': ver, 'flags': flags, 'bounds': h[5:11], 'joints': h[11],
+            'verts': verts, 'indices': indices, 'submeshes': submeshes, 'bytes': len(b)}
+
+
+def read_skel(path):
+    b = open(path, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'SKEL':
+        raise ValueError(f'{path}: not a .skel')
+    J = SKEL_HEADER.unpack_from(b, FILE_HEADER.size)[0]
+    off = FILE_HEADER.size + SKEL_HEADER.size
+    joints = []
+    for j in range(J):
+        v = JOINT_REC.unpack_from(b, off + JOINT_REC.size * j)
+        name = v[0].split(b'\0', 1)[0].decode('utf-8', 'replace')
+        joints.append({'name': name, 'parent': v[1], 'inv_bind': v[2:18],
+                       'T': v[18:21], 'R': v[22:26], 'S': v[26:29]})
+    return joints
+
+
+# ---------------------------------------------------------
+# 四元数 / 变换
+# ---------------------------------------------------------
+def q_normalize(q):
+    n = math.sqrt(sum(c * c for c in q))
+    return tuple(c / n for c in q) if n > 0 else (0.0, 0.0, 0.0, 1.0)
+
+
+def q_dot(a, b):
+    return sum(x * y for x, y in zip(a, b))
+
+
+def q_angle(a, b):
+    d = min(1.0, abs(q_dot(q_normalize(a), q_normalize(b))))
+    return 2.0 * math.acos(d)
+
+
+def q_nlerp(a, b, t):
+    s = -1.0 if q_dot(a, b) < 0.0 else 1.0
+    return q_normalize(tuple(x + (s * y - x) * t for x, y in zip(a, b)))
+
+
+def q_mul(a, b):
+    # Hamilton 积 a*b（x,y,z,w）
+    ax, ay, az, aw = a
+    bx, by, bz, bw = b
+    return (aw * bx + ax * bw + ay * bz - az * by,
+            aw * by - ax * bz + ay * bw + az * bx,
+            aw * bz + ax * by - ay * bx + az * bw,
+            aw * bw - ax * bx - ay * by - az * bz)
+
+
+def q_rotate(q, v):
+    r = q_mul(q_mul(q, (v[0], v[1], v[2], 0.0)), (-q[0], -q[1], -q[2], q[3]))
+    return r[0:3]
+
+
+def model_space_positions(pose, parents, order):
+    """局部 TRS → 各骨骼模型空间位置（S*R*T 行向量约定：p_model = parent.R*(parent.S*p) + parent.T）"""
+    J = len(pose)
+    gR = [None] * J
+    gS = [None] * J
+    gT = [None] * J
+    for j in order:
+        T, R, S = pose[j]
+        R = q_normalize(R)
+        p = parents[j]
+        if p < 0:
+            gR[j], gS[j], gT[j] = R, S, T
+        else:
+            sp = (T[0] * gS[p][0], T[1] * gS[p][1], T[2] * gS[p][2])
+            rp = q_rotate(gR[p], sp)
+            gT[j] = (rp[0] + gT[p][0], rp[1] + gT[p][1], rp[2] + gT[p][2])
+            gR[j] = q_mul(gR[p], R)
+            gS[j] = (S[0] * gS[p][0], S[1] * gS[p][1], S[2] * gS[p][2])
+    return gT
+
+
+def eval_order(parents):
+    order = [j for j, p in enumerate(parents) if p < 0]
+    k = 0
+    children = [[] for _ in parents]
+    for j, p in enumerate(parents):
+        if p >= 0:
+            children[p].append(j)
+    while k < len(order):
+        order.extend(children[order[k]])
+        k += 1
+    return order
+
+
+# ---------------------------------------------------------
+# 4x4 矩阵（行向量约定，与 DirectXMath 相同：p' = p * M，r[3] = 平移）
+# ---------------------------------------------------------
+def m_identity():
+    return [[1.0 if r == c else 0.0 for c in range(4)] for r in range(4)]
+
+
+def m_mul(a, b):
+    return [[sum(a[r][k] * b[k][c] for k in range(4)) for c in range(4)] for r in range(4)]
+
+
+def m_from_rows16(v):
+    return [list(v[r * 4:r * 4 + 4]) for r in range(4)]
+
+
+def m_from_trs(T, R, S):
+    """= XMMatrixScaling(S) * XMMatrixRotationQuaternion(R) * XMMatrixTranslation(T)（R 不归一化，同运行时）"""
+    x, y, z, w = R
+    rot = [[1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + z * w), 2.0 * (x * z - y * w)],
+           [2.0 * (x * y - z * w), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + x * w)],
+           [2.0 * (x * z + y * w), 2.0 * (y * z - x * w), 1.0 - 2.0 * (x * x + y * y)]]
+    m = [[rot[r][c] * S[r] for c in range(3)] + [0.0] for r in range(3)]
+    m.append([T[0], T[1], T[2], 1.0])
+    return m
+
+
+def m_inverse(m):
+    """Gauss-Jordan（部分主元）；奇异矩阵返回单位阵"""
+    a = [list(m[r]) + [1.0 if r == c else 0.0 for c in range(4)] for r in range(4)]
+    for c in range(4):
+        piv = max(range(c, 4), key=lambda r: abs(a[r][c]))
+        if abs(a[piv][c]) < 1e-20:
+            return m_identity()
+        a[c], a[piv] = a[piv], a[c]
+        inv = 1.0 / a[c][c]
+        a[c] = [v * inv for v in a[c]]
+        for r in range(4):
+            if r != c and a[r][c] != 0.0:
+                f = a[r][c]
+                a[r] = [v - f * p for v, p in zip(a[r], a[c])]
+    return [row[4:] for row in a]
+
+
+def q_from_rot_rows(m):
+    """= XMQuaternionRotationMatrix（同样的分支，结果的符号与运行时一致）"""
+    m00, m01, m02 = m[0][0], m[0][1], m[0][2]
+    m10, m11, m12 = m[1][0], m[1][1], m[1][2]
+    m20, m21, m22 = m[2][0], m[2][1], m[2][2]
+    if m22 <= 0.0:
+        dif10 = m11 - m00
+        omr22 = 1.0 - m22
+        if dif10 <= 0.0:
+            f = omr22 - dif10
+            s = 0.5 / math.sqrt(f)
+            return (f * s, (m01 + m10) * s, (m02 + m20) * s, (m12 - m21) * s)
+        f = omr22 + dif10
+        s = 0.5 / math.sqrt(f)
+        return ((m01 + m10) * s, f * s, (m12 + m21) * s, (m20 - m02) * s)
+    sum10 = m11 + m00
+    opr22 = 1.0 + m22
+    if sum10 <= 0.0:
+        f = opr22 - sum10
+        s = 0.5 / math.sqrt(f)
+        return ((m02 + m20) * s, (m12 + m21) * s, f * s, (m01 - m10) * s)
+    f = opr22 + sum10
+    s = 0.5 / math.sqrt(f)
+    return ((m12 - m21) * s, (m20 - m02) * s, (m01 - m10) * s, f * s)
+
+
+def m_decompose(m):
+    """= XMMatrixDecompose：各行长度为缩放，行列式为负时翻转缩放最大的轴；退化返回 None"""
+    S = [math.sqrt(sum(m[r][c] ** 2 for c in range(3))) for r in range(3)]
+    if min(S) < 1e-12:
+        return None
+    rows = [[m[r][c] / S[r] for c in range(3)] for r in range(3)]
+    det = (rows[0][0] * (rows[1][1] * rows[2][2] - rows[1][2] * rows[2][1])
+           - rows[0][1] * (rows[1][0] * rows[2][2] - rows[1][2] * rows[2][0])
+           + rows[0][2] * (rows[1][0] * rows[2][1] - rows[1][1] * rows[2][0]))
+    if det < 0.0:
+        a = max(range(3), key=lambda r: S[r])
+        S[a] = -S[a]
+        rows[a] = [-v for v in rows[a]]
+    return tuple(m[3][0:3]), q_from_rot_rows(rows), tuple(S)
+
+
+def model_space_matrices(pose, parents, order):
+    """局部 TRS → 各骨骼模型空间矩阵（= AnimPose_LocalToModel）"""
+    out = [None] * len(pose)
+    for j in order:
+        T, R, S = pose[j]
+        L = m_from_trs(T, R, S)
+        out[j] = m_mul(L, out[parents[j]]) if parents[j] >= 0 else L
+    return out
+
+
+# ---------------------------------------------------------
+# 量化（与 anim_clip.cpp 的 DecodeVec3 / DecodeQuat 对应）
+# ---------------------------------------------------------
+def quant_vec3(v, vmin, vext):
+    q = []
+    for c in range(3):
+        if vext[c] <= 0.0:
+            q.append(0)
+        else:
+            q.append(max(0, min(65535, int(round((v[c] - vmin[c]) / vext[c] * 65535.0)))))
+    return q
+
+
+def dequant_vec3(q, vmin, vext):
+    return tuple(vmin[c] + q[c] / 65535.0 * vext[c] for c in range(3))
+
+
+def quant_quat(q):
+    q = q_normalize(q)
+    largest = max(range(4), key=lambda i: abs(q[i]))
+    if q[largest] < 0.0:
+        q = tuple(-c for c in q)
+    rest = [q[i] for i in range(4) if i != largest]
+    qs = [max(0, min(32767, int(round((c + INV_SQRT2) / (2.0 * INV_SQRT2) * 32767.0)))) for c in rest]
+    w0 = ((largest >> 1) & 1) << 15 | qs[0]
+    w1 = (largest & 1) << 15 | qs[1]
+    return [w0, w1, qs[2]]
+
+
+def dequant_quat(w):
+    largest = ((w[0] >> 15) << 1) | (w[1] >> 15)
+    s = (2.0 * INV_SQRT2) / 32767.0
+    abc = [(x & 0x7FFF) * s - INV_SQRT2 for x in w]
+    m = math.sqrt(max(0.0, 1.0 - sum(c * c for c in abc)))
+    out, k = [], 0
+    for i in range(4):
+        if i == largest:
+            out.append(m)
+        else:
+            out.append(abc[k])
+            k += 1
+    return tuple(out)
+
+
+def lerp3(a, b, t):
+    return tuple(x + (y - x) * t for x, y in zip(a, b))
+
+
+def channel_error(ch, a, b):
+    if ch == ANIM_CH_R:
+        return q_angle(a, b)
+    return max(abs(x - y) for x, y in zip(a, b))
+
+
+def interp(ch, a, b, t):
+    return q_nlerp(a, b, t) if ch == ANIM_CH_R else lerp3(a, b, t)
+
+
+# ---------------------------------------------------------
+# 单条轨道压缩
+# ---------------------------------------------------------
+def compress_track(ch, values, tol):
+    """values: 每帧原始值。返回 (flags, keyFrames, keyBytes, decodedPerFrame)；动画 T/S 轨道的 keyBytes 以量化区间开头
+    误差预算（对原始值）同时覆盖插值帧和关键帧自身的量化误差"""
+    F = len(values)
+    v0 = values[0]
+
+    # 1) 常量轨道
+    if all(channel_error(ch, v, v0) <= tol for v in values):
+        if ch == ANIM_CH_R:
+            q = q_normalize(v0)
+            data = struct.pack('<4f', *q)
+        else:
+            q = tuple(v0)
+            data = struct.pack('<3f', *q)
+        return ANIM_TRACK_CONSTANT, [], data, [q] * F
+
+    # 2) 量化
+    if ch == ANIM_CH_R:
+        vmin, vext = (0.0, 0.0, 0.0), (0.0, 0.0, 0.0)
+        qv = [quant_quat(v) for v in values]
+        dq = [dequant_quat(w) for w in qv]
+    else:
+        vmin = tuple(min(v[c] for v in values) for c in range(3))
+        vext = tuple(max(v[c] for v in values) - vmin[c] for c in range(3))
+        qv = [quant_vec3(v, vmin, vext) for v in values]
+        dq = [dequant_vec3(w, vmin, vext) for w in qv]
+
+    # 3) 关键帧删减：从当前关键帧尽量往后延伸，插值帧的误差（端点用量化后的值）都在 tol 内；
+    #    量化误差本身超出 tol 的帧不选作关键帧（首尾帧 / 相邻帧没得选时除外，由调用方报告）
+    qerr = [channel_error(ch, dq[f], values[f]) for f in range(F)]
+    keys = [0]
+    k0 = 0
+    while k0 < F - 1:
+        best = k0 + 1
+        for k1 in range(k0 + 2, F):
+            ok = True
+            for f in range(k0 + 1, k1):
+                t = (f - k0) / float(k1 - k0)
+                if channel_error(ch, interp(ch, dq[k0], dq[k1], t), values[f]) > tol:
+                    ok = False
+                    break
+            if not ok:
+                break
+            if qerr[k1] <= tol or qerr[best] > tol:
+                best = k1
+        keys.append(best)
+        k0 = best
+
+    data = b'' if ch == ANIM_CH_R else ANIM_TRACK_RANGE.pack(*vmin, *vext)
+    data += b''.join(struct.pack('<3H', *qv[k]) for k in keys)
+
+    decoded = []
+    ki = 0
+    for f in range(F):
+        while ki + 1 < len(keys) and keys[ki + 1] <= f:
+            ki += 1
+        if keys[ki] == f or ki + 1 >= len(keys):
+            decoded.append(dq[keys[ki]])
+        else:
+            a, b = keys[ki], keys[ki + 1]
+            decoded.append(interp(ch, dq[a], dq[b], (f - a) / float(b - a)))
+    return 0, keys, data, decoded
+
+
+# ---------------------------------------------------------
+# anim-compress
+# ---------------------------------------------------------
+def compress_anim(src, dst, skel_path, tol):
+    anim = read_anim_v1(src)
+    J, F = anim['J'], anim['F']
+    frames = anim['frames']
+
+    tracks = []
+    key_frames = []
+    key_lists = {}       # 关键帧序列 → keyFrames[] 起始下标（相同序列的轨道共用一份，常见于逐帧都是关键帧的轨道）
+    key_data = bytearray()
+    decoded = [[[None, None, None] for _ in range(J)] for _ in range(F)]
+    max_err = [0.0, 0.0, 0.0]
+    const_count = 0
+    over_tol = []        # 误差超出 tol 的轨道（16 位量化区间太粗）：(joint, channel, err)
+
+    for j in range(J):
+        for ch in (ANIM_CH_T, ANIM_CH_R, ANIM_CH_S):
+            values = [frames[f][j][ch] for f in range(F)]
+            flags, keys, data, dec = compress_track(ch, values, tol[ch])
+
+            while len(key_data) % 4:
+                key_data.append(0)
+            if flags & ANIM_TRACK_CONSTANT:
+                const_count += 1
+                tracks.append((flags, 1, 0, len(key_data)))
+            else:
+                kfo = key_lists.get(tuple(keys))
+                if kfo is None:
+                    kfo = key_lists[tuple(keys)] = len(key_frames)
+                    key_frames.extend(keys)
+                tracks.append((flags, len(keys), kfo, len(key_data)))
+            key_data += data
+
+            track_err = 0.0
+            for f in range(F):
+                decoded[f][j][ch] = dec[f]
+                track_err = max(track_err, channel_error(ch, dec[f], values[f]))
+            max_err[ch] = max(max_err[ch], track_err)
+            if track_err > tol[ch]:
+                over_tol.append((j, ch, track_err))
+
+    # 写文件
+    body = bytearray()
+    body += ANIM_HEADER_V2.pack(J, anim['dur'], anim['rate'], F, len(key_frames), len(key_data), 0, 0)
+    for t in tracks:
+        body += ANIM_TRACK_V2.pack(*t)
+    body += struct.pack(f'<{len(key_frames)}H', *key_frames)
+    while len(body) % 4:
+        body.append(0)
+    body += key_data
+    # 尾部可选块（根运动 / 事件）原样带上
+    for _, data in anim['chunks']:
+        while (FILE_HEADER.size + len(body)) % 4:
+            body.append(0)
+        body += data
+    out = FILE_HEADER.pack(b'ANIM', ANIM_VERSION_V2, FILE_HEADER.size + len(body), 0) + bytes(body)
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+
+    # 模型空间误差（有 .skel 时）
+    model_err = None
+    if skel_path and os.path.exists(skel_path):
+        parents = [jt['parent'] for jt in read_skel(skel_path)]
+        if len(parents) == J:
+            order = eval_order(parents)
+            model_err = 0.0
+            for f in range(F):
+                pa = model_space_positions(frames[f], parents, order)
+                pb = model_space_positions([tuple(d) for d in decoded[f]], parents, order)
+                for a, b in zip(pa, pb):
+                    model_err = max(model_err, math.dist(a, b))
+
+    return {
+        'src_bytes': anim['bytes'], 'dst_bytes': len(out), 'J': J, 'F': F,
+        'const': const_count, 'tracks': J * 3, 'keys': len(key_frames),
+        'err': max_err, 'model_err': model_err, 'over_tol': over_tol,
+    }
+
+
+def cmd_anim_compress(args):
+    tol = [args.tol_trans, math.radians(args.tol_rot_deg), args.tol_scale]
+    total_src = total_dst = 0
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.anim')
+        skel = args.skel or os.path.splitext(src)[0] + '.skel'
+        r = compress_anim(src, dst, skel, tol)
+        total_src += r['src_bytes']
+        total_dst += r['dst_bytes']
+        me = 'n/a' if r['model_err'] is None else f"{r['model_err'] * 1000.0:.3f} mm"
+        print(f"{os.path.basename(src):24s} J={r['J']:3d} F={r['F']:4d} "
+              f"{r['src_bytes']:9d} -> {r['dst_bytes']:7d} B  x{r['src_bytes'] / r['dst_bytes']:5.1f}  "
+              f"const {r['const']:3d}/{r['tracks']:3d}  keys {r['keys']:5d}  "
+              f"maxErr T {r['err'][0] * 1000.0:.3f} mm  R {math.degrees(r['err'][1]):.4f} deg  "
+              f"S {r['err'][2]:.2e}  model {me}")
+        for j, ch, err in r['over_tol']:
+            shown = f"{math.degrees(err):.4f} deg" if ch == ANIM_CH_R else f"{err:.2e}"
+            print(f"  WARNING: joint {j} {'TRS'[ch]} error {shown} exceeds the tolerance "
+                  f"(quantization step of the 16-bit range is too coarse)")
+    if len(args.inputs) > 1 and total_dst:
+        print(f"total {total_src} -> {total_dst} B  x{total_src / total_dst:.1f}")
+
+
+# ---------------------------------------------------------
+# root-motion：预计算根运动曲线
+# ---------------------------------------------------------
+# 与 ModelSkinned.cpp ResolveMotionRoot 的默认策略一致
+MOTION_ROOT_CANDIDATES = ['mixamorig:Hips', 'Hips', 'Root', 'root', 'Armature', 'Motion', 'motion']
+
+
+def resolve_motion_root(joints, name):
+    names = [jt['name'] for jt in joints]
+    for n in ([name] if name else []) + MOTION_ROOT_CANDIDATES:
+        if n in names:
+            return names.index(n)
+    return next(j for j, jt in enumerate(joints) if jt['parent'] < 0)
+
+
+def local_yaw(q):
+    """与运行时 YawFromLocalQuat 相同：+Z 经旋转后的朝向，绕 Y 的角度"""
+    f = q_rotate(q_normalize(q), (0.0, 0.0, 1.0))
+    return math.atan2(f[0], f[2])
+
+
+def add_root_motion(src, dst, skel_path, root_name):
+    anim = read_anim_v1(src)
+    joints = read_skel(skel_path)
+    if len(joints) != anim['J']:
+        raise ValueError(f'{src}: joint count {anim["J"]} != {skel_path} ({len(joints)})')
+    root = resolve_motion_root(joints, root_name)
+
+    # 逐帧：局部平移 + 相对第 0 帧展开的 yaw（帧间差取最短角，累加后不回绕）
+    samples = []
+    yaw_prev = yaw_acc = 0.0
+    for f, pose in enumerate(anim['frames']):
+        T, R, _ = pose[root]
+        yaw = local_yaw(R)
+        if f > 0:
+            d = yaw - yaw_prev
+            yaw_acc += math.atan2(math.sin(d), math.cos(d))
+        yaw_prev = yaw
+        samples.extend((T[0], T[1], T[2], yaw_acc))
+
+    chunk = ROOT_MOTION_HEADER.pack(b'ROOT', root, anim['F'], 0, joints[root]['name'].encode('utf-8')[:63])
+    chunk += struct.pack(f'<{len(samples)}f', *samples)
+    chunks = [(b'ROOT', chunk)] + [c for c in anim['chunks'] if c[0] != b'ROOT']
+    size = write_anim_with_chunks(dst, anim['body'], chunks)
+
+    last = samples[-4:]
+    return {'root': joints[root]['name'], 'F': anim['F'], 'dur': anim['dur'],
+            'dT': [last[k] - samples[k] for k in range(3)], 'dYaw': last[3], 'bytes': size - anim['bytes']}
+
+
+def cmd_root_motion(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.anim')
+        skel = args.skel or os.path.splitext(src)[0] + '.skel'
+        r = add_root_motion(src, dst, skel, args.root)
+        print(f"{os.path.basename(src):24s} root={r['root']:20s} F={r['F']:4d} "
+              f"cycle dT=({r['dT'][0]:+.3f}, {r['dT'][1]:+.3f}, {r['dT'][2]:+.3f}) m  "
+              f"dYaw={math.degrees(r['dYaw']):+.2f} deg  (+{r['bytes']} B)")
+
+
+# ---------------------------------------------------------
+# anim-events：事件轨道
+# ---------------------------------------------------------
+def add_anim_events(src, dst, events_path):
+    b = open(src, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'ANIM':
+        raise ValueError(f'{src}: not a .anim')
+    # v1 / v2 头部前 16 字节相同：jointCount, durationSec, sampleRate, frameCount
+    _, dur, rate, F = ANIM_HEADER_V1.unpack_from(b, FILE_HEADER.size)
+    body_end = anim_body_end(b)
+
+    with open(events_path, 'r', encoding='utf-8-sig') as fp:
+        doc = json.load(fp)
+    events = []
+    for e in doc.get('events', []):
+        if 'time' in e:
+            t = float(e['time'])
+        elif 'frame' in e:
+            t = float(e['frame']) / rate
+        elif 'norm' in e:
+            t = float(e['norm']) * dur
+        else:
+            raise ValueError(f'{events_path}: event {e.get("name")!r} needs time / frame / norm')
+        if not 0.0 <= t <= dur + 1e-4:
+            raise ValueError(f'{events_path}: event {e.get("name")!r} at {t:.3f}s outside [0, {dur:.3f}]')
+        events.append((min(t, dur), e['name'], float(e.get('payload', 0.0))))
+    events.sort(key=lambda ev: ev[0])   # 稳定排序：同一时刻保持声明顺序
+
+    names = bytearray()
+    name_offset = {}
+    for _, name, _ in events:
+        if name not in name_offset:
+            name_offset[name] = len(names)
+            names += name.encode('utf-8') + b'\0'
+    while len(names) % 4:
+        names.append(0)
+
+    chunk = ANIM_EVENT_HEADER.pack(b'EVNT', len(events), len(names), 0)
+    for t, name, payload in events:
+        chunk += ANIM_EVENT_REC.pack(t, name_offset[name], payload, 0)
+    chunk += names
+
+    chunks = [c for c in read_anim_chunks(b, body_end) if c[0] != b'EVNT']
+    if events:
+        chunks.append((b'EVNT', chunk))
+    write_anim_with_chunks(dst, b[:body_end], chunks)
+    return {'ver': ver, 'dur': dur, 'events': events}
+
+
+def cmd_anim_events(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.anim')
+        events = args.events or os.path.splitext(src)[0] + '.events.json'
+        r = add_anim_events(src, dst, events)
+        listing = ', '.join(f'{name}@{t:.3f}s' for t, name, _ in r['events'])
+        print(f"{os.path.basename(src):24s} v{r['ver'] >> 16} dur={r['dur']:.3f}s  {len(r['events'])} events  {listing}")
+
+
+# ---------------------------------------------------------
+# anim-joints：骨骼名表（重定向用）
+# ---------------------------------------------------------
+def add_anim_joints(src, dst, skel_path):
+    b = open(src, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'ANIM':
+        raise ValueError(f'{src}: not a .anim')
+    J = ANIM_HEADER_V1.unpack_from(b, FILE_HEADER.size)[0]
+    joints = read_skel(skel_path)
+    if len(joints) != J:
+        raise ValueError(f'{src}: {J} joints but {skel_path} has {len(joints)}')
+
+    chunk = bytearray(ANIM_JOINT_NAMES_HEADER.pack(b'JNTS', J, 0, 0))
+    for jt in joints:
+        name = jt['name'].encode('utf-8')[:ANIM_JOINT_NAME_BYTES - 1]
+        chunk += name.ljust(ANIM_JOINT_NAME_BYTES, b'\0')
+
+    body_end = anim_body_end(b)
+    chunks = [c for c in read_anim_chunks(b, body_end) if c[0] != b'JNTS']
+    chunks.append((b'JNTS', bytes(chunk)))
+    size = write_anim_with_chunks(dst, b[:body_end], chunks)
+    return {'ver': ver, 'J': J, 'bytes': size - len(b)}
+
+
+def cmd_anim_joints(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.anim')
+        skel = args.skel or os.path.splitext(src)[0] + '.skel'
+        r = add_anim_joints(src, dst, skel)
+        print(f"{os.path.basename(src):24s} v{r['ver'] >> 16} J={r['J']:3d}  names from {os.path.basename(skel)}  ({r['bytes']:+d} B)")
+
+
+# ---------------------------------------------------------
+# skel-meta / anim-meta：运行时加载 / Play 时的一次性计算搬到 cook 阶段
+# ---------------------------------------------------------
+def fixup_bind_pose(joints):
+    """= AnimPose_FixupBindPose：由 invBind 反推 bindLocal（平均 MeshGlobalAtBind；乘法顺序与运行时一致）"""
+    parents = [jt['parent'] for jt in joints]
+    order = eval_order(parents)
+    globals_ = model_space_matrices([(jt['T'], jt['R'], jt['S']) for jt in joints], parents, order)
+    inv_bind = [m_from_rows16(jt['inv_bind']) for jt in joints]
+    J = len(joints)
+
+    avg = [[0.0] * 4 for _ in range(4)]
+    for j in range(J):
+        mj = m_mul(globals_[j], inv_bind[j])
+        for r in range(4):
+            for c in range(4):
+                avg[r][c] += mj[r][c] / J
+    G = [m_mul(avg, m_inverse(inv_bind[j])) for j in range(J)]
+
+    out = []
+    for j, jt in enumerate(joints):
+        parent_g = G[parents[j]] if parents[j] >= 0 else m_identity()
+        d = m_decompose(m_mul(m_inverse(parent_g), G[j]))
+        out.append(d if d else (jt['T'], jt['R'], jt['S']))   # 分解失败：保留原值（同运行时）
+    return out
+
+
+def add_skel_meta(src, dst):
+    b = open(src, 'rb').read()
+    joints = read_skel(src)
+    J = len(joints)
+    body_end = FILE_HEADER.size + SKEL_HEADER.size + JOINT_REC.size * J
+    fixed = fixup_bind_pose(joints)
+    root = resolve_motion_root(joints, None)
+
+    out = bytearray(b[:body_end])
+    while len(out) % 4:
+        out.append(0)
+    out += SKEL_META_HEADER.pack(b'SMET', J, root, 0)
+    for T, R, S in fixed:
+        out += ANIM_TRS.pack(*T, 0, *R, *S, 0)
+    struct.pack_into('<I', out, 8, len(out))
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+
+    dT = max(math.dist(jt['T'], f[0]) for jt, f in zip(joints, fixed))
+    dR = max(q_angle(jt['R'], f[1]) for jt, f in zip(joints, fixed))
+    return {'J': J, 'root': joints[root]['name'], 'dT': dT, 'dR': dR, 'bytes': len(out) - len(b)}
+
+
+def cmd_skel_meta(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.skel')
+        r = add_skel_meta(src, dst)
+        print(f"{os.path.basename(src):24s} J={r['J']:3d} root={r['root']:20s} "
+              f"bind fixup max dT={r['dT'] * 1000:.3f} mm dR={math.degrees(r['dR']):.3f} deg  ({r['bytes']:+d} B)")
+
+
+def anim_frame0(b):
+    """.anim v1 / v2 第 0 帧的局部姿态 [(T, R, S)]（v2 的首帧必是关键帧：取每条轨道的第一个 key）"""
+    ver = FILE_HEADER.unpack_from(b, 0)[1]
+    off = FILE_HEADER.size
+    if ver != ANIM_VERSION_V2:
+        J = ANIM_HEADER_V1.unpack_from(b, off)[0]
+        off += ANIM_HEADER_V1.size
+        pose = []
+        for j in range(J):
+            v = ANIM_TRS.unpack_from(b, off + ANIM_TRS.size * j)
+            pose.append((v[0:3], v[4:8], v[8:11]))
+        return pose
+
+    J, _, _, _, kf_count, _, _, _ = ANIM_HEADER_V2.unpack_from(b, off)
+    off += ANIM_HEADER_V2.size
+    kd_base = off + ANIM_TRACK_V2.size * J * 3 + ((kf_count * 2 + 3) & ~3)
+    pose = []
+    for j in range(J):
+        trs = []
+        for ch in (ANIM_CH_T, ANIM_CH_R, ANIM_CH_S):
+            t = ANIM_TRACK_V2.unpack_from(b, off + ANIM_TRACK_V2.size * (j * 3 + ch))
+            flags, kdo = t[0], t[3]
+            if flags & ANIM_TRACK_CONSTANT:
+                trs.append(struct.unpack_from('<4f' if ch == ANIM_CH_R else '<3f', b, kd_base + kdo))
+            elif ch == ANIM_CH_R:
+                trs.append(dequant_quat(struct.unpack_from('<3H', b, kd_base + kdo)))
+            else:
+                r = ANIM_TRACK_RANGE.unpack_from(b, kd_base + kdo)
+                q = struct.unpack_from('<3H', b, kd_base + kdo + ANIM_TRACK_RANGE.size)
+                trs.append(dequant_vec3(q, r[0:3], r[3:6]))
+        pose.append(tuple(trs))
+    return pose
+
+
+def add_anim_meta(src, dst, skel_path, root_name):
+    b = open(src, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'ANIM':
+        raise ValueError(f'{src}: not a .anim')
+    joints = read_skel(skel_path)
+    pose = anim_frame0(b)
+    if len(joints) != len(pose):
+        raise ValueError(f'{src}: {len(pose)} joints but {skel_path} has {len(joints)}')
+    root = resolve_motion_root(joints, root_name)
+
+    # 与运行时相同：局部 = YawFromLocalQuat；模型空间 = +Z 经 MotionRoot 模型矩阵变换后的朝向
+    parents = [jt['parent'] for jt in joints]
+    model = model_space_matrices(pose, parents, eval_order(parents))
+    yaw_local = local_yaw(pose[root][1])
+    f = model[root][2][0:3]
+    yaw_model = math.atan2(f[0], f[2])
+
+    body_end = anim_body_end(b)
+    chunks = [c for c in read_anim_chunks(b, body_end) if c[0] != b'META']
+    chunks.append((b'META', ANIM_META_HEADER.pack(b'META', root, yaw_local, yaw_model)))
+    size = write_anim_with_chunks(dst, b[:body_end], chunks)
+    return {'ver': ver, 'root': joints[root]['name'], 'local': yaw_local, 'model': yaw_model, 'bytes': size - len(b)}
+
+
+def cmd_anim_meta(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.anim')
+        skel = args.skel or os.path.splitext(src)[0] + '.skel'
+        r = add_anim_meta(src, dst, skel, args.root)
+        print(f"{os.path.basename(src):24s} v{r['ver'] >> 16} root={r['root']:20s} "
+              f"f0 yaw local={math.degrees(r['local']):+8.2f} deg model={math.degrees(r['model']):+8.2f} deg  ({r['bytes']:+d} B)")
+
+
+# ---------------------------------------------------------
+# mesh-split：按骨骼数拆分子网格
+# ---------------------------------------------------------
+V_IDX, V_W = 12, 16      # SKINNED_VERTEX_V1 元组中 boneIdx / boneW 的起始位置
+
+
+def vertex_bones(v):
+    return {v[V_IDX + k] for k in range(4) if v[V_W + k] > 0}
+
+
+def split_mesh(src, dst, max_bones):
+    m = read_mesh_v1(src)
+    verts, indices = m['verts'], m['indices']
+
+    # 按原子网格（材质组）依次贪心：三角形按原顺序装入当前分块，骨骼超过上限就开新块
+    parts = []   # (materialIndex, [tri...], sorted bones)
+    for io, ic, mat, *_ in m['submeshes']:
+        cur_tris, cur_bones = [], set()
+        for t in range(io, io + ic, 3):
+            tri = indices[t:t + 3]
+            tb = vertex_bones(verts[tri[0]]) | vertex_bones(verts[tri[1]]) | vertex_bones(verts[tri[2]])
+            if len(cur_bones | tb) > max_bones:
+                parts.append((mat, cur_tris, sorted(cur_bones)))
+                cur_tris, cur_bones = [], set()
+            cur_tris.append(tri)
+            cur_bones |= tb
+        if cur_tris:
+            parts.append((mat, cur_tris, sorted(cur_bones)))
+
+    # 每块的顶点连续存放，boneIdx 改写为块内局部下标
+    out_verts, out_indices, out_subs, out_pals, bone_table = [], [], [], [], []
+    for mat, tris, bones in parts:
+        if not bones:
+            bones = [0]
+        local = {g: i for i, g in enumerate(bones)}
+        vmap = {}
+        v0, i0 = len(out_verts), len(out_indices)
+        for tri in tris:
+            for vi in tri:
+                if vi not in vmap:
+                    v = list(verts[vi])
+                    for k in range(4):
+                        v[V_IDX + k] = local[v[V_IDX + k]] if v[V_W + k] > 0 else 0
+                    vmap[vi] = len(out_verts)
+                    out_verts.append(v)
+                out_indices.append(vmap[vi])
+        pv = out_verts[v0:]
+        bmin = [min(v[a] for v in pv) for a in range(3)]
+        bmax = [max(v[a] for v in pv) for a in range(3)]
+        out_subs.append((i0, len(out_indices) - i0, mat, *bmin, *bmax))
+        out_pals.append((len(bone_table), len(bones), v0, len(pv)))
+        bone_table.extend(bones)
+
+    # 写文件（MeshHeader 其余字段照抄，只改计数与 flags）
+    vcount = len(out_verts)
+    fmt = 'I' if vcount > 65535 else 'H'
+    body = bytearray()
+    body += MESH_HEADER.pack(vcount, len(out_indices), SKINNED_VERTEX_V1.size, len(out_subs),
+                             m['flags'] | HAS_BONE_PALETTES, *m['bounds'], m['joints'], 0, 0, 0)
+    for v in out_verts:
+        body += SKINNED_VERTEX_V1.pack(*v)
+    body += struct.pack(f'<{len(out_indices)}{fmt}', *out_indices)   # 与原格式一致：Submesh 表紧跟索引，不对齐
+    for sm in out_subs:
+        body += SUBMESH.pack(*sm)
+    body += MESH_BONE_PALETTE_HEADER.pack(max_bones, len(bone_table), 0, 0)
+    for pal in out_pals:
+        body += MESH_BONE_PALETTE.pack(*pal)
+    body += struct.pack(f'<{len(bone_table)}H', *bone_table)
+    while len(body) % 4:
+        body.append(0)
+    out = FILE_HEADER.pack(b'MESH', m['version'], FILE_HEADER.size + len(body), 0) + bytes(body)
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+
+    # 校验：还原成全局骨骼下标后，每个三角形与原网格逐顶点一致
+    flat = [i for _, tris, _ in parts for tri in tris for i in tri]
+    for k, (src_i, dst_i) in enumerate(zip(flat, out_indices)):
+        a, b = verts[src_i], out_verts[dst_i]
+        sub = next(p for p in out_pals if p[2] <= dst_i < p[2] + p[3])
+        for c in range(4):
+            if a[V_W + c] > 0 and bone_table[sub[0] + b[V_IDX + c]] != a[V_IDX + c]:
+                raise AssertionError(f'{src}: bone remap mismatch at index {k}')
+        if a[:V_IDX] != b[:V_IDX] or a[V_W:] != b[V_W:]:
+            raise AssertionError(f'{src}: vertex mismatch at index {k}')
+
+    return {
+        'src_bytes': m['bytes'], 'dst_bytes': len(out), 'J': m['joints'],
+        'subs_in': len(m['submeshes']), 'subs_out': len(out_subs),
+        'verts_in': len(verts), 'verts_out': vcount,
+        'max_used': max(p[1] for p in out_pals), 'avg_used': sum(p[1] for p in out_pals) / len(out_pals),
+    }
+
+
+def cmd_mesh_split(args):
+    if not 12 <= args.max_bones <= MAX_BONES:
+        raise SystemExit(f'--max-bones must be in [12, {MAX_BONES}] (one triangle can touch 12 bones)')
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.mesh')
+        r = split_mesh(src, dst, args.max_bones)
+        J = max(1, min(r['J'], MAX_BONES))
+        print(f"{os.path.basename(src):24s} J={r['J']:3d} submesh {r['subs_in']:3d} -> {r['subs_out']:3d}  "
+              f"verts {r['verts_in']:6d} -> {r['verts_out']:6d} (+{(r['verts_out'] / r['verts_in'] - 1) * 100:.1f}%)  "
+              f"bones/draw max {r['max_used']:3d} avg {r['avg_used']:5.1f}  "
+              f"upload/draw {r['avg_used'] * 64:.0f} B (was {J * 64} B)")
+
+
+# ---------------------------------------------------------
+# mesh-quantize：压缩顶点（.mesh v2）
+# ---------------------------------------------------------
+def to_snorm16(v):
+    return int(round(max(-1.0, min(1.0, v)) * 32767.0))
+
+
+def from_snorm16(v):
+    return max(-1.0, v / 32767.0)
+
+
+def oct_decode(e):
+    """与 mesh_quant.cpp MeshQuant_OctDecode / HLSL OctDecode 一致"""
+    x, y = from_snorm16(e[0]), from_snorm16(e[1])
+    z = 1.0 - abs(x) - abs(y)
+    t = max(-z, 0.0)
+    x += -t if x >= 0.0 else t
+    y += -t if y >= 0.0 else t
+    l = math.sqrt(x * x + y * y + z * z)
+    return (x / l, y / l, z / l) if l > 0.0 else (0.0, 0.0, 1.0)
+
+
+def oct_encode(n):
+    """八面体编码；在量化格点的 4 个邻居里挑解码后误差最小的（解码仍是标准算法）"""
+    l1 = abs(n[0]) + abs(n[1]) + abs(n[2])
+    if l1 <= 0.0:
+        return (0, 0)
+    x, y = n[0] / l1, n[1] / l1
+    if n[2] < 0.0:
+        x, y = (1.0 - abs(y)) * (1.0 if x >= 0.0 else -1.0), (1.0 - abs(x)) * (1.0 if y >= 0.0 else -1.0)
+    fx, fy = math.floor(max(-1.0, min(1.0, x)) * 32767.0), math.floor(max(-1.0, min(1.0, y)) * 32767.0)
+    best, best_dot = None, -2.0
+    for qx in (fx, fx + 1):
+        for qy in (fy, fy + 1):
+            c = (max(-32767, min(32767, qx)), max(-32767, min(32767, qy)))
+            d = oct_decode(c)
+            dot = d[0] * n[0] + d[1] * n[1] + d[2] * n[2]
+            if dot > best_dot:
+                best, best_dot = c, dot
+    return best
+
+
+def unit(v):
+    l = math.sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2])
+    return (v[0] / l, v[1] / l, v[2] / l) if l > 0.0 else (0.0, 0.0, 1.0)
+
+
+def angle_deg(a, b):
+    return math.degrees(math.acos(max(-1.0, min(1.0, a[0] * b[0] + a[1] * b[1] + a[2] * b[2]))))
+
+
+def quantize_mesh(src, dst):
+    b = open(src, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'MESH':
+        raise ValueError(f'{src}: not a .mesh')
+    if ver == MESH_VERSION_V2:
+        raise ValueError(f'{src}: already quantized')
+    h = list(MESH_HEADER.unpack_from(b, FILE_HEADER.size))
+    vcount, stride, flags = h[0], h[2], h[4]
+    skinned = bool(flags & HAS_SKIN)
+    vin = SKINNED_VERTEX_V1 if skinned else MESH_VERTEX_V0
+    vout = SKINNED_VERTEX_V2 if skinned else MESH_VERTEX_V2
+    if stride != vin.size:
+        raise ValueError(f'{src}: unexpected vertex stride {stride} (flags={flags:#x})')
+
+    off = FILE_HEADER.size + MESH_HEADER.size
+    verts = [vin.unpack_from(b, off + stride * i) for i in range(vcount)]
+    tail = b[off + stride * vcount:]   # 索引 / Submesh / 调色板表：顶点数不变，原样保留
+
+    # 量化区间：顶点的紧包围盒（写回 MeshHeader::bounds，运行时据此反量化）
+    if verts:
+        bmin = [min(v[a] for v in verts) for a in range(3)]
+        bmax = [max(v[a] for v in verts) for a in range(3)]
+    else:
+        bmin, bmax = list(h[5:8]), list(h[8:11])
+    ext = [bmax[a] - bmin[a] for a in range(3)]
+    h[2] = vout.size
+    h[5:11] = bmin + bmax
+
+    body = bytearray(MESH_HEADER.pack(*h))
+    err_pos, err_nrm, err_tan, err_uv = 0.0, 0.0, 0.0, 0.0
+    for v in verts:
+        pos, nrm, tan, uv = v[0:3], v[3:6], v[6:10], v[10:12]
+        qp = [int(round(max(0.0, min(1.0, (pos[a] - bmin[a]) / ext[a])) * 65535.0)) if ext[a] > 0.0 else 0
+              for a in range(3)]
+        qn, qt = oct_encode(unit(nrm)), oct_encode(unit(tan[:3]))
+        rec = [*qp, 0 if tan[3] < 0.0 else 65535, *qn, *qt, *uv]
+        if skinned:
+            rec += v[12:20]
+        body += vout.pack(*rec)
+
+        # 误差：按运行时的解码规则还原
+        dec = vout.unpack(vout.pack(*rec))
+        for a in range(3):
+            err_pos = max(err_pos, abs(bmin[a] + dec[a] / 65535.0 * ext[a] - pos[a]))
+        err_nrm = max(err_nrm, angle_deg(oct_decode(dec[4:6]), unit(nrm)))
+        err_tan = max(err_tan, angle_deg(oct_decode(dec[6:8]), unit(tan[:3])))
+        err_uv = max(err_uv, abs(dec[8] - uv[0]), abs(dec[9] - uv[1]))
+
+    body += tail
+    out = FILE_HEADER.pack(b'MESH', MESH_VERSION_V2, FILE_HEADER.size + len(body), 0) + bytes(body)
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+    return {'skinned': skinned, 'verts': vcount, 'stride_in': stride, 'stride_out': vout.size,
+            'src_bytes': len(b), 'dst_bytes': len(out), 'ext': max(ext) if verts else 0.0,
+            'err_pos': err_pos, 'err_nrm': err_nrm, 'err_tan': err_tan, 'err_uv': err_uv}
+
+
+def cmd_mesh_quantize(args):
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.mesh')
+        r = quantize_mesh(src, dst)
+        print(f"{os.path.basename(src):24s} {'skinned' if r['skinned'] else 'static '} verts {r['verts']:6d}  "
+              f"{r['stride_in']} -> {r['stride_out']} B/vert  {r['src_bytes']} -> {r['dst_bytes']} B "
+              f"({r['dst_bytes'] / r['src_bytes'] * 100:.1f}%)  "
+              f"max err pos {r['err_pos']:.2e} (extent {r['ext']:.3f})  nrm {r['err_nrm']:.4f} deg  "
+              f"tan {r['err_tan']:.4f} deg  uv {r['err_uv']:.2e}")
+
+
+# ---------------------------------------------------------
+# .mesh 通用读写（v1 / v2，拆分 / 未拆分；顶点按原始字节保存，不解码）
+# ---------------------------------------------------------
+def read_mesh(path):
+    b = open(path, 'rb').read()
+    magic, ver, _, _ = FILE_HEADER.unpack_from(b, 0)
+    if magic != b'MESH':
+        raise ValueError(f'{path}: not a .mesh')
+    h = list(MESH_HEADER.unpack_from(b, FILE_HEADER.size))
+    vcount, icount, stride, scount, flags = h[0:5]
+    off = FILE_HEADER.size + MESH_HEADER.size
+    verts = [b[off + stride * i:off + stride * (i + 1)] for i in range(vcount)]
+    off += stride * vcount
+    fmt = 'I' if vcount > 65535 else 'H'
+    indices = list(struct.unpack_from(f'<{icount}{fmt}', b, off))
+    off += icount * struct.calcsize(fmt)
+    submeshes = [list(SUBMESH.unpack_from(b, off + SUBMESH.size * i)) for i in range(scount)]
+    off += SUBMESH.size * scount
+    m = {'version': ver, 'header': h, 'verts': verts, 'indices': indices, 'submeshes': submeshes,
+         'palettes': None, 'bone_table': None, 'max_bones': 0, 'bytes': len(b)}
+    if flags & HAS_BONE_PALETTES:
+        m['max_bones'], bcount, _, _ = MESH_BONE_PALETTE_HEADER.unpack_from(b, off)
+        off += MESH_BONE_PALETTE_HEADER.size
+        m['palettes'] = [list(MESH_BONE_PALETTE.unpack_from(b, off + MESH_BONE_PALETTE.size * i)) for i in range(scount)]
+        off += MESH_BONE_PALETTE.size * scount
+        m['bone_table'] = list(struct.unpack_from(f'<{bcount}H', b, off))
+        off += 2 * bcount
+    m['lods'] = None
+    if flags & HAS_LODS:
+        off = (off + 3) & ~3
+        L = h[12]
+        m['lods'] = [[MESH_LOD_RANGE.unpack_from(b, off + MESH_LOD_RANGE.size * (i * L + k))[:3] for k in range(L)]
+                     for i in range(scount)]
+    return m
+
+
+def write_mesh(path, m):
+    vcount = len(m['verts'])
+    fmt = 'I' if vcount > 65535 else 'H'
+    h = list(m['header'])
+    h[0], h[1], h[3] = vcount, len(m['indices']), len(m['submeshes'])
+    body = bytearray(MESH_HEADER.pack(*h))
+    for v in m['verts']:
+        body += v
+    body += struct.pack(f"<{len(m['indices'])}{fmt}", *m['indices'])
+    for sm in m['submeshes']:
+        body += SUBMESH.pack(*sm)
+    if m['palettes'] is not None:
+        body += MESH_BONE_PALETTE_HEADER.pack(m['max_bones'], len(m['bone_table']), 0, 0)
+        for pal in m['palettes']:
+            body += MESH_BONE_PALETTE.pack(*pal)
+        body += struct.pack(f"<{len(m['bone_table'])}H", *m['bone_table'])
+        while len(body) % 4:
+            body.append(0)
+    if m.get('lods'):
+        while len(body) % 4:
+            body.append(0)
+        for row in m['lods']:
+            for io, ic, err in row:
+                body += MESH_LOD_RANGE.pack(io, ic, err, 0)
+    out = FILE_HEADER.pack(b'MESH', m['version'], FILE_HEADER.size + len(body), 0) + bytes(body)
+    with open(path, 'wb') as fp:
+        fp.write(out)
+    return len(out)
+
+
+def mesh_vertex_attrs(m):
+    """按格式解出 (pos, nrm, tangent4, uv, 骨骼 8 字节)；v2 按运行时规则反量化"""
+    h = m['header']
+    skinned = bool(h[4] & HAS_SKIN)
+    out = []
+    if m['version'] == MESH_VERSION_V2:
+        fmt = SKINNED_VERTEX_V2 if skinned else MESH_VERTEX_V2
+        bmin, ext = h[5:8], [h[8 + a] - h[5 + a] for a in range(3)]
+        for v in m['verts']:
+            q = fmt.unpack(v)
+            pos = tuple(bmin[a] + q[a] / 65535.0 * ext[a] for a in range(3))
+            tan = (*oct_decode(q[6:8]), 1.0 if q[3] >= 32768 else -1.0)
+            out.append((pos, oct_decode(q[4:6]), tan, q[8:10], v[20:28] if skinned else b''))
+    else:
+        fmt = SKINNED_VERTEX_V1 if skinned else MESH_VERTEX_V0
+        for v in m['verts']:
+            q = fmt.unpack(v)
+            out.append((q[0:3], q[3:6], q[6:10], q[10:12], v[48:56] if skinned else b''))
+    return out
+
+
+def mesh_vertex_groups(m):
+    """顶点只能在组内合并 / 重排：拆分过的网格每个子网格一组（boneIdx 是局部下标），否则整体一组"""
+    if m['palettes'] is None:
+        return [(0, len(m['verts']), list(range(len(m['submeshes']))))]
+    return [(p[2], p[3], [i]) for i, p in enumerate(m['palettes'])]
+
+
+# ---------------------------------------------------------
+# 顶点缓存统计（FIFO 模拟）
+#  ACMR = 变换的顶点数 / 三角形数（下限 ~0.5）；ATVR = 变换的顶点数 / 引用到的顶点数（下限 1.0）
+# ---------------------------------------------------------
+def cache_stats(indices, cache_size):
+    fifo, live, miss = [], set(), 0
+    head = 0
+    for i in indices:
+        if i in live:
+            continue
+        miss += 1
+        fifo.append(i)
+        live.add(i)
+        if len(fifo) - head > cache_size:
+            live.discard(fifo[head])
+            head += 1
+    tris = max(1, len(indices) // 3)
+    return miss / tris, miss / max(1, len(set(indices)))
+
+
+def cache_report(indices, sizes=(16, 32)):
+    return '  '.join(f'K={k} ACMR {a:.3f} ATVR {t:.3f}' for k, (a, t) in
+                     ((k, cache_stats(indices, k)) for k in sizes))
+
+
+# ---------------------------------------------------------
+# mesh-optimize：焊接 / 骨骼权重 / 顶点缓存 / overdraw / 取顶点顺序
+# ---------------------------------------------------------
+def prune_skin_weights(m, min_weight):
+    """去掉 < min_weight 的影响，按 255 重新分配，按权重降序排（VS 的 w > 0 分支更一致）"""
+    if not (m['header'][4] & HAS_SKIN):
+        return 0
+    stride, cut = m['header'][2], min_weight * 255.0
+    pruned = 0
+    for n, v in enumerate(m['verts']):
+        idx, w = v[stride - 8:stride - 4], v[stride - 4:]
+        infl = sorted(((w[k], idx[k]) for k in range(4) if w[k] > 0), key=lambda e: -e[0])
+        keep = [e for e in infl if e[0] >= cut] or infl[:1]
+        pruned += len(infl) - len(keep)
+        total = sum(e[0] for e in keep)
+        if total > 0:
+            # 最大余数法：整数权重和保持 255
+            exact = [e[0] * 255.0 / total for e in keep]
+            nw = [int(x) for x in exact]
+            for k in sorted(range(len(keep)), key=lambda k: -(exact[k] - nw[k]))[:255 - sum(nw)]:
+                nw[k] += 1
+            keep = sorted(((nw[k], keep[k][1]) for k in range(len(keep))), key=lambda e: -e[0])
+        keep += [(0, 0)] * (4 - len(keep))
+        m['verts'][n] = v[:stride - 8] + bytes(e[1] for e in keep) + bytes(e[0] for e in keep)
+    return pruned
+
+
+def weld_vertices(m, attrs, eps_pos, eps_nrm_deg, eps_uv):
+    """SpatialSort 同样的思路：位置按 eps 分格，只和相邻格里的顶点比较其余属性；返回 旧 → 代表 的映射"""
+    cos_nrm = math.cos(math.radians(eps_nrm_deg))
+    cell = max(eps_pos, 1e-9)
+    remap = list(range(len(attrs)))
+
+    def same(a, b):
+        return (all(abs(a[0][k] - b[0][k]) <= eps_pos for k in range(3))
+                and a[1][0] * b[1][0] + a[1][1] * b[1][1] + a[1][2] * b[1][2] >= cos_nrm
+                and a[2][0] * b[2][0] + a[2][1] * b[2][1] + a[2][2] * b[2][2] >= cos_nrm and a[2][3] == b[2][3]
+                and abs(a[3][0] - b[3][0]) <= eps_uv and abs(a[3][1] - b[3][1]) <= eps_uv
+                and a[4] == b[4])
+
+    for v0, vn, _ in mesh_vertex_groups(m):
+        grid = {}
+        for i in range(v0, v0 + vn):
+            key = tuple(math.floor(c / cell) for c in attrs[i][0])
+            found = -1
+            for dx in (-1, 0, 1):
+                for dy in (-1, 0, 1):
+                    for dz in (-1, 0, 1):
+                        for j in grid.get((key[0] + dx, key[1] + dy, key[2] + dz), ()):
+                            if same(attrs[i], attrs[j]):
+                                found = j
+                                break
+                        if found >= 0:
+                            break
+                    if found >= 0:
+                        break
+                if found >= 0:
+                    break
+            if found >= 0:
+                remap[i] = found
+            else:
+                grid.setdefault(key, []).append(i)
+    return remap
+
+
+def tipsify(tris, cache_size):
+    """Tipsify（Sander et al. 2007）：按顶点扇形输出三角形；返回 (三角形顺序, 硬边界)
+    硬边界 = 扇形走不下去、从死端栈 / 游标重新开始的位置（之后的三角形与前面不共享缓存）"""
+    verts = sorted({v for t in tris for v in t})
+    local = {v: i for i, v in enumerate(verts)}
+    n = len(verts)
+    adj = [[] for _ in range(n)]
+    for ti, t in enumerate(tris):
+        for v in t:
+            adj[local[v]].append(ti)
+    live = [len(a) for a in adj]
+    stamp = [0] * n
+    emitted = [False] * len(tris)
+    dead, order, breaks = [], [], [0]
+    cursor, s = 0, cache_size + 1
+
+    def skip_dead_end():
+        nonlocal cursor
+        while dead:
+            d = dead.pop()
+            if live[d] > 0:
+                return d
+        while cursor < n:
+            if live[cursor] > 0:
+                return cursor
+            cursor += 1
+        return -1
+
+    f = 0 if n else -1
+    while f >= 0:
+        cand = []
+        for ti in adj[f]:
+            if emitted[ti]:
+                continue
+            emitted[ti] = True
+            order.append(ti)
+            for v in tris[ti]:
+                lv = local[v]
+                dead.append(lv)
+                cand.append(lv)
+                live[lv] -= 1
+                if s - stamp[lv] > cache_size:
+                    stamp[lv] = s
+                    s += 1
+        f, best = -1, -1
+        for v in cand:
+            if live[v] > 0:
+                p = s - stamp[v] if s - stamp[v] + 2 * live[v] <= cache_size else 0
+                if p > best:
+                    f, best = v, p
+        if f < 0:
+            f = skip_dead_end()
+            if f >= 0 and len(order) > breaks[-1]:
+                breaks.append(len(order))
+    return order, breaks
+
+
+def overdraw_sort(tris, order, breaks, pos, cache_size, lam):
+    """Sander 的线性时间 overdraw 排序：在硬边界之间再按 ACMR 切出软边界（簇的 ACMR 降到 lam 以下就断开），
+    簇按 dot(簇中心 - 网格中心, 簇法线) 从大到小排：朝外、容易挡住别人的簇先画"""
+    hard = set(breaks)
+    clusters, start, fifo, miss = [], 0, [], 0
+    for k, ti in enumerate(order):
+        if k in hard and k > start:
+            clusters.append(order[start:k])
+            start, fifo, miss = k, [], 0
+        for v in tris[ti]:
+            if v not in fifo:
+                miss += 1
+                fifo.append(v)
+                if len(fifo) > cache_size:
+                    fifo.pop(0)
+        if lam > 0.0 and miss / (k - start + 1) < lam and k + 1 not in hard:
+            clusters.append(order[start:k + 1])
+            start, fifo, miss = k + 1, [], 0
+    if start < len(order):
+        clusters.append(order[start:])
+
+    def face(ti):
+        a, b, c = (pos[v] for v in tris[ti])
+        e1 = [b[k] - a[k] for k in range(3)]
+        e2 = [c[k] - a[k] for k in range(3)]
+        nrm = (e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0])
+        ctr = tuple((a[k] + b[k] + c[k]) / 3.0 for k in range(3))
+        return nrm, ctr, 0.5 * math.sqrt(sum(x * x for x in nrm))
+
+    faces = [face(ti) for ti in range(len(tris))]
+    area = sum(f[2] for f in faces) or 1.0
+    mc = [sum(f[1][k] * f[2] for f in faces) / area for k in range(3)]
+    # 绕序不假定：整体的 dot(面中心 - 网格中心, 叉积) 为负说明叉积朝内
+    flip = -1.0 if sum(sum((f[1][k] - mc[k]) * f[0][k] for k in range(3)) for f in faces) < 0.0 else 1.0
+
+    def key(cl):
+        n = [sum(faces[ti][0][k] for ti in cl) for k in range(3)]
+        a = sum(faces[ti][2] for ti in cl) or 1.0
+        c = [sum(faces[ti][1][k] * faces[ti][2] for ti in cl) / a for k in range(3)]
+        ln = math.sqrt(sum(x * x for x in n)) or 1.0
+        return flip * sum((c[k] - mc[k]) * n[k] for k in range(3)) / ln
+
+    clusters.sort(key=key, reverse=True)
+    return [ti for cl in clusters for ti in cl], len(clusters)
+
+
+def optimize_mesh_data(m, opts):
+    """就地优化读进来的网格（不能带 LOD 表）；返回统计"""
+    pruned = prune_skin_weights(m, opts['min_weight']) if opts['min_weight'] > 0.0 else 0
+    attrs = mesh_vertex_attrs(m)
+    weld = weld_vertices(m, attrs, opts['weld_eps'], opts['weld_nrm_deg'], opts['weld_uv']) \
+        if opts['weld_eps'] >= 0.0 else list(range(len(attrs)))
+    pos = [a[0] for a in attrs]
+    K = opts['cache']
+
+    # 子网格内部重排三角形（子网格之间的顺序与索引区间不变）
+    new_indices, degenerate, clusters = [], 0, 0
+    for sm in m['submeshes']:
+        io, ic = sm[0], sm[1]
+        tris = []
+        for t in range(io, io + ic - 2, 3):
+            tri = tuple(weld[i] for i in m['indices'][t:t + 3])
+            if tri[0] == tri[1] or tri[1] == tri[2] or tri[0] == tri[2]:
+                degenerate += 1
+                continue
+            tris.append(tri)
+        order, breaks = tipsify(tris, K)
+        if opts['overdraw_lambda'] >= 0.0:
+            order, nc = overdraw_sort(tris, order, breaks, pos, K, opts['overdraw_lambda'])
+            clusters += nc
+        sm[0] = len(new_indices)
+        for ti in order:
+            new_indices.extend(tris[ti])
+        sm[1] = len(new_indices) - sm[0]
+
+    # 取顶点顺序：组内按首次使用的顺序重新编号，没人引用的顶点丢掉
+    vmap, new_verts = {}, []
+    for gi, (v0, vn, subs) in enumerate(mesh_vertex_groups(m)):
+        g0 = len(new_verts)
+        for si in subs:
+            sm = m['submeshes'][si]
+            for i in new_indices[sm[0]:sm[0] + sm[1]]:
+                if i not in vmap:
+                    vmap[i] = len(new_verts)
+                    new_verts.append(m['verts'][i])
+        if m['palettes'] is not None:
+            m['palettes'][gi][2], m['palettes'][gi][3] = g0, len(new_verts) - g0
+    verts_in = len(m['verts'])
+    m['indices'] = [vmap[i] for i in new_indices]
+    m['verts'] = new_verts
+    return {'pruned': pruned, 'welded': verts_in - len(set(weld)), 'verts_in': verts_in,
+            'verts_out': len(new_verts), 'degenerate': degenerate, 'clusters': clusters}
+
+
+def mesh_optimize_opts(args):
+    return {'cache': args.cache, 'min_weight': args.min_weight, 'weld_eps': args.weld_eps,
+            'weld_nrm_deg': args.weld_nrm_deg, 'weld_uv': args.weld_uv, 'overdraw_lambda': args.overdraw_lambda}
+
+
+def cmd_mesh_optimize(args):
+    opts = mesh_optimize_opts(args)
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.mesh')
+        m = read_mesh(src)
+        if m['lods'] is not None:
+            raise ValueError(f'{src}: mesh has LODs (run mesh-optimize before mesh-lod)')
+        before = cache_report(m['indices'])
+        r = optimize_mesh_data(m, opts)
+        size = write_mesh(dst, m)
+        print(f"{os.path.basename(src):24s} verts {r['verts_in']:6d} -> {r['verts_out']:6d} (welded {r['welded']})  "
+              f"tris {len(m['indices']) // 3:6d} (dropped {r['degenerate']} degenerate)  "
+              f"weights pruned {r['pruned']}  clusters {r['clusters']}  {m['bytes']} -> {size} B")
+        print(f"{'':24s} before  {before}")
+        print(f"{'':24s} after   {cache_report(m['indices'])}")
+
+
+def strip_mesh_lods(m):
+    """只留 LOD0：各子网格的索引区间拼在一起、去掉 LOD 表（mesh-analyze 用；LOD 档的区间接在 LOD0 后面，不该算进 ACMR）"""
+    if m['lods'] is None:
+        return
+    indices = []
+    for sm in m['submeshes']:
+        io, ic = sm[0], sm[1]
+        sm[0] = len(indices)
+        indices.extend(m['indices'][io:io + ic])
+    m['indices'] = indices
+    m['lods'] = None
+
+
+def cmd_mesh_analyze(args):
+    opts = mesh_optimize_opts(args)
+    files = collect_pack_inputs(args.inputs, {'.mesh'})
+    if not files:
+        raise SystemExit('no .mesh files')
+    for path in files:
+        m = read_mesh(path)
+        lods = len(m['lods'][0]) if m['lods'] else 0
+        strip_mesh_lods(m)   # 带 LOD 的网格：只统计 / 优化 LOD0（mesh-optimize 本身仍要求在 mesh-lod 之前跑）
+        stored = cache_report(m['indices'])
+        r = optimize_mesh_data(m, opts)
+        print(f"{path}: v{m['version'] >> 16} verts {r['verts_in']} tris {len(m['indices']) // 3} "
+              f"submeshes {len(m['submeshes'])}{' (split)' if m['palettes'] is not None else ''}"
+              f"{f' (LOD0 of {lods})' if lods > 1 else ''}")
+        print(f"  as stored       {stored}")
+        print(f"  mesh-optimize   {cache_report(m['indices'])}  (verts {r['verts_out']}, clusters {r['clusters']})")
+
+
+# ---------------------------------------------------------
+# mesh-lod：二次误差（QEM）简化，生成 LOD 索引区间
+#  半边折叠：顶点只能折到已有的邻居上（所有档共用一个 VB）；在按位置合并后的拓扑上做
+#  接缝（同位置多套属性）只能沿接缝折叠，边界只能沿边界折叠；非流形边的顶点锁定
+#  误差 = 二次误差 / 面积的平方根（到原始平面的面积加权 RMS 距离）
+# ---------------------------------------------------------
+def plane_quadric(n, p, w):
+    """单位法线 n、过点 p 的平面，权重 w；对称 4x4 的上三角 + 权重和"""
+    x, y, z = n
+    d = -(x * p[0] + y * p[1] + z * p[2])
+    return [w * v for v in (x * x, x * y, x * z, x * d, y * y, y * z, y * d, z * z, z * d, d * d)] + [w]
+
+
+def quadric_add(q, r):
+    return [q[k] + r[k] for k in range(11)]
+
+
+def quadric_error(q, p):
+    x, y, z = p
+    e = (q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+         + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y + q[7] * z * z + 2 * q[8] * z + q[9])
+    return math.sqrt(max(0.0, e) / q[10]) if q[10] > 0.0 else 0.0
+
+
+def tri_normal(a, b, c):
+    e1 = [b[k] - a[k] for k in range(3)]
+    e2 = [c[k] - a[k] for k in range(3)]
+    return (e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0])
+
+
+def vec_unit(v):
+    l = math.sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2])
+    return (v[0] / l, v[1] / l, v[2] / l) if l > 0.0 else None
+
+
+def simplify_lods(tris, pos, ratios):
+    """tris：顶点下标三元组；pos：下标 → 位置。按 ratios（相对 LOD0 的三角形比例，降序）依次简化，
+    返回 [(三角形列表, 误差)]，每档都在上一档的基础上继续折叠；误差取到该档为止折叠代价的最大值"""
+    import heapq
+    pid_of, pid_pos, vpid = {}, [], {}
+    for t in tris:
+        for v in t:
+            if v not in vpid:
+                key = tuple(pos[v])
+                if key not in pid_of:
+                    pid_of[key] = len(pid_pos)
+                    pid_pos.append(pos[v])
+                vpid[v] = pid_of[key]
+    P = len(pid_pos)
+
+    faces = []          # [pid 三元组, 顶点三元组, alive]
+    vfaces = [set() for _ in range(P)]
+    for t in tris:
+        pt = [vpid[v] for v in t]
+        if len(set(pt)) < 3:
+            continue
+        fi = len(faces)
+        faces.append([pt, list(t), True])
+        for p in pt:
+            vfaces[p].add(fi)
+
+    def edge_faces(a, b):
+        return [fi for fi in vfaces[a] if b in faces[fi][0]]
+
+    def neighbours(p):
+        return {q for fi in vfaces[p] for q in faces[fi][0] if q != p}
+
+    # 误差二次型：每个面的平面；边界边再加一个垂直于面、过该边的平面（保持轮廓）
+    quad = [[0.0] * 11 for _ in range(P)]
+    locked = [False] * P
+    for f in faces:
+        a, b, c = (pid_pos[p] for p in f[0])
+        n = tri_normal(a, b, c)
+        un = vec_unit(n)
+        if un is None:
+            continue
+        q = plane_quadric(un, a, 0.5 * math.sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]))
+        for p in f[0]:
+            quad[p] = quadric_add(quad[p], q)
+    for p in range(P):
+        for q in neighbours(p):
+            if q < p:
+                continue
+            ef = edge_faces(p, q)
+            if len(ef) > 2:
+                locked[p] = locked[q] = True
+            elif len(ef) == 1:
+                a, b = pid_pos[p], pid_pos[q]
+                n = tri_normal(*(pid_pos[x] for x in faces[ef[0]][0]))
+                e = [b[k] - a[k] for k in range(3)]
+                side = vec_unit((e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]))
+                if side is not None:
+                    w = e[0] * e[0] + e[1] * e[1] + e[2] * e[2]
+                    bq = plane_quadric(side, a, w)
+                    quad[p] = quadric_add(quad[p], bq)
+                    quad[q] = quadric_add(quad[q], bq)
+
+    ver = [0] * P
+    alive = [True] * P
+    heap = []
+
+    def push(a, b):
+        if not locked[a]:
+            heapq.heappush(heap, (quadric_error(quadric_add(quad[a], quad[b]), pid_pos[b]), a, b, ver[a], ver[b]))
+
+    for p in range(P):
+        for q in neighbours(p):
+            push(p, q)
+
+    def attr_map(a, b, shared):
+        """a 的每套属性 → b 在同一侧的属性；某套属性的三角形碰不到 b（折过去要造新顶点）就不能折"""
+        amap = {}
+        for fi in shared:
+            f = faces[fi]
+            va, vb = f[1][f[0].index(a)], f[1][f[0].index(b)]
+            if amap.setdefault(va, vb) != vb:
+                return None
+        for fi in vfaces[a]:
+            f = faces[fi]
+            if f[1][f[0].index(a)] not in amap:
+                return None
+        return amap
+
+    def is_border(p):
+        return any(len(edge_faces(p, q)) == 1 for q in neighbours(p))
+
+    live = total = len(faces)
+    max_err = 0.0
+    out = []
+    targets = [max(1, int(total * r)) for r in ratios]
+    ti = 0
+    while ti < len(targets):
+        if live <= targets[ti] or not heap:
+            out.append(([tuple(f[1]) for f in faces if f[2]], max_err))
+            ti += 1
+            continue
+        cost, a, b, va, vb = heapq.heappop(heap)
+        if not (alive[a] and alive[b]) or va != ver[a] or vb != ver[b]:
+            continue
+        shared = edge_faces(a, b)
+        if not shared:
+            continue
+        # 链接条件：a、b 的公共邻居只能是边 (a,b) 两侧三角形的第三个顶点，否则折叠后非流形
+        if len(neighbours(a) & neighbours(b)) != len(shared):
+            continue
+        # 边界顶点只能沿边界边折叠
+        if len(shared) != 1 and is_border(a):
+            continue
+        amap = attr_map(a, b, shared)
+        if amap is None:
+            continue
+        flip = False
+        for fi in vfaces[a]:
+            if fi in shared:
+                continue
+            pt = faces[fi][0]
+            old = tri_normal(*(pid_pos[p] for p in pt))
+            new = tri_normal(*(pid_pos[b] if p == a else pid_pos[p] for p in pt))
+            if old[0] * new[0] + old[1] * new[1] + old[2] * new[2] <= 0.0:
+                flip = True
+                break
+        if flip:
+            continue
+
+        for fi in list(vfaces[a]):
+            f = faces[fi]
+            if fi in shared:
+                f[2] = False
+                live -= 1
+                for p in f[0]:
+                    vfaces[p].discard(fi)
+                continue
+            k = f[0].index(a)
+            f[0][k] = b
+            f[1][k] = amap[f[1][k]]
+            vfaces[b].add(fi)
+        vfaces[a].clear()
+        alive[a] = False
+        quad[b] = quadric_add(quad[b], quad[a])
+        max_err = max(max_err, cost)
+        nb = neighbours(b)
+        ver[b] += 1
+        for q in nb:
+            ver[q] += 1
+        for q in nb:
+            for r in neighbours(q):
+                push(q, r)
+            push(b, q)
+    return out
+
+
+def build_mesh_lods(m, ratios, cache_size):
+    """给读进来的网格加 LOD 档（就地修改 indices / header / lods）；返回每个子网格每档的三角形数与误差"""
+    if m['header'][4] & HAS_LODS:
+        raise ValueError('mesh already has LODs')
+    pos = [a[0] for a in mesh_vertex_attrs(m)]
+    lod0 = list(m['indices'])
+    extra, table, stats = [], [], []
+    base = len(lod0)
+    for sm in m['submeshes']:
+        io, ic = sm[0], sm[1]
+        tris = [tuple(lod0[t:t + 3]) for t in range(io, io + ic - 2, 3)]
+        row = [(io, ic, 0.0)]
+        counts = [len(tris)]
+        for ltris, err in simplify_lods(tris, pos, ratios):
+            order, _ = tipsify(ltris, cache_size)
+            off = base + len(extra)
+            for ti in order:
+                extra.extend(ltris[ti])
+            row.append((off, len(ltris) * 3, err))
+            counts.append(len(ltris))
+        table.append(row)
+        stats.append((counts, [r[2] for r in row]))
+    m['indices'] = lod0 + extra
+    m['header'][4] |= HAS_LODS
+    m['header'][12] = len(ratios) + 1
+    m['lods'] = table
+    return stats
+
+
+def cmd_mesh_lod(args):
+    ratios = [float(r) for r in args.ratios.split(',') if r]
+    if not 1 <= len(ratios) <= MESH_MAX_LODS - 1 or any(not 0.0 < r < 1.0 for r in ratios) or ratios != sorted(ratios, reverse=True):
+        raise SystemExit(f'--ratios: 1..{MESH_MAX_LODS - 1} descending values in (0, 1)')
+    for src in args.inputs:
+        out_dir = args.out_dir or os.path.dirname(src)
+        base = os.path.splitext(os.path.basename(src))[0]
+        dst = os.path.join(out_dir, base + args.suffix + '.mesh')
+        m = read_mesh(src)
+        stats = build_mesh_lods(m, ratios, args.cache)
+        size = write_mesh(dst, m)
+        tris = [sum(s[0][k] for s in stats) for k in range(len(ratios) + 1)]
+        errs = [max(s[1][k] for s in stats) for k in range(len(ratios) + 1)]
+        print(f"{os.path.basename(src):24s} tris " + ' / '.join(f'{t}' for t in tris)
+              + '  max err ' + ' / '.join(f'{e * 1000:.2f}mm' for e in errs)
+              + f"  {m['bytes']} -> {size} B")
+
+
+# ---------------------------------------------------------
+# 资源包
+# ---------------------------------------------------------
+def fnv1a64(data):
+    h = FNV_OFFSET
+    for b in data:
+        h = ((h ^ b) * FNV_PRIME) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def pack_path_key(path):
+    """包内路径规范化（与 asset_view.cpp AssetPack_HashPath 一致）"""
+    p = path.replace('\\', '/')
+    while p.startswith('./'):
+        p = p[2:]
+    return ''.join(c.lower() if 'A' <= c <= 'Z' else c for c in p)
+
+
+def collect_pack_inputs(inputs, exts):
+    files = []
+    for src in inputs:
+        if os.path.isdir(src):
+            for dirpath, _, names in os.walk(src):
+                files += [os.path.join(dirpath, n) for n in sorted(names)
+                          if os.path.splitext(n)[1].lower() in exts]
+        else:
+            files.append(src)
+    return files
+
+
+def write_pack(files, root, dst, align):
+    # 去重：内容哈希 + 长度相同再逐字节比较
+    blobs = []                 # (content_hash, data)
+    by_hash = {}
+    entries = {}               # path_hash -> (path, blob index)
+    for f in files:
+        key = pack_path_key(os.path.relpath(f, root))
+        if key.startswith('../'):
+            raise SystemExit(f'{f}: outside --root {root}')
+        ph = fnv1a64(key.encode('utf-8'))
+        if ph in entries:
+            if entries[ph][0] == key:
+                continue
+            raise SystemExit(f'path hash collision: {entries[ph][0]} / {key}')
+        with open(f, 'rb') as fp:
+            data = fp.read()
+        ch = fnv1a64(data)
+        idx = next((i for i in by_hash.get((ch, len(data)), []) if blobs[i][1] == data), None)
+        if idx is None:
+            idx = len(blobs)
+            blobs.append((ch, data))
+            by_hash.setdefault((ch, len(data)), []).append(idx)
+        entries[ph] = (key, idx)
+
+    def aligned(n):
+        return (n + align - 1) & ~(align - 1)
+
+    toc_end = FILE_HEADER.size + PACK_HEADER.size + PACK_ENTRY.size * len(entries)
+    offsets = []
+    pos = aligned(toc_end)
+    for _, data in blobs:
+        offsets.append(pos)
+        pos = aligned(pos + len(data))
+    total = offsets[-1] + len(blobs[-1][1]) if blobs else toc_end
+    if total > 0xFFFFFFFF:
+        raise SystemExit('pack exceeds 4 GiB')
+
+    out = bytearray(total)
+    FILE_HEADER.pack_into(out, 0, b'PACK', PACK_VERSION, total, 0)
+    PACK_HEADER.pack_into(out, FILE_HEADER.size, len(entries), len(blobs), align, 0)
+    o = FILE_HEADER.size + PACK_HEADER.size
+    for ph in sorted(entries):
+        idx = entries[ph][1]
+        PACK_ENTRY.pack_into(out, o, ph, blobs[idx][0], offsets[idx], len(blobs[idx][1]))
+        o += PACK_ENTRY.size
+    for off, (_, data) in zip(offsets, blobs):
+        out[off:off + len(data)] = data
+    with open(dst, 'wb') as fp:
+        fp.write(out)
+    return {
+        'files': len(entries), 'blobs': len(blobs), 'pack_bytes': total,
+        'loose_bytes': sum(len(blobs[i][1]) for _, i in entries.values()),
+        'paths': sorted(k for k, _ in entries.values()),
+    }
+
+
+def cmd_pack(args):
+    if args.align < 16 or args.align & (args.align - 1):
+        raise SystemExit('--align must be a power of two >= 16')
+    exts = {e if e.startswith('.') else '.' + e for e in args.ext.lower().split(',') if e}
+    files = collect_pack_inputs(args.inputs, exts)
+    if not files:
+        raise SystemExit('no input files')
+    r = write_pack(files, args.root, args.out, args.align)
+    for path in r['paths']:
+        print(f'  {path}')
+    print(f"{args.out}: {r['files']} files, {r['blobs']} unique blobs, "
+          f"{r['loose_bytes']} -> {r['pack_bytes']} B ({r['pack_bytes'] / max(1, r['loose_bytes']) * 100:.1f}%)")
+
+
+# ---------------------------------------------------------
+# main
+# ---------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description='asset post-processing tool')
+    sub = ap.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('anim-compress', help='.anim v1 -> v2 (compressed)')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--skel', default=None, help='skeleton for model-space error (default: same name .skel)')
+    p.add_argument('--tol-trans', type=float, default=0.0002, help='translation tolerance (m)')
+    p.add_argument('--tol-rot-deg', type=float, default=0.05, help='rotation tolerance (deg)')
+    p.add_argument('--tol-scale', type=float, default=0.0001, help='scale tolerance')
+    p.set_defaults(func=cmd_anim_compress)
+
+    p = sub.add_parser('root-motion', help='append pre-integrated motion-root curves to .anim v1')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--skel', default=None, help='skeleton (default: same name .skel)')
+    p.add_argument('--root', default=None, help='motion-root joint name (default: Hips / Root / parent == -1)')
+    p.set_defaults(func=cmd_root_motion)
+
+    p = sub.add_parser('anim-events', help='write the event track of .anim (v1 / v2) from JSON')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--events', default=None, help='event JSON (default: same name .events.json)')
+    p.set_defaults(func=cmd_anim_events)
+
+    p = sub.add_parser('anim-joints', help='write the joint-name table of .anim (v1 / v2) for retargeting')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--skel', default=None, help='skeleton the clip was exported with (default: same name .skel)')
+    p.set_defaults(func=cmd_anim_joints)
+
+    p = sub.add_parser('skel-meta', help='append the fixed-up bind pose and motion-root index to .skel')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.set_defaults(func=cmd_skel_meta)
+
+    p = sub.add_parser('anim-meta', help='append frame-0 motion-root yaw (local / model space) to .anim (v1 / v2)')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--skel', default=None, help='skeleton the clip was exported with (default: same name .skel)')
+    p.add_argument('--root', default=None, help='motion-root joint name (default: Hips / Root / parent == -1)')
+    p.set_defaults(func=cmd_anim_meta)
+
+    p = sub.add_parser('mesh-split', help='skinned .mesh -> submeshes with <= N bones each')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--max-bones', type=int, default=MAX_BONES, help=f'bones per submesh (12..{MAX_BONES})')
+    p.set_defaults(func=cmd_mesh_split)
+
+    p = sub.add_parser('mesh-quantize', help='.mesh v1 -> v2 (quantized vertices)')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.set_defaults(func=cmd_mesh_quantize)
+
+    for name, hlp in (('mesh-optimize', '.mesh weld / skin-weight prune / vertex cache + overdraw + fetch reorder'),
+                      ('mesh-analyze', 'report ACMR / ATVR of .mesh files before and after mesh-optimize')):
+        p = sub.add_parser(name, help=hlp)
+        p.add_argument('inputs', nargs='+', help='files' if name == 'mesh-optimize' else 'files or directories')
+        if name == 'mesh-optimize':
+            p.add_argument('--out-dir', default=None)
+            p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+        p.add_argument('--cache', type=int, default=16, help='post-transform cache size for Tipsify (entries)')
+        p.add_argument('--min-weight', type=float, default=0.01, help='drop skin influences below this (0 = keep all)')
+        p.add_argument('--weld-eps', type=float, default=1e-5, help='weld position tolerance (negative = no welding)')
+        p.add_argument('--weld-nrm-deg', type=float, default=0.5, help='weld normal / tangent tolerance (deg)')
+        p.add_argument('--weld-uv', type=float, default=1e-5, help='weld UV tolerance')
+        p.add_argument('--overdraw-lambda', type=float, default=0.0,
+                       help='split clusters when their ACMR drops below this (0 = hard boundaries only, negative = no overdraw sort)')
+        p.set_defaults(func=cmd_mesh_optimize if name == 'mesh-optimize' else cmd_mesh_analyze)
+
+    p = sub.add_parser('mesh-lod', help='.mesh -> + QEM-simplified LOD index ranges per submesh')
+    p.add_argument('inputs', nargs='+')
+    p.add_argument('--out-dir', default=None)
+    p.add_argument('--suffix', default='', help='output name suffix (default: overwrite name in out-dir)')
+    p.add_argument('--ratios', default='0.5,0.25,0.125', help='triangle ratio of LOD1.. relative to LOD0 (descending)')
+    p.add_argument('--cache', type=int, default=16, help='post-transform cache size for reordering each LOD')
+    p.set_defaults(func=cmd_mesh_lod)
+
+    p = sub.add_parser('pack', help='cooked files -> one .pak (TOC + aligned, deduplicated blobs)')
+    p.add_argument('inputs', nargs='+', help='files or directories')
+    p.add_argument('-o', '--out', required=True)
+    p.add_argument('--root', default='.', help='pack paths are relative to this directory (default: cwd)')
+    p.add_argument('--align', type=int, default=64, help='blob alignment in bytes (power of two >= 16)')
+    p.add_argument('--ext', default='.mesh,.skel,.anim,.mat', help='extensions taken from directories')
+    p.set_defaults(func=cmd_pack)
+
+    args = ap.parse_args()
+    writes = ('anim-compress', 'root-motion', 'anim-events', 'anim-joints', 'skel-meta', 'anim-meta',
+              'mesh-split', 'mesh-quantize', 'mesh-optimize', 'mesh-lod')
+    if args.cmd in writes and args.out_dir is None and args.suffix == '':
+        ap.error(f'{args.cmd}: refusing to overwrite inputs; give --out-dir or --suffix')
+    args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -29,6 +29,7 @@
 #include "mouse.h"
 #include "billboard.h"
 #include "texture.h"
+#include "anim_benchmark.h"
 using namespace DirectX;
 
 static float g_x = 0.0f;
@@ -109,6 +110,11 @@ void Game_Update(double elapsed_time)
     g_AccumulatedTime += elapsed_time;
     Cube_Update(elapsed_time);
 
+    // F9：动画 CPU 基准（结果输出到调试窗口）
+    if (KeyLogger_IsTrigger(KK_F9)) {
+        AnimBenchmark_RunAll();
+    }
+
     // 采集鼠标
     Mouse_State ms{};
     Mouse_GetState(&ms);
@@ -148,6 +154,9 @@ void Game_Update(double elapsed_time)
     // 4) 把所有和玩家相关的逻辑都交给 Player_Update
     Player_Update(elapsed_time, pin);
 
+    // 4.5) 所有角色的动画时间都推进完了 → 姿态/调色板在线程池上一起算（Draw 只负责上传）
+    ModelSkinned_EvaluatePoses();
+
     // 5) 让底层 Camera 模块更新 view/proj（原来就有）
     Camera_Update(elapsed_time);
 
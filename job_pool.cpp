@@ -0,0 +1,129 @@
+﻿#include "job_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------
+// 状态
+// ---------------------------------------------------------
+static std::vector<std::thread> gWorkers;
+static std::mutex               gMutex;
+static std::condition_variable  gWake;      // 主 → 工作线程：有新任务 / 退出
+static std::condition_variable  gDone;      // 工作线程 → 主：全部完成
+static uint64_t                 gGeneration = 0;
+static bool                     gQuit = false;
+
+// 当前任务（gMutex 下写入，gGeneration 递增后工作线程只读）
+static const JobPoolFn*         gFn = nullptr;
+static uint32_t                 gCount = 0;
+static uint32_t                 gGrain = 1;
+static uint32_t                 gParticipants = 0;   // 含调用线程
+static std::atomic<uint32_t>    gNext{ 0 };
+static std::atomic<uint32_t>    gPending{ 0 };       // 尚未完成的工作线程数
+
+// 抢块执行，直到取完
+static void RunChunks(uint32_t slot)
+{
+    for (;;) {
+        const uint32_t begin = gNext.fetch_add(gGrain, std::memory_order_relaxed);
+        if (begin >= gCount) break;
+        const uint32_t end = std::min(gCount, begin + gGrain);
+        (*gFn)(begin, end, slot);
+    }
+}
+
+static void WorkerMain(uint32_t slot)
+{
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(gMutex);
+            gWake.wait(lk, [&] { return gQuit || gGeneration != seen; });
+            if (gQuit) return;
+            seen = gGeneration;
+            if (slot >= gParticipants) continue;   // 本次不参与
+        }
+
+        RunChunks(slot);
+
+        if (gPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lk(gMutex);
+            gDone.notify_one();
+        }
+    }
+}
+
+// ---------------------------------------------------------
+// Public
+// ---------------------------------------------------------
+bool JobPool_Initialize(uint32_t workerThreads)
+{
+    JobPool_Finalize();
+
+    if (workerThreads == 0) {
+        const uint32_t hw = std::thread::hardware_concurrency();
+        workerThreads = (hw > 1) ? hw - 1 : 0;
+    }
+
+    gQuit = false;
+    gWorkers.reserve(workerThreads);
+    for (uint32_t i = 0; i < workerThreads; ++i)
+        gWorkers.emplace_back(WorkerMain, i + 1);   // slot 0 = 调用线程
+    return true;
+}
+
+void JobPool_Finalize()
+{
+    {
+        std::lock_guard<std::mutex> lk(gMutex);
+        gQuit = true;
+    }
+    gWake.notify_all();
+    for (auto& t : gWorkers) {
+        if (t.joinable()) t.join();
+    }
+    gWorkers.clear();
+}
+
+uint32_t JobPool_GetThreadCount()
+{
+    return (uint32_t)gWorkers.size() + 1;
+}
+
+void JobPool_ParallelFor(uint32_t count, uint32_t grain, const JobPoolFn& fn, uint32_t maxThreads)
+{
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    uint32_t threads = JobPool_GetThreadCount();
+    if (maxThreads > 0) threads = std::min(threads, maxThreads);
+    threads = std::min(threads, (count + grain - 1) / grain);
+
+    // 一个线程就够：不唤醒工作线程
+    if (threads <= 1) {
+        for (uint32_t b = 0; b < count; b += grain)
+            fn(b, std::min(count, b + grain), 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(gMutex);
+        gFn = &fn;
+        gCount = count;
+        gGrain = grain;
+        gParticipants = threads;
+        gNext.store(0, std::memory_order_relaxed);
+        gPending.store(threads - 1, std::memory_order_relaxed);
+        ++gGeneration;
+    }
+    gWake.notify_all();
+
+    RunChunks(0);
+
+    std::unique_lock<std::mutex> lk(gMutex);
+    gDone.wait(lk, [] { return gPending.load(std::memory_order_acquire) == 0; });
+    gFn = nullptr;
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+
+// ---------------------------------------------------------
+// 简单线程池（并行 for）
+//  - 工作线程常驻，ParallelFor 时唤醒；调用线程自己也参与
+//  - 同一时间只允许一个 ParallelFor（只从主线程调用）
+//  - 未初始化时 ParallelFor 在调用线程上串行执行
+// ---------------------------------------------------------
+
+// workerThreads = 0：硬件线程数 - 1（调用线程占一个）
+bool     JobPool_Initialize(uint32_t workerThreads = 0);
+void     JobPool_Finalize();
+
+// 参与执行的线程总数（工作线程 + 调用线程），>= 1
+uint32_t JobPool_GetThreadCount();
+
+// 把 [0, count) 按 grain 切块分给各线程，全部完成后返回
+//  fn(begin, end, slot)：slot ∈ [0, JobPool_GetThreadCount())，调用线程为 0；
+//                        同一 slot 同一时间只在一个线程上运行 → 可用来索引每线程的临时区
+//  maxThreads = 0：不限制（基准测试时用来固定线程数）
+using JobPoolFn = std::function<void(uint32_t begin, uint32_t end, uint32_t slot)>;
+void JobPool_ParallelFor(uint32_t count, uint32_t grain, const JobPoolFn& fn, uint32_t maxThreads = 0);
@@ -29,6 +29,9 @@
 #include "ModelStatic.h"
 #include "ModelSkinned.h"
 #include "AnimatorRegistry.h"
+#include "job_pool.h"
+#include "asset_view.h"
+#include "asset_stream.h"
 #pragma comment(lib, "xinput.lib")
 
 using namespace DirectX;
@@ -67,6 +70,9 @@ int APIENTRY WinMain(
 	SpriteAnim_Initialize();
 	Fade_Initialize();
 	Mouse_SetVisible(true);
+	JobPool_Initialize(); // 动画姿态并行（硬件线程数 - 1 个工作线程）
+	AssetPack_Mount(L"resources/player_anim/cooked.pak"); // cooked 资源包（cook_tool.py pack）；没有包时读散文件
+	AssetStream_Initialize(); // 异步资源加载（IO 线程 + 解码线程；GPU 资源在 AssetStream_Update 里创建）
 	//ModelSkinned_Initialize(Direct3D_GetDevice(), Direct3D_GetContext());
 	AnimatorRegistry_Initialize(Direct3D_GetDevice(), Direct3D_GetContext());
 	Game_Initialize();
@@ -171,6 +177,7 @@ int APIENTRY WinMain(
 
 				// ゲームの更新
 				KeyLogger_Update(); // キーの状態を更新
+				AssetStream_Update(); // 帧边界：收尾加载完成的资源
 				Game_Update(elapsed_time);
 				Scene_Update(elapsed_time);
 				SpriteAnim_Update(elapsed_time);
@@ -217,6 +224,10 @@ int APIENTRY WinMain(
 	Cube_Finalize();
 	ModelStatic_UnloadDefault();
 	ModelStatic_Finalize();
+	AssetStream_Finalize();
+	AnimatorRegistry_Finalize();
+	AssetPack_UnmountAll();
+	JobPool_Finalize();
 	Scene_Finalize();
 	
 
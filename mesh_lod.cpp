@@ -0,0 +1,90 @@
+﻿#include "mesh_lod.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// ---------------------------------------------------------
+// 解析：跳过 VB / IB / Submesh / 调色板表，补齐到 4 字节后是 MeshLodRange[submesh][lod]
+// ---------------------------------------------------------
+bool MeshLod_Parse(const uint8_t* data, size_t size, MeshLodInfo& out)
+{
+    out = MeshLodInfo{};
+    size_t off = 0;
+    auto need = [&](size_t n) { return size - off >= n; };
+
+    if (!need(sizeof(FileHeader) + sizeof(MeshHeader))) return false;
+    MeshHeader mh{};
+    std::memcpy(&mh, data + sizeof(FileHeader), sizeof(mh));
+    off = sizeof(FileHeader) + sizeof(MeshHeader);
+
+    const size_t vbBytes = size_t(mh.vertexCount) * mh.vertexStride;
+    const size_t ibBytes = size_t(mh.indexCount) * (mh.vertexCount > 65535 ? 4 : 2);
+    if (!need(vbBytes)) return false;
+    off += vbBytes;
+    if (!need(ibBytes)) return false;
+    off += ibBytes;
+
+    const size_t sbBytes = sizeof(Submesh) * mh.submeshCount;
+    if (!need(sbBytes)) return (mh.flags & HAS_LODS) == 0;   // 旧文件可能没有 Submesh 表
+    out.submeshBounds.resize(mh.submeshCount);
+    out.ranges.resize(mh.submeshCount);
+    for (uint32_t i = 0; i < mh.submeshCount; ++i) {
+        Submesh sm;
+        std::memcpy(&sm, data + off + i * sizeof(Submesh), sizeof(sm));
+        out.submeshBounds[i] = sm.bounds;
+        out.ranges[i] = { sm.indexOffset, sm.indexCount, 0.0f, 0 };
+    }
+    off += sbBytes;
+    if ((mh.flags & HAS_LODS) == 0) return true;
+
+    if (mh.flags & HAS_BONE_PALETTES) {
+        MeshBonePaletteHeader ph{};
+        if (!need(sizeof(ph))) return false;
+        std::memcpy(&ph, data + off, sizeof(ph));
+        off += sizeof(ph);
+        const size_t palBytes = sizeof(MeshBonePalette) * mh.submeshCount + size_t(ph.boneIndexCount) * sizeof(uint16_t);
+        if (!need(palBytes)) return false;
+        off += palBytes;
+    }
+    off = (off + 3) & ~size_t(3);
+
+    if (mh.lodCount < 1 || mh.lodCount > MESH_MAX_LODS) return false;
+    const size_t n = size_t(mh.submeshCount) * mh.lodCount;
+    if (off > size || !need(n * sizeof(MeshLodRange))) return false;
+    out.lodCount = mh.lodCount;
+    out.ranges.resize(n);
+    std::memcpy(out.ranges.data(), data + off, n * sizeof(MeshLodRange));
+    for (const MeshLodRange& r : out.ranges)
+        if (size_t(r.indexOffset) + r.indexCount > mh.indexCount || r.indexCount % 3 != 0) return false;
+    return true;
+}
+
+// ---------------------------------------------------------
+// 选档
+// ---------------------------------------------------------
+float MeshLod_ScreenSize(const AABB& box, FXMMATRIX world, const XMFLOAT3& eye, float fovY)
+{
+    const XMVECTOR mn = XMLoadFloat3((const XMFLOAT3*)box.minv);
+    const XMVECTOR mx = XMLoadFloat3((const XMFLOAT3*)box.maxv);
+    const XMVECTOR center = XMVector3TransformCoord(XMVectorScale(XMVectorAdd(mn, mx), 0.5f), world);
+
+    // 行向量约定：world.r[0..2] 是各轴方向（含缩放）
+    const float scale = std::sqrt(std::max({ XMVectorGetX(XMVector3LengthSq(world.r[0])),
+        XMVectorGetX(XMVector3LengthSq(world.r[1])), XMVectorGetX(XMVector3LengthSq(world.r[2])) }));
+    const float radius = 0.5f * XMVectorGetX(XMVector3Length(XMVectorSubtract(mx, mn))) * scale;
+
+    const float dist = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3(&eye))));
+    if (dist <= radius) return FLT_MAX;
+    return radius / (dist * std::tan(0.5f * fovY));
+}
+
+int MeshLod_Select(float screenSize, const float* thresholds, int thresholdCount, int lodCount)
+{
+    int lod = 0;
+    while (lod < thresholdCount && screenSize < thresholds[lod]) ++lod;
+    return std::min(lod, std::max(0, lodCount - 1));
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "asset_format.h"   // MeshHeader / Submesh / MeshLodRange / AABB
+
+// ---------------------------------------------------------
+// 网格 LOD（.mesh 的 HAS_LODS 表；cook_tool.py mesh-lod 生成）
+//  - 解析：从映射的 .mesh 读出子网格包围盒与每档索引区间（ModelSkinned / ModelStatic 共用）
+//  - 选档：子网格 AABB 的外接球投影到屏幕上的大小（相对屏幕高度），按阈值降档
+// 纯 CPU，不碰 D3D
+// ---------------------------------------------------------
+struct MeshLodInfo {
+    uint32_t                  lodCount = 1;     // 1 = 没有 LOD 表
+    std::vector<AABB>         submeshBounds;    // [submeshCount]
+    std::vector<MeshLodRange> ranges;           // [submesh * lodCount + lod]；LOD0 = Submesh 的区间
+};
+
+// data/size：整个 .mesh 文件；表越界 / 档数不合法返回 false（没有 HAS_LODS 时 lodCount = 1）
+bool MeshLod_Parse(const uint8_t* data, size_t size, MeshLodInfo& out);
+
+// 屏幕大小：外接球直径 / 该距离处视锥的高度（1 = 正好占满屏幕高度）
+//  box 为模型空间 AABB，world 的缩放取最大轴；相机在球内返回一个很大的值（→ LOD0）
+float MeshLod_ScreenSize(const AABB& box, DirectX::FXMMATRIX world, const DirectX::XMFLOAT3& eye, float fovY);
+
+// 默认阈值（ModelSkinned / ModelStatic 共用）：角色（~1.8m，fov 60°）约 3m / 6.5m / 16m 处降档
+static const float MESH_LOD_DEFAULT_THRESHOLDS[3] = { 0.5f, 0.25f, 0.1f };
+
+// thresholds 降序：screenSize < thresholds[i] 时至少用 LOD i+1；结果夹到 [0, lodCount-1]
+int MeshLod_Select(float screenSize, const float* thresholds, int thresholdCount, int lodCount);
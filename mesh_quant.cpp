@@ -0,0 +1,174 @@
+﻿#include "mesh_quant.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ---------------------------------------------------------
+// 八面体
+//  编码：n / (|x|+|y|+|z|) 投到八面体上，下半球（z < 0）沿对角线折到外侧，再量化为 snorm16
+//  解码：与 D3D 的 SNORM 转换一致（v / 32767，-32768 夹到 -1），再展开、归一化
+// ---------------------------------------------------------
+static float SignNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+static int16_t ToSnorm16(float v)
+{
+    v = std::min(1.0f, std::max(-1.0f, v));
+    return int16_t(std::lround(v * 32767.0f));
+}
+
+static float FromSnorm16(int16_t v)
+{
+    return std::max(-1.0f, float(v) / 32767.0f);
+}
+
+static void OctUnfold(float x, float y, float out[3])
+{
+    float z = 1.0f - std::fabs(x) - std::fabs(y);
+    const float t = std::max(-z, 0.0f);
+    x += (x >= 0.0f) ? -t : t;
+    y += (y >= 0.0f) ? -t : t;
+    const float len = std::sqrt(x * x + y * y + z * z);
+    const float inv = len > 0.0f ? 1.0f / len : 0.0f;
+    out[0] = x * inv; out[1] = y * inv; out[2] = z * inv;
+}
+
+void MeshQuant_OctEncode(const float n[3], int16_t out[2])
+{
+    const float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    if (l1 <= 0.0f) { out[0] = 0; out[1] = 0; return; }   // 零向量：解出 +Z
+
+    float x = n[0] / l1, y = n[1] / l1;
+    if (n[2] < 0.0f) {
+        const float ox = x;
+        x = (1.0f - std::fabs(y)) * SignNotZero(ox);
+        y = (1.0f - std::fabs(ox)) * SignNotZero(y);
+    }
+    out[0] = ToSnorm16(x);
+    out[1] = ToSnorm16(y);
+}
+
+void MeshQuant_OctDecode(const int16_t in[2], float out[3])
+{
+    OctUnfold(FromSnorm16(in[0]), FromSnorm16(in[1]), out);
+}
+
+// ---------------------------------------------------------
+// half
+// ---------------------------------------------------------
+uint16_t MeshQuant_FloatToHalf(float f)
+{
+    uint32_t u;
+    std::memcpy(&u, &f, 4);
+    const uint16_t sign = uint16_t((u >> 16) & 0x8000u);
+    const uint32_t absu = u & 0x7FFFFFFFu;
+
+    if (absu >= 0x7F800000u)                           // inf / NaN
+        return uint16_t(sign | 0x7C00u | (absu > 0x7F800000u ? 0x200u : 0u));
+    if (absu >= 0x477FF000u) return uint16_t(sign | 0x7C00u);   // 舍入后超出 65504
+
+    if (absu < 0x38800000u) {                          // 非规格化 / 0
+        if (absu < 0x33000000u) return sign;           // < 2^-25：舍入为 0
+        const uint32_t mant = (absu & 0x007FFFFFu) | 0x00800000u;
+        const uint32_t shift = 126u - (absu >> 23);    // 14..24
+        uint32_t h = mant >> shift;
+        const uint32_t rem = mant & ((1u << shift) - 1u);
+        const uint32_t half = 1u << (shift - 1u);
+        if (rem > half || (rem == half && (h & 1u))) ++h;
+        return uint16_t(sign | h);
+    }
+
+    uint32_t h = ((absu >> 13) - (112u << 10));        // 重新偏置指数（127 → 15）
+    const uint32_t rem = absu & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) ++h;   // 进位可以顺延到指数
+    return uint16_t(sign | h);
+}
+
+float MeshQuant_HalfToFloat(uint16_t h)
+{
+    const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+    uint32_t u;
+    if (exp == 0x1Fu) {
+        u = sign | 0x7F800000u | (mant << 13);
+    }
+    else if (exp != 0) {
+        u = sign | ((exp + 112u) << 23) | (mant << 13);
+    }
+    else if (mant == 0) {
+        u = sign;
+    }
+    else {                                             // 非规格化：规格化后再拼
+        exp = 113u;
+        while ((mant & 0x400u) == 0) { mant <<= 1; --exp; }
+        u = sign | (exp << 23) | ((mant & 0x3FFu) << 13);
+    }
+    float f;
+    std::memcpy(&f, &u, 4);
+    return f;
+}
+
+// ---------------------------------------------------------
+// 位置
+// ---------------------------------------------------------
+void MeshQuant_EncodePosition(const float p[3], const AABB& b, uint16_t out[3])
+{
+    for (int a = 0; a < 3; ++a) {
+        const float ext = b.maxv[a] - b.minv[a];
+        const float t = ext > 0.0f ? (p[a] - b.minv[a]) / ext : 0.0f;
+        out[a] = uint16_t(std::lround(std::min(1.0f, std::max(0.0f, t)) * 65535.0f));
+    }
+}
+
+void MeshQuant_DecodePosition(const uint16_t q[3], const AABB& b, float out[3])
+{
+    for (int a = 0; a < 3; ++a)
+        out[a] = b.minv[a] + (float(q[a]) / 65535.0f) * (b.maxv[a] - b.minv[a]);
+}
+
+// ---------------------------------------------------------
+// 整批
+// ---------------------------------------------------------
+void MeshQuant_DecodeSkinned(const SkinnedVertexV2* in, uint32_t count, const AABB& bounds, SkinnedVertexV1* out)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        const SkinnedVertexV2& s = in[i];
+        SkinnedVertexV1& d = out[i];
+        MeshQuant_DecodePosition(s.pos, bounds, d.pos);
+        MeshQuant_OctDecode(s.nrm, d.nrm);
+        MeshQuant_OctDecode(s.tangent, d.tangent);
+        d.tangent[3] = s.pos[3] >= 32768 ? 1.0f : -1.0f;
+        d.uv[0] = MeshQuant_HalfToFloat(s.uv[0]);
+        d.uv[1] = MeshQuant_HalfToFloat(s.uv[1]);
+        std::memcpy(d.boneIdx, s.boneIdx, 4);
+        std::memcpy(d.boneW, s.boneW, 4);
+    }
+}
+
+void MeshQuant_EncodeSkinned(const SkinnedVertexV1* in, uint32_t count, const AABB& bounds, SkinnedVertexV2* out)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        const SkinnedVertexV1& s = in[i];
+        SkinnedVertexV2& d = out[i];
+        MeshQuant_EncodePosition(s.pos, bounds, d.pos);
+        d.pos[3] = s.tangent[3] < 0.0f ? 0 : 65535;
+        MeshQuant_OctEncode(s.nrm, d.nrm);
+        MeshQuant_OctEncode(s.tangent, d.tangent);
+        d.uv[0] = MeshQuant_FloatToHalf(s.uv[0]);
+        d.uv[1] = MeshQuant_FloatToHalf(s.uv[1]);
+        std::memcpy(d.boneIdx, s.boneIdx, 4);
+        std::memcpy(d.boneW, s.boneW, 4);
+    }
+}
+
+void MeshQuant_DecodeStatic(const MeshVertexV2& in, const AABB& bounds,
+    float pos[3], float nrm[3], float tangent[4], float uv[2])
+{
+    MeshQuant_DecodePosition(in.pos, bounds, pos);
+    MeshQuant_OctDecode(in.nrm, nrm);
+    MeshQuant_OctDecode(in.tangent, tangent);
+    tangent[3] = in.pos[3] >= 32768 ? 1.0f : -1.0f;
+    uv[0] = MeshQuant_HalfToFloat(in.uv[0]);
+    uv[1] = MeshQuant_HalfToFloat(in.uv[1]);
+}
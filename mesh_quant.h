@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstdint>
+
+#include "asset_format.h"   // SkinnedVertexV1 / SkinnedVertexV2 / MeshVertexV2 / AABB
+
+// ---------------------------------------------------------
+// .mesh v2 压缩顶点的编码 / 解码（纯 CPU，与 cook_tool.py mesh-quantize、
+// shader_vertex_skinned_q_3d.hlsl 同一套规则）
+//  - 位置：bounds 内 16 位定点；切线手性放在 pos[3]
+//  - 法线 / 切线：八面体编码，snorm16 x2
+//  - UV：half
+// 用途：CPU 蒙皮 / 包围盒要 float 顶点、没有压缩版 VS 时退回 v1 上传、校验 cooker 输出
+// ---------------------------------------------------------
+
+// 单位向量 ↔ 八面体 snorm16 x2（解码结果已归一化）
+void MeshQuant_OctEncode(const float n[3], int16_t out[2]);
+void MeshQuant_OctDecode(const int16_t in[2], float out[3]);
+
+// IEEE half（就近舍入到偶数；溢出为 inf）
+uint16_t MeshQuant_FloatToHalf(float f);
+float    MeshQuant_HalfToFloat(uint16_t h);
+
+// 位置：q = round((p - minv) / (maxv - minv) * 65535)；退化的轴（extent = 0）全部为 0
+void MeshQuant_EncodePosition(const float p[3], const AABB& bounds, uint16_t out[3]);
+void MeshQuant_DecodePosition(const uint16_t q[3], const AABB& bounds, float out[3]);
+
+// 整批转换（v2 → v1 / v1 → v2）；tangent.w 只保留符号
+void MeshQuant_DecodeSkinned(const SkinnedVertexV2* in, uint32_t count, const AABB& bounds, SkinnedVertexV1* out);
+void MeshQuant_EncodeSkinned(const SkinnedVertexV1* in, uint32_t count, const AABB& bounds, SkinnedVertexV2* out);
+
+// 静态顶点：解出 v0 的 pos3 / nrm3 / tangent4 / uv2
+void MeshQuant_DecodeStatic(const MeshVertexV2& in, const AABB& bounds,
+    float pos[3], float nrm[3], float tangent[4], float uv[2]);
@@ -34,6 +34,10 @@ static void Player_Kinematic_Update(double dt,
     const PlayerUpdateInput& in,
     bool locomotionActive)
 {
+    // 混合空间给出速度时按它走（与步频一致，不滑步）；否则用常数 s_speed
+    float speed = s_speed;
+    AnimatorRegistry_GetBlendSpaceSpeed(&speed);
+
     // 1) 构建世界系下的移动向量（XZ 平面）
     //    moveDir = moveX * camRight + moveZ * camForward
     XMFLOAT3 f = in.camForwardXZ;
@@ -57,9 +61,9 @@ static void Player_Kinematic_Update(double dt,
         float a = ExpLerp01(s_turnK, static_cast<float>(dt));
         s_yaw += AngleDelta(s_yaw, targetYaw) * a;
 
-        // 3) 沿着当前移动方向前进（速度为常数 s_speed）
-        s_pos.x += v2.x * s_speed * static_cast<float>(dt);
-        s_pos.z += v2.y * s_speed * static_cast<float>(dt);
+        // 3) 沿着当前移动方向前进
+        s_pos.x += v2.x * speed * static_cast<float>(dt);
+        s_pos.z += v2.y * speed * static_cast<float>(dt);
     }
 
     // 4) 把玩家「当前真值」同步到动画系统的 BaseWorld
@@ -96,16 +100,37 @@ void Player_Update(double dt, const PlayerUpdateInput& in)
     // 2) 跑 FSM，决定当前播放的状态/动画
     PlayerSMOutput smOut = PlayerSM_Update(dt);
 
+    // 混合空间参数先写入：进入混合空间时直接用本帧参数选主剪辑
+    if (smOut.hasBlendParam) {
+        AnimatorRegistry_SetBlendParams(smOut.blendParam[0], smOut.blendParam[1]);
+    }
+
     if (smOut.changed) {
-        // 播放新动画
-        AnimatorRegistry_Play(smOut.clip, nullptr);
+        // 离开层状态：层权重按转移的 duration 淡出，基础层的动作一直在播
+        if (smOut.leftLayer) {
+            AnimatorRegistry_StopLayer(smOut.leftLayer, smOut.blendSeconds);
+        }
+        if (smOut.layer) {
+            // 层状态（如上半身攻击）：只在层上播放，下半身继续基础层的动作
+            AnimatorRegistry_PlayLayer(smOut.layer, smOut.clip, smOut.blendSeconds);
+        }
+        else if (smOut.baseChanged) {
+            // 播放新动画（按转移配置的 duration/curve 交叉淡入）
+            AnimatorRegistry_CrossFade(smOut.clip, smOut.blendSeconds, smOut.blendCurve, nullptr);
+        }
+    }
 
-        // 如果该状态没定 length_sec，就用真实动画长度回写
-        float clipSec = 0.0f;
-        if (AnimatorRegistry_DebugGetCurrentClipLengthSec(&clipSec)) {
+    // 新动画真正开始播放时（资源还在流式加载会晚几帧）：如果该状态没定 length_sec，就用真实动画长度回写
+    const bool baseStarted = AnimatorRegistry_ConsumePlayStarted();
+    float clipSec = 0.0f;
+    if (smOut.layer) {
+        if (AnimatorRegistry_ConsumeLayerStarted(smOut.layer, &clipSec)) {
             PlayerSM_OverrideCurrentStateLength(clipSec);
         }
     }
+    else if (baseStarted && AnimatorRegistry_DebugGetCurrentClipLengthSec(&clipSec)) {
+        PlayerSM_OverrideCurrentStateLength(clipSec);
+    }
 
     // 3) 根据 FSM 的 locomotionActive 决定是否允许 WASD 驱动位移
     Player_Kinematic_Update(dt, in, smOut.locomotionActive);
@@ -113,6 +138,13 @@ void Player_Update(double dt, const PlayerUpdateInput& in)
     // 4) 动画时间推进 + RootMotion 累积
     AnimatorRegistry_Update(dt);
 
+    // 本帧越过的动画事件 → FSM 触发器（下一帧 PlayerSM_Update 消费）
+    AnimEventHit events[8];
+    const uint32_t eventCount = AnimatorRegistry_GetFrameEvents(events, 8);
+    for (uint32_t i = 0; i < eventCount; ++i) {
+        PlayerSM_OnAnimEvent(events[i].name, events[i].payload);
+    }
+
     // 5) 若当前状态允许使用 RootMotion，就消费动画 Δ 并同步回玩家
     if (smOut.useRootMotion) {
         RootMotionDelta rm{};
@@ -27,13 +27,15 @@ static inline float NormalizeDeg(float d) {
 // ---------- 内部数据结构 ----------
 struct SMState {
     std::string  name;            // UTF-8
-    std::wstring clip;            // 绑定的动画名
+    std::wstring clip;            // 绑定的动画名（或混合空间名）
+    int    blendSpace = -1;       // >=0：clip 是混合空间，参数见 SMConfig::blendSpaces
     bool   loop = true;
     bool   useRootMotion = false; // none/use_delta
     float  lengthSec = 0.0f;      // 可选：clip 长度（秒），window 计算用
     // 不可打断窗口（归一化时间、多段）
     std::vector<std::pair<float, float>> uninterruptible;
     bool   locomotionAllowed = false;
+    std::wstring layer;           // 非空：clip 在该动画层上播放，基础层保持上一个基础状态的动作
 };
 
 struct SMTransition {
@@ -56,7 +58,15 @@ struct SMTransition {
     int   declOrder = 0;
 };
 
+// 混合空间：样本本身注册到 AnimatorRegistry，这里只保留参数表达式
+struct SMBlendSpace {
+    std::string name;
+    CondExpr    params[2] = {};
+    int         paramCount = 0;   // 1 或 2
+};
+
 struct SMConfig {
+    std::vector<SMBlendSpace> blendSpaces;
     std::vector<SMState>      states;
     std::vector<SMTransition> transitions;
     int   initial = 0;            // 初始状态索引
@@ -66,6 +76,7 @@ struct SMConfig {
 static SMConfig g_cfg;
 static std::unordered_map<std::string, int> g_stateIndex; // name->idx
 static int    g_cur = -1;
+static int    g_base = -1;        // 最近一个不在动画层上的状态（基础层正在播它的动作）
 static double g_timeInState = 0.0;
 static float  g_moveMag = 0.0f;
 
@@ -145,6 +156,91 @@ bool PlayerSM_LoadConfigJSON(const wchar_t* jsonPath)
     // 先同步默认缓冲（稍后也会再次覆盖一次，确保一致）
     Cond_SetTriggerBufferDefault(cfg.defaultTriggerBuffer);
 
+    // -------- blend_spaces（可选）--------
+    // { "name": "Locomotion", "params": [ "move.mag" ],
+    //   "samples": [ { "clip": "Walk", "pos": [ 0.1 ], "rate": 0.4, "speed": 0.8 }, ... ] }
+    if (auto bsA = root.find("blend_spaces"); bsA && bsA->isArray()) {
+        for (auto& jb : bsA->arr) {
+            if (!jb.isObject()) continue;
+            auto n = jb.find("name");
+            auto ps = jb.find("params");
+            auto ss = jb.find("samples");
+            if (!n || !n->isString() || !ps || !ps->isArray() || !ss || !ss->isArray()
+                || ps->arr.empty() || ps->arr.size() > 2) {
+                OutputDebugStringA("[PlayerSM] blend space needs name, params[1..2], samples[]\n");
+                continue;
+            }
+
+            SMBlendSpace sb{};
+            sb.name = n->getString();
+            bool ok = true;
+            for (auto& pe : ps->arr) {
+                std::string e = pe.isString() ? pe.getString() : std::string();
+                if (!Cond_CompileFloat(e.c_str(), &sb.params[sb.paramCount])) {
+                    OutputDebugStringA(("[PlayerSM] blend param compile failed: " + e + "\n").c_str());
+                    ok = false; break;
+                }
+                ++sb.paramCount;
+            }
+            if (!ok) continue;
+
+            AnimBlendSpaceDesc desc{};
+            desc.name.assign(sb.name.begin(), sb.name.end());
+            desc.dims = (uint32_t)sb.paramCount;
+            for (auto& js : ss->arr) {
+                if (!js.isObject()) continue;
+                AnimBlendSampleDesc smp{};
+                if (auto c = js.find("clip"); c && c->isString()) {
+                    auto cs = c->getString();
+                    smp.clip.assign(cs.begin(), cs.end());
+                }
+                if (auto pos = js.find("pos"); pos && pos->isArray()) {
+                    if (pos->arr.size() > 0) smp.x = (float)pos->arr[0].getNumber(0.0);
+                    if (pos->arr.size() > 1) smp.y = (float)pos->arr[1].getNumber(0.0);
+                }
+                if (auto r = js.find("rate"); r && r->isNumber())  smp.rate = (float)r->getNumber(1.0);
+                if (auto v = js.find("speed"); v && v->isNumber()) smp.speed = (float)v->getNumber(0.0);
+                desc.samples.push_back(std::move(smp));
+            }
+
+            // 重新加载 JSON 时 Registry 里可能已有同名的 → 视为已注册
+            if (!AnimatorRegistry_RegisterBlendSpace(desc) && !AnimatorRegistry_Has(desc.name)) {
+                OutputDebugStringA(("[PlayerSM] blend space register failed: " + sb.name + "\n").c_str());
+            }
+            cfg.blendSpaces.push_back(std::move(sb));
+        }
+    }
+
+    // -------- layers（可选）--------
+    // { "name": "UpperBody", "mode": "override", "mask": [ "mixamorig:Spine" ], "mask_weights": [ 1.0 ], "weight": 1.0 }
+    if (auto lyA = root.find("layers"); lyA && lyA->isArray()) {
+        for (auto& jl : lyA->arr) {
+            if (!jl.isObject()) continue;
+            auto n = jl.find("name");
+            if (!n || !n->isString()) {
+                OutputDebugStringA("[PlayerSM] layer without name\n");
+                continue;
+            }
+            AnimLayerDesc desc{};
+            const std::string ln = n->getString();
+            desc.name.assign(ln.begin(), ln.end());
+            if (auto m = jl.find("mode"); m && m->isString())
+                desc.mode = _stricmp(m->getString().c_str(), "additive") == 0 ? AnimLayerBlend::Additive : AnimLayerBlend::Override;
+            if (auto mk = jl.find("mask"); mk && mk->isArray()) {
+                for (auto& r : mk->arr) if (r.isString()) desc.maskRoots.push_back(r.getString());
+            }
+            if (auto mw = jl.find("mask_weights"); mw && mw->isArray()) {
+                for (auto& w : mw->arr) desc.maskWeights.push_back((float)w.getNumber(1.0));
+            }
+            if (auto w = jl.find("weight"); w && w->isNumber()) desc.weight = (float)w->getNumber(1.0);
+
+            // 重新加载 JSON 时 Registry 里可能已有同名的 → 视为已注册
+            if (!AnimatorRegistry_RegisterLayer(desc) && !AnimatorRegistry_HasLayer(desc.name)) {
+                OutputDebugStringA(("[PlayerSM] layer register failed: " + ln + "\n").c_str());
+            }
+        }
+    }
+
     // -------- states --------
     auto stA = root.find("states");
     if (!stA || !stA->isArray()) {
@@ -166,6 +262,15 @@ bool PlayerSM_LoadConfigJSON(const wchar_t* jsonPath)
             auto s = c->getString();
             st.clip.assign(s.begin(), s.end());   // UTF-8 → wstring（逐字节）
         }
+        // "blend_space": 名字 → 代替 clip 播放
+        if (auto b = js.find("blend_space"); b && b->isString()) {
+            auto s = b->getString();
+            for (int i = 0; i < (int)cfg.blendSpaces.size(); ++i) {
+                if (cfg.blendSpaces[i].name == s) { st.blendSpace = i; break; }
+            }
+            if (st.blendSpace >= 0) st.clip.assign(s.begin(), s.end());
+            else OutputDebugStringA(("[PlayerSM] unknown blend_space: " + s + "\n").c_str());
+        }
 
         st.loop = js.find("loop") ? js.find("loop")->getBool(true) : true;
 
@@ -177,6 +282,12 @@ bool PlayerSM_LoadConfigJSON(const wchar_t* jsonPath)
 
         st.locomotionAllowed = js.find("locomotion") ? js.find("locomotion")->getBool(false) : false;
 
+        // "layer": 在该动画层上播放（如上半身攻击），基础层的动作继续
+        if (auto l = js.find("layer"); l && l->isString()) {
+            auto s = l->getString();
+            st.layer.assign(s.begin(), s.end());
+        }
+
         if (auto ui = js.find("uninterruptible"); ui && ui->isArray()) {
             for (auto& seg : ui->arr) {
                 if (seg.isArray() && seg.arr.size() == 2) {
@@ -298,6 +409,7 @@ bool PlayerSM_LoadConfigJSON(const wchar_t* jsonPath)
     // -------- 应用配置 --------
     g_cfg = std::move(cfg);
     g_cur = g_cfg.initial;
+    g_base = g_cfg.initial;
     g_timeInState = 0.0;
     g_moveMag = 0.0f;
 
@@ -385,6 +497,7 @@ void PlayerSM_LoadConfigDefaults()
 void PlayerSM_Reset()
 {
     g_cur = g_cfg.initial;
+    g_base = g_cfg.initial;
     g_timeInState = 0.0;
     g_moveMag = 0.0f;
 }
@@ -405,6 +518,11 @@ void PlayerSM_SetMoveInput(float x, float z)
 void PlayerSM_SetBool(const char* name, bool v) { Cond_SetBool(name, v); }
 void PlayerSM_SetFloat(const char* name, float v) { Cond_SetFloat(name, v); }
 void PlayerSM_FireTrigger(const char* name) { Cond_FireTrigger(name); }
+void PlayerSM_OnAnimEvent(const char* name, float payload) {
+    if (!name || !*name) return;
+    Cond_SetFloat((std::string("event.") + name).c_str(), payload);
+    Cond_FireTrigger(name);
+}
 
 // ---------- 主更新 ----------
 PlayerSMOutput PlayerSM_Update(double dt)
@@ -481,7 +599,17 @@ PlayerSMOutput PlayerSM_Update(double dt)
         blendCurve = tr.curve;
     }
 
+    const wchar_t* leftLayer = nullptr;
+    bool baseChanged = false;
     if (changed) {
+        const auto& from = g_cfg.states[g_cur];
+        const auto& to = g_cfg.states[next];
+        if (!from.layer.empty() && from.layer != to.layer) leftLayer = from.layer.c_str();
+        if (to.layer.empty()) {
+            // 从层状态回来、且基础层已经在播这个动作 → 不重播（走路的相位不被打断）
+            baseChanged = from.layer.empty() || g_base < 0 || g_cfg.states[g_base].clip != to.clip;
+            g_base = next;
+        }
         g_cur = next;
         g_timeInState = 0.0;
     }
@@ -495,6 +623,18 @@ PlayerSMOutput PlayerSM_Update(double dt)
     out.useRootMotion = st.useRootMotion;
     out.locomotionActive = st.locomotionAllowed;
 
+    out.layer = st.layer.empty() ? nullptr : st.layer.c_str();
+    out.leftLayer = leftLayer;
+    out.baseChanged = baseChanged;
+
+    // 层状态：混合空间参数跟随基础层的状态（上半身攻击时下半身照常按输入走 / 跑）
+    const auto& baseSt = (st.layer.empty() || g_base < 0) ? st : g_cfg.states[g_base];
+    out.hasBlendParam = baseSt.blendSpace >= 0;
+    if (out.hasBlendParam) {
+        const auto& sb = g_cfg.blendSpaces[baseSt.blendSpace];
+        for (int i = 0; i < sb.paramCount; ++i) out.blendParam[i] = Cond_EvalFloat(sb.params[i]);
+    }
+
     return out;
 }
 
@@ -526,6 +666,8 @@ void PlayerSM_DebugDraw()
     ss << " Loop       : " << (st.loop ? "true" : "false") << "\n";
     ss << " RootMotion : " << (st.useRootMotion ? "true" : "false") << "\n";
     ss << " Locomotion : " << (st.locomotionAllowed ? "true" : "false") << "\n";
+    if (!st.layer.empty())
+        ss << " Layer      : " << std::string(st.layer.begin(), st.layer.end()) << "\n";
     ss << " move.mag   : " << g_moveMag << "\n";
 
     // === 新增：玩家朝向（forward 向量 + yaw 角度/度） ===
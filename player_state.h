@@ -8,10 +8,15 @@ struct PlayerSMOutput {
     const char* state;          // 最终状态名（UTF-8）
     const wchar_t* clip;           // 动画名（直接喂 AnimatorRegistry_Play / CrossFade）
     bool            changed;        // 本帧是否发生状态切换
-    float           blendSeconds;   // 预留：融合时间（秒）
-    const char* blendCurve;     // 预留：曲线名
+    float           blendSeconds;   // 融合时间（秒）→ AnimatorRegistry_CrossFade
+    const char* blendCurve;     // 曲线名（linear / ease_in / ease_out / ease_in_out）
     bool            useRootMotion;  // 本状态是否消费动画Δ
     bool            locomotionActive; // ★ 是否允许基于输入的行走位移
+    bool            hasBlendParam;  // 基础层在播混合空间 → blendParam 有效
+    float           blendParam[2];  // 混合空间参数（JSON params 求值）→ AnimatorRegistry_SetBlendParams
+    const wchar_t* layer;          // 本状态在哪个动画层上播放（nullptr = 基础层）→ AnimatorRegistry_PlayLayer
+    const wchar_t* leftLayer;      // 本帧离开的状态所在的层（nullptr = 没有）→ AnimatorRegistry_StopLayer
+    bool            baseChanged;    // 基础层要换动作（进入层状态、或从层状态回到基础层正在播的动作时为 false）
 };
 
 bool PlayerSM_LoadConfigJSON(const wchar_t* jsonPath); // 读取 JSON（占位：详见 .cpp 里的说明）
@@ -23,6 +28,9 @@ void PlayerSM_SetMoveInput(float x, float z);           // -1..1，内部会计
 void PlayerSM_SetBool(const char* name, bool v);        // e.g., grounded
 void PlayerSM_SetFloat(const char* name, float v);      // e.g., stamina
 void PlayerSM_FireTrigger(const char* name);            // e.g., Attack
+// 动画事件（AnimatorRegistry_GetFrameEvents）→ 同名触发器，转移的 "trigger" 直接写事件名
+// payload 同时写入浮点变量 "event.<name>"（条件表达式可读）
+void PlayerSM_OnAnimEvent(const char* name, float payload);
 
 // 每帧更新，做转移决策并返回执行结果
 PlayerSMOutput PlayerSM_Update(double dt);
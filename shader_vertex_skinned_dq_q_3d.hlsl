@@ -0,0 +1,117 @@
+/*==============================================================================
+   Skinned 3D 頂点シェーダー（双四元数蒙皮；输入/输出与 shader_vertex_skinned_q_3d 相同）
+==============================================================================*/
+
+// ---- 常量缓冲：与通用 VS 完全一致 ----
+cbuffer VS_CONSTANT_BUFFER : register(b0)
+{
+    float4x4 world;
+};
+
+cbuffer VS_CONSTANT_BUFFER : register(b1)
+{
+    float4x4 view;
+};
+
+cbuffer VS_CONSTANT_BUFFER : register(b2)
+{
+    float4x4 proj;
+};
+
+// ---- 双四元数调色板：每骨骼 2 个 float4（[2j] = 实部 旋转，[2j+1] = 对偶部 平移）----
+// CPU 由 invBind * animatedGlobal 转换（AnimPose_PaletteToDualQuat），不需要转置
+cbuffer VS_CONSTANT_BUFFER : register(b5)
+{
+    float4 BoneDQ[256];
+};
+
+// ---- 位置反量化：pos = posMin + unorm16 * posExtent（MeshHeader::bounds，每个模型一份）----
+cbuffer VS_CONSTANT_BUFFER : register(b6)
+{
+    float4 posMin;
+    float4 posExtent;
+};
+
+// ---- 顶点输入：与 D3D11 输入布局一一对应 ----
+struct VS_IN
+{
+    float4 posQ : POSITION; // R16G16B16A16_UNORM（w = 切线手性 0/1）
+    float2 nrmQ : NORMAL; // R16G16_SNORM（八面体）
+    float2 tangQ : TANGENT; // R16G16_SNORM（八面体；目前未使用）
+    float2 uv : TEXCOORD0; // R16G16_FLOAT
+    uint4 idx4 : BLENDINDICES; // R8G8B8A8_UINT   ->  VS 看成 uint4
+    float4 w4 : BLENDWEIGHT; // R8G8B8A8_UNORM  ->  VS 看成 float4 (0..1)
+};
+
+// ---- VS 输出：与通用 VS 完全一致（给 PS 做光照） ----
+struct VS_OUT
+{
+    float4 posH : SV_Position; // クリップ空間
+    float4 posW : POSITION0; // ワールド座標（PS 用于光照/視線ベクトル等）
+    float4 normalW : NORMAL0; // ワールド法線（w=0）
+    float4 color : COLOR0; // 顶点色；蒙皮网格没有顶点色，这里填白
+    float2 uv : TEXCOORD0;
+};
+
+// 八面体解码（与 MeshQuant_OctDecode 一致）
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += (n.x >= 0.0f) ? -t : t;
+    n.y += (n.y >= 0.0f) ? -t : t;
+    return normalize(n);
+}
+
+VS_OUT main(VS_IN vi)
+{
+    VS_OUT o;
+
+    // ------ 0) 解压 ------
+    float3 posL = posMin.xyz + vi.posQ.xyz * posExtent.xyz;
+    float3 nrmL = OctDecode(vi.nrmQ);
+
+    // ------ 1) 双四元数线性混合（DLB）------
+    float wsum = max(1e-6f, vi.w4.x + vi.w4.y + vi.w4.z + vi.w4.w);
+    float4 w = vi.w4 / wsum;
+
+    float4 r0 = BoneDQ[vi.idx4.x * 2];
+    float4 d0 = BoneDQ[vi.idx4.x * 2 + 1];
+    float4 r1 = BoneDQ[vi.idx4.y * 2];
+    float4 d1 = BoneDQ[vi.idx4.y * 2 + 1];
+    float4 r2 = BoneDQ[vi.idx4.z * 2];
+    float4 d2 = BoneDQ[vi.idx4.z * 2 + 1];
+    float4 r3 = BoneDQ[vi.idx4.w * 2];
+    float4 d3 = BoneDQ[vi.idx4.w * 2 + 1];
+
+    // 与第一个骨骼不在同一半球的取反（q 与 -q 是同一旋转）
+    float s1 = (dot(r0, r1) < 0.0f) ? -w.y : w.y;
+    float s2 = (dot(r0, r2) < 0.0f) ? -w.z : w.z;
+    float s3 = (dot(r0, r3) < 0.0f) ? -w.w : w.w;
+
+    float4 br = r0 * w.x + r1 * s1 + r2 * s2 + r3 * s3;
+    float4 bd = d0 * w.x + d1 * s1 + d2 * s2 + d3 * s3;
+
+    float len = max(1e-8f, length(br));
+    br /= len;
+    bd /= len;
+
+    // 旋转：v + 2 r.xyz × (r.xyz × v + r.w v)；平移：2 (r.w d.xyz - d.w r.xyz + r.xyz × d.xyz)
+    float3 t = 2.0f * (br.w * bd.xyz - bd.w * br.xyz + cross(br.xyz, bd.xyz));
+    float3 skinnedPos = posL + 2.0f * cross(br.xyz, cross(br.xyz, posL) + br.w * posL) + t;
+    float3 skinnedNrm = nrmL + 2.0f * cross(br.xyz, cross(br.xyz, nrmL) + br.w * nrmL);
+
+    // ------ 2) 转到世界/裁剪空间（光照交给 PS） ------
+    o.posW = mul(float4(skinnedPos, 1.0f), world);
+
+    float4 posV = mul(o.posW, view);
+    o.posH = mul(posV, proj);
+
+    float3 nW = mul(float4(normalize(skinnedNrm), 0.0f), world).xyz;
+    o.normalW = float4(normalize(nW), 0.0f);
+
+    o.color = 1.0.xxxx;
+    o.uv = vi.uv;
+
+    return o;
+}